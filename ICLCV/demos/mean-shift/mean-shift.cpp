@@ -75,7 +75,7 @@ void init(){
            << Slider(1,1000,20).out("maxCycles").label("max cycles")
            << FSlider(0.1,5,1.0).out("convergence").label("conv. crit.")
            << Slider(4,200,50).out("bandwidth").label("kernel bandwidth")
-           << Combo("epanechnikov,gaussian").handle("kernel-type").label("kernel type")
+           << Combo("epanechnikov,gaussian,flat").handle("kernel-type").label("kernel type")
            << Combo("color image,weight image").handle("vis").label("shown image")
            )
       << Show();
@@ -0,0 +1,176 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLCV/examples/assignment-benchmark.cpp                **
+** Module : ICLCV                                                  **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#include <ICLCV/HungarianAlgorithm.h>
+#include <ICLCV/JonkerVolgenantAlgorithm.h>
+#include <ICLCV/PositionTracker.h>
+#include <ICLCV/VectorTracker.h>
+#include <ICLUtils/Time.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <map>
+
+using namespace icl;
+using namespace icl::utils;
+using namespace icl::cv;
+
+static float random_value(float min, float max){
+  return min + (max-min) * (std::rand()/(float)RAND_MAX);
+}
+
+// a swarm of randomly moving targets (with a constant density); some targets
+// disappear and new ones appear in each step
+struct Swarm{
+  std::vector<Point32f> pos, vel;
+  std::vector<int> labels;
+  float size;
+  int nextLabel;
+
+  Swarm(int n):size(40*std::sqrt((float)n)),nextLabel(0){
+    for(int i=0;i<n;++i) add();
+  }
+  void add(){
+    pos.push_back(Point32f(random_value(0,size),random_value(0,size)));
+    vel.push_back(Point32f(random_value(-3,3),random_value(-3,3)));
+    labels.push_back(nextLabel++);
+  }
+  void step(float changeRate){
+    const int n = (int)pos.size(), changes = (int)(n * changeRate);
+    for(int i=0;i<changes;++i){
+      const int j = std::rand() % pos.size();
+      pos.erase(pos.begin()+j);
+      vel.erase(vel.begin()+j);
+      labels.erase(labels.begin()+j);
+    }
+    for(int i=0;i<changes;++i) add();
+    for(unsigned int i=0;i<pos.size();++i){
+      vel[i] += Point32f(random_value(-1,1),random_value(-1,1));
+      pos[i] += vel[i];
+    }
+  }
+};
+
+// counts the targets whose (valid) id has changed since the last step
+static int count_id_switches(const std::vector<int> &labels, const std::vector<int> &ids, std::map<int,int> &lastIDs){
+  int switches = 0;
+  std::map<int,int> current;
+  for(unsigned int i=0;i<labels.size();++i){
+    std::map<int,int>::const_iterator it = lastIDs.find(labels[i]);
+    if(it != lastIDs.end() && it->second != -1 && it->second != ids[i]) ++switches;
+    current[labels[i]] = ids[i];
+  }
+  lastIDs = current;
+  return switches;
+}
+
+static void benchmark_trackers(int n, bool sparse, int steps){
+  std::srand(n); // same swarm for both modes
+  Swarm s(n);
+  PositionTracker<float> pt;
+  VectorTracker vt(2,1000);
+  if(sparse){
+    pt.setAssignmentMode(sparseJonkerVolgenantAssignment,40);
+    vt.setSparseAssignment(40);
+  }
+  std::map<int,int> lastPT, lastVT;
+  double tPT = 0, tVT = 0;
+  int switchesPT = 0, switchesVT = 0;
+  for(int t=0;t<steps;++t){
+    std::vector<VectorTracker::Vec> vs(s.pos.size(),VectorTracker::Vec(2));
+    for(unsigned int i=0;i<s.pos.size();++i){
+      vs[i][0] = s.pos[i].x;
+      vs[i][1] = s.pos[i].y;
+    }
+    Time t0 = Time::now();
+    pt.pushData(s.pos);
+    if(t) tPT += t0.age().toMilliSecondsDouble();
+    t0 = Time::now();
+    vt.pushData(vs);
+    if(t) tVT += t0.age().toMilliSecondsDouble();
+
+    std::vector<int> idsPT(s.pos.size()), idsVT(s.pos.size());
+    for(unsigned int i=0;i<s.pos.size();++i){
+      idsPT[i] = pt.getID(i);
+      idsVT[i] = vt.getID(i);
+    }
+    switchesPT += count_id_switches(s.labels,idsPT,lastPT);
+    switchesVT += count_id_switches(s.labels,idsVT,lastVT);
+    s.step(0.01);
+  }
+  std::printf("%-9s %6d | %12.2f %8d | %12.2f %8d\n", sparse ? "sparse JV" : "hungarian", n,
+              tPT/(steps-1), switchesPT, tVT/(steps-1), switchesVT);
+}
+
+int main(int n, char **ppc){
+  const int maxN = n > 1 ? std::atoi(ppc[1]) : 2000;
+  const int sizes[] = { 25, 50, 100, 200, 500, 1000, 2000, 5000 };
+
+  std::printf("assignment of N targets (times in ms)\n");
+  std::printf("     N | hungarian | dense JV | sparse JV (gating) | #pairs\n");
+  for(int k=0;k<8 && sizes[k] <= maxN;++k){
+    const int N = sizes[k];
+    Swarm s(N);
+    std::vector<Point32f> a = s.pos;
+    s.step(0);
+    const std::vector<Point32f> &b = s.pos;
+
+    double tH = -1, tD = -1;
+    if(N <= 1000){
+      Array2D<float> m(N,N);
+      for(int i=0;i<N;++i){
+        for(int j=0;j<N;++j) m(i,j) = std::sqrt(a[i].distanceTo(b[j]));
+      }
+      if(N <= 200){
+        Time t = Time::now();
+        HungarianAlgorithm<float>::apply(m);
+        tH = t.age().toMilliSecondsDouble();
+      }
+      Time t = Time::now();
+      JonkerVolgenantAlgorithm<float>::apply(m);
+      tD = t.age().toMilliSecondsDouble();
+    }
+    Time t = Time::now();
+    std::vector<JonkerVolgenantAlgorithm<float>::Entry> entries;
+    JonkerVolgenantAlgorithm<float>::gate(b,a,20,entries);
+    for(unsigned int i=0;i<entries.size();++i) entries[i].cost = std::sqrt(std::sqrt(entries[i].cost));
+    std::vector<int> rows, cols;
+    JonkerVolgenantAlgorithm<float>::solve(N,N,entries,std::sqrt(20.0f),rows,cols);
+    const double tS = t.age().toMilliSecondsDouble();
+    std::printf("%6d | %9.2f | %8.2f | %18.2f | %6d\n", N, tH, tD, tS, (int)entries.size());
+  }
+
+  std::printf("\ntracking (1%% of the targets change per step, ms per step and id switches)\n");
+  std::printf("mode           N | PositionTracker switches | VectorTracker switches\n");
+  for(int k=0;k<8 && sizes[k] <= maxN;++k){
+    if(sizes[k] <= 200) benchmark_trackers(sizes[k],false,10);
+    benchmark_trackers(sizes[k],true,10);
+  }
+}
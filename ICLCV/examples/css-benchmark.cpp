@@ -0,0 +1,113 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLCV/examples/css-benchmark.cpp                       **
+** Module : ICLCV                                                  **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#include <ICLCV/CornerDetectorCSS.h>
+#include <ICLCV/RegionDetector.h>
+#include <ICLUtils/Time.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+
+using namespace icl;
+using namespace icl::utils;
+using namespace icl::core;
+using namespace icl::cv;
+
+int main(int n, char **ppc){
+  const int numShapes = n > 1 ? std::atoi(ppc[1]) : 300;
+  const Size size(1920,1080);
+
+  // image with randomly rotated rectangles and triangles
+  std::srand(42);
+  Img8u image(size,1);
+  for(int s=0;s<numShapes;++s){
+    const int cx = 40+std::rand()%(size.width-80), cy = 40+std::rand()%(size.height-80);
+    const float r = 8+std::rand()%25, a = (std::rand()%360)*M_PI/180;
+    const int numCorners = 3 + std::rand()%2;
+    float xs[4], ys[4];
+    for(int i=0;i<numCorners;++i){
+      xs[i] = cx + r*std::cos(a+i*2*M_PI/numCorners);
+      ys[i] = cy + r*std::sin(a+i*2*M_PI/numCorners);
+    }
+    for(int y=cy-r;y<=cy+r;++y){
+      for(int x=cx-r;x<=cx+r;++x){
+        bool inside = true;
+        for(int i=0;i<numCorners && inside;++i){
+          const int j = (i+1)%numCorners;
+          inside = (xs[j]-xs[i])*(y-ys[i]) - (ys[j]-ys[i])*(x-xs[i]) >= 0;
+        }
+        if(inside) image(x,y,0) = 255;
+      }
+    }
+  }
+
+  RegionDetector rd(20,100000,255,255);
+  const std::vector<ImageRegion> &rs = rd.detect(&image);
+  std::vector<Point> points;
+  std::vector<int> offsets(1,0);
+  for(unsigned int i=0;i<rs.size();++i){
+    const std::vector<Point> &b = rs[i].getBoundary();
+    points.insert(points.end(),b.begin(),b.end());
+    offsets.push_back(points.size());
+  }
+  std::printf("%d boundaries with %d points\n",(int)rs.size(),(int)points.size());
+
+  CornerDetectorCSS css;
+  std::vector<std::vector<Point32f> > single(rs.size());
+  const int N = 20;
+  Time t = Time::now();
+  for(int k=0;k<N;++k){
+    for(unsigned int i=0;i<rs.size();++i){
+      single[i] = css.detectCorners(rs[i].getBoundary());
+    }
+  }
+  std::printf("single             : %7.3f ms\n",t.age().toMilliSecondsDouble()/N);
+
+  const int threads[] = { 1, 2, 4 };
+  for(int m=0;m<3;++m){
+    css.setNumThreads(threads[m]);
+    CornerDetectorCSS::BatchResult res;
+    t = Time::now();
+    for(int k=0;k<N;++k){
+      css.detectCorners(points,offsets,res);
+    }
+    const double dt = t.age().toMilliSecondsDouble()/N;
+    int numDifferent = 0;
+    for(int i=0;i<res.getNumBoundaries();++i){
+      bool same = res.getNumCorners(i) == (int)single[i].size();
+      for(int j=0;same && j<res.getNumCorners(i);++j){
+        same = res.getCorners(i)[j] == single[i][j];
+      }
+      numDifferent += !same;
+    }
+    std::printf("batched (%d threads): %7.3f ms (%d boundaries with different corners)\n",
+                threads[m],dt,numDifferent);
+  }
+}
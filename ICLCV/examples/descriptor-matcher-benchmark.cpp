@@ -0,0 +1,117 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLCV/examples/descriptor-matcher-benchmark.cpp        **
+** Module : ICLCV                                                  **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#include <ICLCV/DescriptorMatcher.h>
+#include <ICLUtils/Time.h>
+#include <ICLUtils/StringUtils.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <cfloat>
+
+using namespace icl;
+using namespace icl::utils;
+using namespace icl::cv;
+
+static float random_value(){
+  return std::rand()/(float)RAND_MAX - 0.5f;
+}
+
+static void normalize(SurfFeature &f){
+  float s = 0;
+  for(int i=0;i<64;++i) s += f.descriptor[i]*f.descriptor[i];
+  s = std::sqrt(s);
+  for(int i=0;i<64;++i) f.descriptor[i] /= s;
+}
+
+// the former brute force matching of the SurfFeatureDetector
+static int naive_match(const std::vector<SurfFeature> &ref, const std::vector<SurfFeature> &cur, float significance){
+  int n = 0;
+  for(size_t j=0;j<cur.size();++j){
+    float ds[2] = { FLT_MAX, FLT_MAX };
+    for(size_t i=0;i<ref.size();++i){
+      const float d = ref[i] - cur[j];
+      if(d < ds[0]){
+        ds[1] = ds[0];
+        ds[0] = d;
+      }else if(d < ds[1]){
+        ds[1] = d;
+      }
+    }
+    if(ds[0]/ds[1] < significance) ++n;
+  }
+  return n;
+}
+
+int main(int n, char **ppc){
+  const int nTrain = n > 1 ? std::atoi(ppc[1]) : 5000;
+  const int nQuery = n > 2 ? std::atoi(ppc[2]) : 2000;
+  
+  // queries are noisy copies of random train descriptors (x holds the true index)
+  std::vector<SurfFeature> train(nTrain), query(nQuery);
+  for(int i=0;i<nTrain;++i){
+    for(int d=0;d<64;++d) train[i].descriptor[d] = random_value();
+    normalize(train[i]);
+  }
+  for(int i=0;i<nQuery;++i){
+    const int j = std::rand() % nTrain;
+    for(int d=0;d<64;++d) query[i].descriptor[d] = train[j].descriptor[d] + 0.05f*random_value();
+    normalize(query[i]);
+    query[i].x = j;
+  }
+
+  std::printf("%d train and %d query descriptors\n", nTrain, nQuery);
+  std::printf("method                   threads matches correct |       ms\n");
+
+  Time t = Time::now();
+  const int nNaive = naive_match(train,query,0.65f);
+  std::printf("naive                    %7d %7d       ? | %8.2f\n", 1, nNaive, t.age().toMilliSecondsDouble());
+
+  const int threads[] = { 1, 2, 4, 8 };
+  const int checks[] = { 32, 128, 512 };
+  for(int c=-1;c<3;++c){
+    for(int i=0;i<4;++i){
+      DescriptorMatcher m(c < 0 ? DescriptorMatcher::BruteForce : DescriptorMatcher::KDForest, threads[i]);
+      if(c >= 0) m.setKDForestParams(4,checks[c]);
+      m.setTrainDescriptors(train);
+      std::vector<DescriptorMatcher::Match> ms;
+      m.match(query,ms); // warm up (and kd-forest creation)
+      t = Time::now();
+      m.match(query,ms);
+      const double dt = t.age().toMilliSecondsDouble();
+      int correct = 0;
+      for(size_t j=0;j<ms.size();++j){
+        if((int)query[ms[j].query].x == ms[j].train) ++correct;
+      }
+      const std::string name = c < 0 ? std::string("brute force") : ("kd-forest (" + str(checks[c]) + " checks)");
+      std::printf("%-24s %7d %7d %7d | %8.2f\n", name.c_str(), threads[i], (int)ms.size(), correct, dt);
+    }
+  }
+}
@@ -0,0 +1,142 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLCV/examples/hough-benchmark.cpp                     **
+** Module : ICLCV                                                  **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#include <ICLCV/HoughLineDetector.h>
+#include <ICLUtils/Time.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+
+using namespace icl;
+using namespace icl::utils;
+using namespace icl::core;
+using namespace icl::math;
+using namespace icl::cv;
+
+static float random_value(float min, float max){
+  return min + (max-min) * (std::rand()/(float)RAND_MAX);
+}
+
+struct Line{ float rho, r; };
+
+// returns the number of found lines and the mean angle (deg) and distance errors of these
+static int evaluate(const std::vector<Line> &gt, const std::vector<StraightLine2D> &ls,
+                    float &angleError, float &distError){
+  int found = 0;
+  angleError = distError = 0;
+  for(size_t i=0;i<gt.size();++i){
+    float bestA = 1000, bestD = 1000;
+    for(size_t j=0;j<ls.size();++j){
+      const float r = ls[j].o.length();
+      if(!r) continue;
+      const float c = (ls[j].o[0]*std::cos(gt[i].rho) + ls[j].o[1]*std::sin(gt[i].rho))/r;
+      const float a = std::acos(c < -1 ? -1 : c > 1 ? 1 : c) * 180/M_PI;
+      const float d = std::fabs(r-gt[i].r);
+      if(a + d < bestA + bestD){
+        bestA = a;
+        bestD = d;
+      }
+    }
+    if(bestA < 3 && bestD < 10){
+      ++found;
+      angleError += bestA;
+      distError += bestD;
+    }
+  }
+  if(found){
+    angleError /= found;
+    distError /= found;
+  }
+  return found;
+}
+
+int main(int n, char **ppc){
+  const int numClutter = n > 1 ? std::atoi(ppc[1]) : 100000;
+  const int numLines = 8;
+  const Size size(640,480);
+
+  // synthetic edge image: some lines and lots of random edge pixels
+  Img8u edges(size,1);
+  Img32f gx(size,1), gy(size,1);
+  std::vector<Line> gt;
+  while((int)gt.size() < numLines){
+    Line l = { random_value(0,2*M_PI), random_value(20,500) };
+    const float c = std::cos(l.rho), s = std::sin(l.rho);
+    int count = 0;
+    for(int y=0;y<size.height;++y){
+      for(int x=0;x<size.width;++x){
+        count += std::fabs(x*c + y*s - l.r) < 0.5f;
+      }
+    }
+    if(count < 200) continue;
+    for(int y=0;y<size.height;++y){
+      for(int x=0;x<size.width;++x){
+        if(std::fabs(x*c + y*s - l.r) < 0.5f){
+          const float a = l.rho + random_value(-0.05,0.05) + (std::rand()%2) * M_PI;
+          edges(x,y,0) = 255;
+          gx(x,y,0) = std::cos(a);
+          gy(x,y,0) = std::sin(a);
+        }
+      }
+    }
+    gt.push_back(l);
+  }
+  for(int i=0;i<numClutter;++i){
+    const int x = std::rand()%size.width, y = std::rand()%size.height;
+    const float a = random_value(0,2*M_PI);
+    edges(x,y,0) = 255;
+    gx(x,y,0) = std::cos(a);
+    gy(x,y,0) = std::sin(a);
+  }
+  int numEdges = 0;
+  for(const icl8u *p = edges.begin(0); p != edges.end(0); ++p) numEdges += (*p != 0);
+  std::printf("%d edge pixels, %d lines\n", numEdges, numLines);
+  std::printf("method                  threads |       ms | found  angle-err  dist-err\n");
+
+  const Range32f rRange(0,std::sqrt(640*640+480*480));
+  for(int mode=0;mode<3;++mode){
+    const int threads[] = { 1, 2, 4 };
+    for(int t=0;t<(mode ? 3 : 1);++t){
+      HoughLineDetector h(0.05,4,rRange,20,0.3,true,true,false,false);
+      h.setPropertyValue("number of threads",threads[t]);
+      h.setPropertyValue("gradient.refine lines",mode == 2);
+      h.reset();
+      Time tt = Time::now();
+      if(mode) h.add(edges,gx,gy);
+      else h.add(edges);
+      std::vector<StraightLine2D> ls = h.getLines(numLines);
+      const double dt = tt.age().toMilliSecondsDouble();
+      float ae = 0, de = 0;
+      const int found = evaluate(gt,ls,ae,de);
+      static const char *names[] = { "full voting", "gradient voting", "gradient + refinement" };
+      std::printf("%-23s %7d | %8.2f | %5d %10.3f %9.3f\n", names[mode], threads[t], dt, found, ae, de);
+    }
+  }
+}
@@ -0,0 +1,131 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLCV/examples/lk-tracker-benchmark.cpp                **
+** Module : ICLCV                                                  **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#include <ICLCV/PyramidalLKTracker.h>
+#include <ICLUtils/Time.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+
+using namespace icl;
+using namespace icl::utils;
+using namespace icl::core;
+using namespace icl::cv;
+
+// smooth synthetic texture
+static float texture(float x, float y){
+  return 128 + 50*std::sin(x*0.11f + 0.3f*std::cos(y*0.07f)) + 40*std::cos(y*0.13f + x*0.05f)
+         + 30*std::sin((x+y)*0.31f);
+}
+
+static Img8u create_frame(const Size &size, float dx, float dy){
+  Img8u image(size,1);
+  for(int y=0;y<size.height;++y){
+    for(int x=0;x<size.width;++x){
+      const float v = texture(x-dx,y-dy);
+      image(x,y,0) = v < 0 ? 0 : v > 255 ? 255 : (icl8u)v;
+    }
+  }
+  return image;
+}
+
+int main(int n, char **ppc){
+  const int numFrames = n > 1 ? std::atoi(ppc[1]) : 30;
+  const Size size(640,480);
+  const float vx = 3.7, vy = -2.2;
+
+  std::vector<Img8u> frames(numFrames);
+  for(int i=0;i<numFrames;++i){
+    frames[i] = create_frame(size,i*vx,i*vy);
+  }
+  std::vector<Point32f> grid;
+  for(int y=20;y<size.height-20;y+=8){
+    for(int x=20;x<size.width-20;x+=8){
+      grid.push_back(Point32f(x+0.5f,y+0.5f));
+    }
+  }
+
+  std::printf("low level flow of %d points (640x480, window 15x15, 3 levels)\n",(int)grid.size());
+  std::printf("threads | ms/frame | tracked  mean-err\n");
+  const int threads[] = { 1, 2, 4 };
+  for(int t=0;t<3;++t){
+    PyramidalLKTracker lk(15,3,threads[t]);
+    std::vector<Point32f> next;
+    std::vector<icl8u> status;
+    lk.computeFlow(frames[0],grid,next,status);
+    double dt = 0, err = 0;
+    int tracked = 0;
+    for(int i=1;i<numFrames;++i){
+      Time tt = Time::now();
+      lk.computeFlow(frames[i],grid,next,status);
+      dt += tt.age().toMilliSecondsDouble();
+      for(unsigned int j=0;j<grid.size();++j){
+        if(!status[j]) continue;
+        ++tracked;
+        err += std::sqrt(std::pow(next[j].x-grid[j].x-vx,2) + std::pow(next[j].y-grid[j].y-vy,2));
+      }
+    }
+    std::printf("%7d | %8.2f | %7d %9.4f\n", threads[t], dt/(numFrames-1),
+                tracked/(numFrames-1), err/iclMax(tracked,1));
+  }
+
+  // tracking with ids: 'detections' (the moving grid points) are only passed every 10th frame
+  PyramidalLKTracker lk;
+  int idSwitches = 0;
+  std::vector<int> lastIDs;
+  double dt = 0;
+  for(int i=0;i<numFrames;++i){
+    Time tt = Time::now();
+    const bool detect = lk.needsDetections();
+    std::vector<Point32f> det;
+    if(detect){
+      for(unsigned int j=0;j<grid.size();++j){
+        const Point32f p(grid[j].x + i*vx, grid[j].y + i*vy);
+        if(p.x >= 0 && p.y >= 0 && p.x < size.width && p.y < size.height) det.push_back(p);
+      }
+    }
+    const std::vector<PyramidalLKTracker::Feature> &fs = detect ? lk.track(frames[i],det) : lk.track(frames[i]);
+    dt += tt.age().toMilliSecondsDouble();
+
+    // the features are identified by their grid point
+    std::vector<int> ids(grid.size(),-1);
+    for(unsigned int j=0;j<fs.size();++j){
+      const int gx = (int)floor((fs[j].pos.x - i*vx - 20)/8 + 0.5f);
+      const int gy = (int)floor((fs[j].pos.y - i*vy - 20)/8 + 0.5f);
+      const int idx = gy*((size.width-40+7)/8) + gx;
+      if(idx >= 0 && idx < (int)ids.size()) ids[idx] = fs[j].id;
+    }
+    for(unsigned int j=0;j<lastIDs.size();++j){
+      idSwitches += lastIDs[j] != -1 && ids[j] != -1 && lastIDs[j] != ids[j];
+    }
+    lastIDs = ids;
+  }
+  std::printf("tracking with ids: %.2f ms/frame, %d id switches\n", dt/numFrames, idSwitches);
+}
@@ -0,0 +1,98 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLCV/examples/mean-shift-benchmark.cpp                **
+** Module : ICLCV                                                  **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#include <ICLCV/MeanShiftTracker.h>
+#include <ICLUtils/Time.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+
+using namespace icl;
+using namespace icl::utils;
+using namespace icl::core;
+using namespace icl::cv;
+
+int main(int n, char **ppc){
+  const int numTargets = n > 1 ? std::atoi(ppc[1]) : 40;
+  const int bandwidth = n > 2 ? std::atoi(ppc[2]) : 30;
+  const Size size(1920,1080);
+
+  // weight image with gaussian blobs; the trackers start at some distance from the blobs
+  std::srand(42);
+  Img32f weights(size,1);
+  std::vector<Point32f> centers(numTargets), starts(numTargets);
+  for(int i=0;i<numTargets;++i){
+    centers[i] = Point32f(100 + std::rand()%(size.width-200), 100 + std::rand()%(size.height-200));
+    starts[i] = centers[i] + Point32f(std::rand()%21-10, std::rand()%21-10);
+  }
+  for(int y=0;y<size.height;++y){
+    for(int x=0;x<size.width;++x){
+      float v = 0;
+      for(int i=0;i<numTargets;++i){
+        const float dx = x-centers[i].x, dy = y-centers[i].y;
+        if(std::fabs(dx) < 60 && std::fabs(dy) < 60) v += std::exp(-(dx*dx+dy*dy)/(2*15*15));
+      }
+      weights(x,y,0) = v;
+    }
+  }
+
+  std::printf("%d targets, bandwidth %d, 1920x1080 weight image\n",numTargets,bandwidth);
+  std::printf("kernel        method    threads |    ms  | mean error  converged\n");
+  const char *names[] = { "epanechnikov", "gauss", "flat" };
+  const int threads[] = { 1, 2, 4 };
+  for(int k=0;k<3;++k){
+    MeanShiftTracker ms((MeanShiftTracker::kernelType)k, bandwidth, bandwidth/2);
+    for(int m=0;m<4;++m){
+      const bool batched = m > 0;
+      if(batched) ms.setNumThreads(threads[m-1]);
+      std::vector<Point32f> res(numTargets);
+      std::vector<bool> conv(numTargets);
+      Time t = Time::now();
+      if(batched){
+        res = ms.step(weights,starts,100,0.1,&conv);
+      }else{
+        for(int i=0;i<numTargets;++i){
+          bool c = false;
+          res[i] = ms.step(weights,starts[i],100,0.1,&c);
+          conv[i] = c;
+        }
+      }
+      const double dt = t.age().toMilliSecondsDouble();
+      float err = 0;
+      int numConverged = 0;
+      for(int i=0;i<numTargets;++i){
+        err += res[i].distanceTo(centers[i]);
+        numConverged += conv[i];
+      }
+      std::printf("%-13s %-9s %7d | %6.2f | %10.3f  %9d\n", names[k], batched ? "batched" : "single",
+                  batched ? threads[m-1] : 1, dt, err/numTargets, numConverged);
+    }
+  }
+}
@@ -0,0 +1,136 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLCV/examples/orb-benchmark.cpp                       **
+** Module : ICLCV                                                  **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#include <ICLCV/NativeORBFeatureDetector.h>
+#include <ICLIO/FileGrabber.h>
+#include <ICLCore/Img.h>
+#include <ICLUtils/Time.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+
+using namespace icl;
+using namespace icl::utils;
+using namespace icl::core;
+using namespace icl::cv;
+
+typedef NativeORBFeatureDetector Detector;
+
+// creates a textured image with random blobs
+static Img8u create_image(const Size &size){
+  Img8u image(size,formatGray);
+  for(int y=0;y<size.height;++y){
+    for(int x=0;x<size.width;++x){
+      image(x,y,0) = 128 + 60*std::sin(x*0.05)*std::cos(y*0.07) + std::rand()%20;
+    }
+  }
+  const int nBlobs = size.getDim()/1500;
+  for(int i=0;i<nBlobs;++i){
+    const int cx = std::rand()%size.width, cy = std::rand()%size.height;
+    const int r = 3 + std::rand()%15, v = std::rand()%256;
+    for(int y=iclMax(0,cy-r);y<iclMin(size.height,cy+r);++y){
+      for(int x=iclMax(0,cx-r);x<iclMin(size.width,cx+r);++x){
+        if((x-cx)*(x-cx) + (y-cy)*(y-cy) < r*r) image(x,y,0) = v;
+      }
+    }
+  }
+  return image;
+}
+
+// rotates the image by 90 degrees: (x,y) -> (h-1-y,x)
+static Img8u rotate(const Img8u &image){
+  const int w = image.getWidth(), h = image.getHeight();
+  Img8u r(Size(h,w),formatGray);
+  for(int y=0;y<h;++y){
+    for(int x=0;x<w;++x){
+      r(h-1-y,x,0) = image(x,y,0);
+    }
+  }
+  return r;
+}
+
+int main(int n, char **ppc){
+  std::vector<Img8u> images;
+  if(n > 1){
+    io::FileGrabber g(ppc[1]);
+    g.useDesired(formatGray);
+    g.useDesired(depth8u);
+    images.push_back(*g.grab()->as8u());
+  }else{
+    images.push_back(create_image(Size::VGA));
+    images.push_back(create_image(Size::HD1080));
+  }
+  const int threads[] = { 1, 2, 4, 8 };
+  const char *modes[] = { "brute force", "lsh" };
+  const int nRuns = 5;
+
+  std::printf("detection: time per frame in ms (1000 features per megapixel)\n");
+  std::printf("size        threads features |       ms\n");
+  for(unsigned int s=0;s<images.size();++s){
+    const Img8u &image = images[s];
+    for(int t=0;t<4;++t){
+      Detector d;
+      d.setPropertyValue("max features",image.getDim()/1000);
+      d.setPropertyValue("number of threads",threads[t]);
+      const int nf = d.detect(image)->getNumFeatures(); // warm up
+      Time start = Time::now();
+      for(int i=0;i<nRuns;++i) d.detect(image);
+      std::printf("%5dx%-5d %7d %8d | %8.2f\n", image.getWidth(), image.getHeight(), threads[t],
+                  nf, (Time::now()-start).toMilliSecondsDouble()/nRuns);
+    }
+  }
+
+  std::printf("\nmatching: image vs. image rotated by 90 degrees\n");
+  std::printf("size        mode         threads matches correct |       ms\n");
+  for(unsigned int s=0;s<images.size();++s){
+    const Img8u &image = images[s];
+    const int h = image.getHeight();
+    Detector d;
+    d.setPropertyValue("max features",image.getDim()/1000);
+    Detector::FeatureSet a = d.detect(image), b = d.detect(rotate(image));
+    for(int m=0;m<2;++m){
+      for(int t=0;t<4;++t){
+        d.setPropertyValue("matching.mode",modes[m]);
+        d.setPropertyValue("number of threads",threads[t]);
+        std::vector<Detector::Match> ms = d.match(a,b);
+        Time start = Time::now();
+        for(int i=0;i<nRuns;++i) d.match(a,b);
+        const double dt = (Time::now()-start).toMilliSecondsDouble()/nRuns;
+        int correct = 0;
+        for(unsigned int i=0;i<ms.size();++i){
+          const Point32f e(h-1-ms[i].a.y, ms[i].a.x);
+          if(e.distanceTo(ms[i].b) < 3) ++correct;
+        }
+        std::printf("%5dx%-5d %-12s %7d %7d %7d | %8.2f\n", image.getWidth(), image.getHeight(),
+                    modes[m], threads[t], (int)ms.size(), correct, dt);
+      }
+    }
+  }
+}
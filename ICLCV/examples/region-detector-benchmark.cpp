@@ -0,0 +1,94 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLCV/examples/region-detector-benchmark.cpp           **
+** Module : ICLCV                                                  **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#include <ICLCV/RegionDetector.h>
+#include <ICLCore/Img.h>
+#include <ICLUtils/Time.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+
+using namespace icl;
+using namespace icl::utils;
+using namespace icl::core;
+using namespace icl::cv;
+
+// creates an image with about nRegions regions of random shape
+static Img8u create_image(const Size &size, int nRegions){
+  Img8u image(size,1);
+  const int cell = std::max(2,(int)std::sqrt(double(size.getDim())/nRegions));
+  for(int y=0;y<size.height;++y){
+    for(int x=0;x<size.width;++x){
+      // alternating cells with some noise at the cell borders
+      const int jx = (x + (std::rand()%3==0)) / cell, jy = (y + (std::rand()%3==0)) / cell;
+      image(x,y,0) = (jx + 2*jy) % 3;
+    }
+  }
+  return image;
+}
+
+// detects all regions and queries the common features of each region
+static double bench(RegionDetector &rd, const Img8u &image, int n, double &checksum){
+  Time t = Time::now();
+  for(int i=0;i<n;++i){
+    const std::vector<ImageRegion> &rs = rd.detect(&image);
+    checksum = 0;
+    for(unsigned int j=0;j<rs.size();++j){
+      checksum += rs[j].getSize() + rs[j].getCOG().x + rs[j].getBoundingBox().width 
+                + rs[j].getPCAInfo().len1;
+    }
+  }
+  return (Time::now()-t).toMilliSecondsDouble()/n;
+}
+
+int main(int n, char **ppc){
+  const int nRegions = n > 1 ? std::atoi(ppc[1]) : 10000;
+  const Size sizes[] = { Size::VGA, Size::HD1080, Size(3840,2160) };
+  const int threads[] = { 1, 2, 4, 8 };
+
+  std::printf("time per frame in ms (detection + size, cog, bounding box and pca of all regions)\n");
+  std::printf("size        regions threads |  on demand accumulated\n");
+  for(int s=0;s<3;++s){
+    Img8u image = create_image(sizes[s],nRegions);
+    for(int t=0;t<4;++t){
+      RegionDetector rd;
+      rd.setNumThreads(threads[t]);
+      double c1 = 0, c2 = 0;
+      const int nRuns = 5;
+      double tLazy = bench(rd,image,nRuns,c1);
+      rd.setFeatureMask(RegionDetector::FeatureAll);
+      double tAcc = bench(rd,image,nRuns,c2);
+      std::printf("%5dx%-5d %7d %7d | %10.2f %10.2f %s\n", sizes[s].width, sizes[s].height,
+                  (int)rd.detect(&image).size(), threads[t], tLazy, tAcc, 
+                  std::fabs(c1-c2) > 1e-3*std::fabs(c1) ? "(results differ!)" : "");
+    }
+  }
+}
@@ -0,0 +1,128 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLCV/examples/region-grower-benchmark.cpp             **
+** Module : ICLCV                                                  **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#include <ICLCV/RegionGrower.h>
+#include <ICLUtils/Time.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+
+using namespace icl;
+using namespace icl::utils;
+using namespace icl::core;
+using namespace icl::cv;
+
+// compares label images and region lists (the pixel order within the regions may differ)
+static bool equal(const Img32s &a, const Img32s &b,
+                  std::vector<std::vector<int> > ra, std::vector<std::vector<int> > rb){
+  if(a.getSize() != b.getSize() || ra.size() != rb.size()) return false;
+  for(int i=0;i<a.getDim();++i){
+    if(a[0][i] != b[0][i]) return false;
+  }
+  for(unsigned int i=0;i<ra.size();++i){
+    std::sort(ra[i].begin(),ra[i].end());
+    std::sort(rb[i].begin(),rb[i].end());
+    if(ra[i] != rb[i]) return false;
+  }
+  return true;
+}
+
+int main(){
+  // organized xyzh point cloud of a depth camera (512x424): a floor, a wall
+  // and some boxes with noise and invalid (NaN) points
+  const Size size(512,424);
+  std::srand(42);
+  std::vector<float> xyzh(size.getDim()*4);
+  for(int y=0;y<size.height;++y){
+    for(int x=0;x<size.width;++x){
+      float *p = &xyzh[4*(x+y*size.width)];
+      float z = y > 250 ? 1000 + (size.height-y)*8 : 3000;
+      for(int b=0;b<6;++b){
+        const int bx = 40+b*75, by = 120+(b%3)*50;
+        if(x >= bx && x < bx+50 && y >= by && y < by+70) z = 800 + b*150 + (x-bx);
+      }
+      z += (std::rand()%100)/25.f;
+      const bool invalid = std::rand()%200 == 0;
+      p[0] = invalid ? NAN : (x-256)*z/365;
+      p[1] = invalid ? NAN : (y-212)*z/365;
+      p[2] = invalid ? NAN : z;
+      p[3] = 1;
+    }
+  }
+  DataSegment<float,4> data(xyzh.data(),4*sizeof(float),size.getDim(),size.width);
+  Img8u mask(size,1);
+  for(int x=0;x<size.width;++x){
+    mask(x,0,0) = mask(x,size.height-1,0) = 1;
+  }
+
+  // binary image for the equal threshold criterion
+  Img8u binary(size,1);
+  for(int i=0;i<300;++i){
+    const int cx = std::rand()%size.width, cy = std::rand()%size.height, r = 2+std::rand()%15;
+    for(int y=iclMax(0,cy-r);y<iclMin(size.height,cy+r);++y){
+      for(int x=iclMax(0,cx-r);x<iclMin(size.width,cx+r);++x){
+        binary(x,y,0) = 255;
+      }
+    }
+  }
+
+  const int N = 20;
+  std::printf("                          mode threads |     ms | regions identical\n");
+  for(int c=0;c<2;++c){
+    RegionGrower rg;
+    Img32s seq;
+    std::vector<std::vector<int> > seqRegions;
+    for(int m=0;m<4;++m){
+      const int threads = m ? 1 << (m-1) : 1;
+      rg.setParallelMode(m > 0,threads);
+      Img32s res;
+      Img8u m1, m2;
+      double dt = 0;
+      for(int k=0;k<N;++k){
+        // the mask is modified by the RegionGrower
+        mask.deepCopy(&m1);
+        m2 = Img8u(size,1);
+        Time t = Time::now();
+        const Img32s &r = c ? rg.applyEqualThreshold(binary,m2,255,10) :
+                              rg.applyFloat4EuclideanDistance(data,m1,20,50);
+        dt += t.age().toMilliSecondsDouble()/N;
+        if(k == N-1) r.deepCopy(&res);
+      }
+      if(!m){
+        seq = res;
+        seqRegions = rg.getRegions();
+      }
+      std::printf("%-20s %10s %7d | %6.2f | %7d %s\n", c ? "equal threshold" : "euclidean distance",
+                  m ? "parallel" : "sequential", threads, dt, (int)rg.getRegions().size(),
+                  m ? (equal(seq,res,seqRegions,rg.getRegions()) ? "yes" : "NO") : "");
+    }
+  }
+}
@@ -0,0 +1,113 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLCV/examples/surf-benchmark.cpp                      **
+** Module : ICLCV                                                  **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#include <ICLCV/SurfFeatureDetector.h>
+#include <ICLCV/NativeSurfLib.h>
+#include <ICLIO/FileGrabber.h>
+#include <ICLCore/Img.h>
+#include <ICLUtils/Time.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+
+using namespace icl;
+using namespace icl::utils;
+using namespace icl::core;
+using namespace icl::cv;
+
+// creates a textured image with random blobs
+static Img8u create_image(const Size &size){
+  Img8u image(size,formatGray);
+  for(int y=0;y<size.height;++y){
+    for(int x=0;x<size.width;++x){
+      image(x,y,0) = 128 + 60*std::sin(x*0.05)*std::cos(y*0.07) + std::rand()%20;
+    }
+  }
+  const int nBlobs = size.getDim()/1500;
+  for(int i=0;i<nBlobs;++i){
+    const int cx = std::rand()%size.width, cy = std::rand()%size.height;
+    const int r = 3 + std::rand()%15, v = std::rand()%256;
+    for(int y=iclMax(0,cy-r);y<iclMin(size.height,cy+r);++y){
+      for(int x=iclMax(0,cx-r);x<iclMin(size.width,cx+r);++x){
+        if((x-cx)*(x-cx) + (y-cy)*(y-cy) < r*r) image(x,y,0) = v;
+      }
+    }
+  }
+  return image;
+}
+
+template<class Detector>
+static double bench(Detector &d, const ImgBase *image, int n, int &nFeatures){
+  nFeatures = (int)d.detect(image).size(); // warm up
+  Time t = Time::now();
+  for(int i=0;i<n;++i){
+    d.detect(image);
+  }
+  return (Time::now()-t).toMilliSecondsDouble()/n;
+}
+
+int main(int n, char **ppc){
+  std::vector<Img8u> images;
+  if(n > 1){
+    io::FileGrabber g(ppc[1]);
+    g.useDesired(formatGray);
+    g.useDesired(depth8u);
+    images.push_back(*g.grab()->as8u());
+  }else{
+    images.push_back(create_image(Size::VGA));
+    images.push_back(create_image(Size::HD1080));
+  }
+  const int threads[] = { 1, 2, 4, 8 };
+  const int nRuns = 5;
+
+  std::printf("time per frame in ms (detection and description)\n");
+  std::printf("size        backend   threads features |       ms   features/ms\n");
+  for(unsigned int s=0;s<images.size();++s){
+    const Img8u &image = images[s];
+    for(int t=0;t<4;++t){
+      nativesurf::Surf surf(5,4,2,0.0004f);
+      surf.setNumThreads(threads[t]);
+      int nf = 0;
+      const double ms = bench(surf,&image,nRuns,nf);
+      std::printf("%5dx%-5d native    %7d %8d | %8.2f %13.2f\n", image.getWidth(), image.getHeight(),
+                  threads[t], nf, ms, nf/ms);
+    }
+#ifdef ICL_HAVE_OPENCV
+    SurfFeatureDetector opensurf(5,4,2,0.0004f,"opensurf");
+    int nf = 0;
+    const double ms = bench(opensurf,&image,nRuns,nf);
+    std::printf("%5dx%-5d opensurf  %7d %8d | %8.2f %13.2f\n", image.getWidth(), image.getHeight(),
+                1, nf, ms, nf/ms);
+#else
+    std::printf("%5dx%-5d opensurf  (not available: OpenCV support is missing)\n",
+                image.getWidth(), image.getHeight());
+#endif
+  }
+}
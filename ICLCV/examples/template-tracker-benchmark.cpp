@@ -0,0 +1,107 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLCV/examples/template-tracker-benchmark.cpp          **
+** Module : ICLCV                                                  **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#include <ICLCV/TemplateTracker.h>
+#include <ICLUtils/Time.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+
+using namespace icl;
+using namespace icl::utils;
+using namespace icl::core;
+using namespace icl::cv;
+
+static float texture(float x, float y){
+  return 128 + 50*std::sin(x*0.21f + 0.7f*std::cos(y*0.17f)) + 40*std::cos(y*0.23f + x*0.05f)
+         + 30*std::sin((x-y)*0.11f);
+}
+
+// texture rotated by angle around c and shifted by d
+static Img8u create_frame(const Point32f &c, const Point32f &d, float angle){
+  Img8u image(Size(640,480),1);
+  const float ca = std::cos(angle), sa = std::sin(angle);
+  for(int y=0;y<image.getHeight();++y){
+    for(int x=0;x<image.getWidth();++x){
+      const float u = x - c.x - d.x, v = y - c.y - d.y;
+      const float t = texture(ca*u + sa*v + c.x, -sa*u + ca*v + c.y);
+      image(x,y,0) = t < 0 ? 0 : t > 255 ? 255 : (icl8u)t;
+    }
+  }
+  return image;
+}
+
+int main(int n, char **ppc){
+  const int numRuns = n > 1 ? std::atoi(ppc[1]) : 10;
+  const Point32f c(320,240), d(13,-7);
+  const float angle = 0.25;
+
+  const Img8u f0 = create_frame(c,Point32f(0,0),0);
+  Img8u tpl(Size(48,48),1);
+  for(int y=0;y<48;++y){
+    for(int x=0;x<48;++x){
+      tpl(x,y,0) = f0(c.x-24+x,c.y-24+y,0);
+    }
+  }
+  const Img8u f1 = create_frame(c,d,angle);
+
+  std::printf("48x48 template, position range 80, rotation range 60 deg (1 deg LUT)\n");
+  std::printf("expected: pos (%.0f,%.0f), angle %.1f deg\n", c.x+d.x, c.y+d.y, angle*180/M_PI);
+  std::printf("search                   score threads |   ms (min) |      pos       angle  score\n");
+  struct Config { const char *name; int levels, coarse; bool et; };
+  const Config configs[] = {
+    { "exhaustive",               1, 1,  false },
+    { "exhaustive + early term.", 1, 1,  true },
+    { "coarse-to-fine",           3, 10, false },
+    { "coarse-to-fine + e.t.",    3, 10, true }
+  };
+  const int threads[] = { 1, 2, 4 };
+  for(int s=0;s<2;++s){
+    for(int i=0;i<4;++i){
+      for(int t=0;t<3;++t){
+        TemplateTracker tt(&tpl,1.0,80,60,configs[i].coarse,1);
+        tt.setPropertyValue("tracking.score",s ? "sad" : "ncc");
+        tt.setPropertyValue("tracking.pyramid levels",configs[i].levels);
+        tt.setPropertyValue("tracking.early termination",configs[i].et);
+        tt.setPropertyValue("number of threads",threads[t]);
+        double best = 1e38;
+        TemplateTracker::Result r;
+        for(int k=0;k<numRuns;++k){
+          const TemplateTracker::Result init(c,0,0,0);
+          Time tt0 = Time::now();
+          r = tt.track(f1,&init);
+          best = iclMin(best,tt0.age().toMilliSecondsDouble());
+        }
+        std::printf("%-24s %5s %7d | %10.2f | (%5.1f,%5.1f) %6.1f  %.3f\n", configs[i].name, s ? "sad" : "ncc",
+                    threads[t], best, r.pos.x, r.pos.y, r.angle*180/M_PI, r.proximityValue);
+      }
+    }
+  }
+}
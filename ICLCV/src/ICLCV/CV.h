@@ -32,7 +32,9 @@
 
 #include <ICLCV/Extrapolator.h>
 #include <ICLCV/HungarianAlgorithm.h>
+#include <ICLCV/JonkerVolgenantAlgorithm.h>
 #include <ICLCV/MeanShiftTracker.h>
+#include <ICLCV/PyramidalLKTracker.h>
 
 #include <ICLCV/PositionTracker.h>
 #include <ICLCV/VectorTracker.h>
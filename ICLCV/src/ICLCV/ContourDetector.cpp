@@ -30,11 +30,15 @@
 
 
 #include <ICLCV/ContourDetector.h>
+#include <ICLCV/RegionDetectorTools.h>
 
 #include <ICLCore/Img.h>
 #include <ICLUtils/SSEUtils.h>
+#include <ICLUtils/MultiThreader.h>
 
 #include <vector>
+#include <algorithm>
+#include <cstring>
 
 using namespace icl::utils;
 using namespace icl::core;
@@ -123,6 +127,185 @@ namespace icl{
     };
 
 
+    /// contour that refers to a FlatContours instance (used by ContourDetector::detect)
+    struct FlatContourImpl : public ContourImpl{
+      const Point *begin_point;
+      const Point *end_point;
+      int id;
+      int is_hole;
+      std::vector<int> children;
+
+      virtual bool hasHierarchy() const { return id != -1; }
+      virtual int getID() const { return id; }
+      virtual bool isHole() const { return is_hole; }
+      virtual const std::vector<int> &getChildren() const { return children; }
+      virtual const Point *begin() const { return begin_point; }
+      virtual const Point *end() const { return end_point; }
+    };
+
+    namespace{
+      // the union-find root is always the smaller index, i.e. the first pixel of a component
+      using region_detector_tools::uf_find;
+      using region_detector_tools::uf_union;
+
+      /// merges pixel i with its upper neighbours (8-connected fg, 4-connected bg)
+      inline void uf_join_up(const icl8u *d, int *labels, int i, int w){
+        if(d[i]){
+          if(d[i-w]) uf_union(labels,i,i-w);
+          if(d[i-w-1]) uf_union(labels,i,i-w-1);
+          if(d[i-w+1]) uf_union(labels,i,i-w+1);
+        }else if(!d[i-w]){
+          uf_union(labels,i,i-w);
+        }
+      }
+
+      /// traces a single border starting at (x,y) (8-point neighbourhood)
+      /** This is the border following of findContoursWithHierarchy without
+          marking the visited pixels. d must have a zero border */
+      void trace_border(const icl8u *d, int w, int x, int y, bool hole,
+                        std::vector<Point> &dst){
+        static const int int_to_inc[8] = {1, 1, 0, -1, -1, -1, 0, 1};
+        const icl8u *pos0 = d + y*w + x, *pos1 = 0, *pos3 = 0, *pos4 = 0;
+        const icl8u *nbs[8] = {pos0+1, pos0-w+1, pos0-w, pos0-w-1, pos0-1, pos0+w-1, pos0+w, pos0+w+1};
+        int npos = hole ? 0 : 4;
+        Point p(x,y);
+        dst.push_back(p);
+
+        // find last position of the current contour
+        for (int end = npos + 1; npos != end;) {
+          npos = (npos - 1) & 7;
+          if (*(nbs[npos])) {
+            pos1 = nbs[npos++];
+            break;
+          }
+        }
+        if(!pos1) return; // the contour is just a point
+
+        pos3 = pos0;
+        while(true){
+          for (; ; ++npos) {
+            npos &= 7;
+            if (*(nbs[npos])) {
+              pos4 = nbs[npos];
+              break;
+            }
+          }
+          if (pos4 == pos0 && pos3 == pos1) break;
+
+          p = Point(p.x + int_to_inc[npos], p.y + int_to_inc[(npos+2)&7]);
+          dst.push_back(p);
+          npos += 5;
+          pos3 = pos4;
+
+          nbs[0] = pos3 + 1;
+          nbs[1] = pos3 - w + 1;
+          nbs[2] = pos3 - w;
+          nbs[3] = pos3 - w - 1;
+          nbs[4] = pos3 - 1;
+          nbs[5] = pos3 + w - 1;
+          nbs[6] = pos3 + w;
+          nbs[7] = pos3 + w + 1;
+        }
+      }
+
+      /// work package of the strip-parallel contour detection
+      struct ContourWork : public MultiThreader::Work{
+        enum Stage { Label, Resolve, Trace };
+        Stage stage;
+        
+        const Img8u *src;     //!< source image
+        bool binarize;        //!< if false, src is already binary
+        icl8u threshold;
+        Img8u *bin;           //!< binary image with zero border
+        int *labels;          //!< union-find structure (one entry per pixel)
+        int y0, y1;           //!< strip rows
+
+        std::vector<int> roots;   //!< strip-local component roots
+        std::vector<int> starts;  //!< strip-local contour starts (root pixels)
+
+        const int *allStarts; //!< contour starts of all strips (sorted)
+        int nAllStarts;
+        int c0, c1;           //!< contour range for tracing
+        int *parents;         //!< parents destination
+        std::vector<Point> points;
+        std::vector<int> sizes;
+
+        int index_of(int root) const {
+          return (int)(std::lower_bound(allStarts,allStarts+nAllStarts,root) - allStarts);
+        }
+
+        virtual void perform(){
+          const int w = bin->getWidth(), h = bin->getHeight();
+          icl8u *d = bin->begin(0);
+          switch(stage){
+            case Label:{
+              for(int y=y0;y<y1;++y){
+                icl8u *r = d + y*w;
+                if(y == 0 || y == h-1){
+                  std::fill(r, r+w, icl8u(0));
+                  continue;
+                }
+                const icl8u *s = src->begin(0) + y*w;
+                if(binarize){
+                  for(int x=1;x<w-1;++x) r[x] = (s[x] < threshold) ? 0 : 255;
+                }else if(r != s){
+                  std::copy(s+1,s+w-1,r+1);
+                }
+                r[0] = r[w-1] = 0;
+              }
+              roots.clear();
+              for(int y=y0;y<y1;++y){
+                int i = y*w;
+                labels[i] = i;
+                if(y > y0) uf_union(labels,i,i-w); // left border pixel (bg)
+                for(++i; i<(y+1)*w; ++i){
+                  labels[i] = i;
+                  if((d[i] != 0) == (d[i-1] != 0)) uf_union(labels,i,i-1);
+                  if(y > y0 && i < (y+1)*w-1) uf_join_up(d,labels,i,w);
+                  else if(y > y0 && !d[i-w]) uf_union(labels,i,i-w);
+                }
+              }
+              // flatten (parents always have smaller indices)
+              for(int i=y0*w;i<y1*w;++i){
+                labels[i] = labels[labels[i]];
+                if(labels[i] == i) roots.push_back(i);
+              }
+              break;
+            }
+            case Resolve:{
+              starts.clear();
+              for(int i=y0*w;i<y1*w;++i){
+                const int l = labels[i];
+                if(l != i){
+                  const int r = labels[l];
+                  if(r != l) labels[i] = r;
+                }else if(i){ // everything but the outer background
+                  starts.push_back(i);
+                }
+              }
+              break;
+            }
+            case Trace:{
+              points.clear();
+              sizes.clear();
+              for(int c=c0;c<c1;++c){
+                const int i = allStarts[c];
+                const bool hole = !d[i];
+                const int x = i%w, y = i/w;
+                const size_t n = points.size();
+                // holes are traced from the foreground pixel left of their first pixel
+                trace_border(d, w, hole ? x-1 : x, y, hole, points);
+                sizes.push_back((int)(points.size()-n));
+                const int left = labels[i-1];
+                parents[c] = left ? index_of(left) : -1;
+              }
+              break;
+            }
+          }
+        }
+      };
+    }
+
     struct ContourDetector::Data{
       Img8u buffer;
       int id_count;
@@ -143,8 +326,167 @@ namespace icl{
       void findContoursFast(core::Img8u &img);
 
       void traceContour(Point pStart, Channel8u &c);
+
+      int numThreads;
+      MultiThreader mt;
+      Img8u binary;
+      std::vector<int> labels;
+      std::vector<int> allStarts;
+      std::vector<ContourWork> works;
+      FlatContours flat;
+      std::vector<FlatContourImpl> flatContours;
+
+      void runWorks(ContourWork::Stage stage){
+        MultiThreader::WorkSet ws(works.size());
+        for(unsigned int i=0;i<works.size();++i){
+          works[i].stage = stage;
+          ws[i] = &works[i];
+        }
+        if(works.size() == 1) works[0].perform();
+        else mt(ws);
+      }
+
+      void findContoursFlat(const Img8u &src, bool binarize);
+
+      void createContoursFromFlat(bool withHierarchy);
     };
 
+    void ContourDetector::Data::findContoursFlat(const Img8u &src, bool binarize){
+      FlatContours &f = flat;
+      f.points.clear();
+      f.offsets.assign(1,0);
+      f.parents.clear();
+      f.holes.clear();
+      f.childOffsets.assign(1,0);
+      f.children.clear();
+
+      if(src.getFormat() != formatGray){
+        ERROR_LOG("the image format should be formatGray");
+        return;
+      }
+      const int w = src.getWidth(), h = src.getHeight();
+      if(w < 3 || h < 3) return;
+
+      const int nThreads = iclMin(numThreads, h);
+      if(nThreads > 1 && (mt.isNull() || mt.getNumThreads() != nThreads)){
+        mt = MultiThreader(nThreads);
+      }
+      binary.setSize(src.getSize());
+      binary.setChannels(1);
+      labels.resize(w*h);
+      works.resize(nThreads);
+      for(int i=0;i<nThreads;++i){
+        ContourWork &s = works[i];
+        s.src = &src;
+        s.binarize = binarize;
+        s.threshold = threshold;
+        s.bin = &binary;
+        s.labels = labels.data();
+        s.y0 = (i*h)/nThreads;
+        s.y1 = ((i+1)*h)/nThreads;
+      }
+
+      // 1st: binarization and strip-wise labelling
+      runWorks(ContourWork::Label);
+
+      // 2nd: stitching of the strip borders
+      const icl8u *d = binary.begin(0);
+      int *l = labels.data();
+      for(int i=1;i<nThreads;++i){
+        const int y = works[i].y0;
+        uf_union(l,y*w,(y-1)*w);
+        for(int x=1;x<w-1;++x){
+          uf_join_up(d,l,y*w+x,w);
+        }
+        uf_union(l,y*w+w-1,y*w-1);
+      }
+      // strip-local roots only point to smaller roots
+      if(nThreads > 1){
+        for(int i=0;i<nThreads;++i){
+          const std::vector<int> &r = works[i].roots;
+          for(unsigned int j=0;j<r.size();++j){
+            l[r[j]] = l[l[r[j]]];
+          }
+        }
+      }
+
+      // 3rd: final labels and contour start points
+      runWorks(ContourWork::Resolve);
+      allStarts.clear();
+      for(int i=0;i<nThreads;++i){
+        allStarts.insert(allStarts.end(),works[i].starts.begin(),works[i].starts.end());
+      }
+      const int n = (int)allStarts.size();
+      f.parents.resize(n);
+      f.holes.resize(n);
+      for(int i=0;i<n;++i){
+        f.holes[i] = !d[allStarts[i]];
+      }
+
+      // 4th: parallel contour tracing
+      for(int i=0;i<nThreads;++i){
+        ContourWork &s = works[i];
+        s.allStarts = allStarts.data();
+        s.nAllStarts = n;
+        s.parents = f.parents.data();
+        s.c0 = (i*n)/nThreads;
+        s.c1 = ((i+1)*n)/nThreads;
+      }
+      runWorks(ContourWork::Trace);
+
+      f.offsets.resize(n+1);
+      int numPoints = 0;
+      for(int i=0;i<nThreads;++i){
+        const ContourWork &s = works[i];
+        for(int c=s.c0;c<s.c1;++c){
+          f.offsets[c] = numPoints;
+          numPoints += s.sizes[c-s.c0];
+        }
+      }
+      f.offsets[n] = numPoints;
+      f.points.resize(numPoints);
+      for(int i=0;i<nThreads;++i){
+        const ContourWork &s = works[i];
+        if(s.points.size()){
+          std::copy(s.points.begin(),s.points.end(),f.points.begin()+f.offsets[s.c0]);
+        }
+      }
+
+      // 5th: child lists
+      f.childOffsets.assign(n+1,0);
+      for(int i=0;i<n;++i){
+        if(f.parents[i] >= 0) ++f.childOffsets[f.parents[i]+1];
+      }
+      for(int i=0;i<n;++i){
+        f.childOffsets[i+1] += f.childOffsets[i];
+      }
+      f.children.resize(f.childOffsets[n]);
+      std::vector<int> &next = allStarts; // not needed anymore
+      next.assign(f.childOffsets.begin(),f.childOffsets.end()-1);
+      for(int i=0;i<n;++i){
+        if(f.parents[i] >= 0) f.children[next[f.parents[i]]++] = i;
+      }
+    }
+
+    void ContourDetector::Data::createContoursFromFlat(bool withHierarchy){
+      const int n = flat.getNumContours();
+      flatContours.resize(n);
+      for(int i=0;i<n;++i){
+        FlatContourImpl &c = flatContours[i];
+        c.begin_point = flat.begin(i);
+        c.end_point = flat.end(i);
+        if(withHierarchy){
+          c.id = i;
+          c.is_hole = flat.isHole(i);
+          c.children.assign(flat.childrenBegin(i),flat.childrenEnd(i));
+        }else{
+          c.id = -1;
+          c.is_hole = -1;
+          c.children.clear();
+        }
+      }
+    }
+
 
     void ContourDetector::setThreshold(const icl8u &threshold){
       m_data->threshold = threshold;
@@ -154,6 +496,14 @@ namespace icl{
       m_data->algo = algo;
     }
 
+    void ContourDetector::setNumThreads(int nThreads){
+      m_data->numThreads = iclMax(1,nThreads);
+    }
+
+    int ContourDetector::getNumThreads() const{
+      return m_data->numThreads;
+    }
+
     template<class T> static void draw_contour(Img<T> &img, const icl64f &value,
                                                const Point *begin, const Point *end){
       T *d = img.getData(0);
@@ -168,6 +518,7 @@ namespace icl{
       m_data->id_count = 0;
       m_data->threshold = thresh;
       m_data->algo = a;
+      m_data->numThreads = 1;
     };
 
     ContourDetector::~ContourDetector() {
@@ -217,6 +568,16 @@ namespace icl{
     }
 
     const std::vector<Contour> &ContourDetector::detect(core::Img<icl8u> &img) {
+      if(m_data->numThreads > 1 && m_data->algo != Fast){
+        m_data->findContoursFlat(img,false);
+        m_data->createContoursFromFlat(m_data->algo == AccurateWithHierarchy);
+        const size_t n = m_data->flatContours.size();
+        m_data->contoursRet.resize(n);
+        for(size_t i=0;i<n;++i){
+          m_data->contoursRet[i] = Contour(&m_data->flatContours[i]);
+        }
+        return m_data->contoursRet;
+      }
       if(m_data->algo == AccurateWithHierarchy){
         m_data->findContoursWithHierarchy(img);
       }else if(m_data->algo == Accurate){
@@ -251,6 +612,22 @@ namespace icl{
       return detect(m_data->buffer);
     }
 
+    const ContourDetector::FlatContours &ContourDetector::detectFlat(const core::ImgBase *image){
+      ICLASSERT_THROW(image,ICLException("ContourDetector::detectFlat: image was null"));
+      if(image->getDepth() == depth8u){
+        m_data->findContoursFlat(*image->as8u(),true);
+      }else{
+        image->convert(&m_data->buffer);
+        m_data->findContoursFlat(m_data->buffer,true);
+      }
+      return m_data->flat;
+    }
+
+    const ContourDetector::FlatContours &ContourDetector::detectFlat(const core::Img8u &image){
+      m_data->findContoursFlat(image,false);
+      return m_data->flat;
+    }
+
     void ContourDetector::Data::findContoursWithoutHierarchy(core::Img<icl8u> &_img) {
       if (_img.getFormat() != formatGray) {
         ERROR_LOG("the image format should be formatGray");
@@ -489,8 +866,9 @@ namespace icl{
           }
 
 
-          // decide the parent of the current border
-          int lc = lnbd[(*(img_d + lnbdx) & 127)] - 1;
+          // decide the parent of the current border (right sides are marked with -NBD)
+          const char lv = *(img_d + lnbdx);
+          int lc = lnbd[lv < 0 ? -lv : lv] - 1;
 
           if (lc >= 0) {
             while (lc > 126) {
@@ -508,10 +886,10 @@ namespace icl{
 
             if (c.is_hole ^ contours[lc].is_hole) {
               c.parent = lc;
-              contours[lc].children.push_back(id_count);
+              contours[lc].children.push_back(c.id);
             } else {
               c.parent = contours[lc].parent;
-              if (contours[lc].parent >= 0) contours[contours[lc].parent].children.push_back(id_count);
+              if (contours[lc].parent >= 0) contours[contours[lc].parent].children.push_back(c.id);
             }
           } else c.parent = -1;
 
@@ -108,6 +108,31 @@ namespace icl{
         hierarchy. The fast method uses its own memory allocator to improve runtime
         performance.
 
+        \section FLAT Flat Results and Parallel Detection
+        
+        In addition to the std::vector<Contour> interface, the ContourDetector
+        can provide its results in a flat representation (see 
+        ContourDetector::FlatContours), that stores all contour points in a single
+        buffer and the hierarchy in plain index arrays. Consumers can iterate over
+        this structure without any per-contour allocations. Flat results are
+        created by ContourDetector::detectFlat, which always uses the 8-point
+        neighbourhood (i.e. the results correspond to the AccurateWithHierarchy
+        algorithm).
+
+        The flat detection is implemented in a strip-parallel manner (see
+        ContourDetector::setNumThreads): The image is split into horizontal
+        strips, that are binarized and labelled independently (8-connected 
+        foreground and 4-connected background components). After stitching the
+        strip borders, each foreground component has exactly one outer border
+        and each background component, that does not touch the image border, 
+        has exactly one hole border. Both start at the first pixel of the component
+        in raster order, which is also the contour order of the sequential border 
+        following algorithm. The parent of a contour is given by the component
+        that is left of its starting point. Since contours do no longer
+        depend on each other, they are traced in parallel. The results do not 
+        depend on the number of threads. If more than one thread is used, the
+        ContourDetector::detect methods also use this implementation for the
+        Accurate and AccurateWithHierarchy algorithms.
     **/
     class ICLCV_API ContourDetector : public utils::Uncopyable{
       
@@ -119,6 +144,53 @@ namespace icl{
       
       public:
       
+      /// flat contour representation (see \ref FLAT)
+      /** The points of the i-th contour are points[offsets[i]], ..., points[offsets[i+1]-1],
+          its children are children[childOffsets[i]], ..., children[childOffsets[i+1]-1].
+          If a FlatContours instance is reused, its buffers are not reallocated as long
+          as they are large enough */
+      struct FlatContours{
+        std::vector<utils::Point> points; //!< all contour points
+        std::vector<int> offsets;         //!< contour offsets (size is number of contours + 1)
+        std::vector<int> parents;         //!< parent contour index (or -1)
+        std::vector<icl8u> holes;         //!< 1 for hole borders, 0 for outer borders
+        std::vector<int> childOffsets;    //!< child list offsets (size is number of contours + 1)
+        std::vector<int> children;        //!< all child indices (sorted for each contour)
+
+        /// returns the number of contours
+        inline int getNumContours() const {
+          return offsets.size() ? (int)offsets.size()-1 : 0;
+        }
+        /// returns the first point of the i-th contour
+        inline const utils::Point *begin(int i) const {
+          return points.data() + offsets[i];
+        }
+        /// returns the end of the i-th contour
+        inline const utils::Point *end(int i) const {
+          return points.data() + offsets[i+1];
+        }
+        /// returns the number of points of the i-th contour
+        inline int getSize(int i) const {
+          return offsets[i+1] - offsets[i];
+        }
+        /// returns whether the i-th contour is a hole border
+        inline bool isHole(int i) const {
+          return holes[i];
+        }
+        /// returns the parent index of the i-th contour (or -1)
+        inline int getParent(int i) const {
+          return parents[i];
+        }
+        /// returns the first child index of the i-th contour
+        inline const int *childrenBegin(int i) const {
+          return children.data() + childOffsets[i];
+        }
+        /// returns the end of the child indices of the i-th contour
+        inline const int *childrenEnd(int i) const {
+          return children.data() + childOffsets[i+1];
+        }
+      };
+
       /// contour tracing algorithm used
       enum Algorithm{
         Fast,                  //!< fast contour detection algorithm (using 4-point neighbourhood)
@@ -149,6 +221,20 @@ namespace icl{
       
       /// sets whether a contour hierarchy is created
       void setAlgorithm(Algorithm a);
+
+      /// sets the number of threads that are used (see \ref FLAT)
+      void setNumThreads(int nThreads);
+
+      /// returns the current number of threads
+      int getNumThreads() const;
+
+      /// calculates all contours and their hierarchy in the flat representation
+      /** The image is binarized using the current threshold. Non-8u images are
+          converted first */
+      const FlatContours &detectFlat(const core::ImgBase *image);
+
+      /// calculates all contours of the given binary image (not altered)
+      const FlatContours &detectFlat(const core::Img8u &image);
     };
   
   } // namespace cv
@@ -31,7 +31,10 @@
 #include <ICLCV/CornerDetectorCSS.h>
 #include <ICLUtils/StringUtils.h>
 #include <ICLUtils/Point32f.h>
+#include <ICLUtils/MultiThreader.h>
+#include <ICLUtils/SSETypes.h>
 #include <cstring>
+#include <algorithm>
 
 #ifdef ICL_HAVE_OPENCL
 #include <ICLUtils/CLProgram.h>
@@ -104,6 +107,120 @@ namespace icl{
       return index<0 ? index+length : index;
     }
 
+    namespace{
+      /// smoothes x- and y-coordinates of a cyclically padded contour (px[i] is the point i-radius)
+      /** The SSE version computes 4 outputs at once, but it accumulates the products in the
+          same order as the scalar version, which leads to identical results */
+      void smooth_contour(const float *px, const float *py, int length, const float *gauss,
+                          int gauss_length, float *sx, float *sy){
+        int i=0;
+#ifdef ICL_HAVE_SSE2
+        for(;i<=length-4;i+=4){
+          __m128 ax = _mm_setzero_ps(), ay = _mm_setzero_ps();
+          for(int j=0;j<gauss_length;++j){
+            const __m128 g = _mm_set1_ps(gauss[j]);
+            ax = _mm_add_ps(ax,_mm_mul_ps(_mm_loadu_ps(px+i+j),g));
+            ay = _mm_add_ps(ay,_mm_mul_ps(_mm_loadu_ps(py+i+j),g));
+          }
+          _mm_storeu_ps(sx+i,ax);
+          _mm_storeu_ps(sy+i,ay);
+        }
+#endif
+        for(;i<length;++i){
+          float vx = 0, vy = 0;
+          for(int j=0;j<gauss_length;++j){
+            vx += px[i+j] * gauss[j];
+            vy += py[i+j] * gauss[j];
+          }
+          sx[i] = vx;
+          sy[i] = vy;
+        }
+      }
+
+      /// computes the curvature of a contour, whose coordinates are cyclically padded by 2 points
+      /** The derivatives are computed for 4 points at once, the final pow-call remains
+          scalar to obtain the same values as CornerDetectorCSS::calculate_curvatures */
+      void compute_curvatures(const float *x, const float *y, int length, float curvature_cutoff,
+                              float *num, float *den, float *curvatures){
+        int i=0;
+#ifdef ICL_HAVE_SSE2
+        const __m128 h = _mm_set1_ps(0.5f);
+        for(;i<=length-4;i+=4){
+          const __m128 x0 = _mm_loadu_ps(x+i), y0 = _mm_loadu_ps(y+i);
+          const __m128 xu_0 = _mm_mul_ps(_mm_sub_ps(x0,_mm_loadu_ps(x+i-2)),h);
+          const __m128 xu = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(x+i+1),_mm_loadu_ps(x+i-1)),h);
+          const __m128 xu_1 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(x+i+2),x0),h);
+          const __m128 xuu = _mm_mul_ps(_mm_sub_ps(xu_1,xu_0),h);
+          const __m128 yu_0 = _mm_mul_ps(_mm_sub_ps(y0,_mm_loadu_ps(y+i-2)),h);
+          const __m128 yu = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(y+i+1),_mm_loadu_ps(y+i-1)),h);
+          const __m128 yu_1 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(y+i+2),y0),h);
+          const __m128 yuu = _mm_mul_ps(_mm_sub_ps(yu_1,yu_0),h);
+          _mm_storeu_ps(num+i,_mm_sub_ps(_mm_mul_ps(xu,yuu),_mm_mul_ps(xuu,yu)));
+          _mm_storeu_ps(den+i,_mm_add_ps(_mm_mul_ps(xu,xu),_mm_mul_ps(yu,yu)));
+        }
+#endif
+        for(;i<length;++i){
+          const float xu = (x[i+1] - x[i-1]) * 0.5f;
+          const float xuu = ((x[i+2] - x[i]) * 0.5f - (x[i] - x[i-2]) * 0.5f) * 0.5f;
+          const float yu = (y[i+1] - y[i-1]) * 0.5f;
+          const float yuu = ((y[i+2] - y[i]) * 0.5f - (y[i] - y[i-2]) * 0.5f) * 0.5f;
+          num[i] = xu*yuu - xuu*yu;
+          den[i] = xu*xu + yu*yu;
+        }
+        for(i=0;i<length;++i){
+          float k = fabs(num[i] / pow(den[i],1.5f));
+          curvatures[i] = round(k*curvature_cutoff)/curvature_cutoff;
+        }
+      }
+    }
+
+    struct CornerDetectorCSS::ContourBuffers{
+      std::vector<float> padded_x, padded_y, smoothed_x, smoothed_y, num, den, curvature;
+      std::vector<int> extrema0, extrema1;
+
+      void resize(int length, int radius){
+        if((int)curvature.size() < length){
+          smoothed_x.resize(length+4);
+          smoothed_y.resize(length+4);
+          num.resize(length);
+          den.resize(length);
+          curvature.resize(length);
+          extrema0.resize(length);
+          extrema1.resize(length);
+        }
+        if((int)padded_x.size() < length+2*radius){
+          padded_x.resize(length+2*radius);
+          padded_y.resize(length+2*radius);
+        }
+      }
+    };
+
+    struct CornerDetectorCSS::BatchData{
+      std::vector<ContourBuffers> buffers; //!< one per thread
+      std::vector<float> x, y, gauss;
+      std::vector<int> indices, counts;
+      MultiThreader mt;
+    };
+
+    /// each work package processes a contiguous range of contours
+    struct CornerDetectorCSS::BatchWork : public MultiThreader::Work{
+      CornerDetectorCSS *css;
+      ContourBuffers *buf;
+      const int *offsets;
+      int first, last;
+      const float *x, *y, *gauss;
+      int gauss_length;
+      int *indices, *counts;
+
+      virtual void perform(){
+        for(int i=first;i<last;++i){
+          const int o = offsets[i]-offsets[0], length = offsets[i+1]-offsets[i];
+          counts[i] = (gauss_length < length) ?
+                      css->detect_contour(x+o,y+o,length,gauss,gauss_length,*buf,indices+o) : 0;
+        }
+      }
+    };
+
     CornerDetectorCSS::CornerDetectorCSS(float angle_thresh,
                                          float rc_coeff,
                                          float sigma,
@@ -113,7 +230,13 @@ namespace icl{
       angle_thresh(angle_thresh), rc_coeff(rc_coeff), sigma(sigma),
       curvature_cutoff(curvature_cutoff), 
       straight_line_thresh(straight_line_thresh), 
-      accurate(accurate), clcurvature(0), useOpenCL(false){
+      accurate(accurate), clcurvature(0), useOpenCL(false),
+      numThreads(1), batchData(new BatchData){
+    }
+
+    void CornerDetectorCSS::setNumThreads(int numThreads){
+      ICLASSERT_RETURN(numThreads > 0);
+      this->numThreads = numThreads;
     }
     
     int CornerDetectorCSS::gauss_radius(float sigma, float cutoff) {
@@ -138,6 +261,7 @@ namespace icl{
     
     CornerDetectorCSS::~CornerDetectorCSS(){
       ICL_DELETE(clcurvature);
+      ICL_DELETE(batchData);
     }
 
     void CornerDetectorCSS::convolute(const float *data, int data_length, const float *mask , int mask_length, float *convoluted) {
@@ -367,8 +491,10 @@ namespace icl{
         else last = next; // right tangent
         int dist = abs(first-last);
         if (dist>3) {
-          middle = (first + last);
-          if(dist >= array_length/2)middle -= array_length/2;
+          // contour point half way between first and last (which might be on different
+          // sides of the contour start)
+          middle = (first + last) / 2;
+          if(dist >= array_length/2) middle = wrap(middle + array_length/2, array_length);
           x1 = x[first]; y1 = y[first];
           x2 = x[middle]; y2 = y[middle];
           x3 = x[last]; y3 = y[last];
@@ -442,6 +568,45 @@ namespace icl{
       *num_maxima_out = num_maxima;
     }
 
+    int CornerDetectorCSS::detect_contour(const float *x, const float *y, int length, const float *gauss,
+                                          int gauss_length, ContourBuffers &buf, int *corner_indices){
+      const int radius = gauss_length / 2;
+      buf.resize(length,radius);
+
+      //cyclic padding, so that the convolution does not need to wrap indices
+      float *px = buf.padded_x.data(), *py = buf.padded_y.data();
+      for(int i = -radius; i < length+radius; i++) {
+        const int j = wrap(i,length);
+        px[i+radius] = x[j];
+        py[i+radius] = y[j];
+      }
+
+      //smooth arrays, the results are padded by 2 points for the derivatives
+      float *smoothed_x = buf.smoothed_x.data()+2, *smoothed_y = buf.smoothed_y.data()+2;
+      smooth_contour(px,py,length,gauss,gauss_length,smoothed_x,smoothed_y);
+      for(int i = 1; i <= 2; i++) {
+        smoothed_x[-i] = smoothed_x[wrap(-i,length)];
+        smoothed_y[-i] = smoothed_y[wrap(-i,length)];
+        smoothed_x[length+i-1] = smoothed_x[wrap(i-1,length)];
+        smoothed_y[length+i-1] = smoothed_y[wrap(i-1,length)];
+      }
+
+      //calculate curvature
+      float *curvature = buf.curvature.data();
+      compute_curvatures(smoothed_x,smoothed_y,length,curvature_cutoff,buf.num.data(),buf.den.data(),curvature);
+
+      //find extrema
+      int *extrema0 = buf.extrema0.data(), *extrema1 = buf.extrema1.data();
+      int extrema0_sizes, extrema1_sizes, num_corners;
+      int maxima_offset = findExtrema(extrema0,&extrema0_sizes,curvature,length);
+      //remove round corners
+      if(accurate)removeRoundCornersAccurate(rc_coeff, maxima_offset, curvature, length, extrema0, extrema0_sizes, extrema1, &extrema1_sizes);
+      else removeRoundCorners(rc_coeff, maxima_offset, curvature, length, extrema0, extrema0_sizes, extrema1, &extrema1_sizes);
+      //remove false corners
+      removeFalseCorners(angle_thresh,smoothed_x,smoothed_y,curvature,length,extrema1,extrema1_sizes,corner_indices,&num_corners);
+      return num_corners;
+    }
+
     template<class T>
     const vector<Point32f> &CornerDetectorCSS::detectCorners(const vector<T> &boundary) {
       corners.clear();
@@ -449,54 +614,28 @@ namespace icl{
       int length = boundary.size();
       int gauss_length = gauss_radius(sigma, 0.0001) * 2 + 1;
       if(gauss_length < length) {
-        //create needed arrays
-        float *x = new float[length], *y = new float[length];
-        float *smoothed_x = new float[length], *smoothed_y = new float[length];
-        float *curvature = new float[length];
-        float *gauss = new float[gauss_length];
-
-        int *extrema0 = new int[length];
-        int extrema0_sizes;
-        int *extrema1 = new int[length];
-        int extrema1_sizes;
+        BatchData &d = *batchData;
+        if(d.buffers.empty()) d.buffers.resize(1);
+        d.x.resize(length);
+        d.y.resize(length);
+        d.indices.resize(length);
+        d.gauss.resize(gauss_length);
 
         //copy data into arrays
-        for(unsigned int i = 0; i < boundary.size(); i++) {
-          x[i] = boundary[i].x;
-          y[i] = boundary[i].y;
+        for(int i = 0; i < length; i++) {
+          d.x[i] = boundary[i].x;
+          d.y[i] = boundary[i].y;
         }
-        fill_gauss(gauss,sigma,gauss_length / 2);
-
-        //smooth arrays
-        convolute(x,length,gauss,gauss_length,smoothed_x);
-        convolute(y,length,gauss,gauss_length,smoothed_y);
-
-        //calculate curvature
-        calculate_curvatures(smoothed_x, smoothed_y, length, curvature_cutoff, curvature);
-
-        //find extrema
-        int maxima_offset = findExtrema(extrema0,&extrema0_sizes,curvature,length);
-        //remove round corners
-        if(accurate)removeRoundCornersAccurate(rc_coeff, maxima_offset, curvature, length, extrema0, extrema0_sizes, extrema1, &extrema1_sizes);
-        else removeRoundCorners(rc_coeff, maxima_offset, curvature, length, extrema0, extrema0_sizes, extrema1, &extrema1_sizes);
-        //remove false corners
-        removeFalseCorners(angle_thresh,smoothed_x,smoothed_y,curvature,length,extrema1,extrema1_sizes,extrema0,&extrema0_sizes);
-        //the final corner indices reside in extrema0
+        fill_gauss(d.gauss.data(),sigma,gauss_length / 2);
 
+        const int num_corners = detect_contour(d.x.data(),d.y.data(),length,d.gauss.data(),gauss_length,
+                                               d.buffers[0],d.indices.data());
         //extract the corners
-        for(int i = 0; i < extrema0_sizes; i++) {
-          int maximum = extrema0[i];
-          corners.push_back(Point32f(x[maximum], y[maximum]));
+        corners.reserve(num_corners);
+        for(int i = 0; i < num_corners; i++) {
+          int maximum = d.indices[i];
+          corners.push_back(Point32f(d.x[maximum], d.y[maximum]));
         }
-
-        delete x;
-        delete y;
-        delete smoothed_x;
-        delete smoothed_y;
-        delete curvature;
-        delete gauss;
-        delete extrema0;
-        delete extrema1;
       }
       return corners;
     }
@@ -618,6 +757,89 @@ namespace icl{
     template ICLCV_API const vector<vector<utils::Point32f> > &CornerDetectorCSS::detectCorners(const vector<vector<Point> > &boundaries, const vector<icl32f> &sigmas);
 
 
+    template<class T>
+    void CornerDetectorCSS::detectCorners(const T *points, const int *offsets, int numBoundaries, BatchResult &dst){
+      dst.corners.clear();
+      dst.offsets.assign(iclMax(numBoundaries,0)+1,0);
+      if(numBoundaries <= 0) return;
+
+      BatchData &d = *batchData;
+      const int total = offsets[numBoundaries]-offsets[0];
+      d.x.resize(total);
+      d.y.resize(total);
+      d.indices.resize(total);
+      d.counts.resize(numBoundaries);
+      const T *p = points + offsets[0];
+      for(int i = 0; i < total; i++) {
+        d.x[i] = p[i].x;
+        d.y[i] = p[i].y;
+      }
+      const int gauss_length = gauss_radius(sigma, 0.0001) * 2 + 1;
+      d.gauss.resize(gauss_length);
+      fill_gauss(d.gauss.data(),sigma,gauss_length / 2);
+
+      //each thread gets a contiguous range of boundaries with approximately total/nt points
+      const int nt = iclMin(numThreads,numBoundaries);
+      if((int)d.buffers.size() < nt) d.buffers.resize(nt);
+      std::vector<BatchWork> works(nt);
+      for(int t = 0, first = 0; t < nt; t++) {
+        int last = numBoundaries;
+        if(t < nt-1) {
+          const int split = offsets[0] + (int)((double)total*(t+1)/nt);
+          last = (int)(std::lower_bound(offsets+first, offsets+numBoundaries, split) - offsets);
+        }
+        BatchWork &w = works[t];
+        w.css = this;
+        w.buf = &d.buffers[t];
+        w.offsets = offsets;
+        w.first = first;
+        w.last = last;
+        w.x = d.x.data();
+        w.y = d.y.data();
+        w.gauss = d.gauss.data();
+        w.gauss_length = gauss_length;
+        w.indices = d.indices.data();
+        w.counts = d.counts.data();
+        first = last;
+      }
+      if(nt == 1) {
+        works[0].perform();
+      }else {
+        if(d.mt.isNull() || d.mt.getNumThreads() != nt) {
+          d.mt = MultiThreader(nt);
+        }
+        MultiThreader::WorkSet ws(nt);
+        for(int t = 0; t < nt; t++) ws[t] = &works[t];
+        d.mt(ws);
+      }
+
+      //collect the corners
+      for(int i = 0; i < numBoundaries; i++) {
+        dst.offsets[i+1] = dst.offsets[i] + d.counts[i];
+      }
+      dst.corners.resize(dst.offsets[numBoundaries]);
+      for(int i = 0; i < numBoundaries; i++) {
+        const int o = offsets[i]-offsets[0];
+        Point32f *c = dst.corners.data() + dst.offsets[i];
+        for(int j = 0; j < d.counts[i]; j++) {
+          const int maximum = o + d.indices[o+j];
+          c[j] = Point32f(d.x[maximum], d.y[maximum]);
+        }
+      }
+    }
+
+    template<class T>
+    void CornerDetectorCSS::detectCorners(const vector<T> &points, const vector<int> &offsets, BatchResult &dst){
+      ICLASSERT_THROW(offsets.size() && offsets.back() <= (int)points.size(),
+                      ICLException("CornerDetectorCSS::detectCorners: invalid boundary offsets"));
+      detectCorners(points.data(), offsets.data(), (int)offsets.size()-1, dst);
+    }
+
+    template ICLCV_API void CornerDetectorCSS::detectCorners(const Point32f*, const int*, int, BatchResult&);
+    template ICLCV_API void CornerDetectorCSS::detectCorners(const Point*, const int*, int, BatchResult&);
+    template ICLCV_API void CornerDetectorCSS::detectCorners(const vector<Point32f>&, const vector<int>&, BatchResult&);
+    template ICLCV_API void CornerDetectorCSS::detectCorners(const vector<Point>&, const vector<int>&, BatchResult&);
+
     void CornerDetectorCSS::setPropertyValue(const std::string &propertyName, const Any &value) throw (ICLException){
       if(propertyName == "angle-threshold") angle_thresh = parse<float>(value);
       else if(propertyName == "rc-coefficient") rc_coeff = parse<float>(value);
@@ -85,6 +85,24 @@ namespace icl{
         CornerDetectorCSS css;
         const std::vector<Point32f> &corners = css.detectCorners(boundary);
         \endcode
+
+        \section BATCH Batch Processing
+        Marker or shape detection usually needs the corners of several hundred region
+        boundaries per frame. For this, the batch version of detectCorners takes all
+        boundaries in a single flat buffer (the i-th boundary consists of the points
+        points[offsets[i]], ..., points[offsets[i+1]-1]) and returns all corners in a
+        CornerDetectorCSS::BatchResult. In comparison to calling detectCorners for each boundary
+        - the gaussian kernel and all temporary buffers are created only once,
+        - the smoothing of x- and y-coordinates is computed together for 4 contour
+          points at once (SSE2). The wrap-around at the start and the end of the closed
+          contours is handled by cyclic padding of the coordinates,
+        - the derivatives needed for the curvature are also computed for 4 points at once,
+        - the boundaries are distributed to several threads (setNumThreads) in chunks of
+          approximately the same number of points.
+
+        The SIMD code evaluates the very same floating point operations in the same order,
+        so the resulting corners are identical to the ones of the single boundary version.
+        The single boundary version uses the same implementation internally.
     **/
     class ICLCV_API CornerDetectorCSS : public utils::Configurable, public utils::Uncopyable{
       public:
@@ -156,6 +174,46 @@ namespace icl{
       template<class T> ICLCV_API
       const std::vector<utils::Point32f> &detectCorners(const std::vector<T> &boundary);
 
+      /// result type of the batch detectCorners method
+      /** The corners of the i-th boundary are corners[offsets[i]], ..., corners[offsets[i+1]-1] */
+      struct BatchResult{
+        std::vector<utils::Point32f> corners; //!< corners of all boundaries
+        std::vector<int> offsets;             //!< corner offsets (size is number of boundaries + 1)
+
+        /// returns the number of processed boundaries
+        inline int getNumBoundaries() const {
+          return offsets.size() ? (int)offsets.size()-1 : 0;
+        }
+
+        /// returns the number of corners of the i-th boundary
+        inline int getNumCorners(int idx) const {
+          return offsets[idx+1]-offsets[idx];
+        }
+
+        /// returns the corners of the i-th boundary
+        inline const utils::Point32f *getCorners(int idx) const {
+          return corners.data()+offsets[idx];
+        }
+      };
+
+      /// detects the corners of a set of boundaries at once (see \ref BATCH)
+      /** The i-th boundary consists of the points points[offsets[i]], ...,
+          points[offsets[i+1]-1], i.e. offsets must have numBoundaries+1 entries.
+          The results are the same as the ones of detectCorners(const std::vector<T>&)
+          for each boundary. Explicitly instantiated for utils::Point and utils::Point32f */
+      template<class T> ICLCV_API
+      void detectCorners(const T *points, const int *offsets, int numBoundaries, BatchResult &dst);
+
+      /// convenience method for the batch version with std::vectors
+      template<class T> ICLCV_API
+      void detectCorners(const std::vector<T> &points, const std::vector<int> &offsets, BatchResult &dst);
+
+      /// sets the number of threads used by the batch version of detectCorners
+      void setNumThreads(int numThreads);
+
+      /// returns the number of threads used by the batch version of detectCorners
+      inline int getNumThreads() const { return numThreads; }
+
       /// returns the result of last detectCorners call
       /** This function can be used as optimization e.g. whithin ICLCV::Region implementation */
       inline const std::vector<utils::Point32f> &getLastCorners() const {
@@ -214,6 +272,22 @@ namespace icl{
       float cornerAngleAccurate(float *x, float *y, int prev, int current, int next, int array_length, float straight_line_thresh);
       void removeFalseCorners(float angle_thresh, float* x, float* y, float* k, int length, int *maxima, int num_maxima, int *maxima_out, int *num_maxima_out);
 
+      /// temporary buffers for the processing of a single contour
+      struct ContourBuffers;
+
+      /// work package for the batch processing
+      struct BatchWork;
+
+      /// internal data for the batch processing (buffers and threads)
+      struct BatchData;
+
+      /// runs the whole detection pipeline for a single contour
+      /** x and y are the contour coordinates, the gaussian is expected to be shorter
+          than the contour. The indices of the detected corners are written to
+          corner_indices, which must have length elements. Returns the number of corners */
+      int detect_contour(const float *x, const float *y, int length, const float *gauss, int gauss_length,
+                         ContourBuffers &buf, int *corner_indices);
+
       // result lists
       std::vector<utils::Point32f> corners;
       std::vector<std::vector<utils::Point32f> > corners_list;
@@ -221,6 +295,9 @@ namespace icl{
       struct CLCurvature;
       CLCurvature *clcurvature;
       bool useOpenCL; // in case of no support, this is always false
+
+      int numThreads;
+      BatchData *batchData;
     };
   } // namespace core
 }
@@ -0,0 +1,526 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLCV/src/ICLCV/DescriptorMatcher.cpp                  **
+** Module : ICLCV                                                  **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#include <ICLCV/DescriptorMatcher.h>
+#include <ICLUtils/Exception.h>
+#include <ICLUtils/Macros.h>
+#include <ICLUtils/MultiThreader.h>
+#include <ICLUtils/SSETypes.h>
+
+#include <algorithm>
+#include <cfloat>
+
+namespace icl{
+  using namespace utils;
+
+  namespace cv{
+
+    namespace{
+
+      /// inserts train descriptor j with distance d into the sorted k-NN list m
+      inline void insert_neighbour(DescriptorMatcher::Match *m, int k, int j, float d){
+        if(!(d < m[k-1].distance)) return;
+        int i = k-1;
+        for(; i > 0 && d < m[i-1].distance; --i){
+          m[i] = m[i-1];
+        }
+        m[i].train = j;
+        m[i].distance = d;
+      }
+
+      /// squared distances of q to the 4 (dimension-major) descriptors of a package
+      /** the summation order is the same as in a naive scalar implementation */
+      inline void package_distances(const float *q, const float *p, int dim, float *dst){
+#ifdef ICL_HAVE_SSE2
+        __m128 a = _mm_setzero_ps();
+        for(int d=0;d<dim;++d){
+          const __m128 t = _mm_sub_ps(_mm_loadu_ps(p+4*d),_mm_set1_ps(q[d]));
+          a = _mm_add_ps(a,_mm_mul_ps(t,t));
+        }
+        _mm_storeu_ps(dst,a);
+#else
+        for(int l=0;l<4;++l){
+          float a = 0;
+          for(int d=0;d<dim;++d) a += sqr(p[4*d+l]-q[d]);
+          dst[l] = a;
+        }
+#endif
+      }
+
+      /// same as package_distances for 2 consecutive packages
+      inline void package_distances_2(const float *q, const float *p, int dim, float *dst){
+#ifdef ICL_HAVE_SSE2
+        const float *p2 = p + 4*dim;
+        __m128 a = _mm_setzero_ps(), b = _mm_setzero_ps();
+        for(int d=0;d<dim;++d){
+          const __m128 qd = _mm_set1_ps(q[d]);
+          const __m128 t = _mm_sub_ps(_mm_loadu_ps(p+4*d),qd);
+          const __m128 u = _mm_sub_ps(_mm_loadu_ps(p2+4*d),qd);
+          a = _mm_add_ps(a,_mm_mul_ps(t,t));
+          b = _mm_add_ps(b,_mm_mul_ps(u,u));
+        }
+        _mm_storeu_ps(dst,a);
+        _mm_storeu_ps(dst+4,b);
+#else
+        package_distances(q,p,dim,dst);
+        package_distances(q,p+4*dim,dim,dst+4);
+#endif
+      }
+
+      /// simple deterministic random number generator
+      struct LCG{
+        icl32u state;
+        LCG(icl32u seed):state(seed){}
+        inline int next(){
+          state = state * 1664525u + 1013904223u;
+          return (int)(state >> 8);
+        }
+      };
+
+      /// branch that is not yet visited in the kd-forest search
+      struct Branch{
+        float dist; //!< lower bound for the distance
+        int tree;
+        int node;
+        /// inverse ordering for using std heap functions as min-heap
+        bool operator<(const Branch &b) const { return dist > b.dist; }
+      };
+
+      /// single randomized kd-tree
+      struct KDTree{
+        struct Node{
+          int dim;     //!< split dimension (-1 for leaves)
+          float value; //!< split value
+          int left;    //!< left child (or begin of the leaf's index range)
+          int right;   //!< right child (or end of the leaf's index range)
+        };
+        std::vector<Node> nodes;
+        std::vector<int> indices;
+
+        void build(const float *rows, int n, int dim, int leafSize, LCG &rng){
+          nodes.clear();
+          indices.resize(n);
+          for(int i=0;i<n;++i) indices[i] = i;
+          std::vector<float> mean(dim), var(dim);
+          std::vector<std::pair<float,int> > order(dim);
+          if(n) build_node(rows,dim,leafSize,rng,0,n,mean,var,order);
+        }
+        
+        private:
+        struct ByDim{
+          const float *rows;
+          int dim, d;
+          bool operator()(int a, int b) const { return rows[a*dim+d] < rows[b*dim+d]; }
+        };
+
+        int build_node(const float *rows, int dim, int leafSize, LCG &rng, int begin, int end, 
+                       std::vector<float> &mean, std::vector<float> &var,
+                       std::vector<std::pair<float,int> > &order){
+          const int id = (int)nodes.size();
+          Node leaf = { -1, 0, begin, end };
+          nodes.push_back(leaf);
+          if(end - begin <= leafSize) return id;
+
+          // mean and variance are estimated using the first 100 descriptors
+          const int ns = iclMin(end-begin,100);
+          std::fill(mean.begin(),mean.end(),0.f);
+          std::fill(var.begin(),var.end(),0.f);
+          for(int i=begin;i<begin+ns;++i){
+            const float *r = rows + indices[i]*dim;
+            for(int d=0;d<dim;++d) mean[d] += r[d];
+          }
+          for(int d=0;d<dim;++d) mean[d] /= ns;
+          for(int i=begin;i<begin+ns;++i){
+            const float *r = rows + indices[i]*dim;
+            for(int d=0;d<dim;++d) var[d] += sqr(r[d]-mean[d]);
+          }
+          for(int d=0;d<dim;++d) order[d] = std::make_pair(-var[d],d);
+          const int nTop = iclMin(5,dim);
+          std::partial_sort(order.begin(),order.begin()+nTop,order.end());
+          const int d = order[rng.next() % nTop].second;
+          float value = mean[d];
+
+          int *idx = &indices[0];
+          int mid = begin;
+          for(int i=begin;i<end;++i){
+            if(rows[idx[i]*dim+d] < value) std::swap(idx[i],idx[mid++]);
+          }
+          if(mid == begin || mid == end){
+            // degenerated mean split: use the median instead
+            mid = (begin+end)/2;
+            ByDim cmp = { rows, dim, d };
+            std::nth_element(idx+begin,idx+mid,idx+end,cmp);
+            value = rows[idx[mid]*dim+d];
+            if(value == rows[idx[begin]*dim+d]) return id; // all values are equal
+          }
+          const int l = build_node(rows,dim,leafSize,rng,begin,mid,mean,var,order);
+          const int r = build_node(rows,dim,leafSize,rng,mid,end,mean,var,order);
+          Node &n = nodes[id];
+          n.dim = d;
+          n.value = value;
+          n.left = l;
+          n.right = r;
+          return id;
+        }
+      };
+    } // anonymous namespace
+
+    struct DescriptorMatcher::Data{
+      SearchMode mode;
+      int numThreads;
+      int numTrees, maxChecks, leafSize;
+
+      int n, dim;
+      std::vector<float> rows;     //!< row-major descriptor matrix
+      std::vector<float> packages; //!< packages of 4 descriptors (dimension-major)
+      std::vector<KDTree> trees;
+      bool forestDirty;
+
+      // current query
+      const float *queries;
+      int numQueries, stride, k;
+      Match *result;
+
+      /// work package for each thread
+      struct Work : public MultiThreader::Work{
+        Data *data;
+        int index, n;
+        std::vector<int> stamps;     //!< for avoiding multiple checks in kd-forest search
+        std::vector<Branch> branches;
+        virtual void perform(){
+          if(data->mode == BruteForce) data->bruteForce(index,n);
+          else data->searchForest(index,n,stamps,branches);
+        }
+      };
+      MultiThreader mt;
+      std::vector<Work> works;
+
+      Data():mode(BruteForce),numThreads(1),numTrees(4),maxChecks(256),leafSize(8),
+             n(0),dim(0),forestDirty(true){}
+
+      void bruteForce(int index, int nThreads){
+        const int q0 = (index*numQueries)/nThreads, q1 = ((index+1)*numQueries)/nThreads;
+        const int numPackages = (n+3)/4;
+        // about 256 kB of train descriptors are matched against all queries at once
+        const int blockPackages = iclMax(1,16384/dim);
+        float ds[8];
+        for(int b0=0;b0<numPackages;b0+=blockPackages){
+          const int b1 = iclMin(numPackages,b0+blockPackages);
+          for(int q=q0;q<q1;++q){
+            const float *qv = queries + q*stride;
+            Match *m = result + q*k;
+            int b = b0;
+            for(;b+1<b1;b+=2){
+              package_distances_2(qv,&packages[b*4*dim],dim,ds);
+              const int nl = iclMin(8,n-4*b);
+              for(int l=0;l<nl;++l) insert_neighbour(m,k,4*b+l,ds[l]);
+            }
+            if(b<b1){
+              package_distances(qv,&packages[b*4*dim],dim,ds);
+              const int nl = iclMin(4,n-4*b);
+              for(int l=0;l<nl;++l) insert_neighbour(m,k,4*b+l,ds[l]);
+            }
+          }
+        }
+      }
+
+      void buildForest(){
+        trees.resize(numTrees);
+        LCG rng(0x2545f491u);
+        for(int i=0;i<numTrees;++i){
+          trees[i].build(rows.data(),n,dim,leafSize,rng);
+        }
+        forestDirty = false;
+      }
+
+      inline void descend(const float *q, Match *m, int t, int node, float mindist,
+                          std::vector<int> &stamps, int stamp, int &checks,
+                          std::vector<Branch> &branches){
+        const KDTree &tree = trees[t];
+        const KDTree::Node *nodes = tree.nodes.data();
+        while(nodes[node].dim >= 0){
+          const KDTree::Node &nd = nodes[node];
+          const float diff = q[nd.dim] - nd.value;
+          const int near = diff < 0 ? nd.left : nd.right;
+          const Branch b = { mindist + diff*diff, t, diff < 0 ? nd.right : nd.left };
+          if(b.dist < m[k-1].distance){
+            branches.push_back(b);
+            std::push_heap(branches.begin(),branches.end());
+          }
+          node = near;
+        }
+        const KDTree::Node &leaf = nodes[node];
+        for(int i=leaf.left;i<leaf.right;++i){
+          const int j = tree.indices[i];
+          if(stamps[j] == stamp) continue;
+          stamps[j] = stamp;
+          insert_neighbour(m,k,j,l2sqr(q,&rows[j*dim],dim));
+          ++checks;
+        }
+      }
+
+      void searchForest(int index, int nThreads, std::vector<int> &stamps, std::vector<Branch> &branches){
+        const int q0 = (index*numQueries)/nThreads, q1 = ((index+1)*numQueries)/nThreads;
+        stamps.assign(n,-1);
+        for(int q=q0;q<q1;++q){
+          const float *qv = queries + q*stride;
+          Match *m = result + q*k;
+          int checks = 0;
+          branches.clear();
+          for(unsigned int t=0;t<trees.size();++t){
+            descend(qv,m,t,0,0,stamps,q,checks,branches);
+          }
+          while(branches.size() && checks < maxChecks){
+            std::pop_heap(branches.begin(),branches.end());
+            const Branch b = branches.back();
+            branches.pop_back();
+            if(!(b.dist < m[k-1].distance)) break; // all other branches are even farther away
+            descend(qv,m,b.tree,b.node,b.dist,stamps,q,checks,branches);
+          }
+        }
+      }
+
+      void run(){
+        if(mode == KDForest && forestDirty) buildForest();
+        const int nt = iclMax(1,iclMin(numThreads,numQueries));
+        if(nt > 1 && (mt.isNull() || mt.getNumThreads() != nt)){
+          mt = MultiThreader(nt);
+        }
+        works.resize(nt);
+        for(int i=0;i<nt;++i){
+          works[i].data = this;
+          works[i].index = i;
+          works[i].n = nt;
+        }
+        if(nt == 1){
+          works[0].perform();
+          return;
+        }
+        MultiThreader::WorkSet ws(nt);
+        for(int i=0;i<nt;++i) ws[i] = &works[i];
+        mt(ws);
+      }
+    };
+
+    DescriptorMatcher::DescriptorMatcher(SearchMode mode, int numThreads):m_data(new Data){
+      setSearchMode(mode);
+      setNumThreads(numThreads);
+    }
+
+    DescriptorMatcher::~DescriptorMatcher(){
+      delete m_data;
+    }
+
+    void DescriptorMatcher::setSearchMode(SearchMode mode){
+      m_data->mode = mode;
+    }
+
+    DescriptorMatcher::SearchMode DescriptorMatcher::getSearchMode() const{
+      return m_data->mode;
+    }
+
+    void DescriptorMatcher::setNumThreads(int numThreads){
+      m_data->numThreads = iclMax(1,numThreads);
+    }
+
+    int DescriptorMatcher::getNumThreads() const{
+      return m_data->numThreads;
+    }
+
+    void DescriptorMatcher::setKDForestParams(int numTrees, int maxChecks, int leafSize){
+      m_data->numTrees = iclMax(1,numTrees);
+      m_data->maxChecks = iclMax(1,maxChecks);
+      m_data->leafSize = iclMax(1,leafSize);
+      m_data->forestDirty = true;
+    }
+
+    void DescriptorMatcher::setTrainDescriptors(const float *data, int n, int dim, int stride){
+      ICLASSERT_THROW(n >= 0 && dim > 0 && (data || !n), 
+                      ICLException("DescriptorMatcher::setTrainDescriptors: invalid descriptors"));
+      if(!stride) stride = dim;
+      Data &d = *m_data;
+      d.n = n;
+      d.dim = dim;
+      d.rows.resize(n*dim);
+      for(int i=0;i<n;++i){
+        std::copy(data+i*stride,data+i*stride+dim,d.rows.begin()+i*dim);
+      }
+      const int numPackages = (n+3)/4;
+      d.packages.assign(numPackages*4*dim,0.f);
+      for(int i=0;i<n;++i){
+        float *p = &d.packages[(i/4)*4*dim + (i%4)];
+        const float *r = &d.rows[i*dim];
+        for(int j=0;j<dim;++j) p[4*j] = r[j];
+      }
+      d.forestDirty = true;
+    }
+
+    void DescriptorMatcher::setTrainDescriptors(const std::vector<SurfFeature> &features){
+      setTrainDescriptors(features.size() ? features[0].descriptor : 0, (int)features.size(), 64,
+                          (int)(sizeof(SurfFeature)/sizeof(float)));
+    }
+
+    int DescriptorMatcher::getNumTrainDescriptors() const{
+      return m_data->n;
+    }
+
+    int DescriptorMatcher::getDim() const{
+      return m_data->dim;
+    }
+
+    void DescriptorMatcher::knnMatch(const float *queries, int n, int k, std::vector<Match> &dst, int stride){
+      ICLASSERT_THROW(k > 0 && n >= 0 && (queries || !n), ICLException("DescriptorMatcher::knnMatch: invalid arguments"));
+      ICLASSERT_THROW(m_data->dim, ICLException("DescriptorMatcher::knnMatch: no train descriptors given"));
+      Data &d = *m_data;
+      dst.resize(n*k);
+      for(int i=0;i<n;++i){
+        for(int j=0;j<k;++j){
+          Match &m = dst[i*k+j];
+          m.query = i;
+          m.train = -1;
+          m.distance = FLT_MAX;
+        }
+      }
+      if(!n || !d.n) return;
+      d.queries = queries;
+      d.numQueries = n;
+      d.stride = stride ? stride : d.dim;
+      d.k = k;
+      d.result = dst.data();
+      d.run();
+    }
+
+    void DescriptorMatcher::knnMatch(const std::vector<SurfFeature> &queries, int k, std::vector<Match> &dst){
+      ICLASSERT_THROW(m_data->dim == 64, ICLException("DescriptorMatcher::knnMatch: train descriptors are no SURF descriptors"));
+      knnMatch(queries.size() ? queries[0].descriptor : 0, (int)queries.size(), k, dst,
+               (int)(sizeof(SurfFeature)/sizeof(float)));
+    }
+
+    void DescriptorMatcher::match(const float *queries, int n, std::vector<Match> &dst,
+                                  float ratio, bool mutual, int stride){
+      std::vector<Match> knn;
+      knnMatch(queries,n,2,knn,stride);
+      if(!mutual){
+        ratioTest(knn,2,ratio,dst);
+        return;
+      }
+      std::vector<Match> ab;
+      ratioTest(knn,2,ratio,ab);
+
+      // reverse search, only for the matched train descriptors
+      const int dim = m_data->dim;
+      std::vector<int> trainIdx(ab.size());
+      for(unsigned int i=0;i<ab.size();++i) trainIdx[i] = ab[i].train;
+      std::sort(trainIdx.begin(),trainIdx.end());
+      trainIdx.erase(std::unique(trainIdx.begin(),trainIdx.end()),trainIdx.end());
+      std::vector<float> trainRows(trainIdx.size()*dim);
+      for(unsigned int i=0;i<trainIdx.size();++i){
+        std::copy(&m_data->rows[trainIdx[i]*dim],&m_data->rows[trainIdx[i]*dim]+dim,&trainRows[i*dim]);
+      }
+      DescriptorMatcher reverse(m_data->mode,m_data->numThreads);
+      reverse.setKDForestParams(m_data->numTrees,m_data->maxChecks,m_data->leafSize);
+      reverse.setTrainDescriptors(queries,n,dim,stride);
+      std::vector<Match> ba;
+      reverse.knnMatch(trainRows.data(),(int)trainIdx.size(),1,ba);
+      for(unsigned int i=0;i<ba.size();++i) ba[i].query = trainIdx[i];
+      mutualFilter(ab,ba,dst);
+    }
+
+    void DescriptorMatcher::match(const std::vector<SurfFeature> &queries, std::vector<Match> &dst,
+                                  float ratio, bool mutual){
+      ICLASSERT_THROW(m_data->dim == 64, ICLException("DescriptorMatcher::match: train descriptors are no SURF descriptors"));
+      match(queries.size() ? queries[0].descriptor : 0, (int)queries.size(), dst, ratio, mutual,
+            (int)(sizeof(SurfFeature)/sizeof(float)));
+    }
+
+    void DescriptorMatcher::ratioTest(const std::vector<Match> &knn, int k, float ratio, std::vector<Match> &dst){
+      ICLASSERT_THROW(k >= 2, ICLException("DescriptorMatcher::ratioTest: k must be at least 2"));
+      dst.clear();
+      for(unsigned int i=0;i+k<=knn.size();i+=k){
+        const Match &best = knn[i];
+        if(best.train >= 0 && (ratio > 1 || best.distance/knn[i+1].distance < ratio)){
+          dst.push_back(best);
+        }
+      }
+    }
+
+    void DescriptorMatcher::mutualFilter(const std::vector<Match> &ab, const std::vector<Match> &ba,
+                                         std::vector<Match> &dst){
+      int maxTrain = -1;
+      for(unsigned int i=0;i<ba.size();++i) maxTrain = iclMax(maxTrain,ba[i].query);
+      std::vector<int> best(maxTrain+1,-1);
+      for(unsigned int i=0;i<ba.size();++i){
+        if(ba[i].query >= 0) best[ba[i].query] = ba[i].train;
+      }
+      std::vector<Match> result;
+      for(unsigned int i=0;i<ab.size();++i){
+        const int t = ab[i].train;
+        if(t >= 0 && t <= maxTrain && best[t] == ab[i].query) result.push_back(ab[i]);
+      }
+      dst.swap(result);
+    }
+
+    float DescriptorMatcher::l2sqr(const float *a, const float *b, int dim){
+      int i = 0;
+      float sum = 0;
+#ifdef ICL_HAVE_SSE2
+      __m128 s0 = _mm_setzero_ps(), s1 = _mm_setzero_ps();
+      for(;i+8<=dim;i+=8){
+        const __m128 d0 = _mm_sub_ps(_mm_loadu_ps(a+i),_mm_loadu_ps(b+i));
+        const __m128 d1 = _mm_sub_ps(_mm_loadu_ps(a+i+4),_mm_loadu_ps(b+i+4));
+        s0 = _mm_add_ps(s0,_mm_mul_ps(d0,d0));
+        s1 = _mm_add_ps(s1,_mm_mul_ps(d1,d1));
+      }
+      float t[4];
+      _mm_storeu_ps(t,_mm_add_ps(s0,s1));
+      sum = (t[0]+t[1]) + (t[2]+t[3]);
+#endif
+      for(;i<dim;++i) sum += sqr(a[i]-b[i]);
+      return sum;
+    }
+
+    float DescriptorMatcher::dot(const float *a, const float *b, int dim){
+      int i = 0;
+      float sum = 0;
+#ifdef ICL_HAVE_SSE2
+      __m128 s0 = _mm_setzero_ps(), s1 = _mm_setzero_ps();
+      for(;i+8<=dim;i+=8){
+        s0 = _mm_add_ps(s0,_mm_mul_ps(_mm_loadu_ps(a+i),_mm_loadu_ps(b+i)));
+        s1 = _mm_add_ps(s1,_mm_mul_ps(_mm_loadu_ps(a+i+4),_mm_loadu_ps(b+i+4)));
+      }
+      float t[4];
+      _mm_storeu_ps(t,_mm_add_ps(s0,s1));
+      sum = (t[0]+t[1]) + (t[2]+t[3]);
+#endif
+      for(;i<dim;++i) sum += a[i]*b[i];
+      return sum;
+    }
+  }
+}
@@ -0,0 +1,182 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLCV/src/ICLCV/DescriptorMatcher.h                    **
+** Module : ICLCV                                                  **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#pragma once
+
+#include <ICLUtils/CompatMacros.h>
+#include <ICLUtils/Uncopyable.h>
+#include <ICLCV/SurfFeature.h>
+#include <vector>
+
+namespace icl{
+  namespace cv{
+
+    /// Nearest neighbour matching of float descriptors (e.g. SURF descriptors)
+    /** The DescriptorMatcher finds the nearest neighbours (w.r.t. the squared euclidean
+        distance) of a set of query descriptors in a set of train descriptors. It is
+        used by the SurfFeatureDetector, but it works on any kind of float descriptors.
+
+        \section STORAGE Storage
+        The train descriptors are copied into a contiguous matrix once (see
+        setTrainDescriptors), so that they can be matched against several query
+        sets without being copied again. Besides a row-major version, the matrix
+        is stored in packages of 4 descriptors, within which the descriptor
+        values are ordered by dimension (i.e. the 4 values of the first dimension,
+        then the 4 values of the 2nd dimension, and so on). This allows for
+        computing the distances of a query descriptor to 4 train descriptors
+        at once using SSE2 instructions.
+
+        \section BF Brute Force Search
+        In BruteForce mode, the distances of all query/train pairs are computed.
+        In order to stay in the cache, the train descriptors are processed in
+        blocks, that are matched against all queries before the next block is
+        processed. The results are exactly the same as the ones of a naive
+        scalar implementation.
+
+        \section KD Randomized KD-Forest
+        For large train sets, an approximate search can be used (mode KDForest).
+        Here, several randomized kd-trees are built, each one splitting at the
+        mean value of a dimension that is randomly chosen from the 5 dimensions
+        with the highest variance. The trees are searched simultaneously in a
+        best-bin-first manner: after descending to a leaf in each tree, the
+        most promising unexplored branches of all trees are visited until
+        a given number of descriptors was compared (see setKDForestParams).
+
+        \section FILTER Match Filtering
+        The match-methods apply the Lowe ratio test (the best match is only
+        accepted if its distance is significantly smaller than the distance of the
+        2nd best match) and optionally a mutual consistency check (the query is
+        also the nearest neighbour of the matched train descriptor). The filter
+        functions are also available as static methods, so that they can be
+        used for other descriptor types (such as binary descriptors) as well.
+
+        \section THREADS Multi-Threading
+        The query set is distributed to a given number of threads (see
+        setNumThreads). The results do not depend on the number of threads.
+    */
+    class ICLCV_API DescriptorMatcher : public utils::Uncopyable{
+      struct Data;
+      Data *m_data;
+
+      public:
+
+      /// search mode
+      enum SearchMode{
+        BruteForce, //!< exact nearest neighbours
+        KDForest    //!< approximate search using randomized kd-trees
+      };
+
+      /// single match
+      struct Match{
+        int query;      //!< query descriptor index
+        int train;      //!< train descriptor index (-1 for missing k-NN results)
+        float distance; //!< squared euclidean distance
+      };
+
+      /// creates a matcher with given search mode
+      DescriptorMatcher(SearchMode mode=BruteForce, int numThreads=1);
+
+      /// destructor
+      ~DescriptorMatcher();
+
+      /// sets the search mode
+      void setSearchMode(SearchMode mode);
+
+      /// returns the current search mode
+      SearchMode getSearchMode() const;
+
+      /// sets the number of threads used for matching
+      void setNumThreads(int numThreads);
+
+      /// returns the number of threads
+      int getNumThreads() const;
+
+      /// sets the parameters of the kd-forest
+      /** @param numTrees number of randomized trees
+          @param maxChecks maximum number of descriptor comparisons per query
+          @param leafSize maximum number of descriptors in a leaf */
+      void setKDForestParams(int numTrees=4, int maxChecks=256, int leafSize=8);
+
+      /// sets the train descriptors
+      /** The data is copied. Each descriptor has dim values, and consecutive
+          descriptors are stride floats apart (stride 0 means dim) */
+      void setTrainDescriptors(const float *data, int n, int dim, int stride=0);
+
+      /// convenience method for SURF features
+      void setTrainDescriptors(const std::vector<SurfFeature> &features);
+
+      /// returns the number of train descriptors
+      int getNumTrainDescriptors() const;
+
+      /// returns the descriptor dimension
+      int getDim() const;
+
+      /// finds the k nearest train descriptors for each query descriptor
+      /** The result contains k entries for each query (dst[i*k+j] is the j-th
+          nearest neighbour of the i-th query). If less than k neighbours are
+          found, the remaining entries have a train index of -1 and a distance
+          of FLT_MAX. The queries have getDim() values each and are stride
+          floats apart (stride 0 means getDim()) */
+      void knnMatch(const float *queries, int n, int k, std::vector<Match> &dst, int stride=0);
+
+      /// convenience method for SURF features
+      void knnMatch(const std::vector<SurfFeature> &queries, int k, std::vector<Match> &dst);
+
+      /// finds the best match for each query descriptor
+      /** Only matches, that pass the ratio test (see ratioTest), and optionally the
+          mutual consistency check (see mutualFilter), are returned */
+      void match(const float *queries, int n, std::vector<Match> &dst,
+                 float ratio=0.65f, bool mutual=false, int stride=0);
+
+      /// convenience method for SURF features
+      void match(const std::vector<SurfFeature> &queries, std::vector<Match> &dst,
+                 float ratio=0.65f, bool mutual=false);
+
+      /// Lowe ratio test on given k-NN results (k >= 2)
+      /** The best match of each query is accepted if the ratio of its distance and the
+          distance of the 2nd best match is smaller than the given ratio. Please note,
+          that for squared distances, this is the squared distance ratio. Ratios larger
+          than 1 accept all valid matches */
+      static void ratioTest(const std::vector<Match> &knn, int k, float ratio, std::vector<Match> &dst);
+
+      /// removes all matches a->b, whose train descriptor's best match b->a is another query
+      /** ba contains the matches of (a subset of) the train descriptors (as queries) against
+          the query descriptors (as train), e.g. the result of a 1-NN search */
+      static void mutualFilter(const std::vector<Match> &ab, const std::vector<Match> &ba,
+                               std::vector<Match> &dst);
+
+      /// squared euclidean distance of two float vectors (SSE2 optimized)
+      static float l2sqr(const float *a, const float *b, int dim);
+
+      /// dot product of two float vectors (SSE2 optimized)
+      static float dot(const float *a, const float *b, int dim);
+    };
+  }
+}
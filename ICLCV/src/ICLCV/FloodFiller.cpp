@@ -29,6 +29,7 @@
 ********************************************************************/
 
 #include <ICLCV/FloodFiller.h>
+#include <ICLUtils/SSETypes.h>
 
 using namespace icl::utils;
 using namespace icl::core;
@@ -48,46 +49,122 @@ namespace icl{
       return r;
     }
     
-    const FloodFiller::Result &FloodFiller::apply(const ImgBase *image, 
-                                                                const Point &seed, 
-                                                                double referenceValue, 
-                                                                double threshold){
+    void FloodFiller::prepareSpans(const Size &imageSize, const Point &seed){
+      ICLASSERT_THROW(Rect(Point::null,imageSize).contains(seed.x,seed.y),
+                      ICLException("FloodFiller::apply: seedpoint lies outside the image boundaries"));
+      spanState.assign(imageSize.getDim(),0);
+      spanStack.clear();
+      spans.clear();
+    }
+
+    struct FloodFiller::RowEvaluator8u{
+      const icl8u *data;
+      int w;
+      icl8u val, thresh;
+      
+      inline RowEvaluator8u(const Img8u &image, const DefaultCriterion<icl8u> &crit):
+        data(image.getData(0)),w(image.getWidth()),val(crit.val),thresh(crit.thresh){}
+      
+      inline void operator()(int y, int x0, int x1, icl8u *row) const{
+        const icl8u *src = data + y*w;
+        int x = x0;
+  #ifdef ICL_HAVE_SSE2
+        if(thresh){
+          // |src-val| < thresh  <=>  min(|src-val|,thresh-1) == |src-val|
+          const __m128i v = _mm_set1_epi8((char)val);
+          const __m128i t = _mm_set1_epi8((char)(thresh-1));
+          const __m128i e = _mm_set1_epi8(EVALUATED);
+          const __m128i m = _mm_set1_epi8(MATCH);
+          for(;x+16<=x1;x+=16){
+            const __m128i p = _mm_loadu_si128((const __m128i*)(src+x));
+            const __m128i d = _mm_or_si128(_mm_subs_epu8(p,v),_mm_subs_epu8(v,p));
+            const __m128i ok = _mm_cmpeq_epi8(_mm_min_epu8(d,t),d);
+            _mm_storeu_si128((__m128i*)(row+x),_mm_or_si128(e,_mm_and_si128(ok,m)));
+          }
+        }
+  #endif
+        for(;x<x1;++x){
+          row[x] = EVALUATED | (::abs(int(val)-int(src[x])) < thresh ? MATCH : 0);
+        }
+      }
+    };
+
+    const std::vector<LineSegment> &FloodFiller::applySpans(const ImgBase *image, const Point &seed, 
+                                                            double referenceValue, double threshold){
       ICLASSERT_THROW(image,ICLException("FloodFiller::apply: input image is null"));
       switch(image->getDepth()){
+        case depth8u:
+          return fillSpans(image->getSize(),seed,RowEvaluator8u(*image->as8u(),
+                                                                DefaultCriterion<icl8u>(referenceValue,threshold)));
   #define ICL_INSTANTIATE_DEPTH(D)                                        \
         case depth##D:                                                    \
-          applyGeneric(*image->as##D(),                                   \
-                       seed,                                              \
-                       DefaultCriterion<icl##D>(referenceValue,           \
-                                                threshold));              \
-          break;
-          ICL_INSTANTIATE_ALL_DEPTHS;
+          return applyGenericSpans(*image->as##D(),                       \
+                                   seed,                                  \
+                                   DefaultCriterion<icl##D>(referenceValue, \
+                                                            threshold));
+          ICL_INSTANTIATE_DEPTH(16s);
+          ICL_INSTANTIATE_DEPTH(32s);
+          ICL_INSTANTIATE_ALL_FLOAT_DEPTHS;
   #undef ICL_INSTANTIATE_DEPTH
-          default:
-            ICL_INVALID_DEPTH;
-        }
-        return result;
+        default:
+          ICL_INVALID_DEPTH;
       }
+      return spans;
+    }
     
-    const FloodFiller::Result &FloodFiller::applyColor(const ImgBase *image, const Point &seed, 
-                                                                     double refR, double refG, double refB, double threshold){
+    const std::vector<LineSegment> &FloodFiller::applyColorSpans(const ImgBase *image, const Point &seed, 
+                                                                 double refR, double refG, double refB, double threshold){
       ICLASSERT_THROW(image,ICLException("FloodFiller::apply: input image is null"));
       ICLASSERT_THROW(image->getChannels() >= 3,ICLException("FloodFiller::apply: input image has less then 3 channels"));
   
       switch(image->getDepth()){
   #define ICL_INSTANTIATE_DEPTH(D)                                        \
         case depth##D:                                                    \
-          applyColorGeneric(*image->as##D(),                              \
-                            seed,                                         \
-                            ReferenceColorCriterion<icl##D>               \
-                            (refR,refG,refB,                              \
-                             threshold));                                 \
-          break;
+          return applyColorGenericSpans(*image->as##D(),                  \
+                                        seed,                             \
+                                        ReferenceColorCriterion<icl##D>   \
+                                        (refR,refG,refB,                  \
+                                         threshold));
         ICL_INSTANTIATE_ALL_DEPTHS;
   #undef ICL_INSTANTIATE_DEPTH
         default:
           ICL_INVALID_DEPTH;
       }
+      return spans;
+    }
+
+    void FloodFiller::spansToResult(const std::vector<LineSegment> &spans, const Size &imageSize, Result &dst){
+      dst.ffLUT.setChannels(1);
+      dst.ffLUT.setSize(imageSize);
+      dst.ffLUT.fill(0);
+      dst.pixels.clear();
+      
+      int n = 0;
+      for(unsigned int i=0;i<spans.size();++i) n += spans[i].len();
+      dst.pixels.reserve(n);
+      
+      icl8u *ff = dst.ffLUT.begin(0);
+      const int w = imageSize.width;
+      for(unsigned int i=0;i<spans.size();++i){
+        const LineSegment &s = spans[i];
+        std::fill(ff + s.y*w + s.x, ff + s.y*w + s.xend, 255);
+        for(int x=s.x;x<s.xend;++x){
+          dst.pixels.push_back(Point(x,s.y));
+        }
+      }
+    }
+    
+    const FloodFiller::Result &FloodFiller::apply(const ImgBase *image, 
+                                                  const Point &seed, 
+                                                  double referenceValue, 
+                                                  double threshold){
+      spansToResult(applySpans(image,seed,referenceValue,threshold),image->getSize(),result);
+      return result;
+    }
+    
+    const FloodFiller::Result &FloodFiller::applyColor(const ImgBase *image, const Point &seed, 
+                                                       double refR, double refG, double refB, double threshold){
+      spansToResult(applyColorSpans(image,seed,refR,refG,refB,threshold),image->getSize(),result);
       return result;
     }
   
@@ -32,6 +32,9 @@
 
 #include <ICLUtils/CompatMacros.h>
 #include <ICLCore/Img.h>
+#include <ICLCV/LineSegment.h>
+
+#include <algorithm>
 
 namespace icl{
   namespace cv{
@@ -65,7 +68,22 @@ namespace icl{
         while there are pixels in the queue, each of the 8 neighbours, that have not
         been processed earlier and that match the filling criterion are filled
         and put into the queue.
+
+        \section _SPANS_ Span-based Flood Filling
+        For large filled areas, the per-pixel queue causes a lot of memory traffic.
+        Therefore, the FloodFiller also provides a scanline-based algorithm
+        (see FloodFiller::applySpans, FloodFiller::applyColorSpans and their generic
+        versions), that fills whole runs of pixels at once. Its result is a list of
+        run-length encoded spans (LineSegments), sorted by y and x. The filling 
+        criterion is evaluated lazily for blocks of 64 successive pixels of a row,
+        which allows the compiler (and for the default 8u-criterion explicit SSE2
+        code) to use SIMD instructions. The neighbourhood is identical: filled spans
+        are 8-connected.
         
+        The non-generic FloodFiller::apply and FloodFiller::applyColor methods
+        internally use the span-based algorithm. Their Result is created using
+        FloodFiller::spansToResult. Here, the pixels are sorted by y and x, and the 
+        ffLUT contains only the filled pixels (255).
     */
     class ICLCV_API FloodFiller{
       /// internal list of to-be-processed points
@@ -73,6 +91,111 @@ namespace icl{
       
       /// internal utility method
       utils::Rect prepare(const utils::Size &imageSize, const utils::Point &seed);
+
+      /// row range that has to be scanned for fillable pixels
+      struct SpanSeed{
+        int y,x0,x1; //!< row and inclusive x-range
+        SpanSeed(int y=0, int x0=0, int x1=0):y(y),x0(x0),x1(x1){}
+      };
+      
+      /// pixel states for the span-based algorithm
+      enum SpanState{
+        EVALUATED = 1, //!< criterion was evaluated
+        MATCH = 2,     //!< criterion is fulfilled
+        FILLED = 4     //!< pixel is part of a span
+      };
+      
+      std::vector<icl8u> spanState;    //!< pixel states (SpanState)
+      std::vector<SpanSeed> spanStack; //!< to-be-scanned row ranges
+      std::vector<LineSegment> spans;  //!< resulting spans
+      
+      /// internal utility method for the span-based algorithm
+      void prepareSpans(const utils::Size &imageSize, const utils::Point &seed);
+
+      /// returns whether the pixel at x is fillable (evaluates the criterion if necessary)
+      template<class RowEvaluator>
+      inline bool isFillable(icl8u *row, int x, int y, int w, RowEvaluator &eval){
+        if(!(row[x] & EVALUATED)){
+          const int x0 = x & ~63;
+          eval(y,x0,iclMin(x0+64,w),row);
+        }
+        return (row[x] & (MATCH|FILLED)) == MATCH;
+      }
+
+      /// compares two spans w.r.t. y and x
+      static inline bool span_less(const LineSegment &a, const LineSegment &b){
+        return a.y < b.y || (a.y == b.y && a.x < b.x);
+      }
+      
+      /// span-based flood filling
+      /** The row evaluator is called with (y,xStart,xEnd,rowStates) and has to set the
+          row states of the pixels xStart, ..., xEnd-1 to EVALUATED or EVALUATED|MATCH */
+      template<class RowEvaluator>
+      inline const std::vector<LineSegment> &fillSpans(const utils::Size &size, const utils::Point &seed, 
+                                                       RowEvaluator eval){
+        prepareSpans(size,seed);
+        const int W = size.width, H = size.height;
+        icl8u *state = spanState.data();
+        
+        spanStack.push_back(SpanSeed(seed.y,seed.x,seed.x));
+        while(!spanStack.empty()){
+          const SpanSeed s = spanStack.back();
+          spanStack.pop_back();
+          icl8u *row = state + s.y*W;
+          for(int x=s.x0;x<=s.x1;++x){
+            if(!isFillable(row,x,s.y,W,eval)) continue;
+            int l = x, r = x+1;
+            while(l > 0 && isFillable(row,l-1,s.y,W,eval)) --l;
+            while(r < W && isFillable(row,r,s.y,W,eval)) ++r;
+            for(int i=l;i<r;++i) row[i] |= FILLED;
+            spans.push_back(LineSegment(l,s.y,r));
+            
+            // 8-neighbourhood: the adjacent rows are scanned from l-1 to r
+            const int a = iclMax(l-1,0), b = iclMin(r,W-1);
+            if(s.y > 0) spanStack.push_back(SpanSeed(s.y-1,a,b));
+            if(s.y < H-1) spanStack.push_back(SpanSeed(s.y+1,a,b));
+            x = r; // pixel r is not fillable
+          }
+        }
+        std::sort(spans.begin(),spans.end(),span_less);
+        return spans;
+      }
+
+      /// row evaluator for single channel images
+      template<class T, class Criterion>
+      struct RowEvaluator{
+        const T *data;
+        int w;
+        Criterion crit;
+        inline RowEvaluator(const T *data, int w, Criterion crit):data(data),w(w),crit(crit){}
+        inline void operator()(int y, int x0, int x1, icl8u *row) const{
+          const T *src = data + y*w;
+          for(int x=x0;x<x1;++x){
+            row[x] = EVALUATED | (crit(src[x]) ? MATCH : 0);
+          }
+        }
+      };
+
+      /// SSE2-optimized row evaluator for the default criterion on icl8u images
+      struct RowEvaluator8u;
+
+      /// row evaluator for 3 channel images
+      template<class T, class Criterion3Channels>
+      struct RowEvaluatorColor{
+        const T *data[3];
+        int w;
+        Criterion3Channels crit;
+        inline RowEvaluatorColor(const core::Img<T> &image, Criterion3Channels crit):
+          w(image.getWidth()),crit(crit){
+          for(int i=0;i<3;++i) data[i] = image.getData(i);
+        }
+        inline void operator()(int y, int x0, int x1, icl8u *row) const{
+          const T *r = data[0] + y*w, *g = data[1] + y*w, *b = data[2] + y*w;
+          for(int x=x0;x<x1;++x){
+            row[x] = EVALUATED | (crit(r[x],g[x],b[x]) ? MATCH : 0);
+          }
+        }
+      };
   
       public:
   
@@ -188,6 +311,34 @@ namespace icl{
         return result;
       }
   
+      /// span-based flood filling of the given grayscale image (see \ref _SPANS_)
+      /** The fill criterion is identical to apply, however the result is a list of spans */
+      const std::vector<LineSegment> &applySpans(const core::ImgBase *image, const utils::Point &seed, 
+                                                 double referenceValue, double threshold);
+
+      /// span-based flood filling of the given 3-channel image (see \ref _SPANS_)
+      /** The fill criterion is identical to applyColor, however the result is a list of spans */
+      const std::vector<LineSegment> &applyColorSpans(const core::ImgBase *image, const utils::Point &seed, 
+                                                      double refR, double refG, double refB, double threshold);
+      
+      /// generic span-based flood filling for grayscale images (see \ref _SPANS_)
+      template<class T, class Criterion>
+      inline const std::vector<LineSegment> &applyGenericSpans(const core::Img<T> &image, const utils::Point &seed, 
+                                                               Criterion crit){
+        return fillSpans(image.getSize(),seed,RowEvaluator<T,Criterion>(image.getData(0),image.getWidth(),crit));
+      }
+
+      /// generic span-based flood filling for 3-channel color images (see \ref _SPANS_)
+      template<class T, class Criterion3Channels>
+      inline const std::vector<LineSegment> &applyColorGenericSpans(const core::Img<T> &image, const utils::Point &seed, 
+                                                                    Criterion3Channels crit){
+        return fillSpans(image.getSize(),seed,RowEvaluatorColor<T,Criterion3Channels>(image,crit));
+      }
+
+      /// converts a list of spans into the pixel-based Result representation
+      /** The ffLUT image is set to the given size and contains 255 for all filled pixels */
+      static void spansToResult(const std::vector<LineSegment> &spans, const utils::Size &imageSize, Result &dst);
+      
       /// predefined criterion for simple reference-value based filling for 1-channel images
       template<class T>
       struct DefaultCriterion{
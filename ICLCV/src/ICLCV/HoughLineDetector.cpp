@@ -31,6 +31,10 @@
 #include <ICLCV/HoughLineDetector.h>
 #include <ICLMath/DynMatrixUtils.h>
 #include <ICLFilter/ConvolutionOp.h>
+#include <ICLUtils/MultiThreader.h>
+#include <ICLUtils/SSETypes.h>
+
+#include <algorithm>
 
 using namespace icl::utils;
 using namespace icl::math;
@@ -61,6 +65,242 @@ namespace icl{
       core::Channel32s lut;
       core::Img32s image;
       core::Img32f inhibitImage;
+
+      // precomputed samples of the standard (full) sampling loop
+      std::vector<int> sampleX;
+      std::vector<double> sampleCos, sampleSin;
+
+      // gradient-oriented voting
+      float gradientWindow;
+      bool refineLines;
+      int numThreads;
+      std::vector<float> mcos, msin;     //!< mr*cos(getRho(x)) and mr*sin(getRho(x)) for each column x
+      std::vector<Point32f> gradPoints;  //!< gradient points that are kept for the line refinement
+      std::vector<float> gradAngles;
+
+      // current batch
+      const Point32f *batchPoints;
+      const float *batchAngles;
+      int batchSize;
+      const Img8u *batchImage;
+      const Img32f *batchGx, *batchGy;
+
+      /// work package for each thread (with its own accumulator)
+      struct Work : public MultiThreader::Work{
+        Data *data;
+        int index, n;
+        std::vector<int> acc;
+        std::vector<Point32f> ps;
+        std::vector<float> as;
+        virtual void perform(){
+          acc.assign(data->w*data->h,0);
+          ps.clear();
+          as.clear();
+          data->voteBatch(index,n,acc.data(),ps,as);
+        }
+      };
+      MultiThreader mt;
+      std::vector<Work> works;
+
+      void prepareTables(){
+        sampleX.clear();
+        sampleCos.clear();
+        sampleSin.clear();
+        for(float rho=0;rho<2*M_PI;rho+=dRho){
+          sampleX.push_back(round(rho * mrho));
+          sampleCos.push_back(cos(rho));
+          sampleSin.push_back(sin(rho));
+        }
+        mcos.resize(w);
+        msin.resize(w);
+        for(int x=0;x<w;++x){
+          const float rho = x/mrho;
+          mcos[x] = mr * ::cos(rho);
+          msin[x] = mr * ::sin(rho);
+        }
+      }
+
+      inline void inc(int *acc, int x, int y) const{
+        if(blurredSampling){
+          if(y>0) acc[x+(y-1)*w]++;
+          acc[x+y*w] += 2;
+          if(y<h-1) acc[x+(y+1)*w]++;
+        }else{
+          acc[x+y*w]++;
+        }
+      }
+
+      /// votes for the line through (px,py) in the columns [x0,x1)
+      void voteColumns(int *acc, int x0, int x1, float px, float py) const{
+        const float *mc = mcos.data(), *ms = msin.data();
+        const float b = br + 0.5f; // truncation of non-negative values + 0.5 is rounding
+        int x = x0;
+#ifdef ICL_HAVE_SSE2
+        const __m128 vx = _mm_set1_ps(px), vy = _mm_set1_ps(py), vb = _mm_set1_ps(b);
+        const __m128 vh = _mm_set1_ps(h), zero = _mm_setzero_ps();
+        int ys[4];
+        for(;x+4<=x1;x+=4){
+          const __m128 t = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vx,_mm_loadu_ps(mc+x)),
+                                                 _mm_mul_ps(vy,_mm_loadu_ps(ms+x))),vb);
+          const int valid = _mm_movemask_ps(_mm_and_ps(_mm_cmpge_ps(t,zero),_mm_cmplt_ps(t,vh)));
+          if(!valid) continue;
+          _mm_storeu_si128((__m128i*)ys,_mm_cvttps_epi32(t));
+          for(int k=0;k<4;++k){
+            if(valid & (1<<k)) inc(acc,x+k,ys[k]);
+          }
+        }
+#endif
+        for(;x<x1;++x){
+          const float t = (px*mc[x] + py*ms[x]) + b;
+          if(t >= 0 && t < h) inc(acc,x,(int)t);
+        }
+      }
+
+      /// votes for all lines through (px,py) whose normal is close to the given gradient angle
+      void voteGradient(int *acc, float px, float py, float angle) const{
+        const int P = w-1; // the last column (rho=2*pi) equals the first one (rho=0)
+        const float hw = gradientWindow * mrho;
+        if(2*hw+1 >= P){
+          voteColumns(acc,0,w,px,py);
+          return;
+        }
+        for(int i=0;i<2;++i){
+          // the line normal is either the gradient direction or its opposite
+          float a = angle + i*M_PI;
+          a -= floor(a/(2*M_PI)) * 2*M_PI;
+          const float c = a * mrho;
+          const int k0 = ceil(c-hw), k1 = floor(c+hw)+1;
+          const int off = k0 >= 0 ? (k0/P)*P : -((P-1-k0)/P)*P;
+          const int a0 = k0-off, a1 = k1-off;
+          if(a1 <= P){
+            voteColumns(acc,a0,a1,px,py);
+          }else{
+            voteColumns(acc,a0,P,px,py);
+            voteColumns(acc,0,a1-P,px,py);
+          }
+          if(a0 == 0 || a1 > P) voteColumns(acc,P,P+1,px,py);
+        }
+      }
+
+      void votePoint(int *acc, float x, float y, float angle) const{
+        if(angle != angle){ // undefined gradient (NaN): vote in all directions
+          voteColumns(acc,0,w,x,y);
+          if(dilateEntries){
+            voteColumns(acc,0,w,x-1,y);
+            voteColumns(acc,0,w,x+1,y);
+            voteColumns(acc,0,w,x,y-1);
+            voteColumns(acc,0,w,x,y+1);
+          }
+        }else{
+          voteGradient(acc,x,y,angle);
+          if(dilateEntries){
+            voteGradient(acc,x-1,y,angle);
+            voteGradient(acc,x+1,y,angle);
+            voteGradient(acc,x,y-1,angle);
+            voteGradient(acc,x,y+1,angle);
+          }
+        }
+      }
+
+      /// votes the index-th part of the current batch into acc
+      void voteBatch(int index, int n, int *acc, std::vector<Point32f> &ps, std::vector<float> &as){
+        if(batchImage){
+          const Channel8u b = (*batchImage)[0];
+          const Channel32f gx = (*batchGx)[0], gy = (*batchGy)[0];
+          const int W = b.getWidth(), H = b.getHeight();
+          const int y0 = (index*H)/n, y1 = ((index+1)*H)/n;
+          for(int y=y0;y<y1;++y){
+            const icl8u *row = &b(0,y);
+            for(int x=0;x<W;++x){
+              if(!row[x]) continue;
+              const float dx = gx(x,y), dy = gy(x,y);
+              const float a = (dx || dy) ? ::atan2(dy,dx) : NAN;
+              votePoint(acc,x,y,a);
+              if(refineLines && a == a){
+                ps.push_back(Point32f(x,y));
+                as.push_back(a);
+              }
+            }
+          }
+        }else{
+          const int i0 = (index*batchSize)/n, i1 = ((index+1)*batchSize)/n;
+          for(int i=i0;i<i1;++i){
+            votePoint(acc,batchPoints[i].x,batchPoints[i].y,batchAngles[i]);
+          }
+          if(refineLines){
+            for(int i=i0;i<i1;++i){
+              if(batchAngles[i] != batchAngles[i]) continue;
+              ps.push_back(batchPoints[i]);
+              as.push_back(batchAngles[i]);
+            }
+          }
+        }
+      }
+
+      /// votes the current batch using per-thread accumulators, that are merged afterwards
+      void runBatch(){
+        const int work = batchImage ? batchImage->getHeight() : batchSize/256;
+        const int nt = iclMax(1,iclMin(numThreads,work));
+        if(nt == 1){
+          voteBatch(0,1,lut.begin(),gradPoints,gradAngles);
+          return;
+        }
+        if(mt.isNull() || mt.getNumThreads() != nt){
+          mt = MultiThreader(nt);
+        }
+        works.resize(nt);
+        MultiThreader::WorkSet ws(nt);
+        for(int i=0;i<nt;++i){
+          works[i].data = this;
+          works[i].index = i;
+          works[i].n = nt;
+          ws[i] = &works[i];
+        }
+        mt(ws);
+        int *dst = lut.begin();
+        const int dim = w*h;
+        for(int i=0;i<nt;++i){
+          const int *src = works[i].acc.data();
+          for(int j=0;j<dim;++j) dst[j] += src[j];
+          gradPoints.insert(gradPoints.end(),works[i].ps.begin(),works[i].ps.end());
+          gradAngles.insert(gradAngles.end(),works[i].as.begin(),works[i].as.end());
+        }
+      }
+
+      /// refines the line of the hough space peak p by re-voting the supporting points on a finer grid
+      void refine(const Point &p, float &rho, float &r) const{
+        rho = p.x/mrho;
+        r = (p.y-br)/mr;
+        if(!gradPoints.size()) return;
+
+        static const int F = 5, N = 2*F+1; // sub-divisions per coarse bin
+        const float dRhoF = 1.0f/(mrho*F), dRF = 1.0f/(mr*F);
+        float cs[N], sn[N];
+        for(int j=0;j<N;++j){
+          cs[j] = ::cos(rho+(j-F)*dRhoF);
+          sn[j] = ::sin(rho+(j-F)*dRhoF);
+        }
+        int acc[N*N];
+        std::fill(acc,acc+N*N,0);
+
+        const float c0 = ::cos(rho), s0 = ::sin(rho);
+        const float maxDist = 2.0f/mr, maxAngle = gradientWindow + 1.0f/mrho;
+        const float r0 = r - (F+0.5f)*dRF;
+        for(unsigned int i=0;i<gradPoints.size();++i){
+          const Point32f &q = gradPoints[i];
+          if(::fabs(q.x*c0 + q.y*s0 - r) > maxDist) continue;
+          float d = ::fmod(::fabs(gradAngles[i]-rho),float(M_PI));
+          if(iclMin(d,float(M_PI)-d) > maxAngle) continue;
+          for(int j=0;j<N;++j){
+            const float k = (q.x*cs[j] + q.y*sn[j] - r0)/dRF;
+            if(k >= 0 && k < N) acc[j*N+(int)k]++;
+          }
+        }
+        const int best = (int)(std::max_element(acc,acc+N*N)-acc);
+        if(!acc[best]) return;
+        rho += (best/N-F)*dRhoF;
+        r += (best%N-F)*dRF;
+      }
     };
   
     HoughLineDetector::HoughLineDetector(float dRho, float dR, const Range32f &rRange, float rInhibitionRange, float rhoInhibitionRange,
@@ -76,6 +316,14 @@ namespace icl{
       addProperty("adding.blur hough space","flag","",blurHoughSpace,0,"blur the whole hough space before line extraction");
       addProperty("adding.dilate entries","flag","",dilateEntries,0,"apply dilation on entries when adding");
       addProperty("adding.blurred sampling","flag","",blurredSampling,0,"sample the houghspace in a blurred fashion");
+      addProperty("gradient.angle window","range","[0.01,1.57]",0.15,0,
+                  "half angular window (around the gradient direction) that is used for gradient-oriented voting");
+      addProperty("gradient.refine lines","flag","",true,0,
+                  "refine detected lines by coarse-to-fine re-voting of the added gradient points");
+      addProperty("number of threads","range:spinbox","[1,64]:1",1,0,
+                  "number of threads that are used for gradient-oriented batch voting");
+
+      m_data->batchImage = 0;
 
       reset();
     }
@@ -91,9 +339,13 @@ namespace icl{
                        getPropertyValue("range.max radius")),
               getPropertyValue("inhibition.radius-axis"),
               getPropertyValue("inhibition.angle-axis"),
+              getPropertyValue("inhibition.gaussian"),
               getPropertyValue("adding.blur hough space"),
               getPropertyValue("adding.dilate entries"),
-              getPropertyValue("adding.blur hough space"));
+              getPropertyValue("adding.blurred sampling"));
+      m_data->gradientWindow = getPropertyValue("gradient.angle window");
+      m_data->refineLines = getPropertyValue("gradient.refine lines");
+      m_data->numThreads = getPropertyValue("number of threads");
     }
 
     void HoughLineDetector::prepare(float dRho, float dR, const utils::Range32f &rRange, 
@@ -123,6 +375,7 @@ namespace icl{
       m_data->br = -rRange.minVal * m_data->mr;
       
       m_data->mrho = (m_data->w-1)/(2*M_PI);
+      m_data->prepareTables();
   
       if(gaussianInhibition){
         /// create inhibition image
@@ -156,6 +409,37 @@ namespace icl{
       }
     }
 
+    void HoughLineDetector::add(const Point32f &p, float gradientAngle){
+      m_data->votePoint(m_data->lut.begin(),p.x,p.y,gradientAngle);
+      if(m_data->refineLines && gradientAngle == gradientAngle){
+        m_data->gradPoints.push_back(p);
+        m_data->gradAngles.push_back(gradientAngle);
+      }
+    }
+
+    void HoughLineDetector::add(const std::vector<Point32f> &ps, const std::vector<float> &gradientAngles){
+      ICLASSERT_THROW(ps.size() == gradientAngles.size(),
+                      ICLException("HoughLineDetector::add: got different number of points and gradient angles"));
+      if(ps.empty()) return;
+      m_data->batchPoints = ps.data();
+      m_data->batchAngles = gradientAngles.data();
+      m_data->batchSize = (int)ps.size();
+      m_data->batchImage = 0;
+      m_data->runBatch();
+    }
+
+    void HoughLineDetector::add(const Img8u &binaryImage, const Img32f &gx, const Img32f &gy){
+      ICLASSERT_THROW(binaryImage.getChannels() == 1 && gx.getChannels() && gy.getChannels(),
+                      ICLException("HoughLineDetector::add: invalid channel count"));
+      ICLASSERT_THROW(binaryImage.getSize() == gx.getSize() && binaryImage.getSize() == gy.getSize(),
+                      ICLException("HoughLineDetector::add: binary image and gradient images must have the same size"));
+      m_data->batchImage = &binaryImage;
+      m_data->batchGx = &gx;
+      m_data->batchGy = &gy;
+      m_data->runBatch();
+      m_data->batchImage = 0;
+    }
+
     void HoughLineDetector::add_intern(float x, float y){
       if(m_data->dilateEntries){
         add_intern2(x,y);
@@ -169,13 +453,23 @@ namespace icl{
     }
     
     void HoughLineDetector::add_intern2(float x, float y){
-      if(m_data->blurredSampling){
-        for(float rho=0;rho<2*M_PI;rho+=m_data->dRho){
-          incLutBlurred(rho,r(rho,x,y));
+      // uses the precomputed samples of rho (this is equivalent to iterating rho
+      // from 0 to 2*pi and calling incLut(rho,r(rho,x,y)))
+      const Data &d = *m_data;
+      const int n = (int)d.sampleX.size();
+      if(d.blurredSampling){
+        for(int i=0;i<n;++i){
+          const int xi = d.sampleX[i], yi = getY(x*d.sampleCos[i] + y*d.sampleSin[i]);
+          if(yi >= 0 && yi < d.h){
+            if(yi>0) m_data->lut(xi,yi-1)++;
+            m_data->lut(xi,yi)+=2;
+            if(yi<d.h-1) m_data->lut(xi,yi+1)++;
+          }
         }
       }else{
-        for(float rho=0;rho<2*M_PI;rho+=m_data->dRho){
-          incLut(rho,r(rho,x,y));
+        for(int i=0;i<n;++i){
+          const int yi = getY(x*d.sampleCos[i] + y*d.sampleSin[i]);
+          if(yi >= 0 && yi < d.h) m_data->lut(d.sampleX[i],yi)++;
         }
       }
     }
@@ -183,6 +477,8 @@ namespace icl{
     void HoughLineDetector::reset(){
       prepare_all();
       std::fill(m_data->lut.begin(),m_data->lut.end(),0);
+      m_data->gradPoints.clear();
+      m_data->gradAngles.clear();
     }
   
     void HoughLineDetector::apply_inhibition(const Point &p){
@@ -232,7 +528,9 @@ namespace icl{
         Point p(-1,-1);
         int m = m_data->image.getMax(0,&p);
         if(m == 0) return ls;
-        ls.push_back(StraightLine2D(getRho(p.x),getR(p.y)));
+        float rho = 0, r = 0;
+        m_data->refine(p,rho,r);
+        ls.push_back(StraightLine2D(rho,r));
         apply_inhibition(p);
   
       }
@@ -259,7 +557,9 @@ namespace icl{
         if(!i) firstMax = m;
         significances.push_back(float(m)/firstMax);
         if(m == 0) return ls;
-        ls.push_back(StraightLine2D(getRho(p.x),getR(p.y)));
+        float rho = 0, r = 0;
+        m_data->refine(p,rho,r);
+        ls.push_back(StraightLine2D(rho,r));
         
         apply_inhibition(p);
   
@@ -346,7 +646,7 @@ namespace icl{
       if(y >= 0 && y < m_data->h){
         if(y>0) m_data->lut(x,y-1)++;
         m_data->lut(x,y)+=2;
-        if(y<m_data->w-1) m_data->lut(x,y+1)++;
+        if(y<m_data->h-1) m_data->lut(x,y+1)++;
       }
     }
     /// internal utility function
@@ -104,7 +104,28 @@ namespace icl{
         however, the other two optimzations provides better results.
         It's worth mention, that this optimization's additional computational expense is low in comparison
         to the other two optizations.
-        
+
+        @section GRAD Gradient-Oriented Voting
+        If the gradient direction of the border pixels is known (e.g. from a sobel or canny
+        filter), a pixel does not need to vote for all line angles: The normal of a line that
+        passes through an edge pixel is (up to noise) parallel to the pixel's gradient. Therefore,
+        points that are added together with a gradient angle only vote for the lines whose angle
+        rho is within a window (property "gradient.angle window") around the gradient direction or
+        its opposite direction. This reduces the number of votes per pixel by an order of magnitude
+        and it also removes most of the clutter from the hough space.
+        - r is computed for 4 angles at once (SSE2) using precomputed (and pre-scaled)
+          sin/cos tables
+        - the batch versions (a vector of points or a binary image with gradient images) distribute
+          the points to several threads (property "number of threads"); each thread votes into its
+          own accumulator and all accumulators are merged at the end
+        - the stabilization techniques (dilation and blurred sampling) are applied as well
+
+        @subsection REF Coarse-to-Fine Refinement
+        The accuracy of the detected lines is limited by the hough space resolution. If the property
+        "gradient.refine lines" is set, the added gradient points are kept, and each detected
+        line is refined by re-voting all gradient points that support it into a 5-times finer local
+        accumulator around the coarse hough space maximum. This does only affect points that were
+        added with gradient information.
     */
     class ICLCV_API HoughLineDetector : public utils::Configurable{
       struct Data;
@@ -160,6 +181,19 @@ namespace icl{
   
       /// adds all non zero pixels of the given binary image
       void add(const core::Img8u &binaryImage);
+
+      /// adds a new point with given gradient direction (in radians, see \ref GRAD)
+      /** If the gradient angle is NaN, the point votes for all line angles */
+      void add(const utils::Point32f &p, float gradientAngle);
+
+      /// adds new points with given gradient directions (in parallel, see \ref GRAD)
+      void add(const std::vector<utils::Point32f> &ps, const std::vector<float> &gradientAngles);
+
+      /// adds all non zero pixels of the given binary image using gradient-oriented voting
+      /** The gradient direction of each pixel is atan2(gy,gx), where gx and gy are the
+          x- and y-gradient images (e.g. results of a sobel filter), which must have the
+          same size as the binary image. Only the first channels are used. */
+      void add(const core::Img8u &binaryImage, const core::Img32f &gx, const core::Img32f &gy);
   
       /// returns current hough-table image
       const core::Img32s &getImage() const;
@@ -31,6 +31,7 @@
 
 #include <ICLCV/ImageRegion.h>
 #include <ICLCV/ImageRegionData.h>
+#include <ICLCV/RegionDetector.h>
 
 #include <ICLUtils/StringUtils.h>
 #include <ICLCore/Img.h>
@@ -137,10 +138,15 @@ namespace icl{
       if(simple->cog) return *simple->cog;
       
       Point32f cog = Point32f::null;
-      for(std::vector<LineSegment>::const_iterator it = m_data->segments.begin(); it != m_data->segments.end();++it){
-        int l = it->len();
-        cog.x += l * ( it->x + (0.5*(l-1)));
-        cog.y += l * it->y;
+      if(m_data->features.mask & RegionDetector::FeatureMoments){
+        cog.x = m_data->features.sx;
+        cog.y = m_data->features.sy;
+      }else{
+        for(std::vector<LineSegment>::const_iterator it = m_data->segments.begin(); it != m_data->segments.end();++it){
+          int l = it->len();
+          cog.x += l * ( it->x + (0.5*(l-1)));
+          cog.y += l * it->y;
+        }
       }
       float s = 1.0/getSize();
       
@@ -160,6 +166,11 @@ namespace icl{
       ImageRegionData::SimpleInformation *simple = m_data->ensureSimple();
       if(simple->boundingBox) return *simple->boundingBox;
       
+      if(m_data->features.mask & RegionDetector::FeatureBoundingBox){
+        const ImageRegionData::AccumulatedFeatures &f = m_data->features;
+        return *(simple->boundingBox = new Rect(f.minX,f.minY,f.maxX-f.minX,f.maxY-f.minY+1));
+      }
+      
       register int minX = std::numeric_limits<int>::max();
       register int minY = minX;
       register int maxX = std::numeric_limits<int>::min();
@@ -207,20 +218,26 @@ namespace icl{
       register int nPts = getSize();
       
       const std::vector<LineSegment> &segs = m_data->segments;
-      for(unsigned int i=0;i<segs.size();++i){
-        x = segs[i].x;
-        y = segs[i].y;
-        len = segs[i].len();
-        end = segs[i].x+len-1;
-  
-        /// XX = sum(k=x..end) k²
-        avgXX += eval_sum_of_squares(end) - eval_sum_of_squares(x-1);
+      if(m_data->features.mask & RegionDetector::FeatureMoments){
+        avgXX = m_data->features.sxx;
+        avgYY = m_data->features.syy;
+        avgXY = m_data->features.sxy;
+      }else{
+        for(unsigned int i=0;i<segs.size();++i){
+          x = segs[i].x;
+          y = segs[i].y;
+          len = segs[i].len();
+          end = segs[i].x+len-1;
+  
+          /// XX = sum(k=x..end) k²
+          avgXX += eval_sum_of_squares(end) - eval_sum_of_squares(x-1);
         
-        /// YY = sum(k=x..end) y²
-        avgYY += len*y*y;
+          /// YY = sum(k=x..end) y²
+          avgYY += len*y*y;
         
-        /// XY = sum(k=x..end) xy = y * sum(k=x..end) k 
-        avgXY += y * ( eval_sum(end) - eval_sum(x-1) );
+          /// XY = sum(k=x..end) xy = y * sum(k=x..end) k 
+          avgXY += y * ( eval_sum(end) - eval_sum(x-1) );
+        }
       }
       avgXX/=nPts;
       avgYY/=nPts;
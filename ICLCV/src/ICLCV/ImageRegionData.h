@@ -38,8 +38,10 @@
 #include <ICLCV/ImageRegion.h>
 #include <ICLCV/RegionPCAInfo.h>
 #include <ICLCV/CornerDetectorCSS.h>
+#include <ICLCV/RegionDetector.h>
 
 #include <set>
+#include <limits>
 
 namespace icl{
   namespace cv{
@@ -165,6 +167,15 @@ namespace icl{
         std::vector<ImageRegion> *publicNeighbours;         //!< adjacent regions
         CSSParams *cssParams;
       } *complex; //!< more complex image region information
+
+      /// features, that are accumulated by the RegionDetector during the detection
+      /** see RegionDetector::setFeatureMask */
+      struct AccumulatedFeatures{
+        int mask;                 //!< accumulated features (RegionDetector::Feature mask)
+        int minX,minY,maxX,maxY;  //!< bounding box (maxX is exclusive)
+        icl64s sx,sy;             //!< first order raw moments (sum of x and y)
+        icl64s sxx,sxy,syy;       //!< second order raw moments
+      } features; //!< optionally accumulated features
   
       
       CornerDetectorCSS *css; //!< for corner detection
@@ -175,7 +186,9 @@ namespace icl{
       /// Constructor
       inline ImageRegionData(CornerDetectorCSS *css, int value, int id, unsigned int segmentSize, bool createGraph,const core::ImgBase *image):
         value(value),id(id),size(0),image(image),segments(segmentSize),graph(createGraph ? new RegionGraphInfo : 0),
-      simple(0),complex(0),css(css){}
+      simple(0),complex(0),css(css){
+        features.mask = 0;
+      }
       
       /// Destructor
       inline ~ImageRegionData(){
@@ -199,6 +212,37 @@ namespace icl{
         }
       }
       
+      /// initializes the accumulated features for the given RegionDetector::Feature mask
+      inline void initFeatures(int mask){
+        features.mask = mask;
+        features.minX = features.minY = std::numeric_limits<int>::max();
+        features.maxX = features.maxY = std::numeric_limits<int>::min();
+        features.sx = features.sy = features.sxx = features.sxy = features.syy = 0;
+      }
+
+      /// accumulates the features of the given line segment
+      /** This is called by the RegionDetector for all line segments of a region */
+      inline void accumulateFeatures(const LineSegment &s){
+        const int len = s.len();
+        size += len;
+        if(features.mask & RegionDetector::FeatureBoundingBox){
+          if(s.x < features.minX) features.minX = s.x;
+          if(s.xend > features.maxX) features.maxX = s.xend;
+          if(s.y < features.minY) features.minY = s.y;
+          if(s.y > features.maxY) features.maxY = s.y;
+        }
+        if(features.mask & RegionDetector::FeatureMoments){
+          const icl64s x0 = s.x, x1 = s.xend-1, y = s.y;
+          const icl64s sumX = ((x0+x1)*len)/2;
+          const icl64s sumXX = (x1*(x1+1)*(2*x1+1) - (x0-1)*x0*(2*x0-1))/6;
+          features.sx += sumX;
+          features.sy += y*len;
+          features.sxx += sumXX;
+          features.sxy += y*sumX;
+          features.syy += y*y*len;
+        }
+      }
+
       /// adds a new child region
       inline void addChild(ImageRegionData *a){
         graph->children.push_back(a);
@@ -68,6 +68,9 @@ namespace icl{
   
       /// chached value
       int val;
+
+      /// region, this part belongs to (set when the regions are joined)
+      ImageRegionData *data;
       
       /// returns whether this ImageRegionPart is on top
       inline bool is_top() const { return flags & 0x1; }
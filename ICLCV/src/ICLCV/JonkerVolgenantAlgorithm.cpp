@@ -0,0 +1,392 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLCV/src/ICLCV/JonkerVolgenantAlgorithm.cpp           **
+** Module : ICLCV                                                  **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#include <ICLCV/JonkerVolgenantAlgorithm.h>
+#include <ICLUtils/Macros.h>
+#include <ICLUtils/Exception.h>
+#include <ICLCore/Types.h>
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <cmath>
+
+using namespace icl::utils;
+using namespace icl::core;
+
+namespace icl{
+  namespace cv{
+
+    namespace{
+      /// square sparse problem in compressed row storage
+      struct SparseLAP{
+        int n;
+        std::vector<int> first;  //!< entries of row i are first[i] ... first[i+1]-1
+        std::vector<int> cols;
+        std::vector<double> costs;
+
+        /// creates the row structure from the given number of entries per row
+        void init(int n, const std::vector<int> &counts){
+          this->n = n;
+          first.resize(n+1);
+          first[0] = 0;
+          for(int i=0;i<n;++i) first[i+1] = first[i] + counts[i];
+          cols.resize(first[n]);
+          costs.resize(first[n]);
+        }
+      };
+
+      typedef std::pair<double,int> HeapEntry;
+
+      /// shortest augmenting path algorithm (Jonker/Volgenant)
+      /** x[i] becomes the column of row i. Returns false if no perfect matching exists */
+      bool solve_square(const SparseLAP &p, std::vector<int> &x){
+        const int n = p.n;
+        const double inf = std::numeric_limits<double>::max();
+        std::vector<int> y(n,-1);
+        std::vector<double> v(n,inf), xc(n,0); // column potentials, cost of each row's assigned entry
+        x.assign(n,-1);
+
+        // column reduction: v[j] = min_i c(i,j)
+        for(int i=0;i<n;++i){
+          for(int k=p.first[i];k<p.first[i+1];++k){
+            v[p.cols[k]] = iclMin(v[p.cols[k]],p.costs[k]);
+          }
+        }
+        for(int j=0;j<n;++j){
+          if(v[j] == inf) return false; // empty column
+        }
+
+        // greedy assignment of tight entries (each row takes its best column if free)
+        std::vector<int> freeRows;
+        for(int i=0;i<n;++i){
+          int best = -1;
+          double bestVal = inf;
+          for(int k=p.first[i];k<p.first[i+1];++k){
+            const double r = p.costs[k] - v[p.cols[k]];
+            if(r < bestVal || (r == bestVal && y[p.cols[k]] < 0)){
+              bestVal = r;
+              best = k;
+            }
+          }
+          if(best < 0) return false; // empty row
+          const int j = p.cols[best];
+          if(y[j] < 0){
+            x[i] = j;
+            y[j] = i;
+            xc[i] = p.costs[best];
+          }else{
+            freeRows.push_back(i);
+          }
+        }
+
+        // augmentation: one Dijkstra search over the reduced costs for each free row
+        std::vector<double> d(n,inf), predCost(n);
+        std::vector<int> pred(n);
+        std::vector<char> done(n,0);
+        std::vector<int> touched, ready;
+        std::vector<HeapEntry> heap;
+        std::greater<HeapEntry> cmp;
+        for(unsigned int f=0;f<freeRows.size();++f){
+          const int s = freeRows[f];
+          for(int k=p.first[s];k<p.first[s+1];++k){
+            const int j = p.cols[k];
+            const double dj = p.costs[k] - v[j];
+            if(dj < d[j]){
+              if(d[j] == inf) touched.push_back(j);
+              d[j] = dj;
+              pred[j] = s;
+              predCost[j] = p.costs[k];
+              heap.push_back(HeapEntry(dj,j));
+              std::push_heap(heap.begin(),heap.end(),cmp);
+            }
+          }
+          int freeCol = -1;
+          double D = 0;
+          while(heap.size()){
+            std::pop_heap(heap.begin(),heap.end(),cmp);
+            const HeapEntry h = heap.back();
+            heap.pop_back();
+            const int j = h.second;
+            if(done[j] || h.first > d[j]) continue;
+            done[j] = 1;
+            ready.push_back(j);
+            if(y[j] < 0){
+              freeCol = j;
+              D = h.first;
+              break;
+            }
+            // continue from the row that is currently assigned to j (its reduced cost is 0)
+            const int i = y[j];
+            const double base = h.first - (xc[i] - v[j]);
+            for(int k=p.first[i];k<p.first[i+1];++k){
+              const int jj = p.cols[k];
+              if(done[jj]) continue;
+              const double dj = base + p.costs[k] - v[jj];
+              if(dj < d[jj]){
+                if(d[jj] == inf) touched.push_back(jj);
+                d[jj] = dj;
+                pred[jj] = i;
+                predCost[jj] = p.costs[k];
+                heap.push_back(HeapEntry(dj,jj));
+                std::push_heap(heap.begin(),heap.end(),cmp);
+              }
+            }
+          }
+          if(freeCol < 0) return false;
+
+          // update the potentials of all scanned columns
+          for(unsigned int r=0;r<ready.size();++r){
+            v[ready[r]] += d[ready[r]] - D;
+          }
+          // augment along the path
+          for(int j=freeCol;;){
+            const int i = pred[j];
+            const int next = x[i];
+            y[j] = i;
+            x[i] = j;
+            xc[i] = predCost[j];
+            if(i == s) break;
+            j = next;
+          }
+          // reset search state
+          for(unsigned int t=0;t<touched.size();++t){
+            d[touched[t]] = inf;
+            done[touched[t]] = 0;
+          }
+          touched.clear();
+          ready.clear();
+          heap.clear();
+        }
+        return true;
+      }
+    }
+
+    template<class real>
+    std::vector<int> JonkerVolgenantAlgorithm<real>::apply(const Array2D<real> &m, bool isCostMatrix){
+      const int n = m.getWidth();
+      ICLASSERT_THROW(n == m.getHeight(), ICLException("JonkerVolgenantAlgorithm::apply: cost matrix must be square"));
+      if(!n) return std::vector<int>();
+      const real maxWeight = isCostMatrix ? real(0) : m.maxElem();
+
+      SparseLAP p;
+      p.init(n,std::vector<int>(n,n));
+      for(int x=0,k=0;x<n;++x){
+        for(int y=0;y<n;++y,++k){
+          p.cols[k] = y;
+          p.costs[k] = isCostMatrix ? m(x,y) : maxWeight - m(x,y);
+        }
+      }
+      std::vector<int> a;
+      solve_square(p,a);
+      return a;
+    }
+
+    template<class real>
+    real JonkerVolgenantAlgorithm<real>::solve(int numRows, int numCols, const std::vector<Entry> &entries,
+                                               real costOfNonAssignment, std::vector<int> &rowAssignment,
+                                               std::vector<int> &colAssignment){
+      ICLASSERT_THROW(numRows >= 0 && numCols >= 0, ICLException("JonkerVolgenantAlgorithm::solve: invalid size"));
+      const int n = numRows + numCols;
+      const int E = (int)entries.size();
+      rowAssignment.assign(numRows,-1);
+      colAssignment.assign(numCols,-1);
+      if(!n) return 0;
+
+      /* square problem: rows 0..R-1 (real rows) and R..R+C-1 (dummy row for each column)
+         columns 0..C-1 (real columns) and C..C+R-1 (dummy column for each row)
+         - real row i: listed entries + own dummy column C+i (cost of non assignment)
+         - dummy row R+j: real column j (cost of non assignment) + the dummy columns C+i
+           of all rows i that are listed together with column j (cost 0) */
+      const double a = costOfNonAssignment;
+      std::vector<int> counts(n,1);
+      for(int e=0;e<E;++e){
+        const Entry &en = entries[e];
+        ICLASSERT_THROW(en.row >= 0 && en.row < numRows && en.col >= 0 && en.col < numCols,
+                        ICLException("JonkerVolgenantAlgorithm::solve: entry index out of range"));
+        ++counts[en.row];
+        ++counts[numRows+en.col];
+      }
+      SparseLAP p;
+      p.init(n,counts);
+      std::vector<int> pos(p.first.begin(),p.first.end()-1);
+      for(int e=0;e<E;++e){
+        const Entry &en = entries[e];
+        int &k = pos[en.row];
+        p.cols[k] = en.col;
+        p.costs[k++] = en.cost;
+        int &l = pos[numRows+en.col];
+        p.cols[l] = numCols+en.row;
+        p.costs[l++] = 0;
+      }
+      for(int i=0;i<numRows;++i){
+        p.cols[pos[i]] = numCols+i;
+        p.costs[pos[i]] = a;
+      }
+      for(int j=0;j<numCols;++j){
+        p.cols[pos[numRows+j]] = j;
+        p.costs[pos[numRows+j]] = a;
+      }
+
+      std::vector<int> x;
+      solve_square(p,x); // always solvable (all rows and columns can use their dummies)
+
+      double sum = a * (numRows + numCols);
+      for(int i=0;i<numRows;++i){
+        if(x[i] < numCols){
+          rowAssignment[i] = x[i];
+          colAssignment[x[i]] = i;
+        }
+      }
+      for(int e=0;e<E;++e){
+        const Entry &en = entries[e];
+        if(rowAssignment[en.row] == en.col) sum += en.cost - 2*a;
+      }
+      return (real)sum;
+    }
+
+    template<class real>
+    std::vector<int> JonkerVolgenantAlgorithm<real>::toSquareAssignment(const std::vector<int> &rowAssignment,
+                                                                        const std::vector<int> &colAssignment){
+      const int R = (int)rowAssignment.size(), C = (int)colAssignment.size(), N = iclMax(R,C);
+      std::vector<int> r(N,-1), freeCols;
+      freeCols.reserve(N);
+      for(int j=0;j<N;++j){
+        if(j >= C || colAssignment[j] < 0) freeCols.push_back(j);
+      }
+      // free columns are sorted: real columns come first
+      int next = 0;
+      for(int i=0;i<N;++i){
+        if(i < R && rowAssignment[i] >= 0) r[i] = rowAssignment[i];
+        else r[i] = freeCols[next++];
+      }
+      return r;
+    }
+
+    template<class real>
+    void JonkerVolgenantAlgorithm<real>::getUnassigned(const std::vector<int> &rowAssignment,
+                                                       const std::vector<int> &colAssignment,
+                                                       std::vector<int> &rows, std::vector<int> &cols){
+      rows.clear();
+      cols.clear();
+      for(unsigned int i=0;i<rowAssignment.size();++i){
+        if(rowAssignment[i] < 0) rows.push_back(i);
+      }
+      for(unsigned int j=0;j<colAssignment.size();++j){
+        if(colAssignment[j] < 0) cols.push_back(j);
+      }
+    }
+
+    template<class real>
+    std::vector<int> JonkerVolgenantAlgorithm<real>::toSquareAssignment(const std::vector<int> &rowAssignment,
+                                                                        const std::vector<int> &colAssignment,
+                                                                        const Array2D<real> &leftoverCosts){
+      const int R = (int)rowAssignment.size(), C = (int)colAssignment.size(), N = iclMax(R,C);
+      std::vector<int> lr, lc;
+      getUnassigned(rowAssignment,colAssignment,lr,lc);
+      const int nr = (int)lr.size(), nc = (int)lc.size();
+      if(leftoverCosts.getWidth() != nr || leftoverCosts.getHeight() != nc){
+        throw ICLException("JonkerVolgenantAlgorithm::toSquareAssignment: invalid size of leftoverCosts");
+      }
+      // the padded indices are appended (only one of both dimensions is padded), so that the
+      // left over problem is square; pairs with padded indices have no costs
+      for(int i=R;i<N;++i) lr.push_back(i);
+      for(int j=C;j<N;++j) lc.push_back(j);
+      const int K = (int)lr.size();
+
+      std::vector<int> r(N,-1);
+      for(int i=0;i<R;++i){
+        if(rowAssignment[i] >= 0) r[i] = rowAssignment[i];
+      }
+      if(!K) return r;
+
+      Array2D<real> m(K,K,real(0));
+      for(int i=0;i<nr;++i){
+        for(int j=0;j<nc;++j){
+          m(i,j) = leftoverCosts(i,j);
+        }
+      }
+      std::vector<int> a = apply(m);
+      for(int i=0;i<K;++i){
+        r[lr[i]] = lc[a[i]];
+      }
+      return r;
+    }
+
+    template<class real>
+    void JonkerVolgenantAlgorithm<real>::gate(const std::vector<Point32f> &a, const std::vector<Point32f> &b,
+                                              float radius, std::vector<Entry> &dst){
+      if(a.empty() || b.empty() || radius <= 0) return;
+      float minX = b[0].x, maxX = b[0].x, minY = b[0].y, maxY = b[0].y;
+      for(unsigned int i=1;i<b.size();++i){
+        minX = iclMin(minX,b[i].x);
+        maxX = iclMax(maxX,b[i].x);
+        minY = iclMin(minY,b[i].y);
+        maxY = iclMax(maxY,b[i].y);
+      }
+      // the cell size is at least the radius (and the grid is not much larger than the point count)
+      float cell = radius;
+      while(((maxX-minX)/cell+1) * ((maxY-minY)/cell+1) > 4.0f*b.size()+16) cell *= 2;
+      const int gw = (int)((maxX-minX)/cell)+1, gh = (int)((maxY-minY)/cell)+1;
+
+      // counting sort of b into the grid cells
+      std::vector<int> cellOf(b.size()), start(gw*gh+1,0), idx(b.size());
+      for(unsigned int i=0;i<b.size();++i){
+        cellOf[i] = (int)((b[i].x-minX)/cell) + gw * (int)((b[i].y-minY)/cell);
+        ++start[cellOf[i]+1];
+      }
+      for(int c=0;c<gw*gh;++c) start[c+1] += start[c];
+      std::vector<int> pos(start.begin(),start.end()-1);
+      for(unsigned int i=0;i<b.size();++i) idx[pos[cellOf[i]]++] = i;
+
+      const float r2 = radius*radius;
+      for(unsigned int i=0;i<a.size();++i){
+        const float fx = (a[i].x-minX)/cell, fy = (a[i].y-minY)/cell;
+        if(fx < -1 || fy < -1 || fx >= gw+1 || fy >= gh+1) continue;
+        const int cx = (int)floor(fx), cy = (int)floor(fy);
+        for(int y=iclMax(0,cy-1);y<=iclMin(gh-1,cy+1);++y){
+          for(int x=iclMax(0,cx-1);x<=iclMin(gw-1,cx+1);++x){
+            const int c = x + gw*y;
+            for(int k=start[c];k<start[c+1];++k){
+              const Point32f &q = b[idx[k]];
+              const float dx = a[i].x-q.x, dy = a[i].y-q.y, d2 = dx*dx+dy*dy;
+              if(d2 < r2) dst.push_back(Entry(i,idx[k],(real)d2));
+            }
+          }
+        }
+      }
+    }
+
+    template class ICLCV_API JonkerVolgenantAlgorithm<icl32s>;
+    template class ICLCV_API JonkerVolgenantAlgorithm<icl32f>;
+    template class ICLCV_API JonkerVolgenantAlgorithm<icl64f>;
+
+  } // namespace cv
+}
@@ -0,0 +1,146 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLCV/src/ICLCV/JonkerVolgenantAlgorithm.h             **
+** Module : ICLCV                                                  **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#pragma once
+
+#include <ICLUtils/CompatMacros.h>
+#include <ICLUtils/Array2D.h>
+#include <ICLUtils/Point32f.h>
+#include <vector>
+
+namespace icl{
+  namespace cv{
+
+    /// Sparse Jonker-Volgenant solver for (gated) linear assignment problems
+    /** The JonkerVolgenantAlgorithm solves the same linear assignment problems (LAP) as the
+        HungarianAlgorithm, but it uses the shortest augmenting path method of
+        R. Jonker and A. Volgenant (with column reduction as initialization), which works
+        on a sparse cost matrix. Each augmentation is a Dijkstra search over the listed
+        entries only.
+
+        \section DENSE Dense Problems
+        For dense square cost matrices, apply can be used as a drop-in replacement for
+        HungarianAlgorithm::apply. Even here, it is much faster (about O(n^2) in typical
+        cases) than the Hungarian algorithm (O(n^3)).
+
+        \section SPARSE Sparse, Gated Problems
+        In tracking applications, most of the n x m possible associations are implausible.
+        If only the plausible pairs are passed (e.g. all pairs closer than a gating radius,
+        see gate), the solver's complexity depends on the number of pairs only. Rows and
+        columns do not need to have the same size, and some of them might not have any
+        plausible partner. Therefore, not assigning a row (or a column) is allowed, but it
+        entails the costOfNonAssignment. Internally, the problem is transformed into a square
+        sparse problem of size (rows+columns) that always has a perfect matching.
+
+        \section BENCH Benchmark
+        The assignment-benchmark example compares the sparse solver (including gating), the dense
+        solver and the HungarianAlgorithm for a swarm of randomly moving targets and a gating radius
+        of 20 pixels. For a few hundred targets and more, the sparse solver is orders of magnitude
+        faster than both dense solvers, and its run-time grows nearly linearly with the number of
+        targets.
+
+        @see PositionTracker
+        @see VectorTracker
+    */
+    template<class real>
+    class ICLCV_API JonkerVolgenantAlgorithm{
+      public:
+
+      /// sparse cost matrix entry
+      struct Entry{
+        int row;   //!< row index
+        int col;   //!< column index
+        real cost; //!< assignment cost
+        Entry(int row=0, int col=0, real cost=0):row(row),col(col),cost(cost){}
+      };
+
+      /// calculates the best assignment for a dense square matrix (same as HungarianAlgorithm::apply)
+      /** The returned vector a contains, for each x, the y-index that is assigned
+          to it, so that the sum of m(x,a[x]) is minimized. If isCostMatrix is false,
+          the sum is maximized. */
+      static std::vector<int> apply(const utils::Array2D<real> &m, bool isCostMatrix=true);
+
+      /// solves a sparse (potentially rectangular) assignment problem
+      /** Each row can be assigned to at most one column (and vice versa) and only listed
+          entries can be assigned. Each row or column that is not assigned causes additional
+          costOfNonAssignment (i.e. an entry is only used if its costs are less than
+          2*costOfNonAssignment). Each (row,col) pair must not be listed more than once.
+          @param numRows number of rows
+          @param numCols number of columns
+          @param entries list of valid associations
+          @param costOfNonAssignment costs for leaving a row or column unassigned
+          @param rowAssignment destination for the column of each row (or -1)
+          @param colAssignment destination for the row of each column (or -1)
+          @return overall costs (including the costs of non-assignment) */
+      static real solve(int numRows, int numCols, const std::vector<Entry> &entries,
+                        real costOfNonAssignment, std::vector<int> &rowAssignment,
+                        std::vector<int> &colAssignment);
+
+      /// converts a sparse result into the (padded) square assignment format of HungarianAlgorithm
+      /** The result r has size N = max(numRows,numCols). Here, rows and columns are
+          virtually padded to N. r[i] is the (padded) column index that is assigned to row i:
+          Assigned rows keep their columns, unassigned real rows get the left over real columns
+          first, and all other indices are assigned in ascending order. This is exactly what
+          the trackers expect when the smaller dimension is padded with 'blind values'.
+          Please note, that left over rows and columns are paired in index order here. If their
+          costs are known, the overloaded version, that pairs them at minimum costs, should be
+          used instead. */
+      static std::vector<int> toSquareAssignment(const std::vector<int> &rowAssignment,
+                                                 const std::vector<int> &colAssignment);
+
+      /// converts a sparse result into the square format, left over rows and columns are paired at minimum costs
+      /** Like the version above, but the unassigned real rows and columns are associated by solving
+          the dense assignment problem for the given costs. This is what the HungarianAlgorithm would
+          do for rows and columns, that do not have a partner within the gating radius.
+          @param rowAssignment sparse result (see solve)
+          @param colAssignment sparse result (see solve)
+          @param leftoverCosts costs for the unassigned rows and columns: leftoverCosts(i,j) contains the
+                 costs for the i-th unassigned row and the j-th unassigned column (in the order returned by
+                 getUnassigned). Its size must be (number of unassigned rows) x (number of unassigned
+                 columns) */
+      static std::vector<int> toSquareAssignment(const std::vector<int> &rowAssignment,
+                                                 const std::vector<int> &colAssignment,
+                                                 const utils::Array2D<real> &leftoverCosts);
+
+      /// utility function, that lists the unassigned rows and columns of a sparse result (ascending)
+      static void getUnassigned(const std::vector<int> &rowAssignment, const std::vector<int> &colAssignment,
+                                std::vector<int> &rows, std::vector<int> &cols);
+
+      /// utility function to find all plausible pairs for the sparse solver
+      /** All pairs (i,j) with |a[i]-b[j]| < radius are appended to dst (row i, column j,
+          cost: squared distance). Internally, the points b are sorted into a regular grid
+          with cell size radius, so that only the 3x3 neighbouring cells need to be
+          searched for each point a[i] */
+      static void gate(const std::vector<utils::Point32f> &a, const std::vector<utils::Point32f> &b,
+                       float radius, std::vector<Entry> &dst);
+    };
+
+  } // namespace cv
+}
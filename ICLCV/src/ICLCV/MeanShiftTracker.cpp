@@ -30,46 +30,126 @@
 
 #include <ICLCV/MeanShiftTracker.h>
 #include <ICLCore/Channel.h>
+#include <ICLUtils/SSETypes.h>
 
 using namespace icl::utils;
 using namespace icl::core;
 
 namespace icl {
   namespace cv{
-  
-    Point32f MeanShiftTracker::applyMeanShiftStep(const Img32f &image, const Point32f &pos){
-  
-      Channel32f k = m_kernelImage[0];
-      Channel32f w = image[0];
-  
-      double dx = 0;
-      double dy = 0;
-      double accu = 0;
-  
-      for (int x = -m_bandwidth; x<= m_bandwidth; ++x){
-        int ix = x+ pos.x;
-        if (ix <0) continue;
-        if (ix >= image.getWidth()) break;
-        
-        for (int y = -m_bandwidth;y<=m_bandwidth; ++y){
-          int iy = y+pos.y;
-          if (iy < 0) continue;
-          if (iy >= image.getHeight()) break;
-  
-          float sum = k(x+m_bandwidth, y+m_bandwidth) * w(ix,iy);
-  
-          dx += sum * ix;
-          dy += sum * iy;
-          accu += sum;
+
+    namespace{
+
+      /// mean shift step using the kernel weighted window sums
+      /** The window is centered at the integer position (cx,cy) and clipped to the image */
+      Point32f weighted_step(const Img32f &image, const Img32f &kernel, int bandwidth, const Point32f &pos){
+        const int W = image.getWidth(), H = image.getHeight();
+        const int cx = (int)pos.x, cy = (int)pos.y;
+        const int x0 = iclMax(cx-bandwidth,0), x1 = iclMin(cx+bandwidth,W-1);
+        const int y0 = iclMax(cy-bandwidth,0), y1 = iclMin(cy+bandwidth,H-1);
+        const int kw = kernel.getWidth();
+        double s = 0, sx = 0, sy = 0;
+        for(int y=y0;y<=y1;++y){
+          const float *w = image.begin(0) + y*W + x0;
+          const float *k = kernel.begin(0) + (y-cy+bandwidth)*kw + (x0-cx+bandwidth);
+          const int n = x1-x0+1;
+          float rs = 0, rsx = 0; // x is relative to x0 here
+          int x = 0;
+#ifdef ICL_HAVE_SSE2
+          __m128 as = _mm_setzero_ps(), ax = _mm_setzero_ps();
+          __m128 xs = _mm_set_ps(3,2,1,0);
+          const __m128 four = _mm_set1_ps(4);
+          for(;x+4<=n;x+=4){
+            const __m128 p = _mm_mul_ps(_mm_loadu_ps(w+x),_mm_loadu_ps(k+x));
+            as = _mm_add_ps(as,p);
+            ax = _mm_add_ps(ax,_mm_mul_ps(p,xs));
+            xs = _mm_add_ps(xs,four);
+          }
+          float bs[4], bx[4];
+          _mm_storeu_ps(bs,as);
+          _mm_storeu_ps(bx,ax);
+          rs = (bs[0]+bs[1]) + (bs[2]+bs[3]);
+          rsx = (bx[0]+bx[1]) + (bx[2]+bx[3]);
+#endif
+          for(;x<n;++x){
+            const float p = w[x]*k[x];
+            rs += p;
+            rsx += p*x;
+          }
+          s += rs;
+          sx += rsx + (double)x0*rs;
+          sy += (double)y*rs;
         }
+        //setting the new center; sum has to be != zero
+        return s != 0 ? Point32f(sx/s,sy/s) : pos;
       }
-  
-      //setting the new center; sum has to be != zero
-      if (accu != 0) {
-        return Point32f(dx,dy) *(1/accu);
-      }else{
-        return pos;
+
+      /// mean shift step for the flat kernel using the integral images of w, x*w and y*w
+      Point32f flat_step(const std::vector<double> *ii, int W, int H, int bandwidth, const Point32f &pos){
+        const int cx = (int)pos.x, cy = (int)pos.y;
+        const int x0 = iclMax(cx-bandwidth,0), x1 = iclMin(cx+bandwidth,W-1)+1;
+        const int y0 = iclMax(cy-bandwidth,0), y1 = iclMin(cy+bandwidth,H-1)+1;
+        if(x0 >= x1 || y0 >= y1) return pos;
+        const int s = W+1, a = x0+y0*s, b = x1+y0*s, c = x0+y1*s, d = x1+y1*s;
+        const double sw = ii[0][d] - ii[0][b] - ii[0][c] + ii[0][a];
+        if(sw == 0) return pos;
+        return Point32f((ii[1][d] - ii[1][b] - ii[1][c] + ii[1][a])/sw,
+                        (ii[2][d] - ii[2][b] - ii[2][c] + ii[2][a])/sw);
+      }
+
+      /// computes the integral images of w, x*w and y*w (with an extra row and column of 0s)
+      void compute_integrals(const Img32f &image, std::vector<double> *ii){
+        const int W = image.getWidth(), H = image.getHeight(), s = W+1;
+        for(int i=0;i<3;++i) ii[i].assign(s*(H+1),0);
+        for(int y=0;y<H;++y){
+          const float *w = image.begin(0) + y*W;
+          double r0 = 0, r1 = 0, r2 = 0;
+          double *a = &ii[0][(y+1)*s+1], *b = &ii[1][(y+1)*s+1], *c = &ii[2][(y+1)*s+1];
+          for(int x=0;x<W;++x){
+            r0 += w[x];
+            r1 += (double)w[x]*x;
+            r2 += (double)w[x]*y;
+            a[x] = a[x-s] + r0;
+            b[x] = b[x-s] + r1;
+            c[x] = c[x-s] + r2;
+          }
+        }
       }
+
+      /// work package for the batched step method (each thread tracks every n-th target)
+      struct BatchWork : public MultiThreader::Work{
+        const Img32f *image;
+        const Img32f *kernel;
+        const std::vector<double> *integrals; //!< null if the kernel is not flat
+        int bandwidth, maxCycles, index, n;
+        float convergenceCriterion;
+        const std::vector<Point32f> *in;
+        std::vector<Point32f> *out;
+        std::vector<int> *converged;
+
+        virtual void perform(){
+          for(unsigned int i=index;i<in->size();i+=n){
+            Point32f lastPos = (*in)[i];
+            int cycles = maxCycles;
+            (*converged)[i] = 0;
+            while(cycles--){
+              const Point32f newPos = integrals ?
+                                      flat_step(integrals,image->getWidth(),image->getHeight(),bandwidth,lastPos) :
+                                      weighted_step(*image,*kernel,bandwidth,lastPos);
+              if((lastPos-newPos).norm() <= convergenceCriterion){
+                (*converged)[i] = 1;
+                break;
+              }
+              lastPos = newPos;
+            }
+            (*out)[i] = lastPos;
+          }
+        }
+      };
+    }
+  
+    Point32f MeanShiftTracker::applyMeanShiftStep(const Img32f &image, const Point32f &pos){
+      return weighted_step(image,m_kernelImage,m_bandwidth,pos);
     }
   
     Img32f MeanShiftTracker::generateEpanechnikov(int bandwidth) {
@@ -94,21 +174,33 @@ namespace icl {
       return k;
     }
   
+    Img32f MeanShiftTracker::generateFlat(int bandwidth) {
+      Img32f k(Size(2*bandwidth+1,2*bandwidth+1),1);
+      k.clear(-1,1);
+      return k;
+    }
+
     void MeanShiftTracker::setKernel(kernelType type, int bandwidth, float stdDev){
       m_bandwidth = bandwidth;
       m_kernelType = type;
       switch(type){
         case epanechnikov: m_kernelImage = generateEpanechnikov(bandwidth); break;
         case gauss: m_kernelImage = generateGauss(bandwidth,stdDev); break;
+        case flat: m_kernelImage = generateFlat(bandwidth); break;
         default:
           ERROR_LOG("unsupported kernel type");
       }
     }
   
   
-    MeanShiftTracker::MeanShiftTracker(kernelType type, int bandwidth, float stdDev){
+    MeanShiftTracker::MeanShiftTracker(kernelType type, int bandwidth, float stdDev):m_numThreads(1){
       setKernel(type,bandwidth,stdDev);
     }
+
+    void MeanShiftTracker::setNumThreads(int numThreads){
+      ICLASSERT_RETURN(numThreads > 0);
+      m_numThreads = numThreads;
+    }
   
   
     const Point32f MeanShiftTracker::step(const Img32f &weigthImage, const Point32f &initialPoint,  
@@ -128,6 +220,57 @@ namespace icl {
       }
       return lastPos;
     }
+
+    std::vector<Point32f> MeanShiftTracker::step(const Img32f &weightImage, const std::vector<Point32f> &initialPoints,
+                                                 int maxCycles, float convergenceCriterion, std::vector<bool> *converged){
+      if (maxCycles < 0) {
+        maxCycles = 10000;
+      }
+      const int numTargets = (int)initialPoints.size();
+      std::vector<Point32f> result(numTargets);
+      std::vector<int> conv(numTargets,0);
+      if(numTargets){
+        // computing the integral images is much more expensive per pixel than the (SSE)
+        // window sums, it pays off only if the windows of all targets cover the image
+        // several times (empirically, the break even point is at about 3-4 times)
+        const double windowSize = (2*m_bandwidth+1)*(2*m_bandwidth+1);
+        const bool useIntegrals = (m_kernelType == flat &&
+                                   windowSize*numTargets > 4.0*weightImage.getDim());
+        if(useIntegrals){
+          compute_integrals(weightImage,m_integrals);
+        }
+        const int nt = iclMin(m_numThreads,numTargets);
+        std::vector<BatchWork> works(nt);
+        for(int i=0;i<nt;++i){
+          BatchWork &w = works[i];
+          w.image = &weightImage;
+          w.kernel = &m_kernelImage;
+          w.integrals = useIntegrals ? m_integrals : 0;
+          w.bandwidth = m_bandwidth;
+          w.maxCycles = maxCycles;
+          w.index = i;
+          w.n = nt;
+          w.convergenceCriterion = convergenceCriterion;
+          w.in = &initialPoints;
+          w.out = &result;
+          w.converged = &conv;
+        }
+        if(nt == 1){
+          works[0].perform();
+        }else{
+          if(m_mt.isNull() || m_mt.getNumThreads() != nt){
+            m_mt = MultiThreader(nt);
+          }
+          MultiThreader::WorkSet ws(nt);
+          for(int i=0;i<nt;++i) ws[i] = &works[i];
+          m_mt(ws);
+        }
+      }
+      if(converged){
+        converged->assign(conv.begin(),conv.end());
+      }
+      return result;
+    }
   
   } // namespace cv
 }
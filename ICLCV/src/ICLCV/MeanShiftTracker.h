@@ -32,6 +32,9 @@
 
 #include <ICLUtils/CompatMacros.h>
 #include <ICLCore/Img.h>
+#include <ICLUtils/MultiThreader.h>
+
+#include <vector>
 
 namespace icl {
   namespace cv{
@@ -84,6 +87,19 @@ namespace icl {
         the original image, is needed. In this image, all pixels, that belong to the blob must
         have high values.
         
+        \section SEC_BATCH Tracking Several Targets
+        If many targets (e.g. dozens of colour blobs) are tracked in the same weight image, the
+        batched version of step should be used. It distributes the targets to several threads
+        (see setNumThreads); each target is iterated until it converged (or maxCycles is reached)
+        independently of the others. For the flat kernel, the integral images of \f$w\f$,
+        \f$x \cdot w\f$ and \f$y \cdot w\f$ are computed once per call, so that each mean
+        shift step needs only 12 look-ups instead of a sum over the whole window. As this
+        needs a rather expensive pass over the whole image, it is only done if the windows
+        of all targets cover the image more than 4 times (e.g. several hundred targets with
+        large bandwidth); otherwise, the SSE window sums are used as well.
+        For the other kernels, the kernel weighted window sums are computed row by row
+        (4 pixels at once if ICL is compiled with SSE2 support).
+
         \section TODO ToDo
         Add other kernels.
         Add functionality to open any image as kernel image.
@@ -96,7 +112,8 @@ namespace icl {
       /// An enumeration for the different kernel types
       enum kernelType {
         epanechnikov,
-        gauss
+        gauss,
+        flat    //!< all window pixels are weighted equally (see \ref SEC_BATCH)
       }; 
       private:
       
@@ -112,6 +129,15 @@ namespace icl {
           quadrant of the image, as the values are the same for absolute coordinates.
           */
       core::Img32f m_kernelImage;
+
+      /// number of threads used by the batched step method
+      int m_numThreads;
+
+      /// internal thread pool for the batched step method
+      utils::MultiThreader m_mt;
+
+      /// integral images of w, x*w and y*w (only used for the flat kernel)
+      std::vector<double> m_integrals[3];
       
       /// Applies a single step of the mean shift algorithm
       /** 
@@ -135,6 +161,10 @@ namespace icl {
           @param stdDev profiles the standard deviation.
           */
       static core::Img32f generateGauss(int bandwidth,float stdDev);
+
+      /// Generates a flat Kernel (all entries are 1)
+      /** @param bandwidth kernel bandwidth */
+      static core::Img32f generateFlat(int bandwidth);
   
       /// Constructor with only the most needed parameters
       /** The basic constructor with only the most needed parameters.
@@ -172,6 +202,27 @@ namespace icl {
           convergence criterion was reached
           */
       const utils::Point32f step(const core::Img32f &weigthImage, const utils::Point32f &initialPoint,  int maxCycles=-1, float convergenceCriterion=1.0, bool *converged=0);
+
+      /// Batched version of step for several targets (see \ref SEC_BATCH)
+      /** The i-th result corresponds to the one of step(weightImage,initialPoints[i],...).
+          If the integral images are used (flat kernel, see \ref SEC_BATCH), the window sums are
+          accumulated in a different order and precision, so that the results are only equal up to
+          rounding, and the iteration count may differ by one if a step size is very close to
+          convergenceCriterion.
+          @param weightImage gray level input image
+          @param initialPoints starting points (one per target)
+          @param maxCycles maximum iteration count per target (if -1, 10000 is used)
+          @param convergenceCriterion see step
+          @param converged if a non-NULL pointer is given here, it receives a flag for each
+                           target that notifies whether it converged */
+      std::vector<utils::Point32f> step(const core::Img32f &weightImage, const std::vector<utils::Point32f> &initialPoints,
+                                        int maxCycles=-1, float convergenceCriterion=1.0, std::vector<bool> *converged=0);
+
+      /// sets the number of threads, the targets of the batched step method are distributed to
+      void setNumThreads(int numThreads);
+
+      /// returns the number of threads used by the batched step method
+      int getNumThreads() const { return m_numThreads; }
   
     };
   } // namespace cv
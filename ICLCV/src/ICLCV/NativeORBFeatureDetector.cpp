@@ -0,0 +1,889 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLCV/src/ICLCV/NativeORBFeatureDetector.cpp           **
+** Module : ICLCV                                                  **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#include <ICLCV/NativeORBFeatureDetector.h>
+#include <ICLCV/DescriptorMatcher.h>
+#include <ICLCore/CCFunctions.h>
+#include <ICLUtils/ClippedCast.h>
+#include <ICLUtils/MultiThreader.h>
+#include <ICLUtils/SSETypes.h>
+#include <ICLUtils/StringUtils.h>
+#include <ICLUtils/Time.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace icl{
+  using namespace core;
+  using namespace utils;
+
+  namespace cv{
+
+    namespace{
+      
+      /// minimum distance of features to the image border
+      /** this is the orientation patch radius (15) plus some extra pixels for the
+          box filter sums of the rotated descriptor pattern */
+      static const int BORDER = 18;
+      static const int PATCH_SIZE = 31;
+      static const int ORIENTATION_RADIUS = 15;
+      static const int ANGLE_BINS = 32;
+      static const int NUM_PAIRS = 256;
+
+      /// bresenham circle of radius 3 (clockwise, starting at the top)
+      static const int FAST_CIRCLE[16][2] = { {0,-3},{1,-3},{2,-2},{3,-1},{3,0},{3,1},{2,2},{1,3},
+                                              {0,3},{-1,3},{-2,2},{-3,1},{-3,0},{-3,-1},{-2,-2},{-1,-3} };
+
+      /// returns whether the given 16 bit circle mask contains an arc of 9 set bits
+      inline bool has_arc(int m){
+        m |= m << 16;
+        int r = m;
+        for(int i=1;i<9;++i) r &= m >> i;
+        return r & 0xffff;
+      }
+      
+      /// quick rejection test: 9 contiguous pixels always include 2 neighboured compass points
+      inline bool compass_test(const icl8u *p, const int *off, int t){
+        const int hi = *p + t, lo = *p - t;
+        const int a = p[off[0]], b = p[off[4]], c = p[off[8]], d = p[off[12]];
+        return (((a > hi) & (b > hi)) | ((b > hi) & (c > hi)) | ((c > hi) & (d > hi)) | ((d > hi) & (a > hi)) | 
+                ((a < lo) & (b < lo)) | ((b < lo) & (c < lo)) | ((c < lo) & (d < lo)) | ((d < lo) & (a < lo)));
+      }
+
+      /// complete segment test: returns the FAST score (the maximum threshold for which
+      /// p is still a corner) or 0 if p is no corner for the given threshold t
+      inline int fast_score(const icl8u *p, const int *off, int t){
+        const int c = *p;
+        int d[25], bright = 0, dark = 0;
+        for(int k=0;k<16;++k){
+          d[k] = (int)p[off[k]] - c;
+          bright |= int(d[k] > t) << k;
+          dark |= int(d[k] < -t) << k;
+        }
+        if(!has_arc(bright) && !has_arc(dark)) return 0;
+        for(int k=0;k<9;++k) d[16+k] = d[k];
+        // min/max of all 9-arcs, composed of the min/max of arcs of length 2 and 4
+        int mn2[23], mx2[23], best = 0;
+        for(int k=0;k<23;++k){
+          mn2[k] = iclMin(d[k],d[k+1]);
+          mx2[k] = iclMax(d[k],d[k+1]);
+        }
+        for(int s=0;s<16;++s){
+          const int mn = iclMin(iclMin(iclMin(mn2[s],mn2[s+2]),iclMin(mn2[s+4],mn2[s+6])),d[s+8]);
+          const int mx = iclMax(iclMax(iclMax(mx2[s],mx2[s+2]),iclMax(mx2[s+4],mx2[s+6])),d[s+8]);
+          best = iclMax(best,iclMax(mn,-mx));
+        }
+        return best-1;
+      }
+
+      /// index of the lowest set bit (x must not be 0)
+      inline int ctz16(int x){
+#if defined(__GNUC__)
+        return __builtin_ctz(x);
+#else
+        int i = 0;
+        while(!(x & (1<<i))) ++i;
+        return i;
+#endif
+      }
+
+      /// computes the FAST scores for pixels x0 <= x < x1 of a single row
+      void fast_row(const icl8u *row, int x0, int x1, const int *off, int t, icl8u *scores){
+        std::fill(scores+x0,scores+x1,0);
+        int x = x0;
+#ifdef ICL_HAVE_SSE2
+        const __m128i vt = _mm_set1_epi8((char)t);
+        const __m128i z = _mm_setzero_si128();
+        for(; x <= x1-16; x+=16){
+          const icl8u *p = row + x;
+          const __m128i c = _mm_loadu_si128((const __m128i*)p);
+          const __m128i hi = _mm_adds_epu8(c,vt), lo = _mm_subs_epu8(c,vt);
+          // nb[k]/nd[k] are 0xff where the k-th compass point is NOT brighter/darker
+          __m128i nb[4], nd[4];
+          for(int k=0;k<4;++k){
+            const __m128i v = _mm_loadu_si128((const __m128i*)(p+off[4*k]));
+            nb[k] = _mm_cmpeq_epi8(_mm_subs_epu8(v,hi),z);
+            nd[k] = _mm_cmpeq_epi8(_mm_subs_epu8(lo,v),z);
+          }
+          // 0xff where no two neighboured compass points are brighter (darker)
+          const __m128i b = _mm_and_si128(_mm_and_si128(_mm_or_si128(nb[0],nb[1]),_mm_or_si128(nb[1],nb[2])),
+                                          _mm_and_si128(_mm_or_si128(nb[2],nb[3]),_mm_or_si128(nb[3],nb[0])));
+          const __m128i d = _mm_and_si128(_mm_and_si128(_mm_or_si128(nd[0],nd[1]),_mm_or_si128(nd[1],nd[2])),
+                                          _mm_and_si128(_mm_or_si128(nd[2],nd[3]),_mm_or_si128(nd[3],nd[0])));
+          int candidates = ~_mm_movemask_epi8(_mm_and_si128(b,d)) & 0xffff;
+          if(!candidates) continue;
+
+          // complete segment test: maximum run length of brighter and darker pixels
+          const __m128i one = _mm_set1_epi8(1), eight = _mm_set1_epi8(8);
+          __m128i rb = z, rd = z, mb = z, md = z;
+          for(int k=0;k<25;++k){
+            const __m128i v = _mm_loadu_si128((const __m128i*)(p+off[k&15]));
+            const __m128i isb = _mm_xor_si128(_mm_cmpeq_epi8(_mm_subs_epu8(v,hi),z),_mm_cmpeq_epi8(z,z));
+            const __m128i isd = _mm_xor_si128(_mm_cmpeq_epi8(_mm_subs_epu8(lo,v),z),_mm_cmpeq_epi8(z,z));
+            rb = _mm_and_si128(_mm_add_epi8(rb,one),isb);
+            rd = _mm_and_si128(_mm_add_epi8(rd,one),isd);
+            mb = _mm_max_epu8(mb,rb);
+            md = _mm_max_epu8(md,rd);
+          }
+          const __m128i corner = _mm_max_epu8(_mm_subs_epu8(mb,eight),_mm_subs_epu8(md,eight));
+          candidates &= ~_mm_movemask_epi8(_mm_cmpeq_epi8(corner,z)) & 0xffff;
+          while(candidates){
+            const int i = ctz16(candidates);
+            candidates &= candidates-1;
+            scores[x+i] = fast_score(p+i,off,t);
+          }
+        }
+#endif
+        for(; x<x1; ++x){
+          if(compass_test(row+x,off,t)) scores[x] = fast_score(row+x,off,t);
+        }
+      }
+
+      /// bilinear down-scaling (fixed point, pixel centers are aligned)
+      /** this is much faster than the generic Img::scaledCopy for the pyramid levels */
+      void scale_linear(const Img8u &src, Img8u &dst){
+        const int sw = src.getWidth(), sh = src.getHeight();
+        const int dw = dst.getWidth(), dh = dst.getHeight();
+        const int ONE = 1<<11;
+        std::vector<int> xs(dw), wx(dw), row(sw);
+        const float fx = float(sw)/dw, fy = float(sh)/dh;
+        for(int x=0;x<dw;++x){
+          const float sx = clip((x+0.5f)*fx-0.5f, 0.f, float(sw-1));
+          xs[x] = iclMin((int)sx, sw-2);
+          wx[x] = (int)((sx-xs[x])*ONE + 0.5f);
+        }
+        const icl8u *s = src.begin(0);
+        icl8u *d = dst.begin(0);
+        for(int y=0;y<dh;++y,d+=dw){
+          const float sy = clip((y+0.5f)*fy-0.5f, 0.f, float(sh-1));
+          const int y0 = iclMin((int)sy, sh-2), wy = (int)((sy-y0)*ONE + 0.5f);
+          const icl8u *r0 = s + y0*sw, *r1 = r0 + sw;
+          for(int x=0;x<sw;++x){
+            row[x] = r0[x]*(ONE-wy) + r1[x]*wy;
+          }
+          for(int x=0;x<dw;++x){
+            const int *r = &row[xs[x]];
+            d[x] = (icl8u)((r[0]*(ONE-wx[x]) + r[1]*wx[x] + (1<<21)) >> 22);
+          }
+        }
+      }
+
+      /// harris corner response of a 7x7 block (sobel gradients)
+      float harris_response(const icl8u *img, int w, int x, int y){
+        int a=0, b=0, c=0;
+        for(int dy=-3;dy<=3;++dy){
+          const icl8u *r = img + (y+dy)*w + x;
+          for(int dx=-3;dx<=3;++dx){
+            const icl8u *q = r+dx;
+            const int ix = (q[1-w] + 2*q[1] + q[1+w]) - (q[-1-w] + 2*q[-1] + q[-1+w]);
+            const int iy = (q[w-1] + 2*q[w] + q[w+1]) - (q[-w-1] + 2*q[-w] + q[-w+1]);
+            a += ix*ix;
+            b += iy*iy;
+            c += ix*iy;
+          }
+        }
+        // normalize gradients to [-1,1] (per pixel) to get comparable responses
+        const double s = 1.0/(4.0*7*255);
+        const double A = a*s*s, B = b*s*s, C = c*s*s;
+        return (float)(A*B - C*C - 0.04*(A+B)*(A+B));
+      }
+
+      /// orientation of the intensity centroid of the circular patch around (x,y)
+      float ic_angle(const icl8u *img, int w, int x, int y, const int *umax){
+        const icl8u *c = img + y*w + x;
+        int m01 = 0, m10 = 0;
+        for(int u=-ORIENTATION_RADIUS;u<=ORIENTATION_RADIUS;++u){
+          m10 += u*c[u];
+        }
+        for(int v=1;v<=ORIENTATION_RADIUS;++v){
+          const icl8u *lower = c+v*w, *upper = c-v*w;
+          const int d = umax[v];
+          int sum = 0;
+          for(int u=-d;u<=d;++u){
+            const int l = lower[u], h = upper[u];
+            sum += l - h;
+            m10 += u*(l + h);
+          }
+          m01 += v*sum;
+        }
+        return atan2f((float)m01,(float)m10);
+      }
+
+      /// sum of the 5x5 box around c + (dx,dy); c points into the integral image
+      inline int box_sum(const int *c, int W, int dx, int dy){
+        return c[(dy+3)*W+dx+3] - c[(dy-2)*W+dx+3] - c[(dy+3)*W+dx-2] + c[(dy-2)*W+dx-2];
+      }
+
+      /// bit count of a 64 bit word
+      inline int popcount64(icl64u x){
+#ifdef __POPCNT__
+        // hardware popcount instruction (e.g. -mpopcnt or -march=native)
+        return (int)__builtin_popcountll(x);
+#else
+        // without hardware support, __builtin_popcountll is a (slow) library call
+        x = x - ((x >> 1) & 0x5555555555555555ULL);
+        x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+        x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+        return (int)((x * 0x0101010101010101ULL) >> 56);
+#endif
+      }
+
+      /// hamming distance of two 256 bit descriptors
+      inline int hamming(const icl64u *a, const icl64u *b){
+#if defined(ICL_HAVE_SSSE3) && !defined(__POPCNT__)
+        // nibble lookup table popcount (cf. Mula et al., "Faster population counts")
+        const __m128i lut = _mm_setr_epi8(0,1,1,2,1,2,2,3,1,2,2,3,2,3,3,4);
+        const __m128i m = _mm_set1_epi8(0x0f);
+        const __m128i x0 = _mm_xor_si128(_mm_loadu_si128((const __m128i*)a),
+                                         _mm_loadu_si128((const __m128i*)b));
+        const __m128i x1 = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(a+2)),
+                                         _mm_loadu_si128((const __m128i*)(b+2)));
+        const __m128i c0 = _mm_add_epi8(_mm_shuffle_epi8(lut,_mm_and_si128(x0,m)),
+                                        _mm_shuffle_epi8(lut,_mm_and_si128(_mm_srli_epi16(x0,4),m)));
+        const __m128i c1 = _mm_add_epi8(_mm_shuffle_epi8(lut,_mm_and_si128(x1,m)),
+                                        _mm_shuffle_epi8(lut,_mm_and_si128(_mm_srli_epi16(x1,4),m)));
+        const __m128i s = _mm_sad_epu8(_mm_add_epi8(c0,c1),_mm_setzero_si128());
+        return _mm_cvtsi128_si32(s) + _mm_cvtsi128_si32(_mm_srli_si128(s,8));
+#else
+        return (popcount64(a[0]^b[0]) + popcount64(a[1]^b[1]) + 
+                popcount64(a[2]^b[2]) + popcount64(a[3]^b[3]));
+#endif
+      }
+
+      /// updates best and second best match (ties are resolved towards the lower index)
+      inline void update_best(int d, int j, int &d1, int &d2, int &best){
+        if(d < d1 || (d == d1 && j < best)){
+          d2 = d1;
+          d1 = d;
+          best = j;
+        }else if(d < d2){
+          d2 = d;
+        }
+      }
+
+      /// simple deterministic random number generator (platform independent patterns)
+      struct LCG{
+        icl32u state;
+        LCG(icl32u seed):state(seed){}
+        /// uniformly distributed in [0,65535]
+        inline int next(){
+          state = state * 1664525u + 1013904223u;
+          return (int)((state >> 8) & 0xffff);
+        }
+        /// approximately N(0,1) distributed (sum of 12 uniform samples)
+        inline float normal(){
+          int s = 0;
+          for(int i=0;i<12;++i) s += next();
+          return s/65536.0f - 6.0f;
+        }
+      };
+
+      /// rotated BRIEF sampling pattern (x1,y1,x2,y2 for each pair and angle bin)
+      struct BriefPattern{
+        icl8s pts[ANGLE_BINS][NUM_PAIRS*4];
+        
+        BriefPattern(){
+          // isotropic gaussian with sigma = S/5 (cf. Calonder et al., BRIEF G II),
+          // samples are restricted to a circle such that all rotations fit into the patch
+          const float sigma = PATCH_SIZE/5.0f;
+          const int r2 = 13*13;
+          LCG rng(0x2545f491u);
+          int p[NUM_PAIRS*4];
+          for(int i=0;i<NUM_PAIRS;++i){
+            int *q = p+4*i;
+            do{
+              for(int j=0;j<2;++j){
+                do{
+                  q[2*j] = (int)floor(sigma*rng.normal()+0.5f);
+                  q[2*j+1] = (int)floor(sigma*rng.normal()+0.5f);
+                }while(sqr(q[2*j])+sqr(q[2*j+1]) > r2);
+              }
+            }while(q[0] == q[2] && q[1] == q[3]);
+          }
+          for(int a=0;a<ANGLE_BINS;++a){
+            const float alpha = a * 2*M_PI/ANGLE_BINS, ca = cos(alpha), sa = sin(alpha);
+            for(int i=0;i<NUM_PAIRS*2;++i){
+              const float x = p[2*i], y = p[2*i+1];
+              pts[a][2*i] = (icl8s)floor(ca*x - sa*y + 0.5f);
+              pts[a][2*i+1] = (icl8s)floor(sa*x + ca*y + 0.5f);
+            }
+          }
+        }
+      };
+
+      /// multi-probe LSH index over a set of descriptors
+      struct LSHIndex{
+        int numTables, keyBits, size;
+        std::vector<int> bitPos;  //!< key bit positions (keyBits per table)
+        std::vector<int> offsets; //!< bucket offsets ((1<<keyBits)+1 per table)
+        std::vector<int> entries; //!< descriptor indices sorted by bucket (size per table)
+
+        inline int key(const NativeORBFeatureDetector::Descriptor &d, int table) const{
+          const int *b = &bitPos[table*keyBits];
+          int k = 0;
+          for(int i=0;i<keyBits;++i){
+            k |= int((d.bits[b[i]>>6] >> (b[i]&63)) & 1) << i;
+          }
+          return k;
+        }
+
+        void build(const std::vector<NativeORBFeatureDetector::Descriptor> &ds, int tables){
+          size = (int)ds.size();
+          numTables = tables;
+          // about one entry per bucket
+          keyBits = 1;
+          while((1<<(keyBits+1)) <= size) ++keyBits;
+          keyBits = clip(keyBits,8,20);
+          const int B = 1<<keyBits;
+
+          // the key bits are drawn from the half of the bits, that are best balanced
+          // within the set (this avoids degenerated, i.e. overfull, buckets)
+          std::vector<std::pair<int,int> > balance(NUM_PAIRS);
+          for(int b=0;b<NUM_PAIRS;++b){
+            int ones = 0;
+            for(int i=0;i<size;++i) ones += int((ds[i].bits[b>>6] >> (b&63)) & 1);
+            balance[b] = std::make_pair(std::abs(2*ones-size),b);
+          }
+          std::sort(balance.begin(),balance.end());
+          const int numBits = NUM_PAIRS/2;
+
+          LCG rng(0x9e3779b9u);
+          bitPos.resize(numTables*keyBits);
+          int perm[NUM_PAIRS];
+          for(int t=0;t<numTables;++t){
+            for(int i=0;i<numBits;++i) perm[i] = balance[i].second;
+            for(int i=0;i<keyBits;++i){
+              std::swap(perm[i], perm[i + rng.next() % (numBits-i)]);
+              bitPos[t*keyBits+i] = perm[i];
+            }
+          }
+
+          offsets.assign(numTables*(B+1),0);
+          entries.resize(numTables*size);
+          std::vector<int> keys(size);
+          for(int t=0;t<numTables;++t){
+            int *o = &offsets[t*(B+1)];
+            for(int i=0;i<size;++i){
+              keys[i] = key(ds[i],t);
+              ++o[keys[i]+1];
+            }
+            for(int k=0;k<B;++k) o[k+1] += o[k];
+            int *e = size ? &entries[t*size] : 0;
+            std::vector<int> pos(o,o+B);
+            for(int i=0;i<size;++i) e[pos[keys[i]]++] = i;
+          }
+        }
+      };
+
+      struct Candidate{
+        int x,y;
+        float response;
+        
+        /// sorts by descending response (ties are sorted by position for determinism)
+        bool operator<(const Candidate &c) const{
+          if(response != c.response) return response > c.response;
+          return y != c.y ? y < c.y : x < c.x;
+        }
+      };
+      
+      static std::string bench_time_string(const Time &t){
+        int ms10 = (int)(t.toMilliSecondsDouble()*10);
+        return str(float(ms10)/10.0f) + " ms";
+      }
+    } // anonymous namespace
+
+    struct NativeORBFeatureDetector::FeatureSetClass::Impl{
+      std::vector<KeyPoint> keyPoints;
+      std::vector<Descriptor> descriptors;
+    };
+    
+    struct NativeORBFeatureDetector::Data{
+      /// single pyramid level
+      struct Level{
+        Img8u image;
+        float scale;               //!< scale w.r.t. the input image
+        int maxFeatures;           //!< number of features that are kept in this level
+        int off[16];               //!< FAST circle offsets
+        std::vector<icl8u> scores; //!< FAST scores
+        std::vector<int> integral; //!< integral image with an extra row and column of 0s
+      };
+
+      /// work package for each thread
+      struct Work : public MultiThreader::Work{
+        enum Stage { Scores, Suppression, Description, Matching };
+        Stage stage;
+        Data *data;
+        int index, n;
+        std::vector<std::vector<Candidate> > found; //!< non-maximum suppressed corners per level
+        std::vector<int> stamps;                    //!< used for candidate deduplication in LSH queries
+
+        virtual void perform(){
+          switch(stage){
+            case Scores: data->computeScores(index,n); break;
+            case Suppression: data->suppress(index,n,found); break;
+            case Description: data->describe(index,n); break;
+            case Matching: data->matchRange(index,n,stamps); break;
+          }
+        }
+      };
+
+      BriefPattern pattern;
+      int umax[ORIENTATION_RADIUS+1];
+
+      const ImgBase *lastInputImage;
+      Img8u gray;
+      std::vector<Level> levels;
+      int fastThreshold;
+      bool harrisScore;
+      
+      // current detection result
+      std::vector<int> featureLevels;
+      FeatureSetClass *result;
+
+      // current matching state
+      const std::vector<Descriptor> *queries, *train;
+      bool useLSH;
+      LSHIndex lsh;
+      std::vector<int> bestIdx, bestDist, secondDist;
+
+      MultiThreader mt;
+      std::vector<Work> works;
+
+      Data():lastInputImage(0),gray(Size(1,1),formatGray),result(0){
+        for(int v=0;v<=ORIENTATION_RADIUS;++v){
+          int u = 0;
+          while(sqr(u+1)+sqr(v) <= sqr(ORIENTATION_RADIUS)) ++u;
+          umax[v] = u;
+        }
+      }
+
+      void prepareThreads(int n){
+        if(n > 1 && (mt.isNull() || mt.getNumThreads() != n)){
+          mt = MultiThreader(n);
+        }
+        works.resize(n);
+        for(int i=0;i<n;++i){
+          works[i].data = this;
+          works[i].index = i;
+          works[i].n = n;
+        }
+      }
+
+      void run(Work::Stage stage){
+        if(works.size() == 1){
+          works[0].stage = stage;
+          works[0].perform();
+          return;
+        }
+        MultiThreader::WorkSet ws(works.size());
+        for(unsigned int i=0;i<works.size();++i){
+          works[i].stage = stage;
+          ws[i] = &works[i];
+        }
+        mt(ws);
+      }
+
+      void buildPyramid(int numLevels, float scaleFactor, int maxFeatures){
+        const Size s0 = gray.getSize();
+        levels.resize(numLevels);
+        int used = 0;
+        for(int l=0;l<numLevels;++l,++used){
+          const float scale = pow(scaleFactor,l);
+          const Size s((int)floor(s0.width/scale+0.5f), (int)floor(s0.height/scale+0.5f));
+          if(s.width <= 2*BORDER || s.height <= 2*BORDER) break;
+          Level &L = levels[l];
+          L.scale = scale;
+          if(!l){
+            L.image = gray;
+          }else{
+            L.image.setSize(s);
+            L.image.setFormat(formatGray);
+            L.image.setChannels(1);
+            scale_linear(levels[l-1].image,L.image);
+          }
+          L.scores.resize(s.getDim());
+          for(int k=0;k<16;++k){
+            L.off[k] = FAST_CIRCLE[k][0] + FAST_CIRCLE[k][1]*s.width;
+          }
+        }
+        levels.resize(used);
+        
+        // the features are distributed proportionally to the level areas
+        const float f = 1.0f/(scaleFactor*scaleFactor);
+        float n = used ? maxFeatures/(float)used : 0;
+        if(f < 1 && used) n = maxFeatures * (1-f) / (1-pow(f,used));
+        int sum = 0;
+        for(int l=0;l<used;++l){
+          levels[l].maxFeatures = (l == used-1) ? iclMax(0,maxFeatures - sum) : (int)floor(n+0.5f);
+          sum += levels[l].maxFeatures;
+          n *= f;
+        }
+      }
+
+      void computeIntegralImages(){
+        for(unsigned int l=0;l<levels.size();++l){
+          Level &L = levels[l];
+          const int w = L.image.getWidth(), h = L.image.getHeight(), W = w+1;
+          L.integral.resize(W*(h+1));
+          int *ii = L.integral.data();
+          std::fill(ii,ii+W,0);
+          const icl8u *src = L.image.begin(0);
+          for(int y=0;y<h;++y){
+            const icl8u *s = src + y*w;
+            int *prev = ii + y*W, *cur = prev + W;
+            int rowSum = 0;
+            cur[0] = 0;
+            for(int x=0;x<w;++x){
+              rowSum += s[x];
+              cur[x+1] = prev[x+1] + rowSum;
+            }
+          }
+        }
+      }
+
+      void computeScores(int index, int n){
+        // scores are needed in the feature area plus a 1-pixel margin for suppression
+        for(unsigned int l=0;l<levels.size();++l){
+          Level &L = levels[l];
+          const int w = L.image.getWidth(), h = L.image.getHeight();
+          const int y0 = BORDER-1, y1 = h-BORDER+1;
+          const icl8u *img = L.image.begin(0);
+          for(int y=y0+(index*(y1-y0))/n; y<y0+((index+1)*(y1-y0))/n; ++y){
+            fast_row(img+y*w, BORDER-1, w-BORDER+1, L.off, fastThreshold, L.scores.data()+y*w);
+          }
+        }
+      }
+
+      void suppress(int index, int n, std::vector<std::vector<Candidate> > &found){
+        found.resize(levels.size());
+        for(unsigned int l=0;l<levels.size();++l){
+          const Level &L = levels[l];
+          std::vector<Candidate> &dst = found[l];
+          dst.clear();
+          const int w = L.image.getWidth(), h = L.image.getHeight();
+          const int y0 = BORDER, y1 = h-BORDER;
+          for(int y=y0+(index*(y1-y0))/n; y<y0+((index+1)*(y1-y0))/n; ++y){
+            const icl8u *s = L.scores.data() + y*w;
+            for(int x=BORDER;x<w-BORDER;++x){
+              const int v = s[x];
+              if(!v) continue;
+              // ties are resolved towards the last pixel (in raster order)
+              if(v < s[x-1-w] || v < s[x-w] || v < s[x+1-w] || v < s[x-1] ||
+                 v <= s[x+1] || v <= s[x-1+w] || v <= s[x+w] || v <= s[x+1+w]) continue;
+              Candidate c = { x, y, (float)v };
+              dst.push_back(c);
+            }
+          }
+        }
+      }
+
+      void describe(int index, int n){
+        std::vector<KeyPoint> &kps = result->impl->keyPoints;
+        std::vector<Descriptor> &ds = result->impl->descriptors;
+        const int N = (int)kps.size();
+        for(int i=(index*N)/n; i<((index+1)*N)/n; ++i){
+          KeyPoint &k = kps[i];
+          const Level &L = levels[k.level];
+          const int w = L.image.getWidth(), W = w+1;
+          const int x = (int)k.pos.x, y = (int)k.pos.y;
+
+          k.angle = ic_angle(L.image.begin(0), w, x, y, umax);
+          int bin = (int)floor(k.angle * (ANGLE_BINS/(2*M_PI)) + 0.5);
+          bin = ((bin % ANGLE_BINS) + ANGLE_BINS) % ANGLE_BINS;
+          const icl8s *p = pattern.pts[bin];
+          const int *c = L.integral.data() + y*W + x;
+          Descriptor &d = ds[i];
+          for(int j=0;j<4;++j){
+            icl64u bits = 0;
+            for(int b=0;b<64;++b,p+=4){
+              bits |= icl64u(box_sum(c,W,p[0],p[1]) < box_sum(c,W,p[2],p[3])) << b;
+            }
+            d.bits[j] = bits;
+          }
+
+          // transform to input image coordinates
+          k.pos.x = (x+0.5f)*L.scale - 0.5f;
+          k.pos.y = (y+0.5f)*L.scale - 0.5f;
+        }
+      }
+
+      /// finds the best and the 2nd best match in t for each descriptor in q
+      void findBest(const std::vector<Descriptor> &q, const std::vector<Descriptor> &t, bool approximate, int tables){
+        useLSH = approximate;
+        if(useLSH) lsh.build(t,tables);
+        queries = &q;
+        train = &t;
+        bestIdx.resize(q.size());
+        bestDist.resize(q.size());
+        secondDist.resize(q.size());
+        run(Work::Matching);
+      }
+
+      void matchRange(int index, int n, std::vector<int> &stamps){
+        const int N = (int)queries->size(), M = (int)train->size();
+        const Descriptor *t = train->data();
+        if(useLSH) stamps.assign(M,-1);
+        for(int i=(index*N)/n; i<((index+1)*N)/n; ++i){
+          const Descriptor &q = (*queries)[i];
+          int best = -1, d1 = 257, d2 = 257;
+          if(!useLSH){
+            for(int j=0;j<M;++j){
+              const int d = hamming(q.bits,t[j].bits);
+              update_best(d,j,d1,d2,best);
+            }
+          }else{
+            const int B = 1 << lsh.keyBits;
+            for(int tb=0;tb<lsh.numTables;++tb){
+              const int *o = &lsh.offsets[tb*(B+1)];
+              const int *e = &lsh.entries[tb*M];
+              const int key = lsh.key(q,tb);
+              // probe the query bucket and all buckets within hamming distance 1
+              for(int p=-1;p<lsh.keyBits;++p){
+                const int k = p < 0 ? key : key ^ (1<<p);
+                for(int a=o[k];a<o[k+1];++a){
+                  const int j = e[a];
+                  if(stamps[j] == i) continue;
+                  stamps[j] = i;
+                  const int d = hamming(q.bits,t[j].bits);
+                  update_best(d,j,d1,d2,best);
+                }
+              }
+            }
+          }
+          bestIdx[i] = best;
+          bestDist[i] = d1;
+          secondDist[i] = d2;
+        }
+      }
+    };
+
+    NativeORBFeatureDetector::NativeORBFeatureDetector() : m_data(new Data){
+      addProperty("score type","menu","fast,harris","harris",0, "Score type used for ranking the corners: harris is slightly slower but more accurate");
+      addProperty("max features","range:spinbox","[1,100000]:1","500",0, "Maximum number of features to detect");
+      addProperty("fast threshold","range:spinbox","[1,254]:1","20",0, "Intensity threshold for the FAST segment test");
+      addProperty("pyramid.levels","range","[1,100]:1","8",0, "Number of pyramid levels to use for key-point detection");
+      addProperty("pyramid.scale factor","range","[1,4]","1.2",0,"Scale down factor between consecutive pyramid layers");
+      addProperty("matching.mode","menu","auto,brute force,lsh","auto",0,
+                  "Matching strategy: auto uses multi-probe LSH if the second\n"
+                  "feature set contains at least 'matching.lsh min set size' features");
+      addProperty("matching.lsh min set size","range:spinbox","[1,1000000]","2000",0,"Minimum set size for using LSH (in auto mode)");
+      addProperty("matching.lsh tables","range:spinbox","[1,32]","6",0,"Number of LSH hash tables");
+      addProperty("matching.max distance","range","[0,256]:1","64",0,"Maximum hamming distance of accepted matches");
+      addProperty("matching.ratio","range","[0,1]","0.8",0,
+                  "A match is only accepted if its distance is smaller than ratio times the\n"
+                  "distance of the second best match (1 disables this test)");
+      addProperty("matching.cross check","flag","",false,0,"If set, only mutual best matches are returned");
+      addProperty("number of threads","range:spinbox","[1,64]","1",0,"Number of threads used for detection and matching");
+
+      addProperty("bench.enable","flag","",false,0,"Enable/Disable time benchmarks");
+      addProperty("bench.detection time","info","","??? ms",0,"Time for the whole last detection cycle");
+      addProperty("bench.matching time","info","","??? ms",0,"Last feature matching step");
+    }
+
+    NativeORBFeatureDetector::~NativeORBFeatureDetector(){
+      delete m_data;
+    }
+
+    NativeORBFeatureDetector::FeatureSetClass::FeatureSetClass(){
+      impl = new Impl;
+    }
+
+    NativeORBFeatureDetector::FeatureSetClass::~FeatureSetClass(){
+      delete impl;
+    }
+
+    int NativeORBFeatureDetector::FeatureSetClass::getNumFeatures() const{
+      return (int)impl->keyPoints.size();
+    }
+
+    const std::vector<NativeORBFeatureDetector::KeyPoint> &
+    NativeORBFeatureDetector::FeatureSetClass::getKeyPoints() const{
+      return impl->keyPoints;
+    }
+
+    const std::vector<NativeORBFeatureDetector::Descriptor> &
+    NativeORBFeatureDetector::FeatureSetClass::getDescriptors() const{
+      return impl->descriptors;
+    }
+
+    utils::VisualizationDescription NativeORBFeatureDetector::FeatureSetClass::vis() const{
+      VisualizationDescription d;
+      for(size_t i=0;i<impl->keyPoints.size();++i){
+        const KeyPoint &k = impl->keyPoints[i];
+        const float s = k.size/2, cx = k.pos.x, cy = k.pos.y;
+
+        d.color(0,255,0,255);
+        d.linewidth(2);
+        d.line(cx,cy,cx+cos(k.angle)*s,cy+sin(k.angle)*s);
+
+        d.linewidth(1);
+        d.color(0,100,255,255);
+        d.fill(255,0,0,0);
+        d.circle(cx,cy,s);
+      }
+      return d;
+    }
+
+    const ImgBase *NativeORBFeatureDetector::getIntermediateImage(const std::string &id){
+      if(id == "input") return m_data->lastInputImage;
+      if(id == "gray") return &m_data->gray;
+      if(id.length() > 6 && id.substr(0,6) == "level-"){
+        const int l = parse<int>(id.substr(6));
+        if(l >= 0 && l < (int)m_data->levels.size()) return &m_data->levels[l].image;
+      }
+      return 0;
+    }
+
+    int NativeORBFeatureDetector::distance(const Descriptor &a, const Descriptor &b){
+      return hamming(a.bits,b.bits);
+    }
+
+    NativeORBFeatureDetector::FeatureSet NativeORBFeatureDetector::detect(const core::Img8u &image){
+      const bool bench = getPropertyValue("bench.enable");
+      Time t = Time::now();
+      Data &d = *m_data;
+
+      d.lastInputImage = &image;
+      if(image.getChannels() != 1){
+        cc(&image, &d.gray);
+      }else{
+        d.gray = image;
+      }
+      d.fastThreshold = getPropertyValue("fast threshold");
+      d.harrisScore = getPropertyValue("score type").as<std::string>() == "harris";
+
+      d.buildPyramid(getPropertyValue("pyramid.levels"),
+                     getPropertyValue("pyramid.scale factor"),
+                     getPropertyValue("max features"));
+
+      FeatureSetClass *ret = new FeatureSetClass;
+      if(!d.levels.size()) return FeatureSet(ret);
+      
+      d.computeIntegralImages();
+      d.prepareThreads(getPropertyValue("number of threads"));
+      d.run(Data::Work::Scores);
+      d.run(Data::Work::Suppression);
+      
+      // select the best corners of each level (threads are merged in row order)
+      std::vector<KeyPoint> &kps = ret->impl->keyPoints;
+      std::vector<Candidate> cs;
+      for(unsigned int l=0;l<d.levels.size();++l){
+        const Data::Level &L = d.levels[l];
+        cs.clear();
+        for(unsigned int i=0;i<d.works.size();++i){
+          const std::vector<Candidate> &f = d.works[i].found[l];
+          cs.insert(cs.end(),f.begin(),f.end());
+        }
+        const int m = iclMin((int)cs.size(), L.maxFeatures);
+        if(d.harrisScore){
+          // the harris response is only computed for the best corners w.r.t. the FAST score
+          const int m2 = iclMin((int)cs.size(), 2*L.maxFeatures);
+          std::partial_sort(cs.begin(),cs.begin()+m2,cs.end());
+          cs.resize(m2);
+          for(int i=0;i<m2;++i){
+            cs[i].response = harris_response(L.image.begin(0),L.image.getWidth(),cs[i].x,cs[i].y);
+          }
+        }
+        std::partial_sort(cs.begin(),cs.begin()+m,cs.end());
+        for(int i=0;i<m;++i){
+          // positions are kept in level coordinates until the descriptors are computed
+          KeyPoint k = { Point32f(cs[i].x,cs[i].y), PATCH_SIZE*L.scale, 0, cs[i].response, (int)l };
+          kps.push_back(k);
+        }
+      }
+      ret->impl->descriptors.resize(kps.size());
+      d.result = ret;
+      d.run(Data::Work::Description);
+      d.result = 0;
+      
+      if(bench){
+        setPropertyValue("bench.detection time",bench_time_string(t.age()));
+      }
+      return FeatureSet(ret);
+    }
+
+    std::vector<NativeORBFeatureDetector::Match> 
+    NativeORBFeatureDetector::match(const NativeORBFeatureDetector::FeatureSet &a, 
+                                    const NativeORBFeatureDetector::FeatureSet &b){
+      ICLASSERT_THROW(a && b, ICLException("NativeORBFeatureDetector::match: given feature set was null"));
+      const bool bench = getPropertyValue("bench.enable");
+      Time t = Time::now();
+      Data &d = *m_data;
+
+      const std::vector<KeyPoint> &k1 = a->impl->keyPoints, &k2 = b->impl->keyPoints;
+      const int N = (int)k1.size(), M = (int)k2.size();
+      std::vector<Match> ret;
+      if(!N || !M) return ret;
+
+      const std::string mode = getPropertyValue("matching.mode");
+      const int minLSH = getPropertyValue("matching.lsh min set size");
+      const int tables = getPropertyValue("matching.lsh tables");
+      const int maxDist = getPropertyValue("matching.max distance");
+      const float ratio = getPropertyValue("matching.ratio");
+      d.prepareThreads(getPropertyValue("number of threads"));
+
+      d.findBest(a->impl->descriptors, b->impl->descriptors, 
+                 mode == "lsh" || (mode == "auto" && M >= minLSH), tables);
+      std::vector<DescriptorMatcher::Match> ab;
+      for(int i=0;i<N;++i){
+        const int j = d.bestIdx[i];
+        if(j < 0 || d.bestDist[i] > maxDist) continue;
+        if(ratio < 1 && d.bestDist[i] >= ratio * d.secondDist[i]) continue;
+        DescriptorMatcher::Match m = { i, j, (float)d.bestDist[i] };
+        ab.push_back(m);
+      }
+
+      if(getPropertyValue("matching.cross check")){
+        d.findBest(b->impl->descriptors, a->impl->descriptors,
+                   mode == "lsh" || (mode == "auto" && N >= minLSH), tables);
+        std::vector<DescriptorMatcher::Match> ba(M);
+        for(int j=0;j<M;++j){
+          ba[j].query = j;
+          ba[j].train = d.bestIdx[j];
+          ba[j].distance = d.bestDist[j];
+        }
+        DescriptorMatcher::mutualFilter(ab,ba,ab);
+      }
+
+      for(unsigned int i=0;i<ab.size();++i){
+        Match m = { k1[ab[i].query].pos, k2[ab[i].train].pos, ab[i].distance };
+        ret.push_back(m);
+      }
+
+      if(bench){
+        setPropertyValue("bench.matching time",bench_time_string(t.age()));
+      }
+      return ret;
+    }
+
+    REGISTER_CONFIGURABLE_DEFAULT(NativeORBFeatureDetector);
+
+  }
+}
@@ -0,0 +1,165 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLCV/src/ICLCV/NativeORBFeatureDetector.h             **
+** Module : ICLCV                                                  **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#pragma once
+
+#include <ICLUtils/CompatMacros.h>
+#include <ICLCore/Img.h>
+#include <ICLUtils/Uncopyable.h>
+#include <ICLUtils/Configurable.h>
+#include <ICLUtils/Point32f.h>
+#include <ICLUtils/VisualizationDescription.h>
+
+namespace icl{
+  namespace cv{
+
+    /// Native implementation of ORB-like binary features (oriented FAST + rotated BRIEF)
+    /** In contrast to the ORBFeatureDetector, that wraps OpenCV's ORB implementation,
+        the NativeORBFeatureDetector works directly on ICL images and has no
+        external dependencies. Its interface (FeatureSet, Match, detect and match)
+        is the same as the one of the ORBFeatureDetector.
+
+        \section DET Detection
+        Features are detected in an image pyramid (see properties "pyramid.levels"
+        and "pyramid.scale factor"). In each level
+        - FAST-9 corners are detected: a pixel is a corner, if at least 9 contiguous
+          pixels of the 16 pixel Bresenham circle of radius 3 are all brighter or
+          all darker than the center pixel (+/- "fast threshold"). If ICL is compiled
+          with SSE2 support, 16 pixels are tested at once against the 4 compass
+          points of the circle, and only the remaining candidates are tested
+          completely
+        - a 3x3 non-maximum suppression is applied on the FAST scores
+        - the remaining corners are ranked by their harris response (or by their
+          FAST score) and the best ones are kept. The "max features" are
+          distributed over the levels proportionally to the levels' areas. As in
+          OpenCV's ORB, the harris response is only computed for the twice as many
+          corners with the best FAST scores
+        - the orientation of each feature is computed by the intensity centroid
+          of its circular patch (radius 15)
+
+        \section DESC Descriptors
+        Each feature is described by a 256 bit rotated BRIEF descriptor. The
+        descriptor bits are comparisons of 5x5 box-filtered intensities (computed
+        using integral images) at fixed pseudo random point pairs that are
+        distributed normally in the 31x31 patch around the feature. The sampling
+        pattern is rotated in steps of 11.25 degrees according to the feature
+        orientation.
+
+        \section MATCH Matching
+        Descriptors are compared by their hamming distance, which is computed
+        using the hardware popcount instruction if available (i.e. if ICL was
+        compiled with -mpopcnt or -march=native), a SSSE3 nibble lookup table,
+        or a portable bit count. Matching can be performed
+        - by brute force: all feature pairs are compared, or
+        - using multi-probe LSH: the descriptors of the second set are hashed
+          into several hash tables, each using a different random subset of the
+          descriptor bits as key. For each query feature, only the features in
+          its own buckets, and in the buckets, whose keys differ in exactly one
+          bit, are compared.
+
+        By default, LSH is used if the second set contains at least
+        "matching.lsh min set size" features. Matches are only returned if their
+        distance is not larger than "matching.max distance" and if the best match
+        is sufficiently better than the second best one (see "matching.ratio").
+        If "matching.cross check" is set, only mutual best matches are returned
+        (see DescriptorMatcher::mutualFilter).
+
+        \section THREADS Multi-Threading
+        Both, detection and matching can be distributed to several threads
+        (property "number of threads"). The results do not depend on the number
+        of threads.
+    */
+    class ICLCV_API NativeORBFeatureDetector : public utils::Configurable{
+      struct Data;
+      Data *m_data;
+
+      public:
+      /// Default constructor
+      NativeORBFeatureDetector();
+
+      /// Destructor
+      ~NativeORBFeatureDetector();
+
+      /// single key point
+      struct KeyPoint{
+        utils::Point32f pos; //!< position (in input image coordinates)
+        float size;          //!< diameter of the descriptor patch (in input image coordinates)
+        float angle;         //!< orientation in radians
+        float response;      //!< harris or FAST score (depending on the "score type")
+        int level;           //!< pyramid level the key point was detected in
+      };
+
+      /// 256 bit binary descriptor
+      struct Descriptor{
+        icl64u bits[4]; //!< descriptor bits
+      };
+
+      /// Set of detected features
+      struct ICLCV_API FeatureSetClass : public utils::Uncopyable{
+        struct Impl;
+        Impl *impl;
+        FeatureSetClass();
+        ~FeatureSetClass();
+
+        /// returns the number of features
+        int getNumFeatures() const;
+
+        /// returns the key points
+        const std::vector<KeyPoint> &getKeyPoints() const;
+
+        /// returns the descriptors (one per key point)
+        const std::vector<Descriptor> &getDescriptors() const;
+
+        /// returns a visualization of the key points
+        utils::VisualizationDescription vis() const;
+      };
+
+      typedef utils::SmartPtr<FeatureSetClass> FeatureSet;
+
+      /// feature match (a is from the first and b from the second set)
+      struct Match{
+        utils::Point32f a,b;
+        float distance;
+      };
+
+      /// detects features in the given image (color images are converted to gray)
+      FeatureSet detect(const core::Img8u &image);
+
+      /// returns intermediate images ("input", "gray", or "level-i" for i-th pyramid level)
+      const core::ImgBase *getIntermediateImage(const std::string &id);
+
+      /// returns the best match in b for each feature in a (if accepted)
+      std::vector<Match> match(const FeatureSet &a, const FeatureSet &b);
+
+      /// returns the hamming distance of two descriptors
+      static int distance(const Descriptor &a, const Descriptor &b);
+    };
+  }
+}
@@ -0,0 +1,630 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLCV/src/ICLCV/NativeSurfLib.cpp                      **
+** Module : ICLCV                                                  **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#include <ICLCV/NativeSurfLib.h>
+#include <ICLCore/CCFunctions.h>
+#include <ICLFilter/IntegralImgOp.h>
+#include <ICLMath/FixedVector.h>
+#include <ICLUtils/MultiThreader.h>
+#include <ICLUtils/ClippedCast.h>
+#include <ICLUtils/SSEUtils.h>
+
+#include <cmath>
+#include <cstdlib>
+
+using namespace icl::utils;
+using namespace icl::core;
+using namespace icl::math;
+
+namespace icl{
+  namespace cv{
+    namespace nativesurf{
+
+      namespace{
+        /// same value as used by OpenSURF
+        const float pi = 3.14159f;
+
+        /// gaussian weights (sigma=2.5) for the orientation assignment (taken from OpenSURF)
+        const double gauss25 [7][7] = {
+          {0.02350693969273,0.01849121369071,0.01239503121241,0.00708015417522,0.00344628101733,0.00142945847484,0.00050524879060},
+          {0.02169964028389,0.01706954162243,0.01144205592615,0.00653580605408,0.00318131834134,0.00131955648461,0.00046640341759},
+          {0.01706954162243,0.01342737701584,0.00900063997939,0.00514124713667,0.00250251364222,0.00103799989504,0.00036688592278},
+          {0.01144205592615,0.00900063997939,0.00603330940534,0.00344628101733,0.00167748505986,0.00069579213743,0.00024593098864},
+          {0.00653580605408,0.00514124713667,0.00344628101733,0.00196854695367,0.00095819467066,0.00039744277546,0.00014047800980},
+          {0.00318131834134,0.00250251364222,0.00167748505986,0.00095819467066,0.00046640341759,0.00019345616757,0.00006837798818},
+          {0.00131955648461,0.00103799989504,0.00069579213743,0.00039744277546,0.00019345616757,0.00008024231247,0.00002836202103}
+        };
+
+        /// filter index map (octave x interval)
+        const int filter_map[5][4] = {{0,1,2,3}, {1,3,4,5}, {3,5,6,7}, {5,7,8,9}, {7,9,10,11}};
+
+        inline int fRound(float flt){
+          return (int)floor(flt+0.5f);
+        }
+
+        inline float gaussian(float x, float y, float sig){
+          return 1.0f/(2.0f*pi*sig*sig) * exp( -(x*x+y*y)/(2.0f*sig*sig));
+        }
+
+        float get_angle(float X, float Y){
+          if(X > 0 && Y >= 0) return atan(Y/X);
+          if(X < 0 && Y >= 0) return pi - atan(-Y/X);
+          if(X < 0 && Y < 0) return pi + atan(Y/X);
+          if(X > 0 && Y < 0) return 2*pi - atan(-Y/X);
+          return 0;
+        }
+
+        /// integral image access (with the border handling of OpenSURF)
+        struct Integral{
+          const float *data;
+          int w, h;
+
+          /// box sum (row/col is the top left pixel, the result is clipped at 0)
+          inline float box(int row, int col, int rows, int cols) const{
+            const int r1 = iclMin(row, h) - 1;
+            const int c1 = iclMin(col, w) - 1;
+            const int r2 = iclMin(row + rows, h) - 1;
+            const int c2 = iclMin(col + cols, w) - 1;
+            float A(0.0f), B(0.0f), C(0.0f), D(0.0f);
+            if (r1 >= 0 && c1 >= 0) A = data[r1 * w + c1];
+            if (r1 >= 0 && c2 >= 0) B = data[r1 * w + c2];
+            if (r2 >= 0 && c1 >= 0) C = data[r2 * w + c1];
+            if (r2 >= 0 && c2 >= 0) D = data[r2 * w + c2];
+            return iclMax(0.f, A - B - C + D);
+          }
+
+          /// box sum without border checks
+          inline float box_inside(int row, int col, int rows, int cols) const{
+            const float *a = data + (row-1)*w + col - 1;
+            const float *b = a + rows*w;
+            return iclMax(0.f, a[0] - a[cols] - b[0] + b[cols]);
+          }
+
+          inline float haarX(int row, int column, int s) const{
+            return box(row-s/2, column, s, s/2) - box(row-s/2, column-s/2, s, s/2);
+          }
+
+          inline float haarY(int row, int column, int s) const{
+            return box(row, column-s/2, s/2, s) - box(row-s/2, column-s/2, s/2, s);
+          }
+
+          /// computes the haar wavelet responses of size s at n positions
+          void haar(const int *rows, const int *cols, int n, int s, float *rx, float *ry) const{
+            int i = 0;
+#ifdef ICL_HAVE_SSE2
+            if(!(s&1)){
+              // all 8 box integrals share the corners of a 3x3 grid
+              const int s2 = s/2;
+              const __m128 zero = _mm_setzero_ps();
+              for(; i+3 < n; i+=4){
+                bool inside = true;
+                for(int k=0;k<4;++k){
+                  inside &= (rows[i+k]-s2-1 >= 0) & (cols[i+k]-s2-1 >= 0) &
+                            (rows[i+k]+s2-1 < h) & (cols[i+k]+s2-1 < w);
+                }
+                if(!inside){
+                  for(int k=i;k<i+4;++k){
+                    rx[k] = haarX(rows[k],cols[k],s);
+                    ry[k] = haarY(rows[k],cols[k],s);
+                  }
+                  continue;
+                }
+                float tl[4], tc[4], tr[4], ml[4], mr[4], bl[4], bc[4], br[4];
+                for(int k=0;k<4;++k){
+                  const float *t = data + (rows[i+k]-s2-1)*w + cols[i+k];
+                  const float *m = t + s2*w;
+                  const float *b = m + s2*w;
+                  tl[k] = t[-s2-1]; tc[k] = t[-1]; tr[k] = t[s2-1];
+                  ml[k] = m[-s2-1]; mr[k] = m[s2-1];
+                  bl[k] = b[-s2-1]; bc[k] = b[-1]; br[k] = b[s2-1];
+                }
+                const __m128 TL = _mm_loadu_ps(tl), TC = _mm_loadu_ps(tc), TR = _mm_loadu_ps(tr);
+                const __m128 ML = _mm_loadu_ps(ml), MR = _mm_loadu_ps(mr);
+                const __m128 BL = _mm_loadu_ps(bl), BC = _mm_loadu_ps(bc), BR = _mm_loadu_ps(br);
+                
+                // same operation order as in box to get identical results
+                __m128 a = _mm_max_ps(zero,_mm_add_ps(_mm_sub_ps(_mm_sub_ps(TC,TR),BC),BR));
+                __m128 b = _mm_max_ps(zero,_mm_add_ps(_mm_sub_ps(_mm_sub_ps(TL,TC),BL),BC));
+                _mm_storeu_ps(rx+i,_mm_sub_ps(a,b));
+                
+                a = _mm_max_ps(zero,_mm_add_ps(_mm_sub_ps(_mm_sub_ps(ML,MR),BL),BR));
+                b = _mm_max_ps(zero,_mm_add_ps(_mm_sub_ps(_mm_sub_ps(TL,TR),ML),MR));
+                _mm_storeu_ps(ry+i,_mm_sub_ps(a,b));
+              }
+            }
+#endif
+            for(; i<n; ++i){
+              rx[i] = haarX(rows[i],cols[i],s);
+              ry[i] = haarY(rows[i],cols[i],s);
+            }
+          }
+        };
+
+        /// determinant of hessian responses of a single filter size
+        struct ResponseLayer{
+          int width, height, step, filter;
+          std::vector<float> responses;
+          std::vector<icl8u> laplacian;
+
+          void init(int width, int height, int step, int filter){
+            this->width = width;
+            this->height = height;
+            this->step = step;
+            this->filter = filter;
+            responses.resize(width*height);
+            laplacian.resize(width*height);
+          }
+
+          inline float getResponse(int row, int column) const{
+            return responses[row * width + column];
+          }
+
+          /// response at the coordinates of the (sparser) layer src
+          inline float getResponse(int row, int column, const ResponseLayer &src) const{
+            const int scale = width / src.width;
+            return responses[(scale * row) * width + (scale * column)];
+          }
+
+          inline icl8u getLaplacian(int row, int column, const ResponseLayer &src) const{
+            const int scale = width / src.width;
+            return laplacian[(scale * row) * width + (scale * column)];
+          }
+
+          /// computes the rows [r0,r1)
+          void build(const Integral &I, int r0, int r1){
+            const int b = (filter - 1) / 2 + 1;         // border for this filter
+            const int l = filter / 3;                   // lobe for this filter (filter size / 3)
+            const int w = filter;                       // filter size
+            const float inverse_area = 1.f/(w*w*255.f); // normalisation (image values in [0,1])
+            
+            for(int ar = r0; ar < r1; ++ar){
+              const int r = ar * step;
+              const bool rowInside = r-b-1 >= 0 && r+b-2 < I.h;
+              float *res = &responses[ar*width];
+              icl8u *lap = &laplacian[ar*width];
+              for(int ac = 0; ac < width; ++ac){
+                const int c = ac * step; 
+                float Dxx, Dyy, Dxy;
+                if(rowInside && c-b-1 >= 0 && c+b-2 < I.w){
+                  Dxx = I.box_inside(r - l + 1, c - b, 2*l - 1, w)
+                      - I.box_inside(r - l + 1, c - l / 2, 2*l - 1, l)*3;
+                  Dyy = I.box_inside(r - b, c - l + 1, w, 2*l - 1)
+                      - I.box_inside(r - l / 2, c - l + 1, l, 2*l - 1)*3;
+                  Dxy = + I.box_inside(r - l, c + 1, l, l)
+                        + I.box_inside(r + 1, c - l, l, l)
+                        - I.box_inside(r - l, c - l, l, l)
+                        - I.box_inside(r + 1, c + 1, l, l);
+                }else{
+                  Dxx = I.box(r - l + 1, c - b, 2*l - 1, w)
+                      - I.box(r - l + 1, c - l / 2, 2*l - 1, l)*3;
+                  Dyy = I.box(r - b, c - l + 1, w, 2*l - 1)
+                      - I.box(r - l / 2, c - l + 1, l, 2*l - 1)*3;
+                  Dxy = + I.box(r - l, c + 1, l, l)
+                        + I.box(r + 1, c - l, l, l)
+                        - I.box(r - l, c - l, l, l)
+                        - I.box(r + 1, c + 1, l, l);
+                }
+                Dxx *= inverse_area;
+                Dyy *= inverse_area;
+                Dxy *= inverse_area;
+                
+                res[ac] = (Dxx * Dyy - 0.81f * Dxy * Dxy);
+                lap[ac] = (Dxx + Dyy >= 0 ? 1 : 0);
+              }
+            }
+          }
+        };
+
+        /// non maximum suppression in the 3x3x3 neighbourhood
+        bool is_extremum(int r, int c, const ResponseLayer &t, const ResponseLayer &m, 
+                         const ResponseLayer &b, float thresh){
+          const int layerBorder = (t.filter + 1) / (2 * t.step);
+          if (r <= layerBorder || r >= t.height - layerBorder || 
+              c <= layerBorder || c >= t.width - layerBorder){
+            return false;
+          }
+          const float candidate = m.getResponse(r, c, t);
+          if (candidate < thresh) return false;
+
+          for (int rr = -1; rr <=1; ++rr){
+            for (int cc = -1; cc <=1; ++cc){
+              if (t.getResponse(r+rr, c+cc) >= candidate ||
+                  ((rr != 0 && cc != 0) && m.getResponse(r+rr, c+cc, t) >= candidate) ||
+                  b.getResponse(r+rr, c+cc, t) >= candidate){
+                return false;
+              }
+            }
+          }
+          return true;
+        }
+
+        /// interpolates the extremum to sub-pixel and sub-scale accuracy
+        void interpolate_extremum(int r, int c, const ResponseLayer &t, const ResponseLayer &m, 
+                                  const ResponseLayer &b, std::vector<SurfFeature> &dst){
+          const int filterStep = (m.filter - b.filter);
+          const double v = m.getResponse(r, c, t);
+
+          const FixedColVector<double,3> dD((m.getResponse(r, c + 1, t) - m.getResponse(r, c - 1, t)) / 2.0,
+                                            (m.getResponse(r + 1, c, t) - m.getResponse(r - 1, c, t)) / 2.0,
+                                            (t.getResponse(r, c) - b.getResponse(r, c, t)) / 2.0);
+
+          const double dxx = m.getResponse(r, c + 1, t) + m.getResponse(r, c - 1, t) - 2 * v;
+          const double dyy = m.getResponse(r + 1, c, t) + m.getResponse(r - 1, c, t) - 2 * v;
+          const double dss = t.getResponse(r, c) + b.getResponse(r, c, t) - 2 * v;
+          const double dxy = ( m.getResponse(r + 1, c + 1, t) - m.getResponse(r + 1, c - 1, t) - 
+                               m.getResponse(r - 1, c + 1, t) + m.getResponse(r - 1, c - 1, t) ) / 4.0;
+          const double dxs = ( t.getResponse(r, c + 1) - t.getResponse(r, c - 1) - 
+                               b.getResponse(r, c + 1, t) + b.getResponse(r, c - 1, t) ) / 4.0;
+          const double dys = ( t.getResponse(r + 1, c) - t.getResponse(r - 1, c) - 
+                               b.getResponse(r + 1, c, t) + b.getResponse(r - 1, c, t) ) / 4.0;
+
+          const FixedMatrix<double,3,3> H(dxx, dxy, dxs,
+                                          dxy, dyy, dys,
+                                          dxs, dys, dss);
+          FixedColVector<double,3> x;
+          try{
+            x = H.inv() * dD;
+          }catch(ICLException &){
+            return; // singular hessian: no stable extremum
+          }
+          const double xc = -x[0], xr = -x[1], xi = -x[2];
+        
+          if( fabs( xi ) < 0.5f  &&  fabs( xr ) < 0.5f  &&  fabs( xc ) < 0.5f ){
+            SurfFeature f;
+            f.x = static_cast<float>((c + xc) * t.step);
+            f.y = static_cast<float>((r + xr) * t.step);
+            f.scale = static_cast<float>((0.1333f) * (m.filter + xi * filterStep));
+            f.orientation = 0;
+            f.laplacian = static_cast<int>(m.getLaplacian(r,c,t));
+            f.clusterIndex = 0;
+            f.dx = f.dy = 0;
+            dst.push_back(f);
+          }
+        }
+
+        /// assigns the dominant orientation
+        void get_orientation(const Integral &I, SurfFeature &f){
+          const int s = fRound(f.scale), r = fRound(f.y), c = fRound(f.x);
+          static const int id[] = {6,5,4,3,2,1,0,1,2,3,4,5,6};
+          static const int N = 109;
+          int rows[N], cols[N];
+          float gauss[N], resX[N], resY[N], Ang[N];
+
+          int idx = 0;
+          for(int i = -6; i <= 6; ++i){
+            for(int j = -6; j <= 6; ++j){
+              if(i*i + j*j < 36){
+                gauss[idx] = static_cast<float>(gauss25[id[i+6]][id[j+6]]);
+                rows[idx] = r+j*s;
+                cols[idx] = c+i*s;
+                ++idx;
+              }
+            }
+          }
+          I.haar(rows,cols,N,4*s,resX,resY);
+          for(int k=0;k<N;++k){
+            resX[k] *= gauss[k];
+            resY[k] *= gauss[k];
+            Ang[k] = get_angle(resX[k], resY[k]);
+          }
+
+          // slide a pi/3 window around the feature point
+          float max = 0.f, orientation = 0.f;
+          for(float ang1 = 0; ang1 < 2*pi;  ang1+=0.15f) {
+            const float ang2 = ( ang1+pi/3.0f > 2*pi ? ang1-5.0f*pi/3.0f : ang1+pi/3.0f);
+            float sumX = 0.f, sumY = 0.f; 
+            for(int k = 0; k < N; ++k){
+              const float &ang = Ang[k];
+              if ((ang1 < ang2 && ang1 < ang && ang < ang2) ||
+                  (ang2 < ang1 && ((ang > 0 && ang < ang2) || (ang > ang1 && ang < 2*pi)))){
+                sumX += resX[k];  
+                sumY += resY[k];
+              }
+            }
+            if (sumX*sumX + sumY*sumY > max){
+              max = sumX*sumX + sumY*sumY;
+              orientation = get_angle(sumX, sumY);
+            }
+          }
+          f.orientation = orientation;
+        }
+
+        /// computes the 64-dimensional descriptor (see Agrawal ECCV 08)
+        /** ex is used as buffer for the separated gaussian weights */
+        void get_descriptor(const Integral &I, SurfFeature &f, bool upright, std::vector<float> &ex){
+          const float scale = f.scale;
+          const int x = fRound(f.x), y = fRound(f.y), s = 2*fRound(scale);
+          const float co = upright ? 1 : cos(f.orientation);
+          const float si = upright ? 0 : sin(f.orientation);
+          float *desc = f.descriptor;
+          float len = 0.f;
+          float cx = -0.5f, cy = 0.f; // sub-region centers for the 4x4 gaussian weighting
+          int count = 0;
+
+          int rows[81], cols[81];
+          float gauss[81], rx[81], ry[81];
+
+          // the gaussian weights are separated, which saves most exp-calls; sample 
+          // points are less than 5*sqrt(2)*scale (+rounding) away from their sub-region center
+          const float sig = 2.5f*scale, norm = 1.0f/(2.0f*pi*sig*sig);
+          const int maxOffset = (int)(7.1f*scale) + 2;
+          ex.resize(maxOffset+1);
+          for(int k=0;k<=maxOffset;++k){
+            ex[k] = exp( -(k*k)/(2.0f*sig*sig));
+          }
+
+          for(int i = -12; i < 8; i += 5){
+            cx += 1.f;
+            cy = -0.5f;
+            for(int j = -12; j < 8; j += 5){
+              cy += 1.f;
+              const int ix = i + 5, jx = j + 5;
+              const int xs = fRound(x + ( -jx*scale*si + ix*scale*co));
+              const int ys = fRound(y + ( jx*scale*co + ix*scale*si));
+              
+              int n = 0;
+              for (int k = i; k < i + 9; ++k){
+                for (int l = j; l < j + 9; ++l, ++n){
+                  // coordinates of sample point on the rotated axis
+                  cols[n] = fRound(x + (-l*scale*si + k*scale*co));
+                  rows[n] = fRound(y + ( l*scale*co + k*scale*si));
+                  gauss[n] = norm * ex[std::abs(xs-cols[n])] * ex[std::abs(ys-rows[n])];
+                }
+              }
+              I.haar(rows,cols,81,s,rx,ry);
+
+              float dx = 0.f, dy = 0.f, mdx = 0.f, mdy = 0.f;
+              for(int k=0;k<81;++k){
+                // gaussian weighted responses on the rotated axis
+                const float rrx = gauss[k]*(-rx[k]*si + ry[k]*co);
+                const float rry = gauss[k]*(rx[k]*co + ry[k]*si);
+                dx += rrx;
+                dy += rry;
+                mdx += fabs(rrx);
+                mdy += fabs(rry);
+              }
+              
+              const float gauss_s2 = gaussian(cx-2.0f,cy-2.0f,1.5f);
+              desc[count++] = dx*gauss_s2;
+              desc[count++] = dy*gauss_s2;
+              desc[count++] = mdx*gauss_s2;
+              desc[count++] = mdy*gauss_s2;
+              len += (dx*dx + dy*dy + mdx*mdx + mdy*mdy) * gauss_s2*gauss_s2;
+            }
+          }
+          
+          len = sqrt(len);
+          if(len > 0){
+            for(int i = 0; i < 64; ++i) desc[i] /= len;
+          }
+        }
+      }
+
+      struct Surf::Data{
+        int octaves;
+        int sampleStep;
+        float threshold;
+        bool upright;
+        int numThreads;
+
+        Img32f grayBuffer;
+        filter::IntegralImgOp integralOp;
+        ImgBase *integralImage;
+        Integral integral;
+
+        std::vector<ResponseLayer> layers;
+        int usedOctaves;
+        std::vector<SurfFeature> features;
+
+        /// work package for each thread
+        struct Work : public MultiThreader::Work{
+          enum Stage { Responses, Extrema, Descriptors };
+          Stage stage;
+          Data *data;
+          int index, n;
+          std::vector<std::vector<SurfFeature> > found; //!< features for each interval
+          
+          virtual void perform(){
+            switch(stage){
+              case Responses: data->buildResponses(index,n); break;
+              case Extrema: data->findExtrema(index,n,found); break;
+              case Descriptors: data->describe(index,n); break;
+            }
+          }
+        };
+        
+        MultiThreader mt;
+        std::vector<Work> works;
+
+        Data():grayBuffer(Size::null,formatGray),integralOp(depth32f),integralImage(0){}
+
+        ~Data(){
+          ICL_DELETE(integralImage);
+        }
+
+        void run(Work::Stage stage){
+          if(works.size() == 1){
+            works[0].stage = stage;
+            works[0].perform();
+            return;
+          }
+          MultiThreader::WorkSet ws(works.size());
+          for(unsigned int i=0;i<works.size();++i){
+            works[i].stage = stage;
+            ws[i] = &works[i];
+          }
+          mt(ws);
+        }
+
+        void createLayers(int width, int height){
+          static const int filters[12] = { 9, 15, 21, 27, 39, 51, 75, 99, 147, 195, 291, 387 };
+          const int w = width / sampleStep, h = height / sampleStep;
+          
+          // octaves, whose layers would be empty, are skipped
+          usedOctaves = octaves;
+          while(usedOctaves > 0 && ((w >> (usedOctaves-1)) == 0 || (h >> (usedOctaves-1)) == 0)){
+            --usedOctaves;
+          }
+          layers.resize(usedOctaves ? 2 + 2*usedOctaves : 0);
+          for(unsigned int i=0;i<layers.size();++i){
+            const int o = i < 4 ? 0 : (i-2)/2;
+            layers[i].init(w >> o, h >> o, sampleStep << o, filters[i]);
+          }
+        }
+
+        void buildResponses(int index, int n){
+          for(unsigned int i=0;i<layers.size();++i){
+            ResponseLayer &l = layers[i];
+            l.build(integral, (index*l.height)/n, ((index+1)*l.height)/n);
+          }
+        }
+
+        void findExtrema(int index, int n, std::vector<std::vector<SurfFeature> > &found){
+          found.resize(2*usedOctaves);
+          for (int o = 0; o < usedOctaves; ++o){
+            for (int i = 0; i <= 1; ++i){
+              const ResponseLayer &b = layers[filter_map[o][i]];
+              const ResponseLayer &m = layers[filter_map[o][i+1]];
+              const ResponseLayer &t = layers[filter_map[o][i+2]];
+              std::vector<SurfFeature> &dst = found[2*o+i];
+              dst.clear();
+              // loop over middle response layer at density of the most 
+              // sparse layer (always top), to find maxima across scale and space
+              const int r0 = (index*t.height)/n, r1 = ((index+1)*t.height)/n;
+              for (int r = r0; r < r1; ++r){
+                for (int c = 0; c < t.width; ++c){
+                  if (is_extremum(r, c, t, m, b, threshold)){
+                    interpolate_extremum(r, c, t, m, b, dst);
+                  }
+                }
+              }
+            }
+          }
+        }
+        
+        void describe(int index, int n){
+          const int N = (int)features.size();
+          std::vector<float> ex;
+          for(int i=(index*N)/n; i<((index+1)*N)/n; ++i){
+            if(!upright) get_orientation(integral, features[i]);
+            get_descriptor(integral, features[i], upright, ex);
+          }
+        }
+      };
+
+      Surf::Surf(int octaves, int intervals, int sampleStep, float threshold):m_data(new Data){
+        m_data->upright = false;
+        m_data->numThreads = 1;
+        setOctaves(octaves);
+        setIntervals(intervals);
+        setSampleStep(sampleStep);
+        setThreshold(threshold);
+      }
+
+      Surf::~Surf(){
+        delete m_data;
+      }
+
+      void Surf::setOctaves(int octaves){
+        m_data->octaves = clip(octaves,1,5);
+      }
+        
+      void Surf::setIntervals(int intervals){
+        (void)intervals;
+      }
+
+      void Surf::setSampleStep(int sampleStep){
+        m_data->sampleStep = clip(sampleStep,1,6);
+      }
+
+      void Surf::setThreshold(float threshold){
+        m_data->threshold = iclMax(0.f,threshold);
+      }
+
+      void Surf::setUpright(bool upright){
+        m_data->upright = upright;
+      }
+        
+      void Surf::setNumThreads(int numThreads){
+        m_data->numThreads = iclMax(1,numThreads);
+      }
+
+      int Surf::getNumThreads() const{
+        return m_data->numThreads;
+      }
+
+      const std::vector<SurfFeature> &Surf::detect(const ImgBase *image){
+        ICLASSERT_THROW(image,ICLException("nativesurf::Surf::detect: given image was null"));
+        Data &d = *m_data;
+        d.features.clear();
+        
+        const ImgBase *gray = image;
+        if(image->getChannels() != 1){
+          cc(image,&d.grayBuffer);
+          gray = &d.grayBuffer;
+        }
+        d.integralOp.apply(gray,&d.integralImage);
+        const Img32f &ii = *d.integralImage->as32f();
+        d.integral.data = ii.begin(0);
+        d.integral.w = ii.getWidth();
+        d.integral.h = ii.getHeight();
+
+        d.createLayers(ii.getWidth(), ii.getHeight());
+        if(!d.layers.size()) return d.features;
+
+        const int n = d.numThreads;
+        if(n > 1 && (d.mt.isNull() || d.mt.getNumThreads() != n)){
+          d.mt = MultiThreader(n);
+        }
+        d.works.resize(n);
+        for(int i=0;i<n;++i){
+          d.works[i].data = &d;
+          d.works[i].index = i;
+          d.works[i].n = n;
+        }
+        
+        d.run(Data::Work::Responses);
+        d.run(Data::Work::Extrema);
+
+        // keep the sequential order: intervals first, then threads (i.e. rows)
+        for(int i=0;i<2*d.usedOctaves;++i){
+          for(int j=0;j<n;++j){
+            const std::vector<SurfFeature> &f = d.works[j].found[i];
+            d.features.insert(d.features.end(),f.begin(),f.end());
+          }
+        }
+
+        d.run(Data::Work::Descriptors);
+        return d.features;
+      }
+
+    } // namespace nativesurf
+  } // namespace cv
+}
@@ -0,0 +1,117 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLCV/src/ICLCV/NativeSurfLib.h                        **
+** Module : ICLCV                                                  **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#pragma once
+
+#include <ICLUtils/CompatMacros.h>
+#include <ICLUtils/Uncopyable.h>
+#include <ICLCore/Img.h>
+#include <ICLCV/SurfFeature.h>
+#include <vector>
+
+namespace icl{
+  namespace cv{
+    namespace nativesurf{
+
+      /// Native SURF feature detector and descriptor 
+      /** This is a re-implementation of the OpenSURF algorithm (see OpenSurfLib.h)
+          that works directly on ICL images. In contrast to the OpenSurf
+          backend, it has neither an OpenCV nor an OpenCL dependency and it
+          is therefore always available.
+
+          \section ALG Algorithm
+          The implementation follows the OpenSURF library, so that the resulting
+          SurfFeature instances are compatible with the ones of the other backends:
+          - the integral image is created using the filter::IntegralImgOp
+          - the determinant of hessian responses are computed for 4 filters in the
+            first octave and for 2 additional filters in each further octave
+            (filter sizes 9,15,21,27 | 39,51 | 75,99 | 147,195 | 291,387)
+          - local maxima in the 3x3x3 scale-space neighbourhood are interpolated
+            to sub-pixel and sub-scale accuracy
+          - each feature is assigned a dominant orientation (using a sliding
+            window over the gaussian-weighted haar wavelet responses), unless
+            the upright mode is used
+          - a 64-dimensional descriptor is computed from haar wavelet responses
+            in 4x4 sub-regions (modified descriptor, see Agrawal ECCV 08)
+          
+          As in OpenSURF, the number of intervals is fixed to 4 and the given
+          value is ignored. The number of octaves is restricted to [1,5]
+
+          \section PERF Performance
+          The response layers, the extrema detection and the descriptor
+          computation are distributed to several threads (see Surf::setNumThreads).
+          The result does not depend on the number of threads.
+          If SSE2 is available, the haar wavelet responses, that dominate the 
+          descriptor computation, are computed for 4 sample points at once. The
+          ICLCV example surf-benchmark compares the throughput to the OpenSurf
+          backend.
+      */
+      class ICLCV_API Surf : public utils::Uncopyable{
+        struct Data;  //!< hidden implementation
+        Data *m_data; //!< hidden data pointer
+
+        public:
+        
+        /// creates a new instance with given parameters
+        Surf(int octaves=5, int intervals=4, int sampleStep=2, float threshold=0.0004f);
+
+        /// Destructor
+        ~Surf();
+
+        /// sets the number of octaves
+        void setOctaves(int octaves);
+        
+        /// sets the number of intervals (ignored)
+        void setIntervals(int intervals);
+
+        /// sets the initial sample step
+        void setSampleStep(int sampleStep);
+
+        /// sets the hessian response threshold
+        void setThreshold(float threshold);
+        
+        /// sets whether upright (i.e. not rotation invariant) descriptors are used
+        void setUpright(bool upright);
+
+        /// sets the number of threads that are used
+        void setNumThreads(int numThreads);
+
+        /// returns the number of threads
+        int getNumThreads() const;
+
+        /// detects and describes SURF features in the given image
+        /** Color images are converted to gray internally. The range of the image
+            values is assumed to be [0,255] */
+        const std::vector<SurfFeature> &detect(const core::ImgBase *image);
+      };
+
+    } // namespace nativesurf
+  } // namespace cv
+}
@@ -45,6 +45,7 @@
 
 
 #include <ICLCV/OpenSurfLib.h>
+#include <ICLCV/DescriptorMatcher.h>
 
 #include <iostream>
 #include <fstream>
@@ -550,39 +551,23 @@ namespace icl{
       //! Populate IpPairVec with matched ipts 
       void getMatches(IpVec &ipts1, IpVec &ipts2, IpPairVec &matches)
       {
-        float dist, d1, d2;
-        Ipoint *match = 0;
-
         matches.clear();
+        if(!ipts1.size() || !ipts2.size()) return;
 
-        for(unsigned int i = 0; i < ipts1.size(); i++) 
-          {
-            d1 = d2 = FLT_MAX;
-
-            for(unsigned int j = 0; j < ipts2.size(); j++) 
-              {
-                dist = ipts1[i] - ipts2[j];  
-
-                if(dist<d1) // if this feature matches better than current best
-                  {
-                    d2 = d1;
-                    d1 = dist;
-                    match = &ipts2[j];
-                  }
-                else if(dist<d2) // this feature matches better than second best
-                  {
-                    d2 = dist;
-                  }
-              }
+        // If match has a d1:d2 ratio < 0.65 ipoints are a match
+        DescriptorMatcher matcher;
+        matcher.setTrainDescriptors(ipts2);
+        std::vector<DescriptorMatcher::Match> ms;
+        matcher.match(ipts1,ms,0.65f);
 
-            // If match has a d1:d2 ratio < 0.65 ipoints are a match
-            if(d1/d2 < 0.65) 
-              { 
-                // Store the change in position
-                ipts1[i].dx = match->x - ipts1[i].x;
-                ipts1[i].dy = match->y - ipts1[i].y;
-                matches.push_back(std::make_pair(ipts1[i], *match));
-              }
+        for(unsigned int i = 0; i < ms.size(); i++) 
+          {
+            Ipoint &a = ipts1[ms[i].query];
+            const Ipoint &match = ipts2[ms[i].train];
+            // Store the change in position
+            a.dx = match.x - a.x;
+            a.dy = match.y - a.y;
+            matches.push_back(std::make_pair(a, match));
           }
       }
 
@@ -31,6 +31,7 @@
 #include <ICLCV/PositionTracker.h>
 #include <ICLCV/Extrapolator.h>
 #include <ICLCV/HungarianAlgorithm.h>
+#include <ICLCV/JonkerVolgenantAlgorithm.h>
 #include <cmath>
 #include <set>
 #include <limits>
@@ -205,6 +206,47 @@ namespace icl{
   
     // }}}
     
+    template<class valueType>
+    vector<int> compute_assignment(const vector<valueType> pred[2], int numPred,
+                                   const vector<valueType> newData[2], int numNew,
+                                   icl::cv::AssignmentMode mode, float gateRadius){
+      // {{{ open
+      if(mode == hungarianAssignment){
+        Array2D<valueType> distMat = createDistMat( pred , newData );
+        return HungarianAlgorithm<valueType>::apply(distMat);
+      }
+      // only pairs of real entries (no blind values) within the gating radius are regarded
+      // (the costs are not rounded to integers as in createDistMat, which avoids ambiguities)
+      typedef JonkerVolgenantAlgorithm<float> JV;
+      vector<Point32f> ps(numPred), ns(numNew);
+      for(int i=0;i<numPred;++i) ps[i] = Point32f(pred[X][i],pred[Y][i]);
+      for(int i=0;i<numNew;++i) ns[i] = Point32f(newData[X][i],newData[Y][i]);
+      vector<JV::Entry> entries;
+      JV::gate(ns,ps,gateRadius,entries);
+      for(unsigned int i=0;i<entries.size();++i){
+        entries[i].cost = ::sqrt(::sqrt(entries[i].cost));
+      }
+      // a pair at the gating radius is as good as leaving both unassigned
+      const float costOfNonAssignment = ::sqrt(gateRadius)/2;
+      vector<int> rowAssignment, colAssignment;
+      JV::solve(numNew,numPred,entries,costOfNonAssignment,rowAssignment,colAssignment);
+
+      // objects without partner within the gating radius are paired at minimum costs (as
+      // the dense version would do); usually, only very few of these are left
+      vector<int> rows, cols;
+      JV::getUnassigned(rowAssignment,colAssignment,rows,cols);
+      Array2D<float> leftoverCosts(rows.size(),cols.size());
+      for(unsigned int i=0;i<rows.size();++i){
+        for(unsigned int j=0;j<cols.size();++j){
+          const float dx = ns[rows[i]].x - ps[cols[j]].x, dy = ns[rows[i]].y - ps[cols[j]].y;
+          leftoverCosts(i,j) = ::sqrt(::sqrt(dx*dx + dy*dy));
+        }
+      }
+      return JV::toSquareAssignment(rowAssignment,colAssignment,leftoverCosts);
+    }
+
+    // }}}
+
     template<class valueType>
     inline vector<valueType> predict(int dim, std::deque<std::vector<valueType> > &data, const vector<int> &good){
       // {{{ open
@@ -280,15 +322,15 @@ namespace icl{
                                     std::deque<vector<valueType> > data[2], 
                                     vector<int>               &assignment,  
                                     vector<valueType>         newData[2],
-                                    vector<int>               &good){
+                                    vector<int>               &good,
+                                    icl::cv::AssignmentMode   mode,
+                                    float                     gateRadius){
       
       // {{{ open
   
       vector<valueType> pred[2] = { predict(dim,data[X],good), predict(dim,data[Y],good) };
       
-      Array2D<valueType> distMat = createDistMat( pred , newData );
-      
-      assignment = HungarianAlgorithm<valueType>::apply(distMat);
+      assignment = compute_assignment(pred, dim, newData, dim, mode, gateRadius);
       
       push_and_rearrange_data(dim, data, assignment, newData);
       
@@ -377,7 +419,9 @@ namespace icl{
                                    vector<int>               &ids, 
                                    vector<int>               &assignment,  
                                    vector<valueType>         newData[2],
-                                   vector<int>               &good){
+                                   vector<int>               &good,
+                                   icl::cv::AssignmentMode   mode,
+                                   float                     gateRadius){
       // {{{ open
   
       // new data contains less points -> enlarge new new data
@@ -388,9 +432,7 @@ namespace icl{
       int dim = data[X][0].size();
       vector<valueType> pred[2] = { predict(dim,data[X],good), predict(dim,data[Y],good) };
       
-      Array2D<valueType> distMat = createDistMat( pred , newData );
-      
-      assignment = HungarianAlgorithm<valueType>::apply(distMat);
+      assignment = compute_assignment(pred, dim, newData, dim-DIFF, mode, gateRadius);
   
       push_and_rearrange_data(dim, data, assignment, newData);
       
@@ -421,7 +463,9 @@ namespace icl{
                                    vector<valueType>         newData[2],
                                    vector<int>               &good,
                                    icl::cv::IDAllocationMode iaMode,
-                                   int                       &lowestUnusedID){
+                                   int                       &lowestUnusedID,
+                                   icl::cv::AssignmentMode   mode,
+                                   float                     gateRadius){
       // {{{ open
   
       DIFF *= -1; // now positive
@@ -441,9 +485,7 @@ namespace icl{
       /// restore good
       good.resize(good.size()-DIFF);
       
-      Array2D<valueType> distMat = createDistMat( pred , newData );
-      
-      assignment = HungarianAlgorithm<valueType>::apply(distMat);
+      assignment = compute_assignment(pred, dim-DIFF, newData, dim, mode, gateRadius);
       
       /// <old>
       //vector<int> newDataCols;
@@ -520,17 +562,22 @@ namespace icl{
       const int DIFF = DATA_MATRIX_HEIGHT - NEW_DATA_DIMENSION;
   
       if(DIFF <  0){
-        push_data_intern_diff_ltz(DIFF,m_matData, m_vecIDs, m_vecCurrentAssignment, newData,m_vecGoodDataCount, m_IDAllocationMode, m_currentID);
+        push_data_intern_diff_ltz(DIFF,m_matData, m_vecIDs, m_vecCurrentAssignment, newData,m_vecGoodDataCount, m_IDAllocationMode, m_currentID,
+                                  m_assignmentMode, m_gateRadius);
       }else if(DIFF > 0){
-         push_data_intern_diff_gtz(DIFF,m_matData, m_vecIDs, m_vecCurrentAssignment, newData,m_vecGoodDataCount);
+         push_data_intern_diff_gtz(DIFF,m_matData, m_vecIDs, m_vecCurrentAssignment, newData,m_vecGoodDataCount,
+                                   m_assignmentMode, m_gateRadius);
       }else{
-         if(m_bTryOptimize && m_tThreshold > 0){
+         // the trivial assignment test is O(n^2), so it is not used with the sparse assignment
+         if(m_bTryOptimize && m_tThreshold > 0 && m_assignmentMode == hungarianAssignment){
           bool succ = push_data_first_optimized_try(DATA_MATRIX_HEIGHT,m_matData,m_vecCurrentAssignment,newData,m_vecGoodDataCount,m_tThreshold);
           if(!succ){
-            push_data_intern_diff_zero(DATA_MATRIX_HEIGHT,m_matData, m_vecCurrentAssignment, newData,m_vecGoodDataCount);
+            push_data_intern_diff_zero(DATA_MATRIX_HEIGHT,m_matData, m_vecCurrentAssignment, newData,m_vecGoodDataCount,
+                                       m_assignmentMode, m_gateRadius);
           }        
         }else{
-          push_data_intern_diff_zero(DATA_MATRIX_HEIGHT,m_matData, m_vecCurrentAssignment, newData,m_vecGoodDataCount);
+          push_data_intern_diff_zero(DATA_MATRIX_HEIGHT,m_matData, m_vecCurrentAssignment, newData,m_vecGoodDataCount,
+                                     m_assignmentMode, m_gateRadius);
         }
       }
     }
@@ -41,6 +41,12 @@ namespace icl{
       allocateFirstFreeIDs, // re-using old ID's
       allocateBrandNewIDs   // using next brand-new ID
     };
+
+    /// Which algorithm is used to solve the frame-to-frame assignment
+    enum AssignmentMode{
+      hungarianAssignment,            // dense cost matrix, HungarianAlgorithm (default)
+      sparseJonkerVolgenantAssignment // gated sparse cost matrix, JonkerVolgenantAlgorithm
+    };
   
     
     /// Class for tracking 2D positions 
@@ -237,6 +243,18 @@ namespace icl{
         nearest to more then one new center and if all minimum distances are below the given threshold, this trivial assignment is
         used. Otherwise the default algorithm is applied, and the optimization has no effect. <b>Note:</b> If the given threshold
         is smaller or equal to zero or the data dimension changes from on push call to another, no optimization is performed.
+
+        \section SPARSE Sparse Assignment
+        For large numbers of targets (e.g. swarm tracking with hundreds or thousands of targets), neither the O(n^2)
+        dense cost matrix nor the O(n^3) Hungarian algorithm can be afforded. Using setAssignmentMode, the tracker can
+        be set up to use the JonkerVolgenantAlgorithm instead. Here, a regular grid is created over the predicted
+        positions, so that the costs are only computed for pairs of predictions and new data points that are closer
+        than a given gating radius. All other pairs are not considered. If a prediction or a new data point does not
+        have any partner within the gating radius, it is treated like a disappeared or new object. If unmatched
+        predictions and unmatched new points exist at the same time, these are paired at minimum costs, as the dense
+        version would do (see JonkerVolgenantAlgorithm::toSquareAssignment). Since the sparse costs are not rounded
+        to integers, the result may still differ slightly from the dense version if costs are ambiguous.
+        The trivial assignment optimization (see \ref OPT_) is not used in this mode.
     */
   
     template<class valueType>
@@ -247,13 +265,15 @@ namespace icl{
       
   
       /// Empty default constructor without any optimization
-      PositionTracker():m_bTryOptimize(false),m_currentID(0),m_IDAllocationMode(allocateFirstFreeIDs),m_tThreshold(0){}
+      PositionTracker():m_bTryOptimize(false),m_currentID(0),m_IDAllocationMode(allocateFirstFreeIDs),m_tThreshold(0),
+                        m_assignmentMode(hungarianAssignment),m_gateRadius(50){}
   
       /// *NEW* constructor with optimization enabled and given theshold
       /** @param threshold threshold for optimization (must be > 0) \ref OPT_ */
       PositionTracker(valueType threshold):
         m_bTryOptimize(true),m_currentID(0),
-        m_IDAllocationMode(allocateFirstFreeIDs),m_tThreshold(threshold){}
+        m_IDAllocationMode(allocateFirstFreeIDs),m_tThreshold(threshold),
+        m_assignmentMode(hungarianAssignment),m_gateRadius(50){}
       
       /// most common function, adds a new data row, and causes all internal computation (see above)
       /** @param xys data vector with xyxy.. data order 
@@ -274,6 +294,15 @@ namespace icl{
         m_IDAllocationMode = mode;
       }
   
+      /// selects the algorithm for the frame-to-frame assignment (see \ref SPARSE)
+      /** @param mode assignment mode
+          @param gateRadius maximum distance between a predicted position and a new data
+                 point that is regarded by the sparse assignment (not used for hungarianAssignment) */
+      void setAssignmentMode(AssignmentMode mode, float gateRadius=50){
+        m_assignmentMode = mode;
+        m_gateRadius = gateRadius;
+      }
+
       /// returns the unique id of a just pushe data point (x,y)
       /** A problem occurs, if more than on point with coordinates (x,y) was 
           pushed, in this case, this function will return the first found one.
@@ -319,6 +348,12 @@ namespace icl{
   
       /// threshold distance
       valueType m_tThreshold;
+
+      /// current assignment algorithm
+      AssignmentMode m_assignmentMode;
+
+      /// gating radius for the sparse assignment
+      float m_gateRadius;
     };
     
     
@@ -0,0 +1,636 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLCV/src/ICLCV/PyramidalLKTracker.cpp                 **
+** Module : ICLCV                                                  **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#include <ICLCV/PyramidalLKTracker.h>
+#include <ICLCV/VectorTracker.h>
+#include <ICLCore/CCFunctions.h>
+#include <ICLUtils/MultiThreader.h>
+#include <ICLUtils/SSETypes.h>
+#include <ICLUtils/Macros.h>
+#include <ICLUtils/StringUtils.h>
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+
+namespace icl{
+  using namespace core;
+  using namespace utils;
+
+  namespace cv{
+
+    namespace{
+
+      /// fixed-point precision of the bilinear interpolation weights
+      static const int W_BITS = 14;
+
+      /// extra border pixels (in addition to the window radius)
+      /** The SSE2 sampling loops read up to 4 pixels beyond the window and points
+          are allowed to leave the image by some pixels before they are rejected */
+      static const int EXTRA_BORDER = 8;
+
+      /// pyramid level with replicated border and interleaved (dx,dy) gradients
+      struct Level{
+        int w,h,border,stride;
+        std::vector<icl8u> image;
+        std::vector<icl16s> grad;
+
+        inline const icl8u *pix(int x, int y) const {
+          return &image[(y+border)*stride + x + border];
+        }
+        inline icl8u *pix(int x, int y) {
+          return &image[(y+border)*stride + x + border];
+        }
+        inline const icl16s *gpix(int x, int y) const {
+          return &grad[2*((y+border)*stride + x + border)];
+        }
+        inline icl16s *gpix(int x, int y) {
+          return &grad[2*((y+border)*stride + x + border)];
+        }
+
+        void setup(int w, int h, int border){
+          this->w = w;
+          this->h = h;
+          this->border = border;
+          stride = w+2*border;
+          image.resize(stride*(h+2*border));
+          grad.assign(2*stride*(h+2*border),0);
+        }
+
+        /// returns whether a window of size ws with upper left corner (x,y) can be sampled
+        inline bool canSample(int x, int y, int ws) const {
+          return x >= -border && y >= -border && x+ws+5 <= w+border && y+ws+1 <= h+border;
+        }
+
+        void replicateBorder(){
+          for(int y=0;y<h;++y){
+            icl8u *r = pix(0,y);
+            std::fill(r-border,r,r[0]);
+            std::fill(r+w,r+w+border,r[w-1]);
+          }
+          for(int y=1;y<=border;++y){
+            std::copy(pix(-border,0),pix(-border,0)+stride,pix(-border,-y));
+            std::copy(pix(-border,h-1),pix(-border,h-1)+stride,pix(-border,h-1+y));
+          }
+        }
+
+        /// 5x5 gaussian (1 4 6 4 1) and 2:1 sub-sampling of the given level
+        void reduce(const Level &src, std::vector<int> &col){
+          const int xs = 2*w+3;
+          col.resize(xs);
+          for(int y=0;y<h;++y){
+            const icl8u *r0 = src.pix(-2,2*y-2), *r1 = r0+src.stride, *r2 = r1+src.stride;
+            const icl8u *r3 = r2+src.stride, *r4 = r3+src.stride;
+            for(int x=0;x<xs;++x){
+              col[x] = r0[x] + r4[x] + 4*(r1[x]+r3[x]) + 6*r2[x];
+            }
+            icl8u *d = pix(0,y);
+            for(int x=0;x<w;++x){
+              const int *c = &col[2*x];
+              d[x] = (c[0] + c[4] + 4*(c[1]+c[3]) + 6*c[2] + 128) >> 8;
+            }
+          }
+          replicateBorder();
+        }
+
+        /// computes the Scharr gradients (scaled by 32) of all but the outermost pixels
+        void computeGradients(){
+          const int x0 = -border+1, x1 = w+border-1;
+          for(int y=-border+1;y<h+border-1;++y){
+            const icl8u *a = pix(0,y-1), *b = pix(0,y), *c = pix(0,y+1);
+            icl16s *g = gpix(0,y);
+            int x = x0;
+#ifdef ICL_HAVE_SSE2
+            const __m128i z = _mm_setzero_si128();
+            const __m128i three = _mm_set1_epi16(3), ten = _mm_set1_epi16(10);
+            for(;x+8<=x1;x+=8){
+#define ICL_LOAD8(p) _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(p)),z)
+              const __m128i al = ICL_LOAD8(a+x-1), am = ICL_LOAD8(a+x), ar = ICL_LOAD8(a+x+1);
+              const __m128i bl = ICL_LOAD8(b+x-1), br = ICL_LOAD8(b+x+1);
+              const __m128i cl = ICL_LOAD8(c+x-1), cm = ICL_LOAD8(c+x), cr = ICL_LOAD8(c+x+1);
+#undef ICL_LOAD8
+              const __m128i dx = _mm_add_epi16(_mm_mullo_epi16(three,_mm_add_epi16(_mm_sub_epi16(ar,al),
+                                                                                   _mm_sub_epi16(cr,cl))),
+                                               _mm_mullo_epi16(ten,_mm_sub_epi16(br,bl)));
+              const __m128i dy = _mm_add_epi16(_mm_mullo_epi16(three,_mm_add_epi16(_mm_sub_epi16(cl,al),
+                                                                                   _mm_sub_epi16(cr,ar))),
+                                               _mm_mullo_epi16(ten,_mm_sub_epi16(cm,am)));
+              _mm_storeu_si128((__m128i*)(g+2*x),_mm_unpacklo_epi16(dx,dy));
+              _mm_storeu_si128((__m128i*)(g+2*x+8),_mm_unpackhi_epi16(dx,dy));
+            }
+#endif
+            for(;x<x1;++x){
+              g[2*x] = 3*((a[x+1]-a[x-1]) + (c[x+1]-c[x-1])) + 10*(b[x+1]-b[x-1]);
+              g[2*x+1] = 3*((c[x-1]-a[x-1]) + (c[x+1]-a[x+1])) + 10*(c[x]-a[x]);
+            }
+          }
+        }
+      };
+
+      /// image pyramid (including gradients)
+      struct Pyramid{
+        std::vector<Level> levels;
+        std::vector<int> buf;
+
+        void build(const Img8u &gray, int numLevels, int radius){
+          const int ws = 2*radius+1, border = radius+EXTRA_BORDER;
+          Size s = gray.getSize();
+          int n = 1;
+          while(n < numLevels && (s.width+1)/2 >= ws && (s.height+1)/2 >= ws){
+            s = Size((s.width+1)/2,(s.height+1)/2);
+            ++n;
+          }
+          levels.resize(n);
+          levels[0].setup(gray.getWidth(),gray.getHeight(),border);
+          const icl8u *src = gray.begin(0);
+          for(int y=0;y<gray.getHeight();++y){
+            std::copy(src+y*gray.getWidth(),src+(y+1)*gray.getWidth(),levels[0].pix(0,y));
+          }
+          levels[0].replicateBorder();
+          levels[0].computeGradients();
+          for(int l=1;l<n;++l){
+            const Level &p = levels[l-1];
+            levels[l].setup((p.w+1)/2,(p.h+1)/2,border);
+            levels[l].reduce(p,buf);
+            levels[l].computeGradients();
+          }
+        }
+
+        bool compatible(const Pyramid &o) const{
+          return levels.size() && levels.size() == o.levels.size() && levels[0].w == o.levels[0].w &&
+                 levels[0].h == o.levels[0].h && levels[0].border == o.levels[0].border;
+        }
+      };
+
+      /// per thread buffers for the sampled window of the previous image
+      struct Window{
+        std::vector<icl16s> I;  //!< intensities (scaled by 32)
+        std::vector<icl16s> dI; //!< interleaved gradients (scaled by 32)
+      };
+
+      /// tracking parameters
+      struct Params{
+        int radius, maxIterations;
+        float epsilon, minEigenValue, fbThreshold;
+      };
+
+      static inline void bilinear_weights(float ax, float ay, int w[4]){
+        const float s = 1<<W_BITS;
+        w[0] = (int)round((1.f-ax)*(1.f-ay)*s);
+        w[1] = (int)round(ax*(1.f-ay)*s);
+        w[2] = (int)round((1.f-ax)*ay*s);
+        w[3] = (1<<W_BITS) - w[0] - w[1] - w[2];
+      }
+
+      /// samples intensities and gradients of the window and returns the structure tensor
+      static void sample_window(const Level &L, int ix, int iy, int ws, const int wt[4],
+                                Window &win, float &A11, float &A12, float &A22){
+        A11 = A12 = A22 = 0;
+        win.I.resize(ws*ws);
+        win.dI.resize(2*ws*ws);
+#ifdef ICL_HAVE_SSE2
+        const __m128i z = _mm_setzero_si128();
+        const __m128i w01 = _mm_set_epi16(wt[1],wt[0],wt[1],wt[0],wt[1],wt[0],wt[1],wt[0]);
+        const __m128i w23 = _mm_set_epi16(wt[3],wt[2],wt[3],wt[2],wt[3],wt[2],wt[3],wt[2]);
+        const __m128i rnd5 = _mm_set1_epi32(1<<(W_BITS-6)), rnd = _mm_set1_epi32(1<<(W_BITS-1));
+        __m128 sq = _mm_setzero_ps(), xy = _mm_setzero_ps();
+#endif
+        for(int y=0;y<ws;++y){
+          const icl8u *s = L.pix(ix,iy+y), *s2 = s + L.stride;
+          const icl16s *g = L.gpix(ix,iy+y), *g2 = g + 2*L.stride;
+          icl16s *I = win.I.data() + y*ws, *dI = win.dI.data() + 2*y*ws;
+          int x = 0;
+#ifdef ICL_HAVE_SSE2
+          for(;x+4<=ws;x+=4){
+            const __m128i a0 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(s+x)),z);
+            const __m128i a1 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(s+x+1)),z);
+            const __m128i b0 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(s2+x)),z);
+            const __m128i b1 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(s2+x+1)),z);
+            __m128i v = _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(a0,a1),w01),
+                                      _mm_madd_epi16(_mm_unpacklo_epi16(b0,b1),w23));
+            v = _mm_srai_epi32(_mm_add_epi32(v,rnd5),W_BITS-5);
+            _mm_storel_epi64((__m128i*)(I+x),_mm_packs_epi32(v,v));
+
+            const __m128i g0 = _mm_loadu_si128((const __m128i*)(g+2*x));
+            const __m128i g1 = _mm_loadu_si128((const __m128i*)(g+2*x+2));
+            const __m128i h0 = _mm_loadu_si128((const __m128i*)(g2+2*x));
+            const __m128i h1 = _mm_loadu_si128((const __m128i*)(g2+2*x+2));
+            __m128i lo = _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(g0,g1),w01),
+                                       _mm_madd_epi16(_mm_unpacklo_epi16(h0,h1),w23));
+            __m128i hi = _mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(g0,g1),w01),
+                                       _mm_madd_epi16(_mm_unpackhi_epi16(h0,h1),w23));
+            lo = _mm_srai_epi32(_mm_add_epi32(lo,rnd),W_BITS);
+            hi = _mm_srai_epi32(_mm_add_epi32(hi,rnd),W_BITS);
+            _mm_storeu_si128((__m128i*)(dI+2*x),_mm_packs_epi32(lo,hi));
+
+            const __m128 flo = _mm_cvtepi32_ps(lo), fhi = _mm_cvtepi32_ps(hi);
+            sq = _mm_add_ps(sq,_mm_add_ps(_mm_mul_ps(flo,flo),_mm_mul_ps(fhi,fhi)));
+            xy = _mm_add_ps(xy,_mm_add_ps(_mm_mul_ps(flo,_mm_shuffle_ps(flo,flo,_MM_SHUFFLE(2,3,0,1))),
+                                          _mm_mul_ps(fhi,_mm_shuffle_ps(fhi,fhi,_MM_SHUFFLE(2,3,0,1)))));
+          }
+#endif
+          for(;x<ws;++x){
+            I[x] = (s[x]*wt[0] + s[x+1]*wt[1] + s2[x]*wt[2] + s2[x+1]*wt[3] + (1<<(W_BITS-6))) >> (W_BITS-5);
+            const icl16s *a = g+2*x, *b = g2+2*x;
+            const int dx = (a[0]*wt[0] + a[2]*wt[1] + b[0]*wt[2] + b[2]*wt[3] + (1<<(W_BITS-1))) >> W_BITS;
+            const int dy = (a[1]*wt[0] + a[3]*wt[1] + b[1]*wt[2] + b[3]*wt[3] + (1<<(W_BITS-1))) >> W_BITS;
+            dI[2*x] = dx;
+            dI[2*x+1] = dy;
+            A11 += dx*dx;
+            A12 += dx*dy;
+            A22 += dy*dy;
+          }
+        }
+#ifdef ICL_HAVE_SSE2
+        float a[4], b[4];
+        _mm_storeu_ps(a,sq);
+        _mm_storeu_ps(b,xy);
+        A11 += a[0]+a[2];
+        A22 += a[1]+a[3];
+        A12 += (b[0]+b[1]+b[2]+b[3])*0.5f;
+#endif
+      }
+
+      /// computes the mismatch vector b = sum (J-I) * grad(I) for the window at (jx,jy)
+      static void mismatch(const Level &L, int jx, int jy, int ws, const int wt[4],
+                           const Window &win, float &b1, float &b2){
+        b1 = b2 = 0;
+#ifdef ICL_HAVE_SSE2
+        const __m128i z = _mm_setzero_si128();
+        const __m128i w01 = _mm_set_epi16(wt[1],wt[0],wt[1],wt[0],wt[1],wt[0],wt[1],wt[0]);
+        const __m128i w23 = _mm_set_epi16(wt[3],wt[2],wt[3],wt[2],wt[3],wt[2],wt[3],wt[2]);
+        const __m128i rnd5 = _mm_set1_epi32(1<<(W_BITS-6));
+        __m128 acc = _mm_setzero_ps();
+#endif
+        for(int y=0;y<ws;++y){
+          const icl8u *s = L.pix(jx,jy+y), *s2 = s + L.stride;
+          const icl16s *I = win.I.data() + y*ws, *dI = win.dI.data() + 2*y*ws;
+          int x = 0;
+#ifdef ICL_HAVE_SSE2
+          for(;x+4<=ws;x+=4){
+            const __m128i a0 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(s+x)),z);
+            const __m128i a1 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(s+x+1)),z);
+            const __m128i b0 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(s2+x)),z);
+            const __m128i b1 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(s2+x+1)),z);
+            __m128i v = _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(a0,a1),w01),
+                                      _mm_madd_epi16(_mm_unpacklo_epi16(b0,b1),w23));
+            v = _mm_srai_epi32(_mm_add_epi32(v,rnd5),W_BITS-5);
+            const __m128i i16 = _mm_loadl_epi64((const __m128i*)(I+x));
+            const __m128 diff = _mm_cvtepi32_ps(_mm_sub_epi32(v,_mm_srai_epi32(_mm_unpacklo_epi16(i16,i16),16)));
+            const __m128i d = _mm_loadu_si128((const __m128i*)(dI+2*x));
+            const __m128 dlo = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(d,d),16));
+            const __m128 dhi = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(d,d),16));
+            acc = _mm_add_ps(acc,_mm_add_ps(_mm_mul_ps(dlo,_mm_shuffle_ps(diff,diff,_MM_SHUFFLE(1,1,0,0))),
+                                            _mm_mul_ps(dhi,_mm_shuffle_ps(diff,diff,_MM_SHUFFLE(3,3,2,2)))));
+          }
+#endif
+          for(;x<ws;++x){
+            const int J = (s[x]*wt[0] + s[x+1]*wt[1] + s2[x]*wt[2] + s2[x+1]*wt[3] + (1<<(W_BITS-6))) >> (W_BITS-5);
+            const float diff = J - I[x];
+            b1 += diff * dI[2*x];
+            b2 += diff * dI[2*x+1];
+          }
+        }
+#ifdef ICL_HAVE_SSE2
+        float a[4];
+        _mm_storeu_ps(a,acc);
+        b1 += a[0]+a[2];
+        b2 += a[1]+a[3];
+#endif
+      }
+
+      /// tracks a single point p from pyramid A to pyramid B
+      /** q contains the initial guess and receives the result */
+      static bool track_point(const Pyramid &A, const Pyramid &B, const Point32f &p, Point32f &q,
+                              const Params &P, Window &win){
+        const int r = P.radius, ws = 2*r+1, top = (int)A.levels.size()-1;
+        const float eps2 = P.epsilon*P.epsilon;
+        // the window sums are scaled by 32*32 (intensities and gradients)
+        const float minEig = P.minEigenValue * 1024 * ws * ws;
+        float nx = q.x/(1<<top), ny = q.y/(1<<top);
+        int wt[4];
+        for(int l=top;l>=0;--l){
+          if(l != top){
+            nx *= 2;
+            ny *= 2;
+          }
+          const Level &a = A.levels[l], &b = B.levels[l];
+          const float px = p.x/(1<<l) - r, py = p.y/(1<<l) - r;
+          const int ix = (int)floor(px), iy = (int)floor(py);
+          if(!a.canSample(ix,iy,ws)){
+            if(!l) return false;
+            continue;
+          }
+          bilinear_weights(px-ix,py-iy,wt);
+          float A11, A12, A22;
+          sample_window(a,ix,iy,ws,wt,win,A11,A12,A22);
+
+          const float det = A11*A22 - A12*A12;
+          const float e = (A11 + A22 - ::sqrt((A11-A22)*(A11-A22) + 4*A12*A12))/2;
+          if(e < minEig || det < 1e-7){
+            if(!l) return false;
+            continue;
+          }
+          const float D = 1.0f/det;
+          float lastDx = 0, lastDy = 0;
+          for(int k=0;k<P.maxIterations;++k){
+            const float cx = nx - r, cy = ny - r;
+            const int jx = (int)floor(cx), jy = (int)floor(cy);
+            if(!b.canSample(jx,jy,ws)){
+              if(!l) return false;
+              break;
+            }
+            bilinear_weights(cx-jx,cy-jy,wt);
+            float b1, b2;
+            mismatch(b,jx,jy,ws,wt,win,b1,b2);
+            const float dx = (A12*b2 - A22*b1) * D;
+            const float dy = (A12*b1 - A11*b2) * D;
+            nx += dx;
+            ny += dy;
+            if(dx*dx + dy*dy <= eps2) break;
+            if(k && fabs(dx+lastDx) < 0.01f && fabs(dy+lastDy) < 0.01f){
+              // oscillation: the solution is in the middle
+              nx -= dx*0.5f;
+              ny -= dy*0.5f;
+              break;
+            }
+            lastDx = dx;
+            lastDy = dy;
+          }
+        }
+        q = Point32f(nx,ny);
+        // windows that are partially outside the image contain the static replicated
+        // border, which leads to wrong results
+        const Level &l0 = B.levels[0];
+        return nx >= r && ny >= r && nx <= l0.w-1-r && ny <= l0.h-1-r;
+      }
+    }
+
+    struct PyramidalLKTracker::Data{
+      /// work package for each thread (a range of points)
+      struct Work : public MultiThreader::Work{
+        Data *data;
+        int index, n;
+        Window win;
+        virtual void perform(){
+          data->trackRange(index,n,win);
+        }
+      };
+
+      Img8u gray;
+      Pyramid pyramids[2];
+      int prev;        //!< index of the previous pyramid (-1 if there is none)
+      Params params;
+
+      // current low-level call
+      const Point32f *in;
+      Point32f *out;
+      icl8u *status;
+      float *errors;
+      int num;
+
+      MultiThreader mt;
+      std::vector<Work> works;
+
+      // high level tracking
+      std::vector<Feature> features;
+      VectorTracker vt;
+      float gateRadius;
+      int frameCount;
+
+      Data():gray(Size(1,1),formatGray),prev(-1),gateRadius(0),frameCount(0){}
+
+      void trackRange(int index, int n, Window &win){
+        const int i0 = (num*index)/n, i1 = (num*(index+1))/n;
+        const Pyramid &A = pyramids[prev], &B = pyramids[1-prev];
+        for(int i=i0;i<i1;++i){
+          out[i] = in[i];
+          errors[i] = 0;
+          status[i] = track_point(A,B,in[i],out[i],params,win);
+          if(status[i] && params.fbThreshold > 0){
+            Point32f back = out[i];
+            if(track_point(B,A,out[i],back,params,win)){
+              errors[i] = back.distanceTo(in[i]);
+              status[i] = errors[i] <= params.fbThreshold;
+            }else{
+              status[i] = 0;
+            }
+          }
+        }
+      }
+
+      void run(int nt){
+        if(nt > 1 && (mt.isNull() || mt.getNumThreads() != nt)){
+          mt = MultiThreader(nt);
+        }
+        works.resize(nt);
+        for(int i=0;i<nt;++i){
+          works[i].data = this;
+          works[i].index = i;
+          works[i].n = nt;
+        }
+        if(nt == 1){
+          works[0].perform();
+          return;
+        }
+        MultiThreader::WorkSet ws(nt);
+        for(int i=0;i<nt;++i) ws[i] = &works[i];
+        mt(ws);
+      }
+
+      /// builds the pyramid of the given image and returns whether the flow can be computed
+      /** The new pyramid becomes the previous one, when swapPyramids is called */
+      bool setImage(const Img8u &image, int levels){
+        ICLASSERT_THROW(image.getChannels() > 0 && image.getDim() > 0,
+                        ICLException("PyramidalLKTracker: invalid input image"));
+        const Img8u *src = &image;
+        if(image.getChannels() != 1){
+          cc(&image,&gray);
+          src = &gray;
+        }
+        const int next = prev == -1 ? 0 : 1-prev;
+        pyramids[next].build(*src,levels,params.radius);
+        return prev != -1 && pyramids[prev].compatible(pyramids[next]);
+      }
+
+      void swapPyramids(){
+        prev = prev == -1 ? 0 : 1-prev;
+      }
+
+      void prepareVectorTracker(float gate){
+        if(vt.isNull() || gate != gateRadius){
+          vt = VectorTracker(2,1000,std::vector<float>(),VectorTracker::brandNew);
+          vt.setSparseAssignment(gate);
+          gateRadius = gate;
+          features.clear();
+        }
+      }
+
+      /// updates the VectorTracker with the given positions and assigns the ids
+      void associate(const std::vector<Point32f> &ps, const std::vector<float> &errors){
+        std::map<int,int> ages;
+        for(unsigned int i=0;i<features.size();++i){
+          ages[features[i].id] = features[i].age;
+        }
+        std::vector<VectorTracker::Vec> data(ps.size(),VectorTracker::Vec(2));
+        for(unsigned int i=0;i<ps.size();++i){
+          data[i][0] = ps[i].x;
+          data[i][1] = ps[i].y;
+        }
+        vt.pushData(data);
+        if(features.empty() && data.size()){
+          // the VectorTracker assigns ids from the second step on
+          vt.pushData(data);
+        }
+        features.resize(ps.size());
+        for(unsigned int i=0;i<ps.size();++i){
+          Feature &f = features[i];
+          f.pos = ps[i];
+          f.id = vt.getID(i);
+          f.error = errors[i];
+          std::map<int,int>::const_iterator it = ages.find(f.id);
+          f.age = it == ages.end() ? 0 : it->second+1;
+        }
+        ++frameCount;
+      }
+    };
+
+    PyramidalLKTracker::PyramidalLKTracker(int windowSize, int pyramidLevels, int numThreads):m_data(new Data){
+      addProperty("window size","range:spinbox","[5,41]:2",str(windowSize),0,
+                  "Edge length of the tracking window (odd numbers only)");
+      addProperty("pyramid levels","range:spinbox","[1,8]",str(pyramidLevels),0,
+                  "Number of pyramid levels (levels smaller than the window are not used)");
+      addProperty("max iterations","range:spinbox","[1,100]","20",0,
+                  "Maximum number of Lucas-Kanade iterations per pyramid level");
+      addProperty("epsilon","range","[0.001,1]","0.03",0,
+                  "Iterations stop, once the position update is shorter than epsilon (in pixels)");
+      addProperty("min eigenvalue","range","[0,1000]","0.1",0,
+                  "Minimum eigenvalue of the structure tensor (per pixel, in squared gray values per pixel)");
+      addProperty("forward-backward threshold","range","[0,20]","1",0,
+                  "Maximum forward-backward error in pixels (0 deactivates the check)");
+      addProperty("number of threads","range:spinbox","[1,64]",str(numThreads),0,
+                  "Number of threads, the points are distributed to");
+      addProperty("detection interval","range:spinbox","[1,1000]","10",0,
+                  "Number of frames between two feature detections (see needsDetections())");
+      addProperty("association.gate radius","range","[1,1000]","20",0,
+                  "Maximum distance (in pixels) of a new detection to a tracked feature to get its id");
+    }
+
+    PyramidalLKTracker::~PyramidalLKTracker(){
+      delete m_data;
+    }
+
+    void PyramidalLKTracker::computeFlow(const core::Img8u &image, const std::vector<utils::Point32f> &prevPoints,
+                                         std::vector<utils::Point32f> &nextPoints, std::vector<icl8u> &status,
+                                         std::vector<float> *errors){
+      Data &d = *m_data;
+      Params &p = d.params;
+      const int ws = getPropertyValue("window size");
+      p.radius = ws/2;
+      p.maxIterations = getPropertyValue("max iterations");
+      p.epsilon = getPropertyValue("epsilon");
+      p.minEigenValue = getPropertyValue("min eigenvalue");
+      p.fbThreshold = getPropertyValue("forward-backward threshold");
+
+      const int n = (int)prevPoints.size();
+      std::vector<float> errorBuf;
+      std::vector<float> &errs = errors ? *errors : errorBuf;
+      nextPoints = prevPoints;
+      status.assign(n,0);
+      errs.assign(n,0);
+
+      if(!d.setImage(image,getPropertyValue("pyramid levels")) || !n){
+        d.swapPyramids();
+        return;
+      }
+      d.in = prevPoints.data();
+      d.out = nextPoints.data();
+      d.status = status.data();
+      d.errors = errs.data();
+      d.num = n;
+      d.run(iclMax(1,iclMin(n,getPropertyValue("number of threads").as<int>())));
+      d.swapPyramids();
+    }
+
+    const std::vector<PyramidalLKTracker::Feature> &PyramidalLKTracker::track(const core::Img8u &image){
+      Data &d = *m_data;
+      d.prepareVectorTracker(getPropertyValue("association.gate radius"));
+      std::vector<Point32f> ps(d.features.size()), next;
+      for(unsigned int i=0;i<ps.size();++i){
+        ps[i] = d.features[i].pos;
+      }
+      std::vector<icl8u> status;
+      std::vector<float> errors;
+      computeFlow(image,ps,next,status,&errors);
+
+      ps.clear();
+      std::vector<float> es;
+      for(unsigned int i=0;i<next.size();++i){
+        if(status[i]){
+          ps.push_back(next[i]);
+          es.push_back(errors[i]);
+        }
+      }
+      d.associate(ps,es);
+      return d.features;
+    }
+
+    const std::vector<PyramidalLKTracker::Feature> &PyramidalLKTracker::track(const core::Img8u &image,
+                                                                                const std::vector<utils::Point32f> &detections){
+      Data &d = *m_data;
+      d.params.radius = getPropertyValue("window size").as<int>()/2;
+      d.setImage(image,getPropertyValue("pyramid levels"));
+      d.swapPyramids();
+      d.prepareVectorTracker(getPropertyValue("association.gate radius"));
+      d.frameCount = 0;
+      d.associate(detections,std::vector<float>(detections.size(),0));
+      return d.features;
+    }
+
+    bool PyramidalLKTracker::needsDetections() const{
+      return m_data->features.empty() || m_data->vt.isNull() ||
+             m_data->frameCount >= getPropertyValue("detection interval").as<int>();
+    }
+
+    const std::vector<PyramidalLKTracker::Feature> &PyramidalLKTracker::getFeatures() const{
+      return m_data->features;
+    }
+
+    void PyramidalLKTracker::reset(){
+      m_data->features.clear();
+      m_data->prev = -1;
+      m_data->frameCount = 0;
+      if(!m_data->vt.isNull()){
+        m_data->vt.pushData(std::vector<VectorTracker::Vec>());
+      }
+    }
+
+  } // namespace cv
+}
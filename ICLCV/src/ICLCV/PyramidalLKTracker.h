@@ -0,0 +1,142 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLCV/src/ICLCV/PyramidalLKTracker.h                   **
+** Module : ICLCV                                                  **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#pragma once
+
+#include <ICLUtils/CompatMacros.h>
+#include <ICLCore/Img.h>
+#include <ICLUtils/Uncopyable.h>
+#include <ICLUtils/Configurable.h>
+#include <ICLUtils/Point32f.h>
+
+#include <vector>
+
+namespace icl{
+  namespace cv{
+
+    /// Pyramidal Lucas-Kanade (KLT) tracker for sparse optical flow
+    /** The PyramidalLKTracker implements the pyramidal Lucas-Kanade feature tracker
+        (J.-Y. Bouguet, "Pyramidal Implementation of the Lucas Kanade Feature Tracker").
+        It works on Img8u images (images with more than one channel are converted to gray
+        internally).
+
+        \section LOW Low Level Interface
+        computeFlow computes the new positions of a set of points in the given image,
+        w.r.t. the image that was passed to the previous call of computeFlow or track.
+        The image pyramid of each image (and its gradients) is computed only once: it is
+        used as 'next' pyramid, when the image is passed, and kept as 'previous' pyramid for
+        the next call.
+
+        \section HIGH Tracking with IDs
+        The track methods maintain a set of tracked features, each with a persistent id.
+        Usually, feature detection (e.g. FAST or ORB key-points) is too expensive to be run in
+        each frame. Therefore, new detections are only passed every N-th frame (see property
+        "detection interval" and needsDetections()). In between, the features are
+        propagated using the optical flow. The ids are provided by an internal
+        VectorTracker (using its sparse assignment mode with the gate radius given by
+        the property "association.gate radius"): In each frame, it is updated with either
+        the tracked feature positions or with the new detections. By these means, detections
+        that continue an existing feature track get its id, and the motion model of the
+        VectorTracker is kept up to date in the frames without detection.
+
+        \section IMPL Implementation Details
+        - the pyramid levels are computed with a fixed-point 5x5 gaussian and 2:1 sub-sampling;
+          each level has a replicated border, so that the tracking windows never have to be
+          clipped
+        - the x- and y-gradients of each level are computed in 16 bit fixed-point precision
+          using the Scharr operator (SSE2 optimized)
+        - all bilinear window samples use 14 bit fixed-point weights; if ICL is compiled
+          with SSE2 support, 4 pixels are interpolated at once (using _mm_madd_epi16)
+        - points are rejected, if the minimum eigenvalue of the window's structure tensor
+          (normalized by the window area) is lower than "min eigenvalue", if their window
+          leaves the image, or if their forward-backward error is larger than
+          "forward-backward threshold". The forward-backward error is the distance between the original point and the point
+          that is obtained by tracking the result back into the previous image
+        - the points are distributed to "number of threads" threads
+    */
+    class ICLCV_API PyramidalLKTracker : public utils::Configurable, public utils::Uncopyable{
+      /// internal data structure
+      struct Data;
+
+      /// internal data pointer
+      Data *m_data;
+
+      public:
+
+      /// tracked feature
+      struct Feature{
+        utils::Point32f pos; //!< current position
+        int id;              //!< persistent id (provided by the internal VectorTracker)
+        int age;             //!< number of frames, the feature has been tracked
+        float error;         //!< last forward-backward error (0 for new detections)
+      };
+
+      /// creates a new tracker instance
+      PyramidalLKTracker(int windowSize=15, int pyramidLevels=3, int numThreads=1);
+
+      /// destructor
+      ~PyramidalLKTracker();
+
+      /// computes the optical flow of the given points from the last image to the given one
+      /** @param image new image (its pyramid is kept for the next call)
+          @param prevPoints point positions in the last image
+          @param nextPoints destination for the point positions in the new image
+          @param status destination for the point status (1 if the point was tracked
+                        successfully, 0 otherwise)
+          @param errors optional destination for the forward-backward errors (if the
+                        forward-backward check is deactivated, the errors are 0)
+          If there is no last image (or the image size changed), all status entries are 0 */
+      void computeFlow(const core::Img8u &image, const std::vector<utils::Point32f> &prevPoints,
+                       std::vector<utils::Point32f> &nextPoints, std::vector<icl8u> &status,
+                       std::vector<float> *errors=0);
+
+      /// tracks the current features into the given image
+      const std::vector<Feature> &track(const core::Img8u &image);
+
+      /// replaces the current features by the given new detections
+      /** The new detections are associated to the existing features by the internal
+          VectorTracker. The optical flow is not computed in this case */
+      const std::vector<Feature> &track(const core::Img8u &image,
+                                        const std::vector<utils::Point32f> &detections);
+
+      /// returns whether new detections should be passed with the next image
+      /** This is true every "detection interval" frames and whenever there are no
+          features left */
+      bool needsDetections() const;
+
+      /// returns the current features
+      const std::vector<Feature> &getFeatures() const;
+
+      /// removes all features and the last image
+      void reset();
+    };
+
+  } // namespace cv
+}
@@ -39,6 +39,7 @@
 
 #include <ICLUtils/Range.h>
 #include <ICLUtils/StringUtils.h>
+#include <ICLUtils/MultiThreader.h>
 
 #include <algorithm>
 
@@ -63,6 +64,64 @@ namespace icl{
           }
         }
       };
+
+      using region_detector_tools::uf_find;
+      using region_detector_tools::uf_union;
+
+      /// counts the line segments of the given part tree and links all its parts to d
+      unsigned int count_and_link(ImageRegionPart *r, ImageRegionData *d){
+        if(r->is_counted()) return 0;
+        r->notify_counted();
+        r->data = d;
+        unsigned int n = r->segments.size();
+        for(ImageRegionPart::children_container::iterator it = r->children.begin(); it != r->children.end(); ++it){
+          n += count_and_link(*it,d);
+        }
+        return n;
+      }
+
+      /// merges all adjacent line segments of row y-1 and y with identical values
+      inline void uf_join_rows(RunLengthEncoder &rle, int y, int *parents){
+        WorkingLineSegment *base = rle.begin(0);
+        WorkingLineSegment *l = rle.begin(y-1);
+        WorkingLineSegment *c = rle.begin(y);
+        WorkingLineSegment *cEnd = rle.end(y);
+        while(c < cEnd){
+          do{
+            if(l->val == c->val){
+              uf_union(parents,(int)(l-base),(int)(c-base));
+            }
+          }while(c->xend > l->xend && ++l);
+          if(c->xend == l->xend) ++l;
+          ++c;
+        }
+      }
+
+      /// a horizontal image strip that is processed by one thread
+      struct StripWork : public MultiThreader::Work{
+        RunLengthEncoder *rle;
+        const ImgBase *image;
+        int *parents;
+        int y0, y1;
+        bool encode;
+
+        virtual void perform(){
+          if(encode){
+            rle->encodeRows(image,y0,y1);
+            return;
+          }
+          WorkingLineSegment *base = rle->begin(0);
+          for(int y=y0;y<y1;++y){
+            for(WorkingLineSegment *s=rle->begin(y); s != rle->end(y); ++s){
+              const int i = (int)(s-base);
+              parents[i] = i;
+            }
+          }
+          for(int y=y0+1;y<y1;++y){
+            uf_join_rows(*rle,y,parents);
+          }
+        }
+      };
     }
     
     using namespace region_detector_tools;
@@ -81,8 +140,13 @@ namespace icl{
   
       std::vector<ImageRegionData*> regionData;
       
+      std::vector<int> parents;   //!< union-find structure for parallel labelling
+      std::vector<int> regionIdx; //!< region index of each line segment
+      int featureMask;            //!< accumulated region features
+      MultiThreader mt;
+      std::vector<StripWork> strips;
       
-      Data():image(0){}
+      Data():image(0),featureMask(FeatureNone){}
   
       ~Data(){
         for(unsigned int i=0;i<regionData.size();++i){
@@ -90,6 +154,33 @@ namespace icl{
         }
       }
       CornerDetectorCSS css;
+
+      /// splits the image roi into nThreads strips and sets up the multithreader
+      void prepareStrips(int nThreads){
+        if(mt.isNull() || mt.getNumThreads() != nThreads){
+          mt = MultiThreader(nThreads);
+        }
+        strips.resize(nThreads);
+        const int H = roi.height;
+        for(int i=0;i<nThreads;++i){
+          StripWork &s = strips[i];
+          s.rle = &rle;
+          s.image = image;
+          s.y0 = (i*H)/nThreads;
+          s.y1 = ((i+1)*H)/nThreads;
+        }
+      }
+
+      /// runs all strips in parallel (encoding or labelling)
+      void runStrips(bool encode){
+        MultiThreader::WorkSet ws(strips.size());
+        for(unsigned int i=0;i<strips.size();++i){
+          strips[i].encode = encode;
+          strips[i].parents = parents.data();
+          ws[i] = &strips[i];
+        }
+        mt(ws);
+      }
     };
   
   
@@ -110,6 +201,10 @@ namespace icl{
                   "detection step. This graph is used to find\n"
                   "region neighbours, children (fully contained\n"
                   "regions) and parents.");
+      addProperty("number of threads","range:spinbox","[1,64]","1",0,
+                  "Number of threads that are used for the\n"
+                  "run-length encoding and the labelling step.\n"
+                  "The results do not depend on this value.");
   
       addChildConfigurable(&m_data->css,"CSS");
     }
@@ -123,6 +218,7 @@ namespace icl{
       addProperty("minimum value","range:slider","[0,255]",str(minVal));
       addProperty("maximum value","range:slider","[0,255]",str(maxVal));
       addProperty("create region graph","menu","off,on",createRegionGraph ? "on" : "off");
+      addProperty("number of threads","range:spinbox","[1,64]","1");
       addProperty("track times.on","flag","",false);
       addProperty("track times.rle","info","","-");
       addProperty("track times.analyse regions","info","","-");
@@ -137,6 +233,18 @@ namespace icl{
     void RegionDetector::setCreateGraph(bool on){
       setPropertyValue("create region graph", on ? "on" : "off");
     }  
+
+    void RegionDetector::setFeatureMask(int mask){
+      m_data->featureMask = mask & FeatureAll;
+    }
+
+    int RegionDetector::getFeatureMask() const{
+      return m_data->featureMask;
+    }
+
+    void RegionDetector::setNumThreads(int nThreads){
+      setPropertyValue("number of threads", str(iclMax(1,nThreads)));
+    }
   
     RegionDetector::~RegionDetector(){
       delete m_data;
@@ -239,13 +347,123 @@ namespace icl{
       
       bool crg = getPropertyValue("create region graph") == "on";
       
-      int nextID = -1;
+      // create one region for each top-level part; the ids are assigned below
+      std::vector<ImageRegionData*> unsorted;
       ImageRegionPart *parts = m_data->parts.data();
       ImageRegionPart *partsEnd = parts + m_data->nUsedParts;
       for(ImageRegionPart *p=parts; p != partsEnd; ++p){
         if(p->is_top()){
-          m_data->regionData.push_back(ImageRegionData::createInstance(&m_data->css,p,++nextID, crg, m_data->image));
-          m_data->regions.push_back(ImageRegion(m_data->regionData.back()));
+          ImageRegionData *d = new ImageRegionData(&m_data->css,p->val,-1,0,crg,m_data->image);
+          d->segments.resize(count_and_link(p,d));
+          unsorted.push_back(d);
+        }
+      }
+      
+      // collect the line segments in raster order, so that the regions and their line
+      // segments are sorted by their first pixel (see \ref ORDER) without an extra pass
+      const int n = (int)unsorted.size();
+      std::vector<ImageRegionData*> &rd = m_data->regionData;
+      rd.reserve(n);
+      std::vector<int> fill;
+      fill.reserve(n);
+      const int mask = m_data->featureMask;
+      RunLengthEncoder &rle = m_data->rle;
+      const int H = m_data->roi.height;
+      for(int y=0;y<H;++y){
+        for(WorkingLineSegment *s=rle.begin(y); s != rle.end(y); ++s){
+          ImageRegionData *d = s->reg->data;
+          if(d->id < 0){
+            d->id = (int)rd.size();
+            rd.push_back(d);
+            fill.push_back(0);
+            if(mask) d->initFeatures(mask);
+          }
+          d->segments[fill[d->id]++] = *s;
+          s->ird = d;
+          if(mask) d->accumulateFeatures(*s);
+        }
+      }
+      m_data->regions.resize(n,ImageRegion(0));
+      for(int i=0;i<n;++i){
+        m_data->regions[i] = ImageRegion(rd[i]);
+      }
+    }
+
+    void RegionDetector::analyseRegionsMT(){
+      //BENCHMARK_THIS_FUNCTION;
+      RunLengthEncoder &rle = m_data->rle;
+      const int W = m_data->roi.width, H = m_data->roi.height;
+      if((int)m_data->parents.size() != W*H){
+        m_data->parents.resize(W*H);
+      }
+      
+      // label all strips independently
+      m_data->runStrips(false);
+      
+      // stitch strip borders
+      int *parents = m_data->parents.data();
+      for(unsigned int i=1;i<m_data->strips.size();++i){
+        const int y = m_data->strips[i].y0;
+        if(y > 0 && y < H) uf_join_rows(rle,y,parents);
+      }
+    }
+
+    void RegionDetector::joinRegionsMT(){
+      //BENCHMARK_THIS_FUNCTION;
+      m_data->regions.clear();
+      m_data->filteredRegions.clear();
+      for(unsigned int i=0;i<m_data->regionData.size();++i){
+        delete m_data->regionData[i];
+      }
+      m_data->regionData.clear();
+      
+      const bool crg = getPropertyValue("create region graph") == "on";
+      
+      RunLengthEncoder &rle = m_data->rle;
+      const int W = m_data->roi.width, H = m_data->roi.height;
+      WorkingLineSegment *base = rle.begin(0);
+      int *parents = m_data->parents.data();
+      if((int)m_data->regionIdx.size() != W*H){
+        m_data->regionIdx.resize(W*H);
+      }
+      int *regionIdx = m_data->regionIdx.data();
+      
+      // count line segments per region (roots are always visited first)
+      std::vector<int> counts;
+      std::vector<int> values;
+      for(int y=0;y<H;++y){
+        for(WorkingLineSegment *s=rle.begin(y); s != rle.end(y); ++s){
+          const int i = (int)(s-base);
+          const int r = uf_find(parents,i);
+          if(r == i){
+            regionIdx[i] = (int)counts.size();
+            counts.push_back(1);
+            values.push_back(s->val);
+          }else{
+            ++counts[regionIdx[i] = regionIdx[r]];
+          }
+        }
+      }
+      
+      const int n = (int)counts.size();
+      m_data->regionData.resize(n);
+      m_data->regions.resize(n,ImageRegion(0));
+      const int mask = m_data->featureMask;
+      for(int i=0;i<n;++i){
+        m_data->regionData[i] = new ImageRegionData(&m_data->css,values[i],i,counts[i],crg,m_data->image);
+        if(mask) m_data->regionData[i]->initFeatures(mask);
+        m_data->regions[i] = ImageRegion(m_data->regionData[i]);
+        counts[i] = 0;
+      }
+      
+      // collect the line segments
+      for(int y=0;y<H;++y){
+        for(WorkingLineSegment *s=rle.begin(y); s != rle.end(y); ++s){
+          const int r = regionIdx[s-base];
+          ImageRegionData *d = m_data->regionData[r];
+          d->segments[counts[r]++] = *s;
+          s->ird = d;
+          if(mask) d->accumulateFeatures(*s);
         }
       }
     }
@@ -365,15 +583,29 @@ namespace icl{
         t = Time::now();
         tTotal = t;
       }
+      // strips must at least have two rows
+      const int nThreads = iclMin(parse<int>(getPropertyValue("number of threads")),
+                                  m_data->roi.height/2);
+      
       // run length encoding
-      m_data->rle.encode(image);
+      if(nThreads > 1){
+        m_data->prepareStrips(nThreads);
+        m_data->rle.prepare(image);
+        m_data->runStrips(true);
+      }else{
+        m_data->rle.encode(image);
+      }
 
       if(trackTimes){
         setPropertyValue("track times.rle", msec_string_and_reset(t));
       }
   
       // find all image region parts
-      analyseRegions();
+      if(nThreads > 1){
+        analyseRegionsMT();
+      }else{
+        analyseRegions();
+      }
 
       if(trackTimes){
         setPropertyValue("track times.analyse regions", msec_string_and_reset(t));
@@ -381,7 +613,11 @@ namespace icl{
 
   
       // join parts and create image regions
-      joinRegions();
+      if(nThreads > 1){
+        joinRegionsMT();
+      }else{
+        joinRegions();
+      }
 
       if(trackTimes){
         setPropertyValue("track times.join regions", msec_string_and_reset(t));
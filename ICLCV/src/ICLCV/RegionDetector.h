@@ -151,11 +151,13 @@ namespace icl{
         
         \subsection JO Region Joining
         Here, a ImageRegion (stricly speaking ImageRegionData-structure) is created from 
-        each top level ImageRegionParts T. During the creation process, all  
-        WorkingLineSegments of T and all contained ImageRegionParts are collected recursively. 
-        Furthermore, the internally used WorkingLineSegments do no longer 
-        need information about their parent ImageRegionPart. Therefore, their data pointer 
-        is set to their parent ImageRegionData structure.\n
+        each top level ImageRegionParts T. During the creation process, the WorkingLineSegments
+        of T and all contained ImageRegionParts are counted recursively, and all these parts
+        are linked to the new ImageRegionData structure. Afterwards, the WorkingLineSegments
+        are collected in a single pass in raster order (see \ref ORDER). Furthermore, the
+        internally used WorkingLineSegments do no longer need information about their
+        parent ImageRegionPart. Therefore, their data pointer is set to their parent
+        ImageRegionData structure.\n
         After this step, we already have a set of all image regions.
         
         \subsection LINKING Region Linking
@@ -175,6 +177,40 @@ namespace icl{
         \subsection FILTERING Filtering Regions
         Lastly, all ImageRegionData structures are filtered w.r.t. the given size and
         value constraints.
+
+        \subsection ORDER Region Order
+        The resulting regions are sorted by their first (upper-left) pixel in raster order.
+        Furthermore, the line segments of each region are also sorted in raster order.
+        By this means, the result does not depend on the actual labelling algorithm
+        
+        \section FEATURES Accumulated Features
+        Usually, region features, such as the bounding box, are computed on demand 
+        by walking through the region's line segments again. If many regions are detected 
+        and several features are needed for each of them, this becomes expensive. 
+        Therefore, a feature mask can be given (see RegionDetector::setFeatureMask).
+        All selected features are accumulated in the same pass that collects the line
+        segments of each region. The corresponding ImageRegion getters are then O(1):
+        - RegionDetector::FeatureSize: ImageRegion::getSize
+        - RegionDetector::FeatureBoundingBox: ImageRegion::getBoundingBox
+        - RegionDetector::FeatureMoments: raw moments up to second order, which are
+          used by ImageRegion::getCOG and ImageRegion::getPCAInfo
+
+        Value statistics are not needed here: all pixels of a region have the same
+        value (see ImageRegion::getVal).
+        
+        \section PARALLEL Parallel Detection
+        If more than one thread is used (see RegionDetector::setNumThreads),
+        the region analysis and joining steps are replaced by a strip-parallel
+        algorithm. The image is split into horizontal strips that are run-length
+        encoded and labelled independently. For the labelling, adjacent line 
+        segments with identical value are merged in a union-find structure, whose
+        roots are always the first line segment of a region in raster order.
+        Since strips cover disjoint sets of line segments, this does not need
+        any synchronization. Afterwards, the strip borders are stitched by merging 
+        the adjacent line segments of the last row of each strip and the first 
+        row of the next strip. Finally, the region structures are created in a 
+        single pass over all line segments. The resulting regions, including the
+        optional region graph, are identical to the single-threaded result.
     */
     class ICLCV_API RegionDetector : public utils::Uncopyable, public utils::Configurable{
       
@@ -182,6 +218,15 @@ namespace icl{
       Data *m_data; //!< internal data pointer
       
       public:
+
+      /// features that can be accumulated during the detection (see \ref FEATURES)
+      enum Feature{
+        FeatureNone = 0,        //!< all features are computed on demand (default)
+        FeatureSize = 1,        //!< pixel count
+        FeatureBoundingBox = 2, //!< bounding box 
+        FeatureMoments = 4,     //!< raw moments up to second order (for center of gravity and PCA information)
+        FeatureAll = 7          //!< all features
+      };
   
       /// first constructor with given flag for creation of the region graph
       /** Note: at default, the region graph is not created */
@@ -199,6 +244,17 @@ namespace icl{
       
       /// set up the region-graph creation flag
       void setCreateGraph(bool on);
+
+      /// sets the features that are accumulated during the detection (see \ref FEATURES)
+      /** @param mask bitwise or of Feature values */
+      void setFeatureMask(int mask);
+
+      /// returns the current feature mask
+      int getFeatureMask() const;
+
+      /// sets the number of threads that are used for the detection (see \ref PARALLEL)
+      /** Note: this can also be adjusted by the Configurable interface */
+      void setNumThreads(int nThreads);
   
       /// sets the internally used parameters for CSS-based corner detection
       /** The internal corner detector is used if ImageRegion::getBoundaryCorners is
@@ -231,6 +287,14 @@ namespace icl{
       /// combines ImageRegionParts
       /** see \ref JO */
       void joinRegions();
+
+      /// strip-parallel labelling of the line segments
+      /** see \ref PARALLEL */
+      void analyseRegionsMT();
+
+      /// creates the regions from the labels created by analyseRegionsMT
+      /** see \ref PARALLEL */
+      void joinRegionsMT();
       
       /// detects region neighbours
       /** see \ref LINKING */
@@ -134,6 +134,25 @@ namespace icl{
         //  return find_first_not_no_opt(reinterpret_cast<const icl8u*>(p32),last,val);
       }
   #endif
+
+      /// union-find: returns the root of i (with path halving)
+      inline int uf_find(int *parents, int i){
+        while(parents[i] != i){
+          parents[i] = parents[parents[i]];
+          i = parents[i];
+        }
+        return i;
+      }
+
+      /// union-find: merges the sets of a and b
+      /** The smaller root index becomes the new root. Therefore, if the elements are
+          indexed in raster order, the root of each set is always its first element */
+      inline void uf_union(int *parents, int a, int b){
+        a = uf_find(parents,a);
+        b = uf_find(parents,b);
+        if(a < b) parents[b] = a;
+        else if(b < a) parents[a] = b;
+      }
   
     }
   } // namespace cv
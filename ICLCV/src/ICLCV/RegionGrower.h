@@ -35,6 +35,10 @@
 #include <ICLCore/DataSegment.h>
 #include <ICLMath/HomogeneousMath.h>
 #include <ICLUtils/Exception.h>
+#include <ICLUtils/MultiThreader.h>
+#include <ICLUtils/SSETypes.h>
+#include <ICLCV/RegionDetectorTools.h>
+#include <vector>
 
 namespace icl{
   namespace cv{
@@ -42,12 +46,48 @@ namespace icl{
     /// class for region growing on images and DataSegments (e.g. poincloud xyzh)
     /** The RegionGrower class is designed as template applying a growing criterion to given input data.
         A mask defines the points for processing (e.g. a region of interest).
+
+        \section PAR Parallel Mode
+        By default, the regions are grown sequentially using a flood fill from each seed point.
+        Alternatively, a parallel union-find implementation can be enabled (setParallelMode):
+        - the image rows are split into bands, one for each thread
+        - each thread evaluates the criterion on all 8-neighbour edges of its band (in row passes)
+          and merges the connected pixels into its own union-find forest (no synchronisation needed)
+        - the edges across the band borders are merged afterwards
+        - a final pass compacts the labels and removes regions smaller than minSize
+
+        Neighbours p and q are connected if crit(p,q) and crit(q,p) is true. For symmetric criteria
+        (such as the euclidean distance) and for criteria that only depend on the 2nd argument (such as
+        the equal threshold criterion), the resulting label image is identical to the one of the sequential
+        implementation (including the label IDs). Only the order of the pixel indices in the region vectors
+        (see getRegions) differs: the parallel mode sorts them in raster order.
+
+        The edges are evaluated with SSE2 for the euclidean distance criterion on DataSegment<float,4>
+        (e.g. xyzh point clouds) and for the equal threshold criterion on single channel images. Since the
+        parallel mode always processes all pixels, the sequential flood fill can still be faster if
+        the regions cover only a small part of the image.
     */
 
     class RegionGrower{
       	
   	  public:
         
+        /// creates a new RegionGrower instance (using the sequential implementation)
+        RegionGrower():parallel(false),numThreads(1){}
+
+        /// enables or disables the parallel union-find implementation (see \ref PAR)
+        void setParallelMode(bool enabled, int numThreads=4){
+          ICLASSERT_THROW(numThreads > 0, utils::ICLException("RegionGrower::setParallelMode: invalid number of threads"));
+          this->parallel = enabled;
+          this->numThreads = numThreads;
+        }
+
+        /// returns whether the parallel union-find implementation is used
+        bool getParallelMode() const { return parallel; }
+
+        /// returns the number of threads used in parallel mode
+        int getNumThreads() const { return numThreads; }
+        
         /// Applies the region growing on an input image with a growing criterion
         /** @param image the input image for region growing
             @param crit the region growing criterion
@@ -151,6 +191,17 @@ namespace icl{
         core::Img8u mask;
         core::Img32s result;
         std::vector<std::vector<int> > regions;
+
+        bool parallel;
+        int numThreads;
+        utils::MultiThreader mt;
+
+        /// buffers for the parallel mode
+        std::vector<int> parents, sizes, labels;
+        std::vector<icl8u> flags;
+
+        /// pixel flags for the parallel mode
+        enum{ VALID=1, SEED=2 };
       
         template<class T, class DataT, int DIM>
         struct RegionGrowerDataAccessor{
@@ -190,7 +241,167 @@ namespace icl{
           }
         };
         
-  
+
+        /// evaluates the edges to the left, upper-left, upper and upper-right neighbours of row y
+        /** The result bits are 1 (left), 2 (upper-left), 4 (upper) and 8 (upper-right) */
+        template<class T, class DataT, int DIM, class Criterion>
+        static void evaluate_edges(const RegionGrowerDataAccessor<T,DataT,DIM> &a, Criterion crit, int y,
+                                   bool withUpperRow, const icl8u *flags, icl8u *edges,
+                                   int xStart=0, int xEnd=-1){
+          const int w = a.w();
+          const icl8u *f = flags + y*w, *fu = f-w;
+          if(xEnd < 0) xEnd = w;
+          for(int x=xStart;x<xEnd;++x){
+            icl8u e = 0;
+            if(f[x]){
+              const math::FixedColVector<DataT,DIM> p = a(x,y);
+              if(x > 0 && f[x-1] && connected(crit,p,a(x-1,y))) e |= 1;
+              if(withUpperRow){
+                if(x > 0 && fu[x-1] && connected(crit,p,a(x-1,y-1))) e |= 2;
+                if(fu[x] && connected(crit,p,a(x,y-1))) e |= 4;
+                if(x < w-1 && fu[x+1] && connected(crit,p,a(x+1,y-1))) e |= 8;
+              }
+            }
+            edges[x] = e;
+          }
+        }
+
+        /// SSE2-optimized edge evaluation for the euclidean distance on xyzh data
+        static void evaluate_edges(const RegionGrowerDataAccessor<core::DataSegment<float,4>,float,4> &a,
+                                   Float4EuclideanDistance crit, int y, bool withUpperRow,
+                                   const icl8u *flags, icl8u *edges);
+
+        /// SSE2-optimized edge evaluation for the equal threshold criterion on single channel images
+        static void evaluate_edges(const RegionGrowerDataAccessor<core::Img8u,icl8u,1> &a,
+                                   EqualThreshold crit, int y, bool withUpperRow,
+                                   const icl8u *flags, icl8u *edges);
+
+        template<class V, class Criterion>
+        static inline bool connected(Criterion crit, const V &p, const V &q){
+          return crit(p,q) && crit(q,p);
+        }
+
+        /// work package for the parallel mode: flags, edges and union-find for a band of rows
+        template<class T, class DataT, int DIM, class Criterion>
+        struct BandWork : public utils::MultiThreader::Work{
+          RegionGrower *rg;
+          const RegionGrowerDataAccessor<T,DataT,DIM> *a;
+          const core::Channel8u *mask;
+          Criterion crit;
+          int yStart, yEnd;
+          std::vector<icl8u> edges;
+
+          BandWork(Criterion crit):crit(crit){}
+
+          virtual void perform(){
+            const int w = a->w();
+            int *parents = rg->parents.data();
+            icl8u *flags = rg->flags.data();
+            edges.resize(2*w);
+            for(int y=yStart;y<yEnd;++y){
+              for(int x=0,i=y*w;x<w;++x,++i){
+                parents[i] = i;
+                flags[i] = (*mask)(x,y) ? 0 : crit((*a)(x,y),(*a)(x,y)) ? (VALID|SEED) : VALID;
+              }
+              // edges of the current and the last row
+              icl8u *e = edges.data() + (y&1)*w, *eu = edges.data() + ((y+1)&1)*w;
+              evaluate_edges(*a,crit,y,y>yStart,flags,e);
+
+              // edges, whose pixels are already connected via other neighbours, are skipped
+              for(int x=0,i=y*w;x<w;++x,++i){
+                const icl8u c = e[x];
+                if(!c) continue;
+                if(c & 4) region_detector_tools::uf_union(parents,i,i-w);
+                if((c & 2) && !((c & 4) && (eu[x] & 1))) region_detector_tools::uf_union(parents,i,i-w-1);
+                if((c & 8) && !((c & 4) && (eu[x+1] & 1))) region_detector_tools::uf_union(parents,i,i-w+1);
+                if((c & 1) && !((c & 4) && (e[x-1] & 8)) && !((c & 2) && (e[x-1] & 4))) region_detector_tools::uf_union(parents,i,i-1);
+              }
+            }
+          }
+        };
+
+        /// parallel union-find implementation of region_grow (see \ref PAR)
+        template<class T, class DataT, int DIM, class Criterion>
+        void region_grow_parallel(const T &data, core::Img8u &mask, core::Img32s &result, Criterion crit,
+                                  const unsigned int minSize, const unsigned int startID){
+          RegionGrowerDataAccessor<T,DataT,DIM> a(data);
+          const int w = a.w(), h = a.h(), dim = w*h;
+          core::Channel8u m = mask[0];
+          core::Channel32s res = result[0];
+          result.fill(0);
+          regions.clear();
+          if(!dim) return;
+          parents.resize(dim);
+          flags.resize(dim);
+
+          // 1st: union-find within bands of rows
+          const int nt = iclMin(numThreads,h);
+          std::vector<BandWork<T,DataT,DIM,Criterion> > works(nt,BandWork<T,DataT,DIM,Criterion>(crit));
+          for(int i=0;i<nt;++i){
+            works[i].rg = this;
+            works[i].a = &a;
+            works[i].mask = &m;
+            works[i].yStart = (h*i)/nt;
+            works[i].yEnd = (h*(i+1))/nt;
+          }
+          if(nt == 1){
+            works[0].perform();
+          }else{
+            if(mt.isNull() || mt.getNumThreads() != nt){
+              mt = utils::MultiThreader(nt);
+            }
+            utils::MultiThreader::WorkSet ws(nt);
+            for(int i=0;i<nt;++i) ws[i] = &works[i];
+            mt(ws);
+          }
+
+          // 2nd: merge the bands
+          std::vector<icl8u> &edges = works[0].edges;
+          for(int t=1;t<nt;++t){
+            const int y = works[t].yStart;
+            evaluate_edges(a,crit,y,true,flags.data(),edges.data());
+            for(int x=0,i=y*w;x<w;++x,++i){
+              const icl8u e = edges[x];
+              if(e & 2) region_detector_tools::uf_union(parents.data(),i,i-w-1);
+              if(e & 4) region_detector_tools::uf_union(parents.data(),i,i-w);
+              if(e & 8) region_detector_tools::uf_union(parents.data(),i,i-w+1);
+            }
+          }
+
+          // 3rd: region sizes (roots always have smaller indices, so a single pass flattens the forest)
+          sizes.assign(dim,0);
+          for(int i=0;i<dim;++i){
+            if(flags[i]){
+              const int r = parents[parents[i]];
+              parents[i] = r;
+              ++sizes[r];
+            }
+          }
+
+          // 4th: regions are enumerated in the order of their first seed point (as in the flood fill),
+          //      labels contains the region index + 1 for each root (0: no seed found yet, -1: too small)
+          labels.assign(dim,0);
+          int numRegions = 0;
+          for(int i=0;i<dim;++i){
+            if((flags[i] & SEED) && !labels[parents[i]]){
+              labels[parents[i]] = (sizes[parents[i]] < (int)minSize) ? -1 : ++numRegions;
+            }
+          }
+          regions.resize(numRegions);
+          for(int i=0;i<dim;++i){
+            if(flags[i]){
+              const int r = parents[i];
+              if(labels[r] > 0){
+                std::vector<int> &reg = regions[labels[r]-1];
+                if(reg.empty()) reg.reserve(sizes[r]);
+                reg.push_back(i);
+                res[i] = startID + labels[r] - 1;
+                m[i] = true;
+              }
+            }
+          }
+        }
+
         template<class T, class DataT, int DIM, class Criterion>
         static void flood_fill(const RegionGrowerDataAccessor<T,DataT,DIM> &a, int xStart, int yStart, 
                                core::Channel8u &processed, Criterion crit, std::vector<int> &result,  core::Channel32s &result2, int id);
@@ -198,6 +409,10 @@ namespace icl{
                                
         template<class T, class DataT, int DIM, class Criterion>
         void region_grow(const T &data, core::Img8u &mask, core::Img32s &result, Criterion crit, const unsigned int minSize, const unsigned int startID=1){
+          if(parallel){
+            region_grow_parallel<T,DataT,DIM,Criterion>(data, mask, result, crit, minSize, startID);
+            return;
+          }
           RegionGrowerDataAccessor<T,DataT,DIM> a(data);
           
           core::Img8u processed = mask;
@@ -275,6 +490,77 @@ namespace icl{
         math::FixedColVector<float,4> operator()(int x, int y) const { return data(x,y); }
       };
         
+      inline void RegionGrower::evaluate_edges(const RegionGrowerDataAccessor<core::DataSegment<float,4>,float,4> &a,
+                                               Float4EuclideanDistance crit, int y, bool withUpperRow,
+                                               const icl8u *flags, icl8u *edges){
+#ifdef ICL_HAVE_SSE2
+        // the 4 neighbours are compared at once: the differences are transposed, so that each
+        // SSE lane computes (dx*dx + dy*dy) + dz*dz for one edge (in the same order as math::dist3)
+        const int w = a.w();
+        const icl8u *f = flags + y*w, *fu = f-w;
+        const int stride = a.data.getStride();
+        const icl8u *row = a.data.getDataPointer() + (size_t)y*w*stride, *rowu = row - w*stride;
+        const __m128 t = _mm_set1_ps(crit.t);
+        for(int x=0;x<w;++x){
+          if(!f[x]){
+            edges[x] = 0;
+            continue;
+          }
+          const int valid = (x > 0 && f[x-1]) | (withUpperRow ? ((x > 0 && fu[x-1]) << 1) | ((fu[x] != 0) << 2) |
+                                                                ((x < w-1 && fu[x+1]) << 3) : 0);
+          if(!valid){
+            edges[x] = 0;
+            continue;
+          }
+          const icl8u *pp = row + x*stride, *pu = rowu + x*stride;
+          const __m128 p = _mm_loadu_ps((const float*)pp);
+          // invalid neighbours are replaced by p itself (their edge bits are masked out anyway)
+          __m128 d0 = _mm_sub_ps(p, (valid & 1) ? _mm_loadu_ps((const float*)(pp-stride)) : p);
+          __m128 d1 = _mm_sub_ps(p, (valid & 2) ? _mm_loadu_ps((const float*)(pu-stride)) : p);
+          __m128 d2 = _mm_sub_ps(p, (valid & 4) ? _mm_loadu_ps((const float*)pu) : p);
+          __m128 d3 = _mm_sub_ps(p, (valid & 8) ? _mm_loadu_ps((const float*)(pu+stride)) : p);
+          _MM_TRANSPOSE4_PS(d0,d1,d2,d3);
+          const __m128 s = _mm_add_ps(_mm_add_ps(_mm_mul_ps(d0,d0),_mm_mul_ps(d1,d1)),_mm_mul_ps(d2,d2));
+          edges[x] = _mm_movemask_ps(_mm_cmplt_ps(_mm_sqrt_ps(s),t)) & valid;
+        }
+#else
+        evaluate_edges<core::DataSegment<float,4>,float,4,Float4EuclideanDistance>(a,crit,y,withUpperRow,flags,edges);
+#endif
+      }
+
+      inline void RegionGrower::evaluate_edges(const RegionGrowerDataAccessor<core::Img8u,icl8u,1> &a,
+                                               EqualThreshold crit, int y, bool withUpperRow,
+                                               const icl8u *flags, icl8u *edges){
+        const int w = a.w();
+        int x = 0;
+#ifdef ICL_HAVE_SSE2
+        // two pixels are connected if both are valid and both have the value t:
+        // the inner pixels of the row are processed in chunks of 16
+        if(crit.t >= 0 && crit.t <= 255){
+          const icl8u *v = &a.c(0,y), *vu = v-w;
+          const icl8u *f = flags + y*w, *fu = f-w;
+          const __m128i t = _mm_set1_epi8((char)crit.t), zero = _mm_setzero_si128();
+          const __m128i b1 = _mm_set1_epi8(1), b2 = _mm_set1_epi8(2), b4 = _mm_set1_epi8(4), b8 = _mm_set1_epi8(8);
+          for(x=1;x<w-16;x+=16){
+#define ICL_RG_EQ(V,F) _mm_andnot_si128(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(F)),zero), \
+                                        _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(V)),t))
+            const __m128i c = ICL_RG_EQ(v+x,f+x);
+            __m128i e = _mm_and_si128(ICL_RG_EQ(v+x-1,f+x-1),b1);
+            if(withUpperRow){
+              e = _mm_or_si128(e,_mm_and_si128(ICL_RG_EQ(vu+x-1,fu+x-1),b2));
+              e = _mm_or_si128(e,_mm_and_si128(ICL_RG_EQ(vu+x,fu+x),b4));
+              e = _mm_or_si128(e,_mm_and_si128(ICL_RG_EQ(vu+x+1,fu+x+1),b8));
+            }
+#undef ICL_RG_EQ
+            _mm_storeu_si128((__m128i*)(edges+x),_mm_and_si128(c,e));
+          }
+          // the first pixel (and the remaining ones below) are processed by the generic version
+          evaluate_edges<core::Img8u,icl8u,1,EqualThreshold>(a,crit,y,withUpperRow,flags,edges,0,1);
+        }
+#endif
+        evaluate_edges<core::Img8u,icl8u,1,EqualThreshold>(a,crit,y,withUpperRow,flags,edges,x,w);
+      }
+
       template<class T, class DataT, int DIM, class Criterion>
       void RegionGrower::flood_fill(const RegionGrowerDataAccessor<T,DataT,DIM> &a, int xStart, int yStart, 
                                core::Channel8u &processed, Criterion crit, std::vector<int> &result,  core::Channel32s &result2, int id){
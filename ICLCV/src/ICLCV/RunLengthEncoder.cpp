@@ -67,82 +67,49 @@ namespace icl{
     }
     
     template<class T>
-    void RunLengthEncoder::encode_internal(const Img<T> &image){
-      if(image.hasFullROI()){
-        // optimized version form images without ROI
-        const int W = image.getWidth();
-        const int H = image.getHeight();
-        
-        WLS *sldata = m_data.data(), *sls = 0;
-        
-        const T *p = image.begin(0);
-        const T *pEnd(0),*pLast(0),*pBegin(0);
-        T curr(0);
-        
-        for(int y=0;y<H;++y){
-          pBegin = p;    // pixel pointer to current image line begin
-          pEnd = p+W;    // pixel pointer to current image line end
-          curr = *p++;  
-          sls = sldata+y*W;
-          pLast = p-1;
-          while(true){//p<pEnd){
-            p = find_first_not(p,pEnd,curr);
-            sls->init((int)(pLast-pBegin), y,(int)(p-pBegin),curr); 
-            ++sls;
-            if(p == pEnd) break;
-            pLast = p;
-            curr = *p; 
-          }
-          m_ends[y] = sls;
-        }
-  
-  
-      }else{
-        
-        // ROI-version (slighly slower due to some overhead for roi-handling 
-        // and shifting of scanlines)
-        const Rect &roi = image.getROI();
-        
-        const int rx = roi.x;
-        const int ry = roi.y;
-        const int rw = roi.width;
-        const int rh = roi.height;
-        
-        WLS *sldata = m_data.data(), *sls = 0;
-        
-        const T *p = &*image.beginROI(0);
-        const T *pEnd(0),*pLast(0),*pBegin(0);
-        T curr(0);
-        
-        const int yEnd = ry+rh;
-        const int xStep = image.getWidth()-rw;
-        for(int y=ry;y<yEnd;++y){
-          pBegin = p;    // pixel pointer to current image line begin
-          pEnd = p+rw;   // pixel pointer to current image line end
-          curr = *p++;  
-          sls = sldata+rw*(y-ry);
-          pLast = p-1;
-          while(p<pEnd){
-            p = find_first_not(p,pEnd,curr);
-            sls->init(rx+(int)(pLast-pBegin), y,rx+(int)(p-pBegin),curr); 
-            ++sls;
-            curr = *p; 
-            pLast = p;
-          }
-          p += xStep;
-          m_ends[y-ry] = sls;
+    void RunLengthEncoder::encode_internal(const Img<T> &image, int firstRow, int endRow){
+      const Rect &roi = m_imageROI;
+      const int W = image.getWidth();
+      const T *data = image.getData(0);
+      
+      for(int y=firstRow;y<endRow;++y){
+        const T *pBegin = data + (roi.y+y)*W + roi.x; // pixel pointer to current image line begin
+        const T *pEnd = pBegin + roi.width;            // pixel pointer to current image line end
+        const T *pLast = pBegin;
+        const T *p = pBegin+1;
+        T curr = *pBegin;
+        WLS *sls = m_data.data() + y*roi.width;
+        while(true){
+          p = find_first_not(p,pEnd,curr);
+          sls->init(roi.x+(int)(pLast-pBegin), roi.y+y, roi.x+(int)(p-pBegin), curr); 
+          ++sls;
+          if(p == pEnd) break;
+          pLast = p;
+          curr = *p; 
         }
+        m_ends[y] = sls;
       }
     }
     
     void RunLengthEncoder::encode(const ImgBase *image){
-      ICLASSERT_THROW(image,ICLException(" RunLengthEncoder::encode :image is NULL"));
-  
+      prepare(image);
+      encodeRows(image,0,m_imageROI.height);
+    }
+
+    void RunLengthEncoder::prepare(const ImgBase *image){
+      ICLASSERT_THROW(image,ICLException(" RunLengthEncoder::prepare :image is NULL"));
+      
       resetLineSegments();
       prepare(image->getROI());
+    }
+    
+    void RunLengthEncoder::encodeRows(const ImgBase *image, int firstRow, int endRow){
+      ICLASSERT_THROW(image,ICLException(" RunLengthEncoder::encode :image is NULL"));
+      ICLASSERT_THROW(image->getROI() == m_imageROI, 
+                      ICLException(" RunLengthEncoder::encodeRows: prepare was not called for this image"));
       
       switch(image->getDepth()){
-  #define ICL_INSTANTIATE_DEPTH(D) case depth##D: encode_internal<icl##D>(*image->asImg<icl##D>());  break;
+  #define ICL_INSTANTIATE_DEPTH(D) case depth##D: encode_internal<icl##D>(*image->asImg<icl##D>(),firstRow,endRow);  break;
         ICL_INSTANTIATE_ALL_INT_DEPTHS;
   #undef ICL_INSTANTIATE_DEPTH
         default:
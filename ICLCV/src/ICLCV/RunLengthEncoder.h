@@ -74,15 +74,14 @@ namespace icl {
         the RunLengthEncoder is <b>not</b> able to process icl32f and icl64f images
   
         \section ROI ROI Support
-        The RunLengthEncoder provides ROI support. The internal encoding function is implemented
-        twice (with and without ROI handling) because handling of an images ROI entails a few
-        extra computation steps (e.g. shifting of line segments by roi offset).
+        The RunLengthEncoder provides ROI support. Line segment coordinates
+        are always given in image coordinates (i.e. they are shifted by the
+        roi offset).
         If an input image is used, that has a non-full ROI, the internal WorkingLineSegment
         buffer is optimized for that ROI size. Furthermore, the buffer containing the
         line end pointers will also be resized to the input images ROI-height. Therefore
         the given row-indices for the RunLengthEncoder::begin(int) and RunLengthEncoder::end(int)
         functions is always relative to the input images roi-offset.
-  
         <pre>
         image (size: 10x7, roi: (1,2)4x3)
         ..........
@@ -96,6 +95,13 @@ namespace icl {
         
   
         xstart, xend and y
+
+        \section PARALLEL Parallel Encoding
+        Image rows are encoded independently. In order to encode an image in several
+        threads, RunLengthEncoder::prepare(const core::ImgBase*) has to be called once,
+        and then each thread can encode a disjoint range of rows using
+        RunLengthEncoder::encodeRows. RunLengthEncoder::encode does exactly this for
+        all rows in the calling thread.
     */
     class ICLCV_API RunLengthEncoder{
       /// internal typedef
@@ -112,7 +118,7 @@ namespace icl {
   
       /// internal run-length-encoding template
       template<class T>
-      void encode_internal(const core::Img<T> &image);
+      void encode_internal(const core::Img<T> &image, int firstRow, int endRow);
   
       /// internal preparation function (automatically called)
       void prepare(const utils::Rect &roi);
@@ -124,6 +130,14 @@ namespace icl {
       
       /// main encoding function
       void encode(const core::ImgBase *image);
+
+      /// prepares the internal buffers for encoding the given image using encodeRows
+      void prepare(const core::ImgBase *image);
+
+      /// encodes only the rows firstRow, ..., endRow-1 (relative to the image ROI)
+      /** prepare(image) must have been called before. Calls for disjoint row ranges
+          can be performed in parallel */
+      void encodeRows(const core::ImgBase *image, int firstRow, int endRow);
       
       /// Returns a begin()-pointer for the first encoded image line
       /** row-indices are always relative to the image ROI's offset (see \ref ROI) */
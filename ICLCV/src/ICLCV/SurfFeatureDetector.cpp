@@ -30,9 +30,10 @@
 
 
 #include <ICLCV/SurfFeatureDetector.h>
+#include <ICLCV/NativeSurfLib.h>
+#include <ICLCV/DescriptorMatcher.h>
 #include <ICLCore/Img.h>
 #include <ICLCore/CCFunctions.h>
-#include <ICLUtils/Range.h>
 
 #ifdef ICL_HAVE_OPENCL
 #include <ICLCV/CLSurfLib.h>
@@ -56,6 +57,14 @@ namespace icl{
       std::vector<SurfFeature> currFeatures;
       std::vector<SurfMatch> currMatches;
       
+      DescriptorMatcher matcher;   //!< used for CPU-based matching
+      bool matcherDirty;           //!< if true, the reference features must be passed to the matcher
+      std::vector<DescriptorMatcher::Match> cpuMatches;
+
+      bool native_backend;
+      nativesurf::Surf native;
+      ImgBase *native_refimage;
+      
 #ifdef ICL_HAVE_OPENCV
       bool opensurf_backend;
       IplImage *opensurf_refimage;
@@ -92,7 +101,7 @@ namespace icl{
       int sampleStep;
       float threshold;
       
-      Data(){
+      Data():matcherDirty(true),native_backend(false),native_refimage(0){
 #ifdef ICL_HAVE_OPENCV
         opensurf_refimage = 0;
         opensurf_imagebuffer = 0;
@@ -109,6 +118,7 @@ namespace icl{
       }
       
       ~Data(){
+        ICL_DELETE(native_refimage);
 #ifdef ICL_HAVE_OPENCL
         ICL_DELETE(clsurf_refimage_backend);
         ICL_DELETE(clsurf_curimage_backend);
@@ -116,6 +126,17 @@ namespace icl{
       }
       
       void updateReferenceFeatures(){
+        matcherDirty = true;
+        if(native_backend){
+          native.setOctaves(octaves);
+          native.setIntervals(intervals);
+          native.setSampleStep(sampleStep);
+          native.setThreshold(threshold);
+          if(native_refimage){
+            refFeatures = native.detect(native_refimage);
+          }
+        }
+
 #ifdef ICL_HAVE_OPENCV
         if(opensurf_backend && opensurf_refimage){
           refFeatures.clear();
@@ -145,12 +166,8 @@ namespace icl{
 
     SurfFeatureDetector::SurfFeatureDetector(int octaves, int intervals, int sampleStep, 
                                              float threshold, const std::string &plugin){
-#if !defined(ICL_HAVE_OPENCV) && !defined(ICL_HAVE_OPENCL)
-      throw ICLException("Unable to create SurfFeatureDetector: no backend available");
-#endif
-      
-      if(plugin != "clsurf" && plugin != "opensurf" && plugin != "best"){
-        throw ICLException("Unable to create SurfFeatureDetector: invalid plugin name (allowed is clsurf, opensurf and best)");
+      if(plugin != "clsurf" && plugin != "opensurf" && plugin != "native" && plugin != "best"){
+        throw ICLException("Unable to create SurfFeatureDetector: invalid plugin name (allowed is clsurf, opensurf, native and best)");
       }
       
 #ifndef ICL_HAVE_OPENCV
@@ -179,16 +196,25 @@ namespace icl{
 
 
 #ifdef ICL_HAVE_OPENCV
-
-#ifdef ICL_HAVE_OPENCL
-      if(!m_data->clsurf_backend){
+      if(plugin == "opensurf"){
         m_data->opensurf_backend = true;
       }
-#else
-      m_data->opensurf_backend = true;
-#endif
 #endif
       
+      if(plugin == "native"){
+        m_data->native_backend = true;
+      }
+#ifdef ICL_HAVE_OPENCL
+      else if(plugin == "best" && !m_data->clsurf_backend){
+        m_data->native_backend = true;
+      }
+#else
+      else if(plugin == "best"){
+        m_data->native_backend = true;
+      }
+#endif
+      m_data->updateReferenceFeatures();
+
 
 #ifdef ICL_HAVE_OPENCL
       if(m_data->clsurf_backend){
@@ -250,15 +276,10 @@ namespace icl{
         }catch(ICLException &e){
           (void)e;
           if(plugin == "best"){
-#ifdef ICL_HAVE_OPENCV
             DEBUG_LOG("detected an error while initializing OpenCL backend [" + str(e.what()) + "]: using CPU-fallback");
-		    m_data->opensurf_backend = true;
+            m_data->native_backend = true;
             m_data->clsurf_backend = false;
-#else
-			  throw ICLException("Error creating Surf-feature detector: could "
-								 "neither instantiate OpenCL-backend nor use "
-								 "OpenCV-based opensurf-backend");
-#endif
+            m_data->updateReferenceFeatures();
           }else{
             throw;
           }
@@ -294,12 +315,21 @@ namespace icl{
 
 
 
+    void SurfFeatureDetector::setNumThreads(int numThreads){
+      m_data->native.setNumThreads(numThreads);
+      m_data->matcher.setNumThreads(numThreads);
+    }
+
     SurfFeatureDetector::~SurfFeatureDetector(){
       delete m_data;
     }
     
     const std::vector<SurfFeature> &SurfFeatureDetector::detect(const core::ImgBase *image){
       ICLASSERT_THROW(image,ICLException("SurfFeatureDetector::detect: given image was null"));
+      if(m_data->native_backend){
+        m_data->currFeatures = m_data->native.detect(image);
+        return m_data->currFeatures;
+      }
 #ifdef ICL_HAVE_OPENCV
       if(m_data->opensurf_backend){
         core::img_to_ipl(image,&m_data->opensurf_imagebuffer);
@@ -332,6 +362,10 @@ namespace icl{
 
     void SurfFeatureDetector::setReferenceImage(const core::ImgBase *image){
       ICLASSERT_THROW(image,ICLException("SurfFeatureDetector::setReferenceImage: given image was null"));
+      if(m_data->native_backend){
+        image->deepCopy(&m_data->native_refimage);
+        m_data->updateReferenceFeatures();
+      }
 #ifdef ICL_HAVE_OPENCV
       if(m_data->opensurf_backend){
         core::img_to_ipl(image,&m_data->opensurf_refimage);
@@ -445,30 +479,24 @@ namespace icl{
 #endif
 
 #ifdef ICL_HAVE_OPENCV
-      if(m_data->opensurf_backend){
-        for(size_t j=0;j<cur.size();++j){
-          float ds[2] = { Range32f::limits().maxVal, Range32f::limits().maxVal };
-          const SurfFeature &c = cur[j];
-          const SurfFeature *match  = 0;
-          for(size_t i=0;i<ref.size();++i){
-            const SurfFeature &r = ref[i];
-            float d = r - c;
-            if(d < ds[0]){
-              ds[1] = ds[0];
-              ds[0] = d;
-              match = &r;
-            }else if(d < ds[1]){
-              ds[1] = d;
-            }
-          }
-          if(ds[0]/ds[1] < significance){
-            matches.push_back(std::make_pair(c,*match));
-            matches.back().first.dx = match->x - c.x;
-            matches.back().first.dy = match->y - c.y;
-          }
+      const bool cpuMatching = m_data->native_backend || m_data->opensurf_backend;
+#else
+      const bool cpuMatching = m_data->native_backend;
+#endif
+      if(cpuMatching){
+        if(m_data->matcherDirty){
+          m_data->matcher.setTrainDescriptors(ref);
+          m_data->matcherDirty = false;
+        }
+        std::vector<DescriptorMatcher::Match> &ms = m_data->cpuMatches;
+        m_data->matcher.match(cur,ms,significance);
+        for(size_t i=0;i<ms.size();++i){
+          const SurfFeature &c = cur[ms[i].query], &r = ref[ms[i].train];
+          matches.push_back(std::make_pair(c,r));
+          matches.back().first.dx = r.x - c.x;
+          matches.back().first.dy = r.y - c.y;
         }
       }
-#endif
       return matches;
     }
   }
@@ -41,10 +41,12 @@ namespace icl{
   namespace cv{
     
       /// ICL's *New* Generic Surf Feature detection class
-      /** Internally, the class either uses the opensurf-based implementation
-          or an OpenCL-based implementation based on the clsurf library.
+      /** Internally, the class either uses the opensurf-based implementation,
+          an OpenCL-based implementation based on the clsurf library, or
+          ICL's native implementation (see nativesurf::Surf).
           The OpenSurf backend needs OpenCV, while the clsurf-backend
-          builds on mandatory OpenCL support.
+          builds on mandatory OpenCL support. The native backend is always
+          available.
       */
       class ICLCV_API SurfFeatureDetector {
         struct Data;  //!< hidden implementation
@@ -53,8 +55,8 @@ namespace icl{
         public:
     
         /// Constructor with given SURF detection parameters
-        /** plugin can be either "opensurf" or "clsurf" or "best",
-            which will prefer "clsurf" if possible */
+        /** plugin can be either "opensurf", "clsurf", "native" or "best",
+            which will prefer "clsurf" if possible and use "native" otherwise */
         SurfFeatureDetector(int octaves=5, int intervals=4, int sampleStep=2, 
                             float threshold = 0.00005f, 
                             const std::string &plugin="best");
@@ -75,6 +77,9 @@ namespace icl{
         const std::vector<SurfFeature> &getReferenceFeatures() const ;
         
         /// detections SURF features and matches them against the given reference features
+        /** A match is accepted if the ratio of the (squared) descriptor distances of the best
+            and the 2nd best reference feature is smaller than the given significance. Except
+            for the clsurf backend, matching is performed by a DescriptorMatcher */
         const std::vector<SurfMatch> &match(const core::ImgBase *image, float significance=0.65);
         
         void setOctaves(int octaves);
@@ -84,6 +89,9 @@ namespace icl{
         void setSampleStep(int sampleStep);
         
         void setThreshold(float threshold);
+
+        /// sets the number of threads used by the native backend and for CPU-based matching
+        void setNumThreads(int numThreads);
       };
 
   }
@@ -27,13 +27,21 @@
 ** Excellence Initiative.                                          **
 **                                                                 **
 ********************************************************************/
+
 #include <ICLCV/TemplateTracker.h>
 
+#ifdef ICL_HAVE_IPP
 #include <ICLFilter/ProximityOp.h>
+#endif
 #include <ICLFilter/RotateOp.h>
 //#include <ICLQt/Quick.h>
 #include <ICLIO/TestImages.h>
+#include <ICLUtils/MultiThreader.h>
+#include <ICLUtils/SSETypes.h>
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
 namespace icl{
   
@@ -42,12 +50,288 @@ namespace icl{
   using namespace filter;
   
   namespace cv{
+
+    namespace{
+
+      /// score of pruned candidates (lower than any real score)
+      static const float PRUNED = -std::numeric_limits<float>::max();
+
+      /// pyramid level of a template image
+      struct Pattern{
+        int w,h;
+        std::vector<icl8u> pix;
+        double sum, sqrSum;
+        std::vector<double> remSum, remSqrSum; //!< sums of the rows y,..,h-1 (h+1 entries)
+
+        void computeSums(){
+          remSum.assign(h+1,0);
+          remSqrSum.assign(h+1,0);
+          for(int y=h-1;y>=0;--y){
+            double s = 0, ss = 0;
+            for(int x=0;x<w;++x){
+              const int v = pix[x+y*w];
+              s += v;
+              ss += v*v;
+            }
+            remSum[y] = remSum[y+1] + s;
+            remSqrSum[y] = remSqrSum[y+1] + ss;
+          }
+          sum = remSum[0];
+          sqrSum = remSqrSum[0];
+        }
+      };
+
+      /// pyramid level of the search region (with integral images of the values and squared values)
+      struct Region{
+        int w,h;
+        std::vector<icl8u> pix;
+        std::vector<double> I, I2;
+
+        void computeIntegrals(){
+          I.assign((w+1)*(h+1),0);
+          I2.assign((w+1)*(h+1),0);
+          for(int y=0;y<h;++y){
+            double s = 0, ss = 0;
+            for(int x=0;x<w;++x){
+              const int v = pix[x+y*w];
+              s += v;
+              ss += v*v;
+              I[(x+1)+(y+1)*(w+1)] = I[(x+1)+y*(w+1)] + s;
+              I2[(x+1)+(y+1)*(w+1)] = I2[(x+1)+y*(w+1)] + ss;
+            }
+          }
+        }
+
+        inline double rectSum(const std::vector<double> &ii, int x, int y, int rw, int rh) const{
+          const int W = w+1;
+          return ii[(x+rw)+(y+rh)*W] - ii[x+(y+rh)*W] - ii[(x+rw)+y*W] + ii[x+y*W];
+        }
+      };
+
+      /// 2x2 box filter and sub-sampling
+      static void reduce(const icl8u *src, int w, int h, std::vector<icl8u> &dst){
+        const int dw = w/2, dh = h/2;
+        dst.resize(dw*dh);
+        for(int y=0;y<dh;++y){
+          const icl8u *a = src + 2*y*w, *b = a + w;
+          icl8u *d = dst.data() + y*dw;
+          for(int x=0;x<dw;++x){
+            d[x] = (a[2*x] + a[2*x+1] + b[2*x] + b[2*x+1] + 2) >> 2;
+          }
+        }
+      }
+
+      /// sum of absolute differences of two rows
+      static inline int row_sad(const icl8u *a, const icl8u *b, int n){
+        int x = 0, s = 0;
+#ifdef ICL_HAVE_SSE2
+        __m128i acc = _mm_setzero_si128();
+        for(;x+16<=n;x+=16){
+          acc = _mm_add_epi64(acc,_mm_sad_epu8(_mm_loadu_si128((const __m128i*)(a+x)),
+                                               _mm_loadu_si128((const __m128i*)(b+x))));
+        }
+        s = _mm_cvtsi128_si32(acc) + _mm_cvtsi128_si32(_mm_srli_si128(acc,8));
+#endif
+        for(;x<n;++x){
+          s += std::abs(a[x]-b[x]);
+        }
+        return s;
+      }
+
+      /// dot product of two rows
+      static inline int row_dot(const icl8u *a, const icl8u *b, int n){
+        int x = 0, s = 0;
+#ifdef ICL_HAVE_SSE2
+        const __m128i z = _mm_setzero_si128();
+        __m128i acc = _mm_setzero_si128();
+        for(;x+16<=n;x+=16){
+          const __m128i va = _mm_loadu_si128((const __m128i*)(a+x));
+          const __m128i vb = _mm_loadu_si128((const __m128i*)(b+x));
+          acc = _mm_add_epi32(acc,_mm_madd_epi16(_mm_unpacklo_epi8(va,z),_mm_unpacklo_epi8(vb,z)));
+          acc = _mm_add_epi32(acc,_mm_madd_epi16(_mm_unpackhi_epi8(va,z),_mm_unpackhi_epi8(vb,z)));
+        }
+        acc = _mm_add_epi32(acc,_mm_srli_si128(acc,8));
+        acc = _mm_add_epi32(acc,_mm_srli_si128(acc,4));
+        s = _mm_cvtsi128_si32(acc);
+#endif
+        for(;x<n;++x){
+          s += a[x]*b[x];
+        }
+        return s;
+      }
+
+      /// score (NCC or 1-normalized SAD) of the pattern at top-left position (x,y) in the region
+      /** If prune is true, the evaluation is stopped as soon as the score can not become
+          larger than best (PRUNED is returned then) */
+      static float evaluate(const Region &r, const Pattern &p, int x, int y, bool ncc, bool prune, float best){
+        const int n = p.w*p.h;
+        const icl8u *img = r.pix.data() + x + y*r.w;
+        if(!ncc){
+          const double maxSAD = (1.0-best)*255.0*n;
+          double sad = 0;
+          for(int j=0;j<p.h;++j){
+            sad += row_sad(img+j*r.w,p.pix.data()+j*p.w,p.w);
+            if(prune && sad > maxSAD) return PRUNED;
+          }
+          return 1.0 - sad/(255.0*n);
+        }
+        const double SI = r.rectSum(r.I,x,y,p.w,p.h);
+        const double varI = n*r.rectSum(r.I2,x,y,p.w,p.h) - SI*SI;
+        const double varT = n*p.sqrSum - p.sum*p.sum;
+        if(varI <= 0 || varT <= 0) return 0;
+        const double den = ::sqrt(varI*varT);
+        const double muT = p.sum/n;
+        double SIT = 0;
+        for(int j=0;j<p.h;++j){
+          SIT += row_dot(img+j*r.w,p.pix.data()+j*p.w,p.w);
+          if(prune && (j&3) == 3 && j+1 < p.h){
+            // upper bound for the remaining rows (Cauchy-Schwarz on the mean-free parts)
+            const int k = j+1, nr = (p.h-k)*p.w;
+            const double SIk = r.rectSum(r.I,x,y,p.w,k);
+            const double SIr = SI - SIk, SIIr = r.rectSum(r.I2,x,y+k,p.w,p.h-k);
+            const double STr = p.remSum[k], varTr = p.remSqrSum[k] - STr*STr/nr;
+            const double varIr = SIIr - SIr*SIr/nr;
+            const double bound = (SIT - muT*SIk) + SIr/nr*(STr - nr*muT)
+                               + ::sqrt(iclMax(varIr,0.0)*iclMax(varTr,0.0));
+            if(n*bound/den < best - 1e-6) return PRUNED;
+          }
+        }
+        return (n*SIT - SI*p.sum)/den;
+      }
+
+      /// search candidate
+      struct Candidate{
+        int angle, offset, x, y; //!< lut index, its offset to the last angle and top-left position
+        float score;
+        bool operator<(const Candidate &c) const { return score > c.score; }
+      };
+    }
   
     struct TemplateTracker::Data{
       ImgBase *buf;
+#ifdef ICL_HAVE_IPP
       SmartPtr<ProximityOp> prox;
+#endif
       std::vector<SmartPtr<Img8u> > lut;
       TemplateTracker::Result lastResult;
+
+      /// work package: searches a subset of the angles at the top pyramid level
+      struct Work : public MultiThreader::Work{
+        Data *data;
+        int index, n;
+        virtual void perform(){
+          for(unsigned int i=index;i<data->candidates.size();i+=n){
+            data->searchTopLevel(data->candidates[i]);
+          }
+        }
+      };
+
+      std::vector<std::vector<Pattern> > patterns; //!< [lut index][level]
+      int patternLevels;                           //!< number of levels patterns were created for
+      std::vector<Region> regions;                 //!< search region pyramid
+      std::vector<Candidate> candidates;           //!< one per coarse angle
+      bool ncc, prune;
+      MultiThreader mt;
+      std::vector<Work> works;
+
+      Data():buf(0),patternLevels(0){}
+
+      void createPatterns(int levels){
+        patterns.resize(lut.size());
+        for(unsigned int i=0;i<lut.size();++i){
+          const Img8u &t = *lut[i];
+          std::vector<Pattern> &ps = patterns[i];
+          ps.resize(levels);
+          ps[0].w = t.getWidth();
+          ps[0].h = t.getHeight();
+          ps[0].pix.assign(t.begin(0),t.end(0));
+          for(int l=1;l<levels;++l){
+            ps[l].w = ps[l-1].w/2;
+            ps[l].h = ps[l-1].h/2;
+            reduce(ps[l-1].pix.data(),ps[l-1].w,ps[l-1].h,ps[l].pix);
+          }
+          for(int l=0;l<levels;++l) ps[l].computeSums();
+        }
+        patternLevels = levels;
+      }
+
+      void createRegions(const Img8u &image, const Rect &r, int levels){
+        regions.resize(levels);
+        Region &r0 = regions[0];
+        r0.w = r.width;
+        r0.h = r.height;
+        r0.pix.resize(r.width*r.height);
+        for(int y=0;y<r.height;++y){
+          const icl8u *src = image.begin(0) + r.x + (r.y+y)*image.getWidth();
+          std::copy(src,src+r.width,r0.pix.begin()+y*r.width);
+        }
+        for(int l=1;l<levels;++l){
+          regions[l].w = regions[l-1].w/2;
+          regions[l].h = regions[l-1].h/2;
+          reduce(regions[l-1].pix.data(),regions[l-1].w,regions[l-1].h,regions[l].pix);
+        }
+        if(ncc){
+          for(int l=0;l<levels;++l) regions[l].computeIntegrals();
+        }
+      }
+
+      /// searches all positions of the top level for the given candidate's angle
+      /** The search starts at the candidate's position (the last position) */
+      void searchTopLevel(Candidate &c){
+        const Region &r = regions.back();
+        const Pattern &p = patterns[c.angle].back();
+        c.score = evaluate(r,p,c.x,c.y,ncc,false,0);
+        for(int y=0;y+p.h<=r.h;++y){
+          for(int x=0;x+p.w<=r.w;++x){
+            const float s = evaluate(r,p,x,y,ncc,prune,c.score);
+            if(s > c.score){
+              c.score = s;
+              c.x = x;
+              c.y = y;
+            }
+          }
+        }
+      }
+
+      /// searches the positions in [x0,x1]x[y0,y1] of the given level
+      void searchLocal(Candidate &c, int level, int x0, int y0, int x1, int y1, bool keepScore){
+        const Region &r = regions[level];
+        const Pattern &p = patterns[c.angle][level];
+        x0 = iclMax(x0,0);
+        y0 = iclMax(y0,0);
+        x1 = iclMin(x1,r.w-p.w);
+        y1 = iclMin(y1,r.h-p.h);
+        if(!keepScore) c.score = PRUNED;
+        for(int y=y0;y<=y1;++y){
+          for(int x=x0;x<=x1;++x){
+            const float s = evaluate(r,p,x,y,ncc,prune && c.score != PRUNED,c.score);
+            if(s > c.score){
+              c.score = s;
+              c.x = x;
+              c.y = y;
+            }
+          }
+        }
+      }
+
+      void run(int nt){
+        if(nt > 1 && (mt.isNull() || mt.getNumThreads() != nt)){
+          mt = MultiThreader(nt);
+        }
+        works.resize(nt);
+        for(int i=0;i<nt;++i){
+          works[i].data = this;
+          works[i].index = i;
+          works[i].n = nt;
+        }
+        if(nt == 1){
+          works[0].perform();
+          return;
+        }
+        MultiThreader::WorkSet ws(nt);
+        for(int i=0;i<nt;++i) ws[i] = &works[i];
+        mt(ws);
+      }
     };
   
   
@@ -58,8 +342,9 @@ namespace icl{
                                      int coarseSteps,int fineSteps,
                                      const Result &initialResult){
       data = new Data;
-      data->buf = 0;
+#ifdef ICL_HAVE_IPP
       data->prox = new ProximityOp(ProximityOp::crossCorrCoeff);
+#endif
       data->lastResult = initialResult;
       
       addProperty("tracking.position range","range","[1,1000]:1",positionTrackingRangePix,0,
@@ -77,11 +362,29 @@ namespace icl{
                   "step count. The rotation search window size devided\n"
                   "the amount of steps define the angle resolution.");
       addProperty("tracking.fine steps","range:spinbox","[1,100000]:1",fineSteps,0,
-                  "Parameter for coarse to fine search\n"
-                  "(not supported yet)");
-  
+                  "Angle resolution (in rotation LUT entries) of the\n"
+                  "coarse-to-fine angle refinement at full resolution.");
+#ifdef ICL_HAVE_IPP
+      addProperty("tracking.mode","menu","coarse-to-fine,ipp exhaustive","coarse-to-fine",0,
+                  "Search strategy: coarse-to-fine is the native pyramid\n"
+                  "based search; ipp exhaustive scores all angles in full\n"
+                  "resolution using the ProximityOp.");
+#endif
+      addProperty("tracking.score","menu","ncc,sad","ncc",0,
+                  "Match score used by the coarse-to-fine search: normalized\n"
+                  "cross correlation or (normalized) sum of absolute differences");
+      addProperty("tracking.pyramid levels","range:spinbox","[1,6]","3",0,
+                  "Number of pyramid levels of the coarse-to-fine search\n"
+                  "(limited by the template size)");
+      addProperty("tracking.early termination","flag","",true,0,
+                  "Stop scoring candidates that can not become better than\n"
+                  "the current best one (the result does not change)");
+      addProperty("number of threads","range:spinbox","[1,64]","1",0,
+                  "Number of threads the rotation hypotheses are distributed to");
+
+#ifdef ICL_HAVE_IPP
       addChildConfigurable(data->prox.get(),"proximity");
-  
+#endif
       
       if(templateImage){
         setTemplateImage(*templateImage,rotationStepSizeDegree);
@@ -101,8 +404,9 @@ namespace icl{
       const int w = templateImage.getWidth();
       const int h = templateImage.getHeight();
       data->lut.clear();
+      data->patternLevels = 0;
       
-      for(float a=0;a<=360;a+=rotationStepSizeDegree){
+      for(float a=0;a<360;a+=rotationStepSizeDegree){
         rot.setAngle(a);
         const Img8u *r = rot.apply(&templateImage)->as8u();
         const int rw = r->getWidth();
@@ -118,7 +422,12 @@ namespace icl{
     }
   
     void TemplateTracker::setRotationLUT(const std::vector<SmartPtr<Img8u> > &lut){
+      for(unsigned int i=1;i<lut.size();++i){
+        ICLASSERT_THROW(lut[i]->getSize() == lut[0]->getSize(),
+                        ICLException("TemplateTracker::setRotationLUT: all LUT images must have the same size"));
+      }
       data->lut = lut;
+      data->patternLevels = 0;
     }
   
     void TemplateTracker::showRotationLUT() const{
@@ -160,45 +469,116 @@ namespace icl{
       if(last.pos == Point32f(-1,-1)){
         last.pos = Point(image.getWidth()/2,image.getHeight()/2); 
       }
+      ICLASSERT_THROW(data->lut.size(),ICLException("TemplateTracker::track: no template image given"));
       
       const double angle = last.angle;
       const int X = last.pos.x;
       const int Y = last.pos.y;
       const int lutSize = (int)data->lut.size();
-      const int angleIndex = angle / (2*M_PI) * (lutSize-1);
+      const int angleIndex = ((int)round(angle / (2*M_PI) * lutSize) % lutSize + lutSize) % lutSize;
       const int ROI = getPropertyValue("tracking.position range");
       const float rotationRange = getPropertyValue("tracking.rotation range");
       const int step1 = getPropertyValue("tracking.coarse steps");
-      //const int step2 = getPropertyValue("tracking.fine steps");
-      //const float angleStepSize = 360./lutSize;
-  
-      const Rect roi(X - ROI/2, Y-ROI/2, ROI, ROI);
-      
-      SmartPtr<const Img8u> roiImageTmp = image.shallowCopy(roi);
-      SmartPtr<Img8u> roiImage = roiImageTmp->deepCopyROI();
-  
+      const int step2 = getPropertyValue("tracking.fine steps");
+      const float angleStepSize = 2*M_PI/lutSize;
       const int stepRadius = lutSize * rotationRange/720;
-  
-      Result bestResult = last;
-      for(int i = -stepRadius; i <= stepRadius; i+= step1){
-        int curIndex = angleIndex + i;
-        while(curIndex >= lutSize) curIndex -= lutSize;
-        while(curIndex < 0) curIndex += lutSize;
-        
-        data->prox->apply(roiImage.get(),data->lut.at(curIndex).get(),&data->buf);
+      const Size t = data->lut[0]->getSize();
+
+#ifdef ICL_HAVE_IPP
+      if(getPropertyValue("tracking.mode").as<std::string>() == "ipp exhaustive"){
+        const Rect roi = (Rect(X - ROI/2 - t.width/2, Y - ROI/2 - t.height/2, ROI + t.width, ROI + t.height)
+                          & image.getImageRect());
+        SmartPtr<const Img8u> roiImageTmp = image.shallowCopy(roi);
+        SmartPtr<Img8u> roiImage = roiImageTmp->deepCopyROI();
+    
+        Result bestResult = last;
+        bestResult.proximityValue = PRUNED;
+        for(int i = -stepRadius; i <= stepRadius; i+= step1){
+          const int curIndex = ((angleIndex + i) % lutSize + lutSize) % lutSize;
+          
+          data->prox->apply(roiImage.get(),data->lut.at(curIndex).get(),&data->buf);
+          
+          Point maxPos;
+          float maxValue = data->buf->getMax(0,&maxPos);
         
-        Point maxPos;
-        float maxValue = data->buf->getMax(0,&maxPos);
-      
-        Result curr(maxPos+last.pos,
-                    (float(curIndex)/lutSize) * 2 * M_PI, 
-                    maxValue,
-                    data->lut.at(curIndex).get());
-        if(curr.proximityValue > bestResult.proximityValue){
-          bestResult = curr;
+          Result curr(Point32f(maxPos.x + roi.x + t.width/2, maxPos.y + roi.y + t.height/2),
+                      curIndex * angleStepSize,
+                      maxValue,
+                      data->lut.at(curIndex).get());
+          if(curr.proximityValue > bestResult.proximityValue){
+            bestResult = curr;
+          }
+          if(allResults) allResults->push_back(curr);
+        }
+        data->lastResult = bestResult;
+        return bestResult;
+      }
+#endif
+
+      // search region: all template positions, whose center is within the position range
+      const Rect region = Rect(X - ROI/2 - t.width/2, Y - ROI/2 - t.height/2,
+                               ROI + t.width, ROI + t.height) & image.getImageRect();
+      if(region.width < t.width || region.height < t.height){
+        return last;
+      }
+
+      int levels = getPropertyValue("tracking.pyramid levels");
+      while(levels > 1 && ((t.width >> (levels-1)) < 4 || (t.height >> (levels-1)) < 4)) --levels;
+      if(data->patternLevels != levels) data->createPatterns(levels);
+      data->ncc = getPropertyValue("tracking.score").as<std::string>() == "ncc";
+      data->prune = getPropertyValue("tracking.early termination");
+      data->createRegions(image,region,levels);
+
+      // top level: exhaustive position search for each coarse angle (in parallel)
+      const int top = levels-1;
+      const Point p0((X - t.width/2 - region.x) >> top, (Y - t.height/2 - region.y) >> top);
+      const Region &rt = data->regions[top];
+      const Pattern &pt = data->patterns[0][top];
+      std::vector<Candidate> &cs = data->candidates;
+      cs.clear();
+      for(int i = -stepRadius; i <= stepRadius; i+= step1){
+        Candidate c = { ((angleIndex + i) % lutSize + lutSize) % lutSize, i,
+                        iclMax(0,iclMin(p0.x,rt.w-pt.w)), iclMax(0,iclMin(p0.y,rt.h-pt.h)), 0 };
+        cs.push_back(c);
+      }
+      data->run(iclMax(1,iclMin((int)cs.size(),getPropertyValue("number of threads").as<int>())));
+
+      if(allResults){
+        for(unsigned int i=0;i<cs.size();++i){
+          allResults->push_back(Result(Point32f(region.x + (cs[i].x << top) + t.width/2,
+                                                region.y + (cs[i].y << top) + t.height/2),
+                                       cs[i].angle * angleStepSize, cs[i].score,
+                                       data->lut[cs[i].angle].get()));
+        }
+      }
+
+      // refine the best hypotheses through the pyramid levels
+      std::vector<Candidate> best = cs;
+      std::sort(best.begin(),best.end());
+      best.resize(iclMin((int)best.size(),3));
+      for(int l=top-1;l>=0;--l){
+        for(unsigned int i=0;i<best.size();++i){
+          Candidate &c = best[i];
+          data->searchLocal(c,l,2*c.x-1,2*c.y-1,2*c.x+2,2*c.y+2,false);
         }
-        if(allResults) allResults->push_back(curr);
       }
+      Candidate c = *std::min_element(best.begin(),best.end());
+
+      // angle refinement at full resolution (within the rotation range)
+      for(int s=step1/2; s >= step2 && s > 0; s/=2){
+        const Candidate center = c;
+        for(int sign=-1;sign<=1;sign+=2){
+          Candidate d = center;
+          d.offset = center.offset + sign*s;
+          if(std::abs(d.offset) > stepRadius) continue;
+          d.angle = ((angleIndex + d.offset) % lutSize + lutSize) % lutSize;
+          data->searchLocal(d,0,center.x-1,center.y-1,center.x+1,center.y+1,false);
+          if(d.score > c.score) c = d;
+        }
+      }
+
+      Result bestResult(Point32f(region.x + c.x + t.width/2, region.y + c.y + t.height/2),
+                        c.angle * angleStepSize, c.score, data->lut[c.angle].get());
       data->lastResult = bestResult;
       return bestResult;
     }
@@ -207,4 +587,3 @@ namespace icl{
     
   } // namespace cv
 }
-
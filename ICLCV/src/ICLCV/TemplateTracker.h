@@ -38,7 +38,36 @@ namespace icl{
   
   
     /// Utility class vor viewbased template tracking
-    /** TODO: add more documentation! */
+    /** The TemplateTracker tracks the position and the orientation of a template image.
+        Internally, a look-up table of rotated template images is used (see setTemplateImage
+        and setRotationLUT). In each step, the template is searched for within a square region
+        ("tracking.position range") around the last position and within an angle range
+        ("tracking.rotation range") around the last orientation.
+
+        \section C2F Coarse-to-Fine Search
+        By default, a pyramid based coarse-to-fine search is used:
+        - the search region and the rotated templates are down-sampled by factors of 2
+          ("tracking.pyramid levels", the rotated template pyramids are created only once)
+        - at the coarsest level, all positions are evaluated for each "tracking.coarse steps"-th
+          rotation LUT entry. These rotation hypotheses are distributed to
+          "number of threads" threads
+        - the 3 best hypotheses are refined at each finer level by searching a 4x4 neighbourhood
+          of the up-scaled position
+        - finally, the angle is refined at full resolution by a bisection down to an angular
+          resolution of "tracking.fine steps" LUT entries
+
+        Candidates are scored using the normalized cross correlation (ncc, using integral images
+        for the image statistics) or the sum of absolute differences (sad, the proximityValue
+        is 1-SAD/(255*number of pixels) then). Both are computed row by row using SSE2
+        (_mm_madd_epi16 and _mm_sad_epu8). If "tracking.early termination" is set, the evaluation
+        of a candidate is aborted, as soon as an upper bound for its score (the SAD so far or, for
+        the ncc, the correlation so far plus a Cauchy-Schwarz bound for the remaining rows) is
+        worse than the best score so far. This does not change the result.
+
+        If ICL is compiled with IPP support, "tracking.mode" can also be set to "ipp exhaustive",
+        which scores all positions for all coarse angles at full resolution using the ProximityOp.
+
+        The resulting position is always the position of the template center in the image. */
     class ICLCV_API TemplateTracker : public utils::Configurable, public utils::Uncopyable{
       struct Data; //!< internal data storage
       Data *data;  //!< internal data pointer
@@ -60,7 +89,13 @@ namespace icl{
       };
   
       /// Constructor with given parameters
-      /** TODO: describe parameters and methology */
+      /** @param templateImage optional template image (see setTemplateImage)
+          @param rotationStepSizeDegree angle step of the rotation look-up table
+          @param positionTrackingRangePix initial value for the property "tracking.position range"
+          @param rotationTrackingRangeDegree initial value for the property "tracking.rotation range"
+          @param coarseSteps initial value for the property "tracking.coarse steps"
+          @param fineSteps initial value for the property "tracking.fine steps"
+          @param initialResult initial tracking state */
       TemplateTracker(const core::Img8u *templateImage=0,
                       float rotationStepSizeDegree=1.0,
                       int positionTrackingRangePix=100, 
@@ -76,6 +111,7 @@ namespace icl{
       void showRotationLUT() const;
       
       /// sets a new set or rotated template images
+      /** The images must have the same size and must cover 360 degrees in equidistant steps */
       void setRotationLUT(const std::vector<utils::SmartPtr<core::Img8u> > &lut);
       
       /// sets a new template image, that is internally rotated
@@ -87,6 +123,8 @@ namespace icl{
                             float rotationStepSizeDegree=1.0);
       
       /// actual track method
+      /** If allResults is given, the best top-level result of each coarse rotation hypothesis
+          is added */
       Result track(const core::Img8u &image, const Result *initialResult=0,
                    std::vector<Result> *allResults=0);
   
@@ -31,10 +31,12 @@
 #include <ICLCV/VectorTracker.h>
 #include <ICLCV/Extrapolator.h>
 #include <ICLCV/HungarianAlgorithm.h>
+#include <ICLCV/JonkerVolgenantAlgorithm.h>
 #include <ICLUtils/Exception.h>
 #include <ICLMath/DynMatrix.h>
 
 #include <set>
+#include <algorithm>
 #include <limits>
 
 using namespace icl::utils;
@@ -269,7 +271,7 @@ namespace icl{
         VTMat(dim),tryOpt(tryOpt),nextID(0),idMode(idMode),
         thresh(distanceThreshold),largeVal(largeVal),
         normFactors(normFactors),extrapolationMask(dim,true),
-        distanceFunction(df),dfIsQualityFunction(dfIsQualityFunction){
+        distanceFunction(df),dfIsQualityFunction(dfIsQualityFunction),gateRadius(0),costOfNonAssignment(-1){
         
         bool all1 = true;
         for(unsigned int i=0;i<normFactors.size();++i){
@@ -297,6 +299,73 @@ namespace icl{
       VectorTracker::DistanceFunction distanceFunction;
       bool dfIsQualityFunction;
       Array2D<float> lastDistMat;
+      float gateRadius;
+      float costOfNonAssignment;
+      std::vector<float> lastCosts; // costs (or qualities) of the last sparse assignment
+      
+      /// sparse assignment using gating in the first two dimensions (returns HungarianAlgorithm-like result)
+      std::vector<int> sparseAssignment(const std::vector<Vec> &newData){
+        typedef JonkerVolgenantAlgorithm<float> JV;
+        const int newNum = (int)newData.size();
+        std::vector<Point32f> ns(newNum), ps(height);
+        for(int i=0;i<newNum;++i){
+          ns[i] = Point32f(newData[i][0], dim > 1 ? newData[i][1] : 0);
+        }
+        for(int y=0;y<height;++y){
+          ps[y] = Point32f(pred(y)[0], dim > 1 ? pred(y)[1] : 0);
+        }
+        std::vector<JV::Entry> entries;
+        JV::gate(ns,ps,gateRadius,entries);
+
+        const bool quality = distanceFunction && dfIsQualityFunction;
+        const bool pearson = !distanceFunction && (int)normFactors.size() == dim;
+        PearsonDist pearsonDist(normFactors);
+        float maxCost = 0;
+        for(unsigned int i=0;i<entries.size();++i){
+          const Vec &a = newData[entries[i].row], &b = pred(entries[i].col);
+          if(distanceFunction){
+            entries[i].cost = quality ? -distanceFunction(a,b) : distanceFunction(a,b);
+          }else{
+            entries[i].cost = pearson ? pearsonDist(a,b) : sqrt_eucl_dist(a,b);
+          }
+          maxCost = iclMax(maxCost,entries[i].cost);
+        }
+        float a = costOfNonAssignment;
+        if(a < 0) a = quality ? 0 : maxCost/2;
+        std::vector<int> rowAssignment, colAssignment;
+        JV::solve(newNum,height,entries,a,rowAssignment,colAssignment);
+
+        lastCosts.assign(newNum,largeVal);
+        for(unsigned int i=0;i<entries.size();++i){
+          if(rowAssignment[entries[i].row] == entries[i].col){
+            lastCosts[entries[i].row] = quality ? -entries[i].cost : entries[i].cost;
+          }
+        }
+
+        // entries without partner within the gating radius are paired at minimum costs
+        // (as the dense version would do)
+        std::vector<int> rows, cols;
+        JV::getUnassigned(rowAssignment,colAssignment,rows,cols);
+        Array2D<float> leftoverCosts(rows.size(),cols.size());
+        for(unsigned int i=0;i<rows.size();++i){
+          for(unsigned int j=0;j<cols.size();++j){
+            const Vec &n = newData[rows[i]], &p = pred(cols[j]);
+            if(distanceFunction){
+              leftoverCosts(i,j) = quality ? -distanceFunction(n,p) : distanceFunction(n,p);
+            }else{
+              leftoverCosts(i,j) = pearson ? pearsonDist(n,p) : sqrt_eucl_dist(n,p);
+            }
+          }
+        }
+        std::vector<int> r = JV::toSquareAssignment(rowAssignment,colAssignment,leftoverCosts);
+        for(unsigned int i=0;i<rows.size();++i){
+          if(r[rows[i]] < height){
+            const int j = std::find(cols.begin(),cols.end(),r[rows[i]]) - cols.begin();
+            lastCosts[rows[i]] = quality ? -leftoverCosts(i,j) : leftoverCosts(i,j);
+          }
+        }
+        return r;
+      }
       
       virtual void notifyIDLoss(int id){
         // DEBUG_LOG("notify id loss: " << id << "(idsMask.size is " << idMask.size() << ")");
@@ -431,9 +500,12 @@ namespace icl{
       }
       
       m_data->predict(m_data->extrapolationMask);
+      const bool sparse = m_data->gateRadius > 0;
       Array2D<float> &distMat = m_data->lastDistMat;
       bool useCostMatrix = true;
-      if(m_data->distanceFunction){
+      if(sparse){
+        m_data->ass = m_data->sparseAssignment(newData);
+      }else if(m_data->distanceFunction){
         distMat = m_data->createDistanceMatrix(newData,m_data->distanceFunction,m_data->largeVal);
         useCostMatrix = !m_data->dfIsQualityFunction;
       }else if((int)m_data->normFactors.size() == m_data->dim){
@@ -444,7 +516,7 @@ namespace icl{
         }
         distMat = m_data->createDistanceMatrix(newData,sqrt_eucl_dist,m_data->largeVal);
       }
-      if(diff){
+      if(diff && !sparse){
         m_data->ass = HungarianAlgorithm<float>::apply(distMat,useCostMatrix);
         // otherwise this is deferred to after trivial assignmnent check
       }
@@ -484,7 +556,9 @@ namespace icl{
         //DEBUG_LOG("[[[newNum == oldNum case]]]");
         std::vector<Vec> orderedNewData(newNum);
         try{
-          if(m_data->tryOpt && m_data->thresh >= 0){
+          if(sparse){
+            // assignment has already been computed
+          }else if(m_data->tryOpt && m_data->thresh >= 0){
             int assigned = 0;
             std::fill(m_data->ass.begin(),m_data->ass.end(),-1);
             for(int n=0;n<newNum;++n){
@@ -529,7 +603,11 @@ namespace icl{
         }
         int id = m_data->ids.at(ass);
         if(lastErrorOrScore){
-          *lastErrorOrScore = m_data->lastDistMat(ass,id); // or perhaps, the other way around!
+          if(m_data->gateRadius > 0){
+            *lastErrorOrScore = m_data->lastCosts.at(index);
+          }else{
+            *lastErrorOrScore = m_data->lastDistMat(ass,id); // or perhaps, the other way around!
+          }
         }
         return id;
       }else{
@@ -549,6 +627,12 @@ namespace icl{
     const std::vector<bool> &VectorTracker::getExtrapolationMask() const{
       return m_data->extrapolationMask;
     }
+
+    void VectorTracker::setSparseAssignment(float gateRadius, float costOfNonAssignment){
+      ICLASSERT_RETURN(!isNull());
+      m_data->gateRadius = gateRadius;
+      m_data->costOfNonAssignment = costOfNonAssignment;
+    }
     
   
   } // namespace cv
@@ -128,6 +128,22 @@ namespace icl{
       
       /// returns current extrapolation mask
       const std::vector<bool> &getExtrapolationMask() const;
+
+      /// enables the sparse assignment using the JonkerVolgenantAlgorithm
+      /** If gateRadius is larger than 0, the distance function is only evaluated for
+          pairs of predictions and new data entries whose first two dimensions (e.g. x and y)
+          are closer than gateRadius (found using a regular grid over the predictions).
+          The resulting sparse assignment problem is solved with the JonkerVolgenantAlgorithm,
+          which is much faster than the default Hungarian algorithm for large numbers of entries.
+          Leaving a prediction or a new entry unassigned costs costOfNonAssignment. If this is
+          negative, half of the largest distance of all gated pairs is used (so that any gated
+          pair is at least as good as leaving both entries unassigned). If the distance function
+          is a quality function, the negative qualities are used as costs (and the default
+          costOfNonAssignment is 0). Predictions and new entries that remain unassigned are
+          paired at minimum costs afterwards (as in the dense version). Note: In this mode, the
+          trivial assignment test is not used.
+          A gateRadius <= 0 restores the default (dense) assignment */
+      void setSparseAssignment(float gateRadius, float costOfNonAssignment=-1);
       
       private:
       
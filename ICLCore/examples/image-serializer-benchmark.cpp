@@ -0,0 +1,109 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLCore/examples/image-serializer-benchmark.cpp        **
+** Module : ICLCore                                                **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#include <ICLCore/Img.h>
+#include <ICLCore/ImageSerializer.h>
+#include <ICLUtils/Time.h>
+#include <ICLUtils/StringUtils.h>
+#include <cstdio>
+
+using namespace icl;
+using namespace icl::utils;
+using namespace icl::core;
+
+// returns the throughput in MB/s for the given number of Bytes and time
+static double mbps(size_t bytes, const Time &dt, int n){
+  return (double(bytes)*n/(1<<20)) / dt.toSecondsDouble();
+}
+
+// returns a 64 Byte aligned pointer into the given buffer
+static icl8u *aligned(std::vector<icl8u> &buf, int size){
+  buf.resize(size + ImageSerializer::PAYLOAD_ALIGNMENT);
+  size_t p = (size_t)buf.data();
+  size_t a = ImageSerializer::PAYLOAD_ALIGNMENT;
+  return buf.data() + (a - p % a) % a;
+}
+
+template<class T>
+static void bench(const Size &size, int n){
+  Img<T> image(size,formatRGB);
+  for(int c=0;c<image.getChannels();++c){
+    for(int i=0;i<image.getDim();++i) image.getData(c)[i] = T(i%255);
+  }
+  image.setMetaData("some meta data");
+  
+  std::vector<icl8u> legacy;
+  std::vector<icl8u> headerBuffer, alignedBuffer;
+  ImageSerializer::SegmentList segments;
+  icl8u *dst = aligned(alignedBuffer,ImageSerializer::estimateAlignedSerializedSize(&image));
+  ImgBase *out = 0;
+  size_t bytes = ImageSerializer::estimateImageDataSize(&image);
+  
+  Time t = Time::now();
+  for(int i=0;i<n;++i) ImageSerializer::serialize(&image,legacy);
+  double sLegacy = mbps(bytes,Time::now()-t,n);
+
+  t = Time::now();
+  for(int i=0;i<n;++i) ImageSerializer::deserialize(legacy.data(),&out);
+  double dLegacy = mbps(bytes,Time::now()-t,n);
+
+  t = Time::now();
+  for(int i=0;i<n;++i) ImageSerializer::serializeAligned(&image,dst);
+  double sAligned = mbps(bytes,Time::now()-t,n);
+
+  t = Time::now();
+  for(int i=0;i<n;++i) ImageSerializer::serializeSegments(&image,headerBuffer,segments);
+  double sSegments = mbps(bytes,Time::now()-t,n);
+
+  t = Time::now();
+  for(int i=0;i<n;++i) ImageSerializer::deserialize(dst,&out);
+  double dAligned = mbps(bytes,Time::now()-t,n);
+
+  t = Time::now();
+  for(int i=0;i<n;++i) ImageSerializer::wrapAligned(dst,&out);
+  double dWrapped = mbps(bytes,Time::now()-t,n);
+  
+  std::printf("%-9s %5dx%-5d | %10.0f %10.0f | %10.0f %10.0f | %10.0f %10.0f\n",
+              str(getDepth<T>()).c_str(), size.width, size.height,
+              sLegacy, dLegacy, sAligned, dAligned, sSegments, dWrapped);
+  delete out;
+}
+
+int main(){
+  std::printf("throughput in MB/s (channel data only)\n");
+  std::printf("                      |      v1 serialization |   aligned (copying)   |  aligned (zero copy)\n");
+  std::printf("depth     size        |  serialize deserialize|  serialize deserialize|   segments       wrap\n");
+  const Size sizes[] = { Size::QVGA, Size::VGA, Size::HD720, Size::HD1080, Size(3840,2160) };
+  for(int i=0;i<5;++i){
+    int n = std::max(10,(int)(1e9/(sizes[i].getDim()*12)));
+    bench<icl8u>(sizes[i],n);
+    bench<icl32f>(sizes[i],n);
+  }
+}
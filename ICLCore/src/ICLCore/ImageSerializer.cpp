@@ -30,6 +30,8 @@
 
 #include <ICLCore/ImageSerializer.h>
 #include <ICLUtils/StringUtils.h>
+#include <ICLCore/Img.h>
+#include <limits>
 
 using namespace icl::utils;
 
@@ -58,6 +60,60 @@ namespace icl{
           return *this;
         }
       };
+
+      /// static block of zeros, referenced by padding segments
+      const icl8u ZERO_PADDING[ImageSerializer::PAYLOAD_ALIGNMENT] = {0};
+
+      inline int align_up(int n){
+        const int A = ImageSerializer::PAYLOAD_ALIGNMENT;
+        return ((n + A - 1) / A) * A;
+      }
+
+      /// data length as signed value ((size_t)-1 is used for unchecked data)
+      inline icl64s length_limit(size_t len){
+        return len > (size_t)std::numeric_limits<icl64s>::max() ? std::numeric_limits<icl64s>::max() : (icl64s)len;
+      }
+
+      /// parsed version of the aligned header
+      struct AlignedHeader{
+        icl32s magic, version, d, w, h, fmt, channels, rx, ry, rw, rh;
+        int64_t t;
+        icl32s metaLen, dataOffset, channelStride;
+
+        AlignedHeader(const icl8u *data){
+          BinaryUnserializer ser(data);
+          ser >> magic >> version >> d >> w >> h >> fmt >> channels
+              >> rx >> ry >> rw >> rh >> t >> metaLen >> dataOffset >> channelStride;
+          if(magic != ImageSerializer::ALIGNED_FORMAT_MAGIC || version != ImageSerializer::ALIGNED_FORMAT_VERSION){
+            throw ICLException("ImageSerializer: data is not in the aligned wire format");
+          }
+          if(d < 0 || d > depthLast || channels < 0 || w < 0 || h < 0){
+            throw ICLException("ImageSerializer: invalid aligned header");
+          }
+        }
+
+        /// ensures that meta data and all channels are within the first len Bytes of the data
+        void check(size_t dataLength) const{
+          const icl64s len = length_limit(dataLength);
+          const icl64s headerSize = ImageSerializer::getAlignedHeaderSize();
+          const icl64s channelSize = icl64s(w) * h * getSizeOf((depth)d);
+          if(fmt < 0 || fmt > formatLast || metaLen < 0 || dataOffset < 0 || channelStride < channelSize
+             || headerSize + metaLen > len 
+             || (channels && dataOffset + icl64s(channels) * channelStride > len)){
+            throw ICLException("ImageSerializer: aligned header does not match the data length");
+          }
+        }
+      };
+
+      template<class T>
+      void wrap_channels(icl8u *data, const AlignedHeader &h, ImgBase **dst){
+        std::vector<T*> channels(h.channels);
+        for(int i=0;i<h.channels;++i){
+          channels[i] = (T*)(data + h.dataOffset + i*h.channelStride);
+        }
+        ImgBase *base = ensureDepth(dst,getDepth<T>());
+        *base->asImg<T>() = Img<T>(Size(h.w,h.h),h.channels,(format)h.fmt,channels,false);
+      }
     }
     
     
@@ -128,8 +184,31 @@ namespace icl{
     }
     
     void ImageSerializer::deserialize(const icl8u *data, ImgBase **dst) throw (ICLException){
+      deserialize(data,(size_t)-1,dst);
+    }
+
+    void ImageSerializer::deserialize(const icl8u *data, size_t len, ImgBase **dst) throw (ICLException){
       ICLASSERT_THROW(dst,ICLException(str(__FUNCTION__)+": destination ImgBase** was null"));
-      ICLASSERT_THROW(dst,ICLException(str(__FUNCTION__)+": source data pinter was null"));
+      ICLASSERT_THROW(data,ICLException(str(__FUNCTION__)+": source data pinter was null"));
+      ICLASSERT_THROW(len >= (size_t)getHeaderSize() + sizeof(icl32s) && len >= (size_t)getAlignedHeaderSize(),
+                      ICLException(str(__FUNCTION__)+": data is too short"));
+
+      if(getFormatVersion(data) == ALIGNED_FORMAT_VERSION){
+        const AlignedHeader h(data);
+        h.check(len);
+        ImgBase *image = ensureCompatible(dst,depth(h.d),Size(h.w,h.h),h.channels,(format)h.fmt,Rect(h.rx,h.ry,h.rw,h.rh));
+        image->setTime(Time(h.t));
+        const int lengthPerChannel = image->getDim() * getSizeOf(image->getDepth());
+        for(int i=0;i<image->getChannels();++i){
+          memcpy(image->getDataPtr(i),data + h.dataOffset + i*h.channelStride,lengthPerChannel);
+        }
+        if(h.metaLen){
+          image->getMetaData().assign((const char*)data + getAlignedHeaderSize(), h.metaLen);
+        }else{
+          image->clearMetaData();
+        }
+        return;
+      }
       
       BinaryUnserializer ser(data);
       
@@ -139,6 +218,11 @@ namespace icl{
         ser >> is[i];
       }
       ser >> l;
+      if(is[0] < 0 || is[0] > depthLast || is[1] < 0 || is[2] < 0 || is[3] < 0 || is[3] > formatLast || is[4] < 0
+         || getHeaderSize() + icl64s(is[1]) * is[2] * is[4] * getSizeOf((depth)is[0]) + (icl64s)sizeof(icl32s) > length_limit(len)){
+        throw ICLException(str(__FUNCTION__)+": header does not match the data length");
+      }
+      const icl8u *begin = data;
       data += getHeaderSize();
   
       ensureCompatible(dst,depth(is[0]),Size(is[1],is[2]),is[4],(format)is[3],Rect(is[5],is[6],is[7],is[8]));
@@ -154,8 +238,11 @@ namespace icl{
         }
       }
       
-      int metaLen = *(icl32s*)data;
+      int metaLen = *(const icl32s*)data;
       data+= sizeof(icl32s);
+      if(metaLen < 0 || metaLen > length_limit(len) - (data - begin)){
+        throw ICLException(str(__FUNCTION__)+": meta data length does not match the data length");
+      }
       if(metaLen){
         (*dst)->getMetaData().assign((char*)data, metaLen);
       }else{
@@ -169,7 +256,125 @@ namespace icl{
     }
   
     Time ImageSerializer::deserializeTimeStamp(const icl8u *data) throw (ICLException){
+      if(getFormatVersion(data) == ALIGNED_FORMAT_VERSION){
+        return Time(*(const int64_t*)(data+11*sizeof(icl32s)));
+      }
       return Time(*(const int64_t*)(data+9*sizeof(icl32s)));
     }
+
+
+    const icl32s ImageSerializer::ALIGNED_FORMAT_MAGIC;
+    const icl32s ImageSerializer::ALIGNED_FORMAT_VERSION;
+    const int ImageSerializer::PAYLOAD_ALIGNMENT;
+
+    int ImageSerializer::getFormatVersion(const icl8u *data) throw (ICLException){
+      ICLASSERT_THROW(data,ICLException(str(__FUNCTION__)+": data was null"));
+      const icl32s *is = (const icl32s*)data;
+      if(is[0] == ALIGNED_FORMAT_MAGIC) return is[1];
+      return 1;
+    }
+
+    int ImageSerializer::getAlignedHeaderSize(){
+      return PAYLOAD_ALIGNMENT;
+    }
+
+    int ImageSerializer::getAlignedChannelStride(const ImgBase *image) throw (ICLException){
+      ICLASSERT_THROW(image,ICLException(str(__FUNCTION__)+": image was null"));
+      return align_up(image->getDim() * getSizeOf(image->getDepth()));
+    }
+
+    int ImageSerializer::estimateAlignedSerializedSize(const ImgBase *image, bool skipMetaData) throw (ICLException){
+      ICLASSERT_THROW(image,ICLException(str(__FUNCTION__)+": image was null"));
+      int metaLen = skipMetaData ? 0 : (int)image->getMetaData().length();
+      return getAlignedHeaderSize() + align_up(metaLen) + image->getChannels() * getAlignedChannelStride(image);
+    }
+
+    void ImageSerializer::serializeSegments(const ImgBase *image, std::vector<icl8u> &headerBuffer,
+                                            SegmentList &segments, bool skipMetaData) throw (ICLException){
+      ICLASSERT_THROW(image,ICLException(str(__FUNCTION__)+": image was null"));
+      const int metaLen = skipMetaData ? 0 : (int)image->getMetaData().length();
+      const int dataOffset = getAlignedHeaderSize() + align_up(metaLen);
+      const int channelStride = getAlignedChannelStride(image);
+      const int payload = image->getDim() * getSizeOf(image->getDepth());
+
+      BinarySerializer ser;
+      ser << ALIGNED_FORMAT_MAGIC
+          << ALIGNED_FORMAT_VERSION
+          << (icl32s)image->getDepth()
+          << (icl32s)image->getSize().width
+          << (icl32s)image->getSize().height
+          << (icl32s)image->getFormat()
+          << (icl32s)image->getChannels()
+          << (icl32s)image->getROI().x
+          << (icl32s)image->getROI().y
+          << (icl32s)image->getROI().width
+          << (icl32s)image->getROI().height
+          << (int64_t)image->getTime().toMicroSeconds()
+          << (icl32s)metaLen
+          << (icl32s)dataOffset
+          << (icl32s)channelStride;
+      ser.resize(getAlignedHeaderSize(),0);
+      if(metaLen){
+        std::copy(image->getMetaData().begin(), image->getMetaData().end(), std::back_inserter(ser));
+        ser.resize(dataOffset,0);
+      }
+      headerBuffer.swap(ser);
+
+      segments.clear();
+      segments.reserve(1 + 2*image->getChannels());
+      Segment head = { headerBuffer.data(), headerBuffer.size() };
+      segments.push_back(head);
+      for(int i=0;i<image->getChannels();++i){
+        Segment s = { image->getDataPtr(i), (size_t)payload };
+        segments.push_back(s);
+        if(channelStride > payload){
+          Segment pad = { ZERO_PADDING, (size_t)(channelStride - payload) };
+          segments.push_back(pad);
+        }
+      }
+    }
+
+    void ImageSerializer::serializeAligned(const ImgBase *image, icl8u *dst,
+                                           bool skipMetaData) throw (ICLException){
+      ICLASSERT_THROW(dst,ICLException(str(__FUNCTION__)+": destination data was null"));
+      std::vector<icl8u> headerBuffer;
+      SegmentList segments;
+      serializeSegments(image,headerBuffer,segments,skipMetaData);
+      for(unsigned int i=0;i<segments.size();++i){
+        memcpy(dst,segments[i].data,segments[i].size);
+        dst += segments[i].size;
+      }
+    }
+
+    void ImageSerializer::serializeAligned(const ImgBase *image, std::vector<icl8u> &data,
+                                           bool skipMetaData) throw (ICLException){
+      data.resize(estimateAlignedSerializedSize(image,skipMetaData));
+      serializeAligned(image,data.data(),skipMetaData);
+    }
+
+    void ImageSerializer::wrapAligned(icl8u *data, ImgBase **dst) throw (ICLException){
+      wrapAligned(data,(size_t)-1,dst);
+    }
+
+    void ImageSerializer::wrapAligned(icl8u *data, size_t len, ImgBase **dst) throw (ICLException){
+      ICLASSERT_THROW(dst,ICLException(str(__FUNCTION__)+": destination ImgBase** was null"));
+      ICLASSERT_THROW(data,ICLException(str(__FUNCTION__)+": source data pointer was null"));
+      ICLASSERT_THROW(len >= (size_t)getAlignedHeaderSize(), ICLException(str(__FUNCTION__)+": data is too short"));
+      const AlignedHeader h(data);
+      h.check(len);
+      switch(h.d){
+#define ICL_INSTANTIATE_DEPTH(D) case depth##D: wrap_channels<icl##D>(data,h,dst); break;
+        ICL_INSTANTIATE_ALL_DEPTHS;
+#undef ICL_INSTANTIATE_DEPTH
+      }
+      ImgBase *image = *dst;
+      image->setROI(Rect(h.rx,h.ry,h.rw,h.rh));
+      image->setTime(Time(h.t));
+      if(h.metaLen){
+        image->getMetaData().assign((const char*)data + getAlignedHeaderSize(), h.metaLen);
+      }else{
+        image->clearMetaData();
+      }
+    }
   } // namespace core
 }
@@ -61,6 +61,36 @@ namespace icl{
         [size][Meta-Data]
         <-4 -><- size  ->
         </pre>
+
+        \section ALIGNED Aligned Wire Format (Version 2)
+        The format above (version 1) requires all channel data to be copied
+        into one contiguous block, and the channel data within a serialized
+        block has arbitrary alignment. The versioned aligned format allows
+        for zero-copy transfer: each channel payload starts at an offset that
+        is a multiple of 64 Bytes (PAYLOAD_ALIGNMENT), so that a serialized block
+        that is itself 64-Byte aligned (e.g. a shared memory segment or a
+        buffer allocated with posix_memalign) can directly be wrapped as an
+        image using wrapAligned.
+        <pre>
+        Whole-Image:
+        [Header-Block][Meta-Data][pad][Channel-0-Data][pad][Channel-1-Data][pad] ...
+        <- 64 Bytes ->                <---------- channel stride -------->
+        </pre>
+        <pre>
+        Header-Block:
+        [magic][version][depth][width][height][format][channels][roi.x][roi.y][roi.width][roi.height][time-stamp][meta-size][data-offset][channel-stride]
+        <- 4 -><-  4  -><- 4 -><- 4 -><- 4  -><- 4  -><-   4  -><- 4 -><- 4 -><-   4   -><-   4    -><-    8   -><-   4   -><-    4    -><-     4      ->
+        </pre>
+        In contrast to version 1, the time stamp is stored in microseconds.
+        The magic number is chosen such that it can not be mistaken for the
+        depth entry of a version 1 header, so deserialize and
+        deserializeTimeStamp accept both formats.
+
+        serializeSegments creates an iovec-like list of Segments that reference
+        the image's channel data directly. Only the header, the meta data and
+        the padding are provided by a small extra buffer. The segment list can
+        be passed to writev/sendmsg or to zmq multipart messages, or
+        gathered into a target buffer by serializeAligned.
     */
     struct ICLCore_API ImageSerializer{
       
@@ -91,9 +121,76 @@ namespace icl{
       
       /// deserializes an image (and optionally also the meta-data) from given icl8u data block
       static void deserialize(const icl8u *data, ImgBase **dst) throw (utils::ICLException);
+
+      /// length-checked version of deserialize
+      /** The header is read only once and all sizes it contains are checked against the
+          given data length before anything else is read, so that inconsistent or
+          corrupted data (e.g. a shared memory block that is overwritten concurrently)
+          leads to an ICLException instead of an invalid memory access */
+      static void deserialize(const icl8u *data, size_t len, ImgBase **dst) throw (utils::ICLException);
   
-      /// extracts only an images TimeStamp from it's serialized form
+      /// extracts only an images TimeStamp from it's serialized form (both versions)
       static utils::Time deserializeTimeStamp(const icl8u *data) throw (utils::ICLException);
+
+
+      /// magic number that identifies the aligned wire format
+      static const icl32s ALIGNED_FORMAT_MAGIC = 0x324c4349; // "ICL2" in little endian byte order
+
+      /// current version of the aligned wire format
+      static const icl32s ALIGNED_FORMAT_VERSION = 2;
+
+      /// alignment of header, meta data block and channel payloads (in Bytes)
+      static const int PAYLOAD_ALIGNMENT = 64;
+
+      /// single reference to a memory block (binary compatible to POSIX struct iovec)
+      struct Segment{
+        const void *data; //!< start of the memory block
+        size_t size;      //!< length of the memory block in Bytes
+      };
+
+      /// list of Segments, that have to be concatenated to obtain the serialized image
+      typedef std::vector<Segment> SegmentList;
+
+      /// returns the format version of the given serialized image (1 or 2)
+      static int getFormatVersion(const icl8u *data) throw (utils::ICLException);
+
+      /// returns the size of the aligned header block (in Bytes)
+      static int getAlignedHeaderSize();
+
+      /// returns the distance between two channel payloads in the aligned format
+      static int getAlignedChannelStride(const ImgBase *image) throw (utils::ICLException);
+
+      /// estimates the full size of an image serialized in the aligned format
+      static int estimateAlignedSerializedSize(const ImgBase *image, bool skipMetaData=false) throw (utils::ICLException);
+
+      /// serializes an image into a list of segments without copying the channel data
+      /** The header, the meta data and all padding are written into the given
+          headerBuffer, which must stay alive (and unchanged) as long as
+          the segments are used. Payload segments point to the image's
+          channel data directly. Padding segments refer to a static block of
+          zeros. The concatenation of all segments is exactly
+          estimateAlignedSerializedSize(image,skipMetaData) Bytes long. */
+      static void serializeSegments(const ImgBase *image, std::vector<icl8u> &headerBuffer,
+                                    SegmentList &segments, bool skipMetaData=false) throw (utils::ICLException);
+
+      /// serializes an image in the aligned format into given destination data (which has to be long enough)
+      static void serializeAligned(const ImgBase *image, icl8u *dst,
+                                   bool skipMetaData=false) throw (utils::ICLException);
+
+      /// serializes an image in the aligned format into given vector (the vector size is adapted automatically)
+      static void serializeAligned(const ImgBase *image, std::vector<icl8u> &data,
+                                   bool skipMetaData=false) throw (utils::ICLException);
+
+      /// wraps an image serialized in the aligned format without copying the channel data
+      /** The resulting image's channels are not owned by the image, they
+          point into the given data block, which must therefore outlive the image
+          (and all its shallow copies). If the data block is 64-Byte aligned,
+          all channels are 64-Byte aligned as well. The image header and
+          meta data are copied. *dst is adapted to the serialized image's depth. */
+      static void wrapAligned(icl8u *data, ImgBase **dst) throw (utils::ICLException);
+
+      /// length-checked version of wrapAligned (see the length-checked deserialize)
+      static void wrapAligned(icl8u *data, size_t len, ImgBase **dst) throw (utils::ICLException);
   
     };
   } // namespace core
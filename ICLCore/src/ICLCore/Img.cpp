@@ -156,6 +156,7 @@ namespace icl {
     {
       FUNCTION_LOG("this: " << this);
       m_vecChannels = tSrc.m_vecChannels;
+      m_bCopyOnWrite = tSrc.m_bCopyOnWrite;
       setTime(tSrc.getTime());
       setMetaData(tSrc.getMetaData());
     }
@@ -220,6 +221,9 @@ namespace icl {
       //---- Assign new channels to Img ----
       m_oParams = tSrc.getParams ();
       m_vecChannels = tSrc.m_vecChannels;
+
+      // an image that is in copy-on-write mode stays in it
+      m_bCopyOnWrite = m_bCopyOnWrite || tSrc.m_bCopyOnWrite;
   
       //take over timestamp
       this->setTime(tSrc.getTime());
@@ -476,7 +480,7 @@ namespace icl {
       //---- Make the whole Img independent ----
       for(int i=getStartIndex(iIndex),iEnd=getEndIndex(iIndex);i<iEnd;i++){
         if(m_vecChannels[i].use_count() > 1){
-          m_vecChannels[i] = createChannel (getData(i));
+          m_vecChannels[i] = createChannel (m_vecChannels[i].get());
         }
       }
     }
@@ -90,6 +90,22 @@ namespace icl {
           is copied deeply into the new created data pointer
           **/
       utils::SmartArray<Type> createChannel(Type *ptDataToCopy=0) const;
+
+      /// detaches shared channels if the copy-on-write mode is enabled
+      /** This is called before every non-const data access. If the
+          image is in copy-on-write mode, each selected channel (all if
+          iIndex is -1) that is shared with other images is replaced by
+          a deep copy, and the global implicit detach counter is
+          incremented. */
+      inline void copyOnWrite(int iIndex){
+        if(!m_bCopyOnWrite || iIndex >= getChannels()) return;
+        for(int i=getStartIndex(iIndex),iEnd=getEndIndex(iIndex);i<iEnd;++i){
+          if(m_vecChannels[i].use_count() > 1){
+            m_vecChannels[i] = createChannel(m_vecChannels[i].get());
+            countImplicitDetach();
+          }
+        }
+      }
   
       /// returns the start index for a channel loop
       /** In some functions to cases must be regarded:
@@ -370,6 +386,7 @@ namespace icl {
           @param iChannel channel index
           **/
       Type& operator()(int iX, int iY, int iChannel) {
+        copyOnWrite(iChannel);
         return const_cast<Type&>(static_cast<const Img<Type>*>(this)->operator()(iX,iY,iChannel)); 
       }
       
@@ -385,12 +402,13 @@ namespace icl {
           </code>
       */
       inline PixelRef<Type> operator()(int x, int y){
+        copyOnWrite(-1);
         return PixelRef<Type>(x,y,getWidth(),m_vecChannels);
       }
   
       /// as above, but const 
       inline const PixelRef<Type> operator()(int x, int y) const{
-        return const_cast<Img<Type>*>(this)->operator()(x,y);
+        return PixelRef<Type>(x,y,getWidth(),const_cast<std::vector<utils::SmartArray<Type> >&>(m_vecChannels));
       }
       
       /// extracts an image channel 
@@ -469,7 +487,10 @@ namespace icl {
       /// extracts all image channels at once into given channel pointer (const)
       /** Plese note that the given dst-pointer must also be const */
       inline void extractChannels(const Channel<Type> *dst) const{
-        return const_cast<Img<Type>*>(this)->extractChannels(const_cast<Channel<Type>*>(dst));
+        ICLASSERT_RETURN(dst);
+        for(int i=0;i<getChannels();++i){
+          const_cast<Channel<Type>*>(dst)[i] = (*this)[i];
+        }
       }
   
       /// extracts all data pointers into given destination pointer
@@ -862,6 +883,7 @@ namespace icl {
           @return data origin pointer to the specified channel 
       */
       Type* getData(int iChannel) { 
+        copyOnWrite(iChannel);
         return const_cast<Type*>(static_cast<const Img<Type>*>(this)->getData(iChannel));
       }
       
@@ -894,6 +916,7 @@ namespace icl {
           @return roi data pointer
       **/
       Type* getROIData(int iChannel) {
+        copyOnWrite(iChannel);
         return const_cast<Type*>(static_cast<const Img<Type>*>(this)->getROIData(iChannel));
       }
   
@@ -916,6 +939,7 @@ namespace icl {
           @return data pointer with notional ROI offset p
           **/
       Type* getROIData(int iChannel, const utils::Point &p) {
+        copyOnWrite(iChannel);
         return const_cast<Type*>(static_cast<const Img<Type>*>(this)->getROIData(iChannel, p));
       } 
       /// returns the data pointer to a pixel with defined offset (const)
@@ -1413,7 +1437,7 @@ namespace icl {
       
       /// returns the image iterator (equal to getData(channel)) (const)
       inline const_iterator begin(int channel) const{
-        return const_cast<Img<Type>*>(this)->begin(channel);
+        return getData(channel);
       }
   
       /// returns the image end-iterator (equal to getData(channel)+getDim())
@@ -1435,7 +1459,7 @@ namespace icl {
       /// returns the iterator for an images ROI (const)
       inline const_roi_iterator beginROI(int channel) const{
         ICLASSERT_RETURN_VAL(validChannel(channel), roi_iterator());
-        return const_cast<Img<Type>*>(this)->beginROI(channel);
+        return const_roi_iterator(const_cast<Type*>(getData(channel)),getWidth(),getROI());
       } 
       
       /// returns the end-iterator for an images ROI
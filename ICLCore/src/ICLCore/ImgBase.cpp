@@ -31,6 +31,7 @@
 #include <ICLCore/ImgBase.h>
 #include <ICLCore/Img.h>
 #include <ICLUtils/StringUtils.h>
+#include <ICLUtils/Mutex.h>
 
 using namespace icl::utils;
 using namespace icl::math;
@@ -38,7 +39,28 @@ using namespace icl::math;
 namespace icl {
   namespace core{
     
-    ImgBase::ImgBase(depth d, const ImgParams &params):m_oParams(params),m_eDepth(d) { }
+    ImgBase::ImgBase(depth d, const ImgParams &params):
+      m_oParams(params),m_eDepth(d),m_bCopyOnWrite(false) { }
+
+    namespace{
+      Mutex implicit_detach_mutex;
+      int implicit_detach_count = 0;
+    }
+
+    int ImgBase::getImplicitDetachCount(){
+      Mutex::Locker lock(implicit_detach_mutex);
+      return implicit_detach_count;
+    }
+
+    void ImgBase::resetImplicitDetachCount(){
+      Mutex::Locker lock(implicit_detach_mutex);
+      implicit_detach_count = 0;
+    }
+
+    void ImgBase::countImplicitDetach(){
+      Mutex::Locker lock(implicit_detach_mutex);
+      ++implicit_detach_count;
+    }
     
     ImgBase::~ImgBase(){
       FUNCTION_LOG("");
@@ -619,6 +619,33 @@ namespace icl {
           iIndex is -1 (default) all channels are detached
           **/
       virtual void detach(int iIndex = -1)=0;
+
+      /// enables or disables the copy-on-write mode of this image
+      /** By default, images are shallow copied and it is up to the user to
+          call detach() before writing into channels that might be shared with
+          other images. In copy-on-write mode, each non-const data access
+          (Img<T>::getData, Img<T>::getROIData, Img<T>::begin, pixel access
+          operators, getDataPtr, ...) on a channel that is currently shared
+          with other images implicitly detaches that very channel before the
+          data pointer is returned. Channels that are not shared are never
+          copied, so defensive deepCopy or detached() calls become obsolete.
+
+          The copy-on-write flag is passed on to shallow copies of the image.
+          Each implicit channel detach is counted globally (see
+          getImplicitDetachCount()) */
+      void setCopyOnWrite(bool on) { m_bCopyOnWrite = on; }
+
+      /// returns whether the copy-on-write mode is enabled
+      bool isCopyOnWrite() const { return m_bCopyOnWrite; }
+
+      /// returns the number of implicit channel detaches caused by copy-on-write images
+      /** The counter is global and shared by all images of all depths.
+          It can be used to verify that removing defensive copies does not
+          lead to a large number of implicit ones. */
+      static int getImplicitDetachCount();
+
+      /// resets the global implicit detach counter to 0
+      static void resetImplicitDetachCount();
   
       /// Removes a specified channel.
       /** If a non-matrix format image looses a channel,
@@ -881,6 +908,9 @@ namespace icl {
   
       /// Creates an ImgBase object with specified image parameters 
       ImgBase(depth d, const ImgParams& params);
+
+      /// increments the global implicit detach counter (thread-safe)
+      static void countImplicitDetach();
   
       /// all image params
       /** the params class consists of 
@@ -899,6 +929,9 @@ namespace icl {
   
       /// additional information associated with this image
       std::string m_metaData;
+
+      /// copy-on-write flag (see setCopyOnWrite)
+      bool m_bCopyOnWrite;
     };
   
     /// puts a string representation of the image into given steam
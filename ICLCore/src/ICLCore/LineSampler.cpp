@@ -29,6 +29,7 @@
 ********************************************************************/
 
 #include <ICLCore/LineSampler.h>
+#include <ICLCore/Img.h>
 
 namespace icl{
   
@@ -275,5 +276,229 @@ namespace icl{
                                                    m_br.size()?m_br.data():0,pl);
     }
 
+    namespace{
+
+      /// number of points of the line a->b (without bounding rect)
+      inline int line_length(const Point &a, const Point &b){
+        return iclMax(std::abs(a.x-b.x),std::abs(a.y-b.y))+1;
+      }
+
+      /// closed form Bresenham
+      /** After i steps along the major axis, the Bresenham algorithm has increased the
+          minor coordinate k_i = (2*i*dy + dx) / (2*dx) times. Computing k_i directly
+          removes the loop-carried error term, so each point can be computed
+          independently. Steepness and order handling are identical to
+          bresenham_internal_generic_level_0, so the results are the same. The sink
+          is called with (index, x, y) for every point in a->b order; the number of
+          points within the bounds is returned */
+      template<bool useBR, class Sink>
+      inline int dda_line_internal(int x0, int y0, int x1, int y1, const int br[4], Sink &sink){
+        const bool steep = std::abs(y1 - y0) > std::abs(x1 - x0);
+        if(steep){
+          std::swap(x0, y0);
+          std::swap(x1, y1);
+        }
+        const bool inv = x0 > x1;
+        if(inv){
+          std::swap(x0, x1);
+          std::swap(y0, y1);
+        }
+        const int dx = x1 - x0, dy2 = 2*std::abs(y1 - y0), dx2 = iclMax(2*dx,1);
+        const int ystep = y0 < y1 ? 1 : -1, n = dx+1;
+        int m = 0;
+        for(int j=0;j<n;++j){
+          const int i = inv ? dx-j : j;
+          const int u = x0 + i, v = y0 + ystep * ((i*dy2 + dx)/dx2);
+          const int x = steep ? v : u, y = steep ? u : v;
+          if(bounds_check<useBR>(x,y,br)){
+            sink(m++,x,y);
+          }
+        }
+        return m;
+      }
+
+      template<class Sink>
+      inline int dda_line(const Point &a, const Point &b, const int br[4], Sink &sink){
+        if(br && !(bounds_check<true>(a.x,a.y,br) && bounds_check<true>(b.x,b.y,br))){
+          return dda_line_internal<true>(a.x,a.y,b.x,b.y,br,sink);
+        }else{
+          return dda_line_internal<false>(a.x,a.y,b.x,b.y,br,sink);
+        }
+      }
+
+      struct PointSink{
+        Point *dst;
+        inline void operator()(int i, int x, int y){ dst[i] = Point(x,y); }
+      };
+
+      template<class T>
+      struct ValueSink{
+        const T *src;
+        int lineStep;
+        T *dst;
+        inline void operator()(int i, int x, int y){ dst[i] = src[x + y*lineStep]; }
+      };
+
+      /// samples line segments (a[i],b[i]) into a point buffer
+      struct SegmentItems{
+        const Point *a, *b;
+        const int *br;
+        inline int maxLen(int i) const { return line_length(a[i],b[i]); }
+        inline int sample(int i, Point *dst) const {
+          PointSink s = { dst };
+          return dda_line(a[i],b[i],br,s);
+        }
+      };
+
+      /// samples line segments (a[i],b[i]) into a value buffer
+      template<class T>
+      struct ValueItems{
+        const Point *a, *b;
+        const int *br;
+        const T *src;
+        int lineStep;
+        inline int maxLen(int i) const { return line_length(a[i],b[i]); }
+        inline int sample(int i, T *dst) const {
+          ValueSink<T> s = { src, lineStep, dst };
+          return dda_line(a[i],b[i],br,s);
+        }
+      };
+
+      /// samples polylines (shared vertices are only sampled once) into a point buffer
+      struct PolylineItems{
+        const Point *v;
+        const int *offs;
+        const int *br;
+        bool closed;
+
+        inline int maxLen(int i) const {
+          const int s = offs[i], e = offs[i+1];
+          if(e == s) return 0;
+          int len = 1;
+          for(int j=s+1;j<e;++j) len += line_length(v[j-1],v[j])-1;
+          if(closed && e-s > 1) len += line_length(v[e-1],v[s])-1;
+          // +1: each segment's first point is written before it is removed
+          return len+1;
+        }
+
+        inline int sample(int i, Point *dst) const {
+          const int s = offs[i], e = offs[i+1];
+          if(e == s) return 0;
+          if(e-s == 1){
+            PointSink ps = { dst };
+            return dda_line(v[s],v[s],br,ps);
+          }
+          int m = 0;
+          const int nSegs = closed ? e-s : e-s-1;
+          for(int j=0;j<nSegs;++j){
+            const Point &p = v[s+j], &q = v[j == e-s-1 ? s : s+j+1];
+            PointSink ps = { dst+m };
+            int k = dda_line(p,q,br,ps);
+            // remove the point shared with the previous segment
+            if(m && k && dst[m] == dst[m-1]){
+              std::copy(dst+m+1,dst+m+k,dst+m);
+              --k;
+            }
+            m += k;
+          }
+          // the closing segment ends at the first point
+          if(closed && m > 1 && dst[m-1] == dst[0]) --m;
+          return m;
+        }
+      };
+
+      /// generic batch sampling
+      /** At first, an upper bound for the number of points of each item is
+          computed, which is used to reserve a slot in the flat destination buffer.
+          Then, all items are sampled (optionally in parallel) into their slots.
+          Finally, the slots are compacted, which is only necessary if points
+          were clipped by the bounding rect */
+      template<class Items, class Elem>
+      void batch_sample(const Items &items, int n, std::vector<Elem> &data,
+                        std::vector<int> &offsets, bool multiThreaded){
+        offsets.resize(n+1);
+        offsets[0] = 0;
+        for(int i=0;i<n;++i){
+          offsets[i+1] = offsets[i] + items.maxLen(i);
+        }
+        data.resize(offsets[n]);
+        if(!n) return;
+
+        std::vector<int> counts(n);
+        Elem *d = data.data();
+        const int *o = offsets.data();
+        (void)multiThreaded;
+#ifdef USE_OPENMP
+#pragma omp parallel for schedule(dynamic,64) if(multiThreaded)
+#endif
+        for(int i=0;i<n;++i){
+          counts[i] = items.sample(i, d + o[i]);
+        }
+
+        int pos = 0;
+        for(int i=0;i<n;++i){
+          const int slot = offsets[i];
+          if(slot != pos) std::copy(d+slot, d+slot+counts[i], d+pos);
+          offsets[i] = pos;
+          pos += counts[i];
+        }
+        offsets[n] = pos;
+        data.resize(pos);
+      }
+    }
+
+    void LineSampler::sample(const Point *a, const Point *b, int n,
+                             BatchResult &dst, bool multiThreaded) const{
+      SegmentItems items = { a, b, m_br.size() ? m_br.data() : 0 };
+      batch_sample(items, n, dst.points, dst.offsets, multiThreaded);
+    }
+
+    void LineSampler::sample(const std::vector<Point> &endPoints,
+                             BatchResult &dst, bool multiThreaded) const{
+      ICLASSERT_THROW(endPoints.size() % 2 == 0,
+                      ICLException("LineSampler::sample: number of end points must be even"));
+      const int n = endPoints.size()/2;
+      std::vector<Point> a(n), b(n);
+      for(int i=0;i<n;++i){
+        a[i] = endPoints[2*i];
+        b[i] = endPoints[2*i+1];
+      }
+      sample(a.data(), b.data(), n, dst, multiThreaded);
+    }
+
+    void LineSampler::samplePolylines(const std::vector<Point> &vertices,
+                                      const std::vector<int> &offsets, bool closed,
+                                      BatchResult &dst, bool multiThreaded) const{
+      ICLASSERT_THROW(offsets.size() && offsets.back() <= (int)vertices.size(),
+                      ICLException("LineSampler::samplePolylines: invalid polyline offsets"));
+      PolylineItems items = { vertices.data(), offsets.data(),
+                              m_br.size() ? m_br.data() : 0, closed };
+      batch_sample(items, (int)offsets.size()-1, dst.points, dst.offsets, multiThreaded);
+    }
+
+    template<class T>
+    void LineSampler::sampleValues(const Img<T> &image, int channel,
+                                   const Point *a, const Point *b, int n,
+                                   std::vector<T> &values, std::vector<int> &offsets,
+                                   bool multiThreaded) const{
+      ICLASSERT_THROW(channel >= 0 && channel < image.getChannels(),
+                      ICLException("LineSampler::sampleValues: invalid channel index"));
+      Rect r = image.getImageRect();
+      if(m_br.size()){
+        r &= Rect(m_br[0],m_br[1],m_br[2]-m_br[0],m_br[3]-m_br[1]);
+      }
+      const int br[4] = { r.x, r.y, r.right(), r.bottom() };
+      ValueItems<T> items = { a, b, br, image.getData(channel), image.getWidth() };
+      batch_sample(items, n, values, offsets, multiThreaded);
+    }
+
+#define ICL_INSTANTIATE_DEPTH(D)                                        \
+    template ICLCore_API void LineSampler::sampleValues<icl##D>(const Img<icl##D>&,int, \
+                                                                const Point*,const Point*,int, \
+                                                                std::vector<icl##D>&,std::vector<int>&, \
+                                                                bool) const;
+    ICL_INSTANTIATE_ALL_DEPTHS;
+#undef ICL_INSTANTIATE_DEPTH
+
   } // namespace core
 }
@@ -40,6 +40,11 @@
 
 namespace icl{
   namespace core{
+
+    /** \cond */
+    template<class T> class Img;
+    /** \endcond */
+
     /// Utility class for line sampling
     /** The LineSampler class provides a generic framework for efficient line renderig into images.
         It uses the Bresenham line sampling algorithm, that manages to render arbitray lines between 
@@ -63,6 +68,23 @@ namespace icl{
         Rendering all possible lines staring at any pixel and pointing to the center of a VGA image 
         (640x480 lines), takes about 650 ms. This leads to an approximate time of 0.002ms per line
         or in other words, 500 lines per millisecond;
+
+        \section BATCH Batch Sampling
+        Algorithms like the hough transform, contour based corner detection or canvas
+        rendering usually sample thousands of lines at once. Instead of calling
+        LineSampler::sample once per line, these can use the batch interface, which
+        samples a whole set of line segments (or polylines) into a single flat buffer
+        (see LineSampler::BatchResult). The batch methods
+        - compute the needed buffer size once (using the line lengths) so that no
+          per-line allocation is needed,
+        - use a closed-form formulation of the Bresenham algorithm, whose inner loop
+          has no loop-carried dependency and is therefore vectorized by the compiler,
+        - can optionally distribute the lines to several threads (OpenMP), and
+        - can directly sample image values along the lines (see LineSampler::sampleValues),
+          which is e.g. needed for the extraction of intensity profiles.
+
+        The sampled pixels are exactly the same as the ones returned by the single
+        line sampling methods.
     */
     class ICLCore_API LineSampler{
       protected:
@@ -99,6 +121,59 @@ namespace icl{
       
       /// samples the line into the given destination vector
       void sample(const utils::Point &a, const utils::Point &b, std::vector<utils::Point> &dst);
+
+      /// result type for batch line sampling
+      /** All points of all lines are stored in a single flat buffer. The points of the
+          i-th line are points[offsets[i]], ..., points[offsets[i+1]-1]. If a BatchResult
+          instance is reused, its buffers are not reallocated as long as they are large enough */
+      struct BatchResult{
+        std::vector<utils::Point> points; //!< all sampled points
+        std::vector<int> offsets;         //!< line offsets (size is number of lines + 1)
+
+        /// returns the number of sampled lines
+        inline int getNumLines() const {
+          return offsets.size() ? (int)offsets.size()-1 : 0;
+        }
+
+        /// returns the sampled points of the i-th line
+        inline Result operator[](int idx) const {
+          Result r = { points.data()+offsets[idx], offsets[idx+1]-offsets[idx] };
+          return r;
+        }
+      };
+
+      /// samples n lines at once (i-th line from a[i] to b[i])
+      /** If multiThreaded is true, and ICL was compiled with OpenMP support, the
+          lines are sampled in parallel */
+      void sample(const utils::Point *a, const utils::Point *b, int n,
+                  BatchResult &dst, bool multiThreaded=false) const;
+
+      /// convenience method for line segments given as a list of end points
+      /** The i-th line goes from endPoints[2*i] to endPoints[2*i+1] */
+      void sample(const std::vector<utils::Point> &endPoints,
+                  BatchResult &dst, bool multiThreaded=false) const;
+
+      /// samples a set of polylines at once
+      /** The vertices of all polylines are passed in a flat list: The i-th polyline
+          consists of the vertices[offsets[i]], ..., vertices[offsets[i+1]-1]. The
+          result contains one entry per polyline; points that are shared by subsequent
+          segments are only contained once. If closed is true, each polyline is closed
+          by a segment from the last to the first vertex (the first point is then not
+          repeated at the end) */
+      void samplePolylines(const std::vector<utils::Point> &vertices,
+                           const std::vector<int> &offsets, bool closed,
+                           BatchResult &dst, bool multiThreaded=false) const;
+
+      /// samples image values along n lines at once (e.g. for intensity profiles)
+      /** The values along the i-th line (from a[i] to b[i]) are stored in
+          values[offsets[i]], ..., values[offsets[i+1]-1]. In addition to the optionally
+          given bounding rect, the lines are clipped to the image rect.
+          Explicitly instantiated for all ICL depths */
+      template<class T>
+      void sampleValues(const Img<T> &image, int channel,
+                        const utils::Point *a, const utils::Point *b, int n,
+                        std::vector<T> &values, std::vector<int> &offsets,
+                        bool multiThreaded=false) const;
     };
   
   } // namespace core
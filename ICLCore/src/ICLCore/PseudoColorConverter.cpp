@@ -31,6 +31,7 @@
 #include <ICLCore/PseudoColorConverter.h>
 #include <ICLUtils/StringUtils.h>
 #include <ICLUtils/ConfigFile.h>
+#include <ICLUtils/ClippedCast.h>
 
 using namespace icl::utils;
 
@@ -77,6 +78,67 @@ namespace icl{
     bool cmp_stop(const PseudoColorConverter::Stop &a, const PseudoColorConverter::Stop &b){
       return a.relPos < b.relPos;
     }
+
+    namespace{
+      /// packs r,g,b and alpha=255 into one 32 bit value (byte order r,g,b,a in memory)
+      inline icl32u pack_rgba(icl8u r, icl8u g, icl8u b){
+        return icl32u(r) | (icl32u(g) << 8) | (icl32u(b) << 16) | (icl32u(255) << 24);
+      }
+
+      /// writes packed colors into 3 planar channels
+      struct PlanarWriter{
+        icl8u *r,*g,*b;
+        inline void operator()(int i, const icl32u *c, int n) const{
+          for(int j=0;j<n;++j){
+            r[i+j] = c[j] & 0xff;
+            g[i+j] = (c[j] >> 8) & 0xff;
+            b[i+j] = (c[j] >> 16) & 0xff;
+          }
+        }
+      };
+
+      /// writes packed colors as interleaved rgb data
+      struct RGBWriter{
+        icl8u *dst;
+        inline void operator()(int i, const icl32u *c, int n) const{
+          icl8u *d = dst + 3*i;
+          for(int j=0;j<n;++j,d+=3){
+            d[0] = c[j] & 0xff;
+            d[1] = (c[j] >> 8) & 0xff;
+            d[2] = (c[j] >> 16) & 0xff;
+          }
+        }
+      };
+
+      /// writes packed colors as interleaved rgba data
+      struct RGBAWriter{
+        icl32u *dst;
+        inline void operator()(int i, const icl32u *c, int n) const{
+          std::copy(c,c+n,dst+i);
+        }
+      };
+
+  #ifdef ICL_HAVE_SSE2
+      inline __m128 load4(const icl8u *p){
+        __m128i v = _mm_cvtsi32_si128(*(const int*)p);
+        v = _mm_unpacklo_epi8(v,_mm_setzero_si128());
+        return _mm_cvtepi32_ps(_mm_unpacklo_epi16(v,_mm_setzero_si128()));
+      }
+      inline __m128 load4(const icl16s *p){
+        __m128i v = _mm_loadl_epi64((const __m128i*)p);
+        return _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v,v),16));
+      }
+      inline __m128 load4(const icl32s *p){
+        return _mm_cvtepi32_ps(_mm_loadu_si128((const __m128i*)p));
+      }
+      inline __m128 load4(const icl32f *p){
+        return _mm_loadu_ps(p);
+      }
+      inline __m128 load4(const icl64f *p){
+        return _mm_movelh_ps(_mm_cvtpd_ps(_mm_loadu_pd(p)),_mm_cvtpd_ps(_mm_loadu_pd(p+2)));
+      }
+  #endif
+    }
     
     struct PseudoColorConverter::Data{
       std::vector<icl8u> luts[3]; // one Lookup-Table per channel RGB
@@ -86,23 +148,147 @@ namespace icl{
       Img8u sourceBuffer;
       int maxVal;
 
+      std::vector<icl32u> hiLut; // packed rgba table for non-8u sources (one extra entry)
+      int hiLutSize;
+      float rangeMin, rangeMax;
+      bool interpolate;
+
+      Data():hiLutSize(1024),rangeMin(0),rangeMax(255),interpolate(true){}
+
+      /// computes the interpolated stop color at relative position t
+      icl8u stop_color(float t, int channel) const{
+        if(stops.size() == 1 || t <= stops.front().relPos) return stops.front().color[channel];
+        for(unsigned int s=0;s<stops.size()-1;++s){
+          const Stop &a = stops[s], &b = stops[s+1];
+          if(t <= b.relPos){
+            float f = b.relPos > a.relPos ? (t-a.relPos)/(b.relPos-a.relPos) : 1.0f;
+            return utils::clipped_cast<float,icl8u>(f*b.color[channel] + (1.0f-f)*a.color[channel] + 0.5f);
+          }
+        }
+        return stops.back().color[channel];
+      }
+
+      void update_hi_lut(){
+        hiLut.resize(hiLutSize+1);
+        for(int i=0;i<hiLutSize;++i){
+          float t = float(i)/(hiLutSize-1);
+          hiLut[i] = pack_rgba(stop_color(t,0),stop_color(t,1),stop_color(t,2));
+        }
+        hiLut[hiLutSize] = hiLut[hiLutSize-1]; // for interpolation at the upper bound
+      }
+
+      /// maps n source values to packed colors
       template<class T>
-      void lut(const Img<T> &src, Img8u &dst){
+      inline void map_values(const T *s, icl32u *c, int n) const{
+        const icl32u *lut = hiLut.data();
+        const float maxIdx = hiLutSize-1;
+        const float scale = rangeMax > rangeMin ? maxIdx/(rangeMax-rangeMin) : 0;
+        int i=0;
+  #ifdef ICL_HAVE_SSE2
+        const __m128 vmin = _mm_set1_ps(rangeMin), vscale = _mm_set1_ps(scale);
+        const __m128 vzero = _mm_setzero_ps(), vmaxIdx = _mm_set1_ps(maxIdx);
+        const __m128 v128 = _mm_set1_ps(128.0f);
+        for(;i<n-3;i+=4){
+          __m128 f = _mm_mul_ps(_mm_sub_ps(load4(s+i),vmin),vscale);
+          f = _mm_min_ps(_mm_max_ps(f,vzero),vmaxIdx); // max first: NaN becomes 0
+          __m128i idx = _mm_cvttps_epi32(f);
+          int ix[4];
+          _mm_storeu_si128((__m128i*)ix,idx);
+          __m128i c0 = _mm_set_epi32(lut[ix[3]],lut[ix[2]],lut[ix[1]],lut[ix[0]]);
+          if(!interpolate){
+            _mm_storeu_si128((__m128i*)(c+i),c0);
+            continue;
+          }
+          __m128i c1 = _mm_set_epi32(lut[ix[3]+1],lut[ix[2]+1],lut[ix[1]+1],lut[ix[0]+1]);
+          // 7 bit fixed point fraction, replicated for the 4 color bytes of each pixel
+          __m128i fr = _mm_cvttps_epi32(_mm_mul_ps(_mm_sub_ps(f,_mm_cvtepi32_ps(idx)),v128));
+          fr = _mm_packs_epi32(fr,fr);
+          fr = _mm_unpacklo_epi16(fr,fr);
+          const __m128i frLo = _mm_unpacklo_epi32(fr,fr), frHi = _mm_unpackhi_epi32(fr,fr);
+          const __m128i z = _mm_setzero_si128();
+          __m128i a = _mm_unpacklo_epi8(c0,z), b = _mm_unpacklo_epi8(c1,z);
+          __m128i lo = _mm_add_epi16(a,_mm_srai_epi16(_mm_mullo_epi16(_mm_sub_epi16(b,a),frLo),7));
+          a = _mm_unpackhi_epi8(c0,z);
+          b = _mm_unpackhi_epi8(c1,z);
+          __m128i hi = _mm_add_epi16(a,_mm_srai_epi16(_mm_mullo_epi16(_mm_sub_epi16(b,a),frHi),7));
+          _mm_storeu_si128((__m128i*)(c+i),_mm_packus_epi16(lo,hi));
+        }
+  #endif
+        for(;i<n;++i){
+          float f = (float(s[i])-rangeMin)*scale;
+          if(!(f > 0)) f = 0;
+          else if(f > maxIdx) f = maxIdx;
+          const int idx = (int)f;
+          if(!interpolate){
+            c[i] = lut[idx];
+            continue;
+          }
+          const int fr = (int)((f-idx)*128);
+          const icl32u a = lut[idx], b = lut[idx+1];
+          icl32u r = 0;
+          for(int k=0;k<32;k+=8){
+            const int ca = (a>>k)&0xff, cb = (b>>k)&0xff;
+            r |= icl32u(ca + (((cb-ca)*fr)>>7)) << k;
+          }
+          c[i] = r;
+        }
+      }
+
+      /// converts the whole image in parallel strips
+      template<class T, class Writer>
+      void map_image(const Img<T> &src, const Writer &w) const{
+        static const int BLOCK = 256;
+        const int dim = src.getDim();
+        const int nBlocks = (dim+BLOCK-1)/BLOCK;
         const T *s = src.begin(0);
-        icl8u *r = dst.begin(0), *g = dst.begin(1), *b=dst.begin(2);
-        const icl8u *rlut = luts[0].data();
-        const icl8u *glut = luts[1].data();
-        const icl8u *blut = luts[2].data();
-        
+  #ifdef USE_OPENMP
+  #pragma omp parallel for
+  #endif
+        for(int b=0;b<nBlocks;++b){
+          icl32u buf[BLOCK];
+          const int i = b*BLOCK, n = std::min(BLOCK,dim-i);
+          map_values(s+i,buf,n);
+          w(i,buf,n);
+        }
+      }
+
+      /// converts an Img8u using the 256-entry lookup table
+      template<class Writer>
+      void map_image_8u(const Img8u &src, const Writer &w) const{
+        icl32u lut[256];
+        const int m = (int)luts[0].size()-1;
+        for(int i=0;i<256;++i){
+          const int j = std::min(i,m);
+          lut[i] = pack_rgba(luts[0][j],luts[1][j],luts[2][j]);
+        }
+        static const int BLOCK = 256;
         const int dim = src.getDim();
-        for(int i=0;i<dim;++i){
-          const int si = s[i];
-          r[i] = rlut[si];
-          g[i] = glut[si];
-          b[i] = blut[si];
+        const int nBlocks = (dim+BLOCK-1)/BLOCK;
+        const icl8u *s = src.begin(0);
+  #ifdef USE_OPENMP
+  #pragma omp parallel for
+  #endif
+        for(int b=0;b<nBlocks;++b){
+          icl32u buf[BLOCK];
+          const int i = b*BLOCK, n = std::min(BLOCK,dim-i);
+          for(int j=0;j<n;++j) buf[j] = lut[s[i+j]];
+          w(i,buf,n);
         }
       }
-      
+
+      template<class Writer>
+      void map_any(const ImgBase *src, const Writer &w) const{
+        switch(src->getDepth()){
+          case depth8u: map_image_8u(*src->as8u(),w); break;
+          case depth16s: map_image(*src->as16s(),w); break;
+          case depth32s: map_image(*src->as32s(),w); break;
+          case depth32f: map_image(*src->as32f(),w); break;
+          case depth64f: map_image(*src->as64f(),w); break;
+          default:
+            ICL_INVALID_DEPTH;
+        }
+      }
+
       void def(int maxValue){
         maxVal = maxValue;
         std::vector<Stop> s(256);
@@ -122,13 +308,16 @@ namespace icl{
       
       void custom(const std::vector<Stop> &stopsIn, int maxValue) throw (ICLException){
         maxVal = maxValue;
+        rangeMin = 0;
+        rangeMax = maxValue;
         if(!stopsIn.size()) throw ICLException("PseudoColorConverter: no stops found");
         mode = PseudoColorConverter::Custom;
         stops = stopsIn;
         if(stops.size() == 1){
-          std::fill(luts[0].begin(),luts[0].end(),stops[0].color[0]);
-          std::fill(luts[1].begin(),luts[1].end(),stops[0].color[1]);
-          std::fill(luts[2].begin(),luts[2].end(),stops[0].color[1]);
+          for(int i=0;i<3;++i){
+            luts[i].assign(maxVal+1,stops[0].color[i]);
+          }
+          update_hi_lut();
           return;
         }
         std::sort(this->stops.begin(),this->stops.end(),cmp_stop);
@@ -143,6 +332,7 @@ namespace icl{
             fill_lin(luts[i].data(),(maxVal+1)*stops[s].relPos,(maxVal+1)*stops[s+1].relPos,stops[s].color[i],stops[s+1].color[i]);
           }
         }
+        update_hi_lut();
       }
     };
   
@@ -174,17 +364,42 @@ namespace icl{
       if(src->getDepth() == depth8u){
         apply(*src->asImg<icl8u>(),*(*dst)->asImg<icl8u>());        
       }else{
-        switch(src->getDepth()){
-          case depth8u: m_data->lut(*src->as8u(), *(*dst)->as8u()); break;
-          case depth16s: m_data->lut(*src->as16s(), *(*dst)->as8u()); break;
-          case depth32s: m_data->lut(*src->as32s(), *(*dst)->as8u()); break;
-          case depth32f: m_data->lut(*src->as32f(), *(*dst)->as8u()); break;
-          case depth64f: m_data->lut(*src->as64f(), *(*dst)->as8u()); break;
-          default:
-            ICL_INVALID_DEPTH;
-        }
+        Img8u &d = *(*dst)->as8u();
+        d.setROI(src->getROI());
+        d.setTime(src->getTime());
+        PlanarWriter w = { d.begin(0), d.begin(1), d.begin(2) };
+        m_data->map_any(src,w);
+      }
+    }
+
+    void PseudoColorConverter::applyInterleaved(const ImgBase *src, icl8u *dst, bool rgba) throw (ICLException){
+      ICLASSERT_THROW(src,ICLException(str(__FUNCTION__)+": src image was NULL"));
+      ICLASSERT_THROW(dst,ICLException(str(__FUNCTION__)+": destination data was NULL"));
+      ICLASSERT_THROW(src->getChannels() == 1, ICLException(str(__FUNCTION__)+": source image has more than one channel"));
+      if(rgba){
+        RGBAWriter w = { (icl32u*)dst };
+        m_data->map_any(src,w);
+      }else{
+        RGBWriter w = { dst };
+        m_data->map_any(src,w);
       }
     }
+
+    void PseudoColorConverter::setValueRange(float minValue, float maxValue) throw (ICLException){
+      ICLASSERT_THROW(maxValue > minValue, ICLException(str(__FUNCTION__)+": maxValue must be larger than minValue"));
+      m_data->rangeMin = minValue;
+      m_data->rangeMax = maxValue;
+    }
+
+    void PseudoColorConverter::setTableSize(int entries) throw (ICLException){
+      ICLASSERT_THROW(entries >= 2 && entries <= 65536, ICLException(str(__FUNCTION__)+": table size must be in range [2,65536]"));
+      m_data->hiLutSize = entries;
+      m_data->update_hi_lut();
+    }
+
+    void PseudoColorConverter::setInterpolation(bool on){
+      m_data->interpolate = on;
+    }
       
     /// create a speudo color image from given source image
     void PseudoColorConverter::apply(const Img8u &src, Img8u &dst){
@@ -40,7 +40,20 @@ namespace icl{
     /// Utility class for speudocolor conversion
     /** The PseudoColorConverter converts a given 1-channel image into an RGB pseudocolor image.
         It can be set up to use a default color-table or it can be set up using a Stop-based
-        piecewise linear color table as internal convert lookup table */
+        piecewise linear color table as internal convert lookup table 
+
+        \section DEPTH Non-8u Source Images
+        Img8u sources are converted using a 256-entry lookup table per channel. All other
+        depths (e.g. depth16s or depth32f depth images) are converted directly, i.e. without
+        prior normalization and depth conversion: a configurable value range
+        (see setValueRange) is mapped onto a high resolution color table with 1024 entries
+        by default (see setTableSize). Optionally, the colors are linearly interpolated
+        between adjacent table entries (see setInterpolation). Values outside the range
+        are clamped, NaN values are mapped to the first color. The conversion is SSE2
+        accelerated and parallelized over image strips if OpenMP is available.
+        Besides planar Img8u output, applyInterleaved directly creates interleaved
+        RGB or RGBA data that can e.g. be uploaded as texture without further conversion.
+    */
     struct ICLCore_API PseudoColorConverter{
       /// mode internally used
       enum ColorTable{
@@ -82,6 +95,12 @@ namespace icl{
       
       /// create a speudo color image from given source image
       void apply(const ImgBase *src, ImgBase **dst) throw (utils::ICLException);
+
+      /// creates interleaved RGB (or RGBA, alpha = 255) pseudo color data from given source image
+      /** dst must provide width x height x (rgba ? 4 : 3) Bytes. Img8u sources are 
+          converted using the 256-entry lookup table, all other depths use the 
+          value range */
+      void applyInterleaved(const ImgBase *src, icl8u *dst, bool rgba=false) throw (utils::ICLException);
       
       /// create a speudo color image from given source image
       void apply(const Img8u &src, Img8u &dst);
@@ -89,6 +108,17 @@ namespace icl{
       /// create a speudo color image from given source image (using an internal buffer)
       const Img8u &apply(const Img8u &src);
       
+      /// sets the value range that is mapped onto the color table for non-8u source images
+      /** By default, the range is [0,maxValue], where maxValue is the value given
+          to the constructor or to setColorTable */
+      void setValueRange(float minValue, float maxValue) throw (utils::ICLException);
+
+      /// sets the number of color table entries used for non-8u source images (2 to 65536, default: 1024)
+      void setTableSize(int entries) throw (utils::ICLException);
+
+      /// enables or disables linear color interpolation between color table entries (default: true)
+      void setInterpolation(bool on);
+
       /// writes current stop configuration to xml-configuration file with given name
       void save(const std::string &filename);
   
@@ -60,10 +60,11 @@ namespace icl{
   #endif
   
       template<class KernelType, class SrcType, class DstType>
-      void generic_cpp_convolution(const Img<SrcType> &src, Img<DstType> &dst,const KernelType *k, ConvolutionOp &op, int c){
-        const ImgIterator<SrcType> s(const_cast<SrcType*>(src.getData(c)), src.getWidth(),Rect(op.getROIOffset(), dst.getROISize()));
-        const ImgIterator<SrcType> sEnd = ImgIterator<SrcType>::create_end_roi_iterator(src.getData(c),src.getWidth(), Rect(op.getROIOffset(), dst.getROISize()));
-        ImgIterator<DstType>      d = dst.beginROI(c);
+      void generic_cpp_convolution(const Img<SrcType> &src, Img<DstType> &dst,const KernelType *k, ConvolutionOp &op, int c,
+                                   const Rect &srcRect, const Point &dstOffset){
+        const ImgIterator<SrcType> s(const_cast<SrcType*>(src.getData(c)), src.getWidth(),srcRect);
+        const ImgIterator<SrcType> sEnd = ImgIterator<SrcType>::create_end_roi_iterator(src.getData(c),src.getWidth(), srcRect);
+        ImgIterator<DstType>      d(dst.getData(c), dst.getWidth(), Rect(dstOffset, srcRect.getSize()));
         Point an = op.getAnchor();
         Size si = op.getMaskSize();
         int factor = op.getKernel().getFactor();
@@ -78,14 +79,15 @@ namespace icl{
       }
   
       template<class KernelType, class SrcType, class DstType>
-      void generic_cpp_convolution_3x3(const Img<SrcType> &src, Img<DstType> &dst,const KernelType *k, ConvolutionOp &op, int c){
+      void generic_cpp_convolution_3x3(const Img<SrcType> &src, Img<DstType> &dst,const KernelType *k, ConvolutionOp &op, int c,
+                                       const Rect &srcRect, const Point &dstOffset){
       
-        register const SrcType *s = src.getROIData(c,op.getROIOffset());
-        register DstType *d = dst.getROIData(c);
+        register const SrcType *s = src.getROIData(c,srcRect.ul());
+        register DstType *d = dst.getROIData(c,dstOffset);
         register int factor = op.getKernel().getFactor();
         
-        register const int xEnd = dst.getROISize().width;
-        register const int yEnd = dst.getROISize().height;
+        register const int xEnd = srcRect.width;
+        register const int yEnd = srcRect.height;
         register const KernelType m[9] = {k[0],k[1],k[2],k[3],k[4],k[5],k[6],k[7],k[8]};
         register const int dy = src.getWidth();
         
@@ -111,16 +113,92 @@ namespace icl{
           }
         }
       }
-  
+
+      template<class KernelType, class SrcType, class DstType>
+      inline void generic_convolute(const Img<SrcType> &src, Img<DstType> &dst,const KernelType *k, ConvolutionOp &op, int c,
+                                    const Rect &srcRect, const Point &dstOffset){
+        if(op.getAnchor() == Point(1,1) && op.getMaskSize() == Size(3,3)){
+          generic_cpp_convolution_3x3(src,dst,k,op,c,srcRect,dstOffset);
+        }else{
+          generic_cpp_convolution(src,dst,k,op,c,srcRect,dstOffset);
+        }
+      }
       
       template<class KernelType, class SrcType, class DstType, ConvolutionKernel::fixedType t>
       inline void convolute(const Img<SrcType> &src, Img<DstType> &dst,const KernelType *k, ConvolutionOp &op, int c){
         /// here we call the generic conv method and do not implement the convolution directly to 
         /// get rid of the 4th template parameter 't' which is not regarded in this general case
-        if(op.getAnchor() == Point(1,1) && op.getMaskSize() == Size(3,3)){
-          generic_cpp_convolution_3x3(src,dst,k,op,c);
-        }else{
-          generic_cpp_convolution(src,dst,k,op,c);
+        generic_convolute(src,dst,k,op,c,Rect(op.getROIOffset(),dst.getROISize()),dst.getROIOffset());
+      }
+
+      /// maps a virtual coordinate to an image coordinate (-1 means: use the border value)
+      inline int border_index(int v, int n, NeighborhoodOp::BorderPolicy p){
+        if(v >= 0 && v < n) return v;
+        switch(p){
+          case NeighborhoodOp::borderReplicate: 
+            return v < 0 ? 0 : n-1;
+          case NeighborhoodOp::borderReflect:
+            if(n == 1) return 0;
+            while(v < 0 || v >= n){
+              v = v < 0 ? -v-1 : 2*n-v-1;
+            }
+            return v;
+          case NeighborhoodOp::borderWrap:
+            return ((v % n) + n) % n;
+          default:
+            return -1;
+        }
+      }
+      
+      /// convolution of the pixels next to the image border
+      /** Pixels, where the mask is completely inside of the image, are processed
+          by the usual (branch free) convolution code. For the remaining rows and
+          columns, index tables are used to map mask pixels to the image */
+      template<class KernelType, class SrcType, class DstType>
+      void convolute_with_border(const Img<SrcType> &src, Img<DstType> &dst,const KernelType *k, ConvolutionOp &op, int c){
+        const Point an = op.getAnchor();
+        const Size ms = op.getMaskSize();
+        const Rect roi(op.getROIOffset(),dst.getROISize());
+        const Point dOffs = dst.getROIOffset();
+        const int W = src.getWidth(), H = src.getHeight();
+        const Rect inner = (W >= ms.width && H >= ms.height) ? 
+                           (roi & Rect(an.x, an.y, W-ms.width+1, H-ms.height+1)) : Rect::null;
+        
+        if(inner.getDim() > 0){
+          generic_convolute(src,dst,k,op,c,inner,dOffs+(inner.ul()-roi.ul()));
+        }
+        if(inner == roi) return;
+        
+        const NeighborhoodOp::BorderPolicy p = op.getBorderPolicy();
+        std::vector<int> xs(roi.width+ms.width-1), ys(roi.height+ms.height-1);
+        for(unsigned int i=0;i<xs.size();++i) xs[i] = border_index(roi.x-an.x+i, W, p);
+        for(unsigned int i=0;i<ys.size();++i) ys[i] = border_index(roi.y-an.y+i, H, p);
+
+        const SrcType *s = src.getData(c);
+        const KernelType bv = (KernelType)clipped_cast<icl64f,SrcType>(op.getBorderValue());
+        const int factor = op.getKernel().getFactor();
+        
+        for(int y=0;y<roi.height;++y){
+          const int yi = roi.y + y;
+          const bool fullRow = !inner.getDim() || yi < inner.y || yi >= inner.bottom();
+          DstType *d = dst.getROIData(c,Point(dOffs.x,dOffs.y+y));
+          for(int x=0;x<roi.width;++x){
+            if(!fullRow && x == inner.x-roi.x){
+              x = inner.right()-roi.x-1; // skip the inner part
+              continue;
+            }
+            const KernelType *m = k;
+            KernelType buffer = 0;
+            for(int j=0;j<ms.height;++j){
+              const int yy = ys[y+j];
+              const SrcType *sr = yy < 0 ? 0 : s + yy*W;
+              for(int i=0;i<ms.width;++i,++m){
+                const int xx = xs[x+i];
+                buffer += (*m) * ((yy < 0 || xx < 0) ? bv : (KernelType)sr[xx]);
+              }
+            }
+            d[x] = clipped_cast<KernelType, DstType>(buffer / factor);
+          }
         }
       }
       
@@ -211,8 +289,13 @@ namespace icl{
   
       template<class KernelType, class SrcType, class DstType, ConvolutionKernel::fixedType t>
       inline void apply_convolution_sdt(const Img<SrcType> &src, Img<DstType> &dst,const KernelType *k, ConvolutionOp &op){
+        const bool border = op.getBorderPolicy() != NeighborhoodOp::borderShrink;
         for(int c=src.getChannels()-1;c>=0;--c){
-          convolute<KernelType,SrcType,DstType,t>(src,dst,k,op,c);
+          if(border){
+            convolute_with_border(src,dst,k,op,c);
+          }else{
+            convolute<KernelType,SrcType,DstType,t>(src,dst,k,op,c);
+          }
         }
       }
       
@@ -112,6 +112,11 @@ namespace icl {
       
       /// Import unaryOps apply function without destination image
       using NeighborhoodOp::apply;
+
+      /// sets a virtual border policy (see NeighborhoodOp::BorderPolicy)
+      /** If a policy other than borderShrink is used, the result has the full ROI size.
+          Please note: the IPP-optimized functions are not used in this case */
+      using NeighborhoodOp::setBorderPolicy;
       
       /// change kernel
       void setKernel (const ConvolutionKernel &kernel){ m_kernel = kernel; }
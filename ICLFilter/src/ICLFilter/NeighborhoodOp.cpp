@@ -58,6 +58,13 @@ namespace icl {
       Rect imageRect(Point::null,poSrc->getSize());
       Rect imageROI = poSrc->getROI();
       
+      if(m_borderPolicy != borderShrink){
+        // pixels outside of the image are provided virtually by the filter
+        oROIoffset = imageROI.ul();
+        oROIsize = imageROI.getSize();
+        return !!oROIsize.getDim();
+      }
+
       Rect newROI = imageROI & (imageRect+m_oAnchor-m_oMaskSize+Size(1,1));
       oROIoffset = newROI.ul();
       oROIsize = newROI.getSize();
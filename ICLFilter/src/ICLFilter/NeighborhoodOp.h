@@ -55,9 +55,31 @@ namespace icl {
         actually changed, which makes the filter operation thread safe, because
         simultaneous operations running on the source image within different
         threads do not interfere.
+
+        \section BORDER Virtual Border Policies
+        Operators that need a full size result usually had to copy the source
+        image into a larger, padded image before (see core::ImgBorder). Instead,
+        filters, that support this, can be given a virtual border policy (see
+        NeighborhoodOp::BorderPolicy). If a border policy other than borderShrink
+        is set, the ROI is no longer shrinked. Pixels outside of the image are
+        virtually replicated, reflected, wrapped around, or set to a constant value.
+        The filter implementation handles the border rows and columns in special
+        loops, so that the inner part is processed by the usual branch-free code.
+        Please note, that only pixels outside of the image are virtual: pixels
+        outside of the ROI but inside of the image are used as they are.
+        Currently the border policy is supported by the ConvolutionOp.
     */
     class ICLFilter_API NeighborhoodOp : public UnaryOp {
       public:
+
+      /// policies to handle mask pixels outside of the image
+      enum BorderPolicy{
+        borderShrink,    //!< the ROI is shrinked, so that no pixels outside the image are needed (default)
+        borderReplicate, //!< aaa|abcd|ddd
+        borderReflect,   //!< cba|abcd|dcb
+        borderConstant,  //!< xxx|abcd|xxx with constant value x
+        borderWrap       //!< bcd|abcd|abc
+      };
       
       ///Destructor
       virtual ~NeighborhoodOp(){}
@@ -82,10 +104,22 @@ namespace icl {
       using UnaryOp::apply;
       
       protected:
-      NeighborhoodOp() : m_oMaskSize(1,1), m_oAnchor (0,0) {}
-      NeighborhoodOp(const utils::Size &size) {
+      NeighborhoodOp() : m_oMaskSize(1,1), m_oAnchor (0,0),
+                         m_borderPolicy(borderShrink), m_borderValue(0) {}
+      NeighborhoodOp(const utils::Size &size) :
+        m_borderPolicy(borderShrink), m_borderValue(0){
         setMask (size);
       }
+
+      /// sets the border policy
+      /** This is protected, because the policy must be supported by the actual
+          filter implementation. Supporting subclasses make it public.
+          @param policy new border policy
+          @param constantValue value that is used for borderConstant */
+      void setBorderPolicy(BorderPolicy policy, icl64f constantValue=0){
+        m_borderPolicy = policy;
+        m_borderValue = constantValue;
+      }
       
       void setMask(const utils::Size &size) {
           m_oMaskSize = adaptSize(size);
@@ -108,6 +142,14 @@ namespace icl {
       const utils::Point &getROIOffset() const{
         return m_oROIOffset;
       }
+      /// returns the current border policy
+      BorderPolicy getBorderPolicy() const{
+        return m_borderPolicy;
+      }
+      /// returns the border value that is used for borderConstant
+      icl64f getBorderValue() const{
+        return m_borderValue;
+      }
       protected:
   
       /// prepare filter operation: ensure compatible image format and size
@@ -130,6 +172,8 @@ namespace icl {
       utils::Size  m_oMaskSize;  ///< size of filter mask
       utils::Point m_oAnchor;    ///< anchor of filter mask
       utils::Point m_oROIOffset; ///< to-be-used ROI offset for source image
+      BorderPolicy m_borderPolicy; ///< virtual border handling
+      icl64f m_borderValue;        ///< border value for borderConstant
     };
   } // namespace filter
 }
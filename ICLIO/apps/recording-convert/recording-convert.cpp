@@ -0,0 +1,128 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLIO/apps/recording-convert/recording-convert.cpp     **
+** Module : ICLIO                                                  **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#include <ICLUtils/ProgArg.h>
+#include <ICLUtils/StringUtils.h>
+#include <ICLIO/FileGrabber.h>
+#include <ICLIO/ImageRecording.h>
+#include <ICLIO/ImageRecordingWriter.h>
+
+#include <cstdio>
+
+using namespace icl;
+using namespace icl::utils;
+using namespace icl::core;
+using namespace icl::io;
+
+static void show_info(const std::string &filename){
+  ImageRecording rec(filename);
+  const int n = rec.getNumFrames();
+  printf("file:     %s\n", filename.c_str());
+  printf("frames:   %d%s\n", n, rec.isRecovered() ? " (recovered index)" : "");
+  if(n){
+    printf("duration: %.3f s\n", (rec.getTime(n-1)-rec.getTime(0)).toSecondsDouble());
+  }
+}
+
+static void convert(const std::string &input, const std::string &output){
+  FileGrabber g(input);
+  g.setPropertyValue("loop", false);
+  g.setReadAhead(8);
+
+  ImageCompressor::CompressionSpec c("none");
+  if(pa("-compression")){
+    c = ImageCompressor::CompressionSpec(*pa("-compression",0), *pa("-compression",1));
+  }
+  ImageRecordingWriter w(output, c);
+
+  const int n = g.getFileCount();
+  const float fps = pa("-fps");
+  Time last(0);
+  ImgBase *frame = 0;
+  for(int i=0;i<n;++i){
+    const ImgBase *image = g.grab();
+    if(!image){
+      ERROR_LOG("unable to read file " << i << " (skipped)");
+      continue;
+    }
+    const_cast<ImgBase*>(image)->shallowCopy(&frame);
+    if(fps > 0 || frame->getTime() == Time(0) || frame->getTime() < last){
+      // the image files do not have (ascending) time stamps
+      frame->setTime(Time(icl64s(i * 1000000.0 / (fps > 0 ? fps : 30))));
+    }
+    last = frame->getTime();
+    w.write(frame);
+    if(pa("-progress")){
+      printf("\r%d / %d", i+1, n);
+      fflush(stdout);
+    }
+  }
+  if(pa("-progress")) printf("\n");
+  ICL_DELETE(frame);
+  w.close();
+  show_info(output);
+}
+
+int main(int n, char **ppc){
+  pa_explain
+    ("-i","input file pattern or directory (e.g. \"recording/image-*.ppm\"), all supported "
+     "file types can be used")
+    ("-o","output recording file (.iclrec)")
+    ("-compression","compression mode and quality of the ImageCompressor (e.g. jpeg 90, rlen 1);"
+     " by default, the images are stored uncompressed")
+    ("-fps","frame rate that is used to create the time stamps of the frames (if not given, "
+     "the time stamps of the image files are used, if the files don't have time stamps "
+     "30 fps are assumed)")
+    ("-repair","writes the recovered index to a recording, that was not closed correctly "
+     "(e.g. because the recording application crashed)")
+    ("-info","shows the number of frames and the duration of the given recording")
+    ("-progress","shows the conversion progress");
+
+  pa_init(n,ppc,"-input|-i(pattern) -output|-o(filename) -compression|-c(mode,quality) "
+          "-fps(float=0) -repair(filename) -info(filename) -progress");
+
+  try{
+    if(pa("-repair")){
+      int frames = ImageRecording::repair(*pa("-repair"));
+      printf("recording %s has %d frames\n", (*pa("-repair")).c_str(), frames);
+    }else if(pa("-info")){
+      show_info(*pa("-info"));
+    }else if(pa("-i") && pa("-o")){
+      convert(*pa("-i"), *pa("-o"));
+    }else{
+      pa_show_usage("please define input and output, or -repair or -info");
+      return 1;
+    }
+  }catch(const ICLException &e){
+    ERROR_LOG(e.what());
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,112 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLIO/examples/file-grabber-read-ahead-benchmark.cpp   **
+** Module : ICLIO                                                  **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#include <ICLIO/FileGrabber.h>
+#include <ICLIO/FileWriter.h>
+#include <ICLIO/TestImages.h>
+#include <ICLCore/Img.h>
+#include <ICLUtils/Time.h>
+#include <ICLUtils/StringUtils.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+
+using namespace icl;
+using namespace icl::utils;
+using namespace icl::core;
+using namespace icl::io;
+
+static const int N = 120;
+
+// writes N slightly different images into dir using the given suffix
+static void create_files(const std::string &dir, const std::string &suffix, const Size &size){
+  ImgBase *lena = TestImages::create("lena",size,formatRGB,depth8u);
+  Img8u image = *lena->as8u();
+  delete lena;
+  FileWriter w(dir + "/image-####." + suffix);
+  for(int i=0;i<N;++i){
+    image(i%size.width,i%size.height,0) = icl8u(i);
+    w.write(&image);
+  }
+}
+
+static void remove_files(const std::string &dir, const std::string &suffix){
+  for(int i=0;i<N;++i){
+    char buf[32];
+    sprintf(buf,"/image-%04d.",i);
+    remove((dir + buf + suffix).c_str());
+  }
+}
+
+// returns a checksum over all grabbed frames
+static long bench(const std::string &dir, const std::string &suffix, int frames, int threads){
+  FileGrabber g(dir + "/image-*." + suffix);
+  if(frames) g.setReadAhead(frames,threads);
+
+  long sum = 0;
+  Time t = Time::now();
+  for(int i=0;i<N;++i){
+    const ImgBase *image = g.grab();
+    sum += image->as8u()->getData(0)[i];
+  }
+  double dt = (Time::now()-t).toMilliSecondsDouble();
+  if(frames){
+    printf("  read-ahead %2d frames, %d threads: %8.2f ms per frame\n", frames, threads, dt/N);
+  }else{
+    printf("  synchronous decoding:           %8.2f ms per frame\n", dt/N);
+  }
+  return sum;
+}
+
+int main(int n, char **ppc){
+  char tmpl[] = "/tmp/icl-read-ahead-XXXXXX";
+  if(!mkdtemp(tmpl)){
+    printf("unable to create temporary directory\n");
+    return 1;
+  }
+  std::string dir = tmpl;
+  const char *suffixes[] = { "jpg", "png", 0 };
+
+  for(const char **s=suffixes; *s; ++s){
+    create_files(dir,*s,Size(1280,960));
+    printf("%d %s files (1280x960 RGB):\n", N, *s);
+    long ref = bench(dir,*s,0,1);
+    int threads[] = { 1, 2, 4 };
+    for(int i=0;i<3;++i){
+      if(bench(dir,*s,8,threads[i]) != ref){
+        printf("  error: read-ahead result differs from synchronous decoding\n");
+      }
+    }
+    remove_files(dir,*s);
+  }
+  rmdir(tmpl);
+  return 0;
+}
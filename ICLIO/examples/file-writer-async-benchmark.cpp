@@ -0,0 +1,140 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLIO/examples/file-writer-async-benchmark.cpp         **
+** Module : ICLIO                                                  **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#include <ICLIO/FileWriter.h>
+#include <ICLIO/TestImages.h>
+#include <ICLCore/Img.h>
+#include <ICLUtils/Time.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+#include <sys/stat.h>
+
+using namespace icl;
+using namespace icl::utils;
+using namespace icl::core;
+using namespace icl::io;
+
+static const int N = 60;
+
+static std::string file_name(const std::string &dir, int i, const std::string &suffix){
+  char buf[32];
+  sprintf(buf,"/image-%04d.",i);
+  return dir + buf + suffix;
+}
+
+static std::string read_file(const std::string &name){
+  std::ifstream s(name.c_str(), std::ios::binary);
+  std::ostringstream o;
+  o << s.rdbuf();
+  return o.str();
+}
+
+static void remove_files(const std::string &dir, const std::string &suffix){
+  for(int i=0;i<N;++i){
+    remove(file_name(dir,i,suffix).c_str());
+  }
+}
+
+// writes N slightly different images (like a capture loop) and measures the time
+// spent in FileWriter::write
+static void bench(Img8u &image, const std::string &dir, const std::string &suffix,
+                  int threads, FileWriter::QueuePolicy policy=FileWriter::Block, int queueSize=8){
+  FileWriter w(dir + "/image-####." + suffix);
+  if(threads) w.setAsync(threads,queueSize,policy);
+  double sum = 0, maxT = 0;
+  Time t0 = Time::now();
+  for(int i=0;i<N;++i){
+    image(i%image.getWidth(),i%image.getHeight(),0) = icl8u(i);
+    Time t = Time::now();
+    w.write(&image);
+    double dt = (Time::now()-t).toMilliSecondsDouble();
+    sum += dt;
+    maxT = iclMax(maxT,dt);
+  }
+  w.flush();
+  double total = (Time::now()-t0).toMilliSecondsDouble();
+  if(threads){
+    FileWriter::AsyncStatistics s = w.getAsyncStatistics();
+    printf("  async %d threads:  write %7.2f ms (max %7.2f), total %8.1f ms,"
+           " encode %7.2f ms, max queue %d, dropped %d\n", threads, sum/N, maxT,
+           total, s.meanEncodeTime, s.maxQueueDepth, s.framesDropped);
+  }else{
+    printf("  synchronous:      write %7.2f ms (max %7.2f), total %8.1f ms\n",
+           sum/N, maxT, total);
+  }
+}
+
+int main(int n, char **ppc){
+  char tmpl[] = "/tmp/icl-async-writer-XXXXXX";
+  if(!mkdtemp(tmpl)){
+    printf("unable to create temporary directory\n");
+    return 1;
+  }
+  std::string dir = tmpl, syncDir = dir + "/sync", asyncDir = dir + "/async";
+  mkdir(syncDir.c_str(),0700);
+  mkdir(asyncDir.c_str(),0700);
+
+  ImgBase *lena = TestImages::create("lena",Size(1280,960),formatRGB,depth8u);
+  const char *suffixes[] = { "jpg", "png", "ppm.gz", 0 };
+
+  for(const char **s=suffixes; *s; ++s){
+    printf("%d %s files (1280x960 RGB):\n", N, *s);
+    Img8u image = lena->as8u()->detached();
+    bench(image,syncDir,*s,0);
+    int threads[] = { 1, 2, 4 };
+    for(int t=0;t<3;++t){
+      image = lena->as8u()->detached();
+      bench(image,asyncDir,*s,threads[t]);
+      for(int i=0;i<N;++i){
+        if(read_file(file_name(syncDir,i,*s)) != read_file(file_name(asyncDir,i,*s))){
+          printf("  error: file %d differs from the synchronously written file\n",i);
+          break;
+        }
+      }
+      remove_files(asyncDir,*s);
+    }
+    image = lena->as8u()->detached();
+    bench(image,asyncDir,*s,2,FileWriter::DropOldest,2);
+    remove_files(asyncDir,*s);
+    image = lena->as8u()->detached();
+    bench(image,asyncDir,*s,2,FileWriter::DropNewest,2);
+    remove_files(asyncDir,*s);
+    remove_files(syncDir,*s);
+  }
+  delete lena;
+  rmdir(syncDir.c_str());
+  rmdir(asyncDir.c_str());
+  rmdir(tmpl);
+  return 0;
+}
@@ -0,0 +1,115 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLIO/examples/image-recording-benchmark.cpp           **
+** Module : ICLIO                                                  **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#include <ICLIO/FileGrabber.h>
+#include <ICLIO/FileWriter.h>
+#include <ICLIO/ImageRecordingGrabber.h>
+#include <ICLIO/ImageRecordingWriter.h>
+#include <ICLCore/Img.h>
+#include <ICLUtils/Time.h>
+#include <ICLUtils/Random.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+
+using namespace icl;
+using namespace icl::utils;
+using namespace icl::core;
+using namespace icl::io;
+
+static const int N = 2000;
+static const int SEEKS = 500;
+
+int main(int n, char **ppc){
+  char tmpl[] = "/tmp/icl-recording-XXXXXX";
+  if(!mkdtemp(tmpl)){
+    printf("unable to create temporary directory\n");
+    return 1;
+  }
+  std::string dir = tmpl;
+
+  // small (binary) images, so that the file system overhead dominates
+  Img8u image(Size(160,120),1);
+  {
+    FileWriter files(dir + "/image-#####.bicl");
+    ImageRecordingWriter rec(dir + "/recording.iclrec");
+    for(int i=0;i<N;++i){
+      image.fill(i%256);
+      image.setTime(Time(i*33333));
+      files.write(&image);
+      rec.write(&image);
+    }
+  }
+  printf("%d frames (160x120 gray)\n", N);
+
+  std::vector<int> idx(SEEKS);
+  for(int i=0;i<SEEKS;++i) idx[i] = URandI(N-1);
+
+  long sumFiles = 0, sumRec = 0;
+  {
+    Time t = Time::now();
+    FileGrabber g(dir + "/image-*.bicl");
+    double open = (Time::now()-t).toMilliSecondsDouble();
+    g.setPropertyValue("auto-next",false);
+    t = Time::now();
+    for(int i=0;i<SEEKS;++i){
+      g.setPropertyValue("frame-index",idx[i]);
+      sumFiles += g.grab()->as8u()->getData(0)[0];
+    }
+    printf("  file list:  open %8.2f ms, random seek + decode %6.3f ms per frame\n",
+           open, (Time::now()-t).toMilliSecondsDouble()/SEEKS);
+  }
+  {
+    Time t = Time::now();
+    ImageRecordingGrabber g(dir + "/recording.iclrec");
+    double open = (Time::now()-t).toMilliSecondsDouble();
+    g.setPropertyValue("auto-next",false);
+    t = Time::now();
+    for(int i=0;i<SEEKS;++i){
+      g.seek(idx[i]);
+      sumRec += g.grab()->as8u()->getData(0)[0];
+    }
+    printf("  recording:  open %8.2f ms, random seek + decode %6.3f ms per frame\n",
+           open, (Time::now()-t).toMilliSecondsDouble()/SEEKS);
+  }
+  if(sumFiles != sumRec){
+    printf("  error: the recording frames differ from the image files\n");
+  }
+
+  for(int i=0;i<N;++i){
+    char buf[32];
+    sprintf(buf,"/image-%05d.bicl",i);
+    remove((dir + buf).c_str());
+  }
+  remove((dir + "/recording.iclrec").c_str());
+  rmdir(tmpl);
+  return 0;
+}
@@ -0,0 +1,101 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLIO/examples/jpeg-parallel-benchmark.cpp             **
+** Module : ICLIO                                                  **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#include <ICLIO/ImageCompressor.h>
+#include <ICLIO/TestImages.h>
+#include <ICLCore/Img.h>
+#include <ICLUtils/Time.h>
+#include <ICLUtils/StringUtils.h>
+
+#include <cstdio>
+#include <vector>
+
+using namespace icl;
+using namespace icl::utils;
+using namespace icl::core;
+using namespace icl::io;
+
+static const int N = 30;
+
+static bool equal(const ImgBase *a, const ImgBase *b){
+  if(a->getSize() != b->getSize() || a->getChannels() != b->getChannels()) return false;
+  for(int c=0;c<a->getChannels();++c){
+    const icl8u *pa = a->as8u()->begin(c), *pb = b->as8u()->begin(c);
+    if(!std::equal(pa,pa+a->getDim(),pb)) return false;
+  }
+  return true;
+}
+
+// compresses and uncompresses the given image N times using the given number of threads
+static void bench(const ImgBase *image, int threads, const ImgBase *reference){
+  ImageCompressor c(ImageCompressor::CompressionSpec("jpeg","90"));
+  c.setNumThreads(threads);
+  
+  double tEnc = 0, tDec = 0;
+  std::vector<icl8u> data;
+  const ImgBase *decoded = 0;
+  for(int i=0;i<N;++i){
+    Time t = Time::now();
+    const ImageCompressor::CompressedData d = c.compress(image);
+    tEnc += (Time::now()-t).toMilliSecondsDouble();
+    data.assign(d.bytes,d.bytes+d.len);
+    
+    t = Time::now();
+    decoded = c.uncompress(data.data(),data.size());
+    tDec += (Time::now()-t).toMilliSecondsDouble();
+  }
+  printf("  %d threads: encode %7.2f ms, decode %7.2f ms, %7d bytes%s\n",
+         threads, tEnc/N, tDec/N, (int)data.size(),
+         (reference && !equal(reference,decoded)) ? " (error: decoded image differs)" : "");
+}
+
+int main(int n, char **ppc){
+  const Size sizes[] = { Size::VGA, Size(1280,960), Size(2560,1920) };
+  const format formats[] = { formatGray, formatRGB };
+  for(int s=0;s<3;++s){
+    for(int f=0;f<2;++f){
+      ImgBase *image = TestImages::create("lena",sizes[s],formats[f],depth8u);
+      printf("%s %s image:\n",str(sizes[s]).c_str(),str(formats[f]).c_str());
+      
+      // reference: single threaded decoding of a single threaded encoded image
+      ImageCompressor c(ImageCompressor::CompressionSpec("jpeg","90"));
+      const ImageCompressor::CompressedData d = c.compress(image);
+      std::vector<icl8u> data(d.bytes,d.bytes+d.len);
+      const ImgBase *reference = c.uncompress(data.data(),data.size());
+      
+      int threads[] = { 1, 2, 4, 8 };
+      for(int t=0;t<4;++t){
+        bench(image,threads[t],reference);
+      }
+      delete image;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,88 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLIO/examples/jpeg-scaled-decoding-benchmark.cpp      **
+** Module : ICLIO                                                  **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#include <ICLIO/JPEGEncoder.h>
+#include <ICLIO/JPEGDecoder.h>
+#include <ICLIO/TestImages.h>
+#include <ICLCore/Img.h>
+#include <ICLCore/Converter.h>
+#include <ICLUtils/Time.h>
+#include <ICLUtils/StringUtils.h>
+
+#include <cstdio>
+#include <vector>
+
+using namespace icl;
+using namespace icl::utils;
+using namespace icl::core;
+using namespace icl::io;
+
+static const int N = 10;
+
+// decodes the jpeg data N times and scales the result to the given size (like the
+// Grabber's desired size adaption), optionally using DCT-domain downscaling
+static void bench(const std::vector<icl8u> &data, const Size &targetSize, bool scaled){
+  ImgBase *decoded = 0, *result = 0;
+  Converter converter;
+  double tDec = 0, tScale = 0;
+  for(int i=0;i<N;++i){
+    Time t = Time::now();
+    JPEGDecoder::decode(data.data(), data.size(), &decoded, scaled ? targetSize : Size::null);
+    tDec += (Time::now()-t).toMilliSecondsDouble();
+
+    t = Time::now();
+    ensureCompatible(&result, depth8u, targetSize, decoded->getFormat());
+    converter.apply(decoded,result);
+    tScale += (Time::now()-t).toMilliSecondsDouble();
+  }
+  printf("  %-8s decoded %9s: decode %7.2f ms, resize %6.2f ms, total %7.2f ms\n",
+         scaled ? "scaled" : "full", str(decoded->getSize()).c_str(),
+         tDec/N, tScale/N, (tDec+tScale)/N);
+  delete decoded;
+  delete result;
+}
+
+int main(int n, char **ppc){
+  const Size sizes[] = { Size(1920,1080), Size(3840,2160) };
+  const Size targets[] = { Size(960,540), Size::VGA, Size::QVGA };
+  for(int s=0;s<2;++s){
+    ImgBase *image = TestImages::create("lena",sizes[s],formatRGB,depth8u);
+    JPEGEncoder encoder(90);
+    const JPEGEncoder::EncodedData &e = encoder.encode(image);
+    std::vector<icl8u> data(e.bytes,e.bytes+e.len);
+    for(int t=0;t<3;++t){
+      printf("%s jpeg -> %s:\n",str(sizes[s]).c_str(),str(targets[t]).c_str());
+      bench(data,targets[t],false);
+      bench(data,targets[t],true);
+    }
+    delete image;
+  }
+  return 0;
+}
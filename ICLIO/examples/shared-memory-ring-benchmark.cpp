@@ -0,0 +1,172 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLIO/examples/shared-memory-ring-benchmark.cpp        **
+** Module : ICLIO                                                  **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#include <ICLIO/SharedMemoryRingPublisher.h>
+#include <ICLIO/SharedMemoryRingGrabber.h>
+#include <ICLCore/Img.h>
+#include <ICLUtils/Time.h>
+#include <ICLUtils/Thread.h>
+#include <ICLUtils/StringUtils.h>
+
+#include <sys/wait.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdio>
+
+using namespace icl;
+using namespace icl::utils;
+using namespace icl::core;
+using namespace icl::io;
+
+// measured by the reader process and sent back to the writer process
+struct Stats{
+  int received;       // number of received frames
+  int invalid;        // zero-copy frames that were overwritten while being processed
+  double seconds;     // time between the first and the last received frame
+  double latMean;     // mean latency (send -> grabbed and processed) in us
+  double latMedian;
+  double latMax;
+};
+
+// touches all pixels of the first channel, so that zero-copy does not skip the data
+static int checksum(const Img8u &image){
+  const icl8u *d = image.getData(0);
+  int s = 0;
+  for(int i=0;i<image.getDim();++i) s += d[i];
+  return s;
+}
+
+static void reader(const std::string &ring, int frames, bool zeroCopy, int fd){
+  SharedMemoryRingGrabber g(ring);
+  g.setPropertyValue("zero-copy", zeroCopy);
+  char ready = 1;
+  if(write(fd,&ready,1) != 1) return;
+
+  Stats s = {0,0,0,0,0,0};
+  std::vector<double> lat;
+  Time first;
+  volatile int sum = 0;
+  while(true){
+    const ImgBase *image = g.grab();
+    if(!image) break; // timeout
+    int idx = parse<int>(image->getMetaData());
+    if(idx < 0) continue; // warm-up frame
+    sum += checksum(*image->as8u());
+    Time now = Time::now();
+    if(zeroCopy && !g.isLastImageValid()){
+      ++s.invalid;
+    }else{
+      if(!s.received) first = now;
+      ++s.received;
+      lat.push_back((now - image->getTime()).toMicroSecondsDouble());
+      s.seconds = (now - first).toSecondsDouble();
+    }
+    if(idx == frames-1) break;
+  }
+  if(lat.size()){
+    std::sort(lat.begin(),lat.end());
+    double m = 0;
+    for(unsigned int i=0;i<lat.size();++i) m += lat[i];
+    s.latMean = m/lat.size();
+    s.latMedian = lat[lat.size()/2];
+    s.latMax = lat.back();
+  }
+  if(write(fd,&s,sizeof(Stats)) != sizeof(Stats)) return;
+}
+
+static void run(const Size &size, int frames, int periodUS, bool zeroCopy){
+  std::string ring = "icl-ring-benchmark-" + str(getpid());
+  Img8u image(size,formatRGB);
+  for(int c=0;c<3;++c){
+    std::fill(image.begin(c), image.end(c), icl8u(40*c));
+  }
+  SharedMemoryRingPublisher pub(ring, 4);
+  image.setMetaData("-1");
+  pub.send(&image); // creates the ring, so that the reader can connect
+
+  int fds[2];
+  if(pipe(fds)) return;
+  pid_t pid = fork();
+  if(!pid){
+    close(fds[0]);
+    reader(ring, frames, zeroCopy, fds[1]);
+    _exit(0);
+  }
+  close(fds[1]);
+  char ready = 0;
+  if(read(fds[0],&ready,1) != 1){
+    printf("reader process could not connect\n");
+    return;
+  }
+
+  Time t = Time::now();
+  for(int i=0;i<frames;++i){
+    image.setMetaData(str(i));
+    image.setTime(Time::now());
+    pub.send(&image);
+    if(periodUS) Thread::usleep(periodUS);
+  }
+  double sendTime = (Time::now()-t).toSecondsDouble();
+
+  Stats s = {0,0,0,0,0,0};
+  bool ok = read(fds[0],&s,sizeof(Stats)) == sizeof(Stats);
+  close(fds[0]);
+  waitpid(pid,0,0);
+  if(!ok){
+    printf("reader process failed\n");
+    return;
+  }
+
+  double mb = double(image.getDim())*image.getChannels()/(1<<20);
+  printf("%-9s %-9s %6d %9.0f %9.0f %6d %6d %9.0f %9.0f %9.0f\n",
+         str(size).c_str(), zeroCopy ? "zero-copy" : "copy", frames,
+         frames/sendTime, s.seconds > 0 ? (s.received-1)/s.seconds*mb : 0.0,
+         frames - s.received - s.invalid, s.invalid, s.latMean, s.latMedian, s.latMax);
+}
+
+int main(int n, char **ppc){
+  const char *header = "%-9s %-9s %6s %9s %9s %6s %6s %9s %9s %9s\n";
+  printf("shared memory ring benchmark (writer and reader in two processes, 4 slots, RGB 8u)\n\n");
+
+  printf("latency (one frame every 2 ms, latency is measured from send to grabbed and processed in us):\n");
+  printf(header,"size","mode","frames","pub/s","rcv MB/s","drop","inval","mean","median","max");
+  run(Size::VGA, 500, 2000, false);
+  run(Size::VGA, 500, 2000, true);
+  run(Size(1920,1080), 200, 4000, false);
+  run(Size(1920,1080), 200, 4000, true);
+
+  printf("\nthroughput (frames are published back to back, the writer never waits for the reader):\n");
+  printf(header,"size","mode","frames","pub/s","rcv MB/s","drop","inval","mean","median","max");
+  run(Size::VGA, 2000, 0, false);
+  run(Size::VGA, 2000, 0, true);
+  run(Size(1920,1080), 500, 0, false);
+  run(Size(1920,1080), 500, 0, true);
+  return 0;
+}
@@ -45,7 +45,7 @@ namespace icl{
     namespace color_format_converter{
 
       template<BayerConverter::bayerPattern P>
-      void bayer(const icl8u *rawData,const Size &size, ImgBase **dst, std::vector<icl8u> *buffer=0){
+      void bayer(const icl8u *rawData,const Size &size, ImgBase **dst, std::vector<icl8u> *buffer, const Size&){
         ensureCompatible(dst,depth8u, size, formatRGB);
         BayerConverter bc(P,BayerConverter::bilinear);
         std::vector<icl8u*> cs(1,const_cast<icl8u*>(rawData));
@@ -54,7 +54,7 @@ namespace icl{
       }
       
       // can be used to grab kinect IR-image via V4L2
-      void y10b(const icl8u *rawData,const Size &size, ImgBase **dst, std::vector<icl8u> *buffer=0){
+      void y10b(const icl8u *rawData,const Size &size, ImgBase **dst, std::vector<icl8u> *buffer, const Size&){
         ensureCompatible(dst,depth16s,size,formatGray);
         icl16s *d = (*dst)->as16s()->begin(0);
         int dim = size.getDim()+1;
@@ -71,12 +71,12 @@ namespace icl{
 	}
       }
   
-      void myrm(const icl8u *rawData,const Size &size, ImgBase **dst, std::vector<icl8u> *buffer=0){
+      void myrm(const icl8u *rawData,const Size &size, ImgBase **dst, std::vector<icl8u> *buffer, const Size&){
         static MyrmexDecoder dec;
         dec.decode(reinterpret_cast<const icl16s*>(rawData), size, dst);
       }
         
-      void gray(const icl8u *rawData,const Size &size, ImgBase **dst, std::vector<icl8u> *buffer=0){
+      void gray(const icl8u *rawData,const Size &size, ImgBase **dst, std::vector<icl8u> *buffer, const Size&){
         ensureCompatible(dst,depth8u,size,formatGray);
         Img8u &image = *(*dst)->as8u();
   
@@ -86,7 +86,7 @@ namespace icl{
       }
       
       
-      void y444(const icl8u* rawData, const Size &size, ImgBase **dst, std::vector<icl8u> *buffer){
+      void y444(const icl8u* rawData, const Size &size, ImgBase **dst, std::vector<icl8u> *buffer, const Size&){
         ensureCompatible(dst,depth8u,size,formatRGB);
         Img8u &image = *(*dst)->as8u();
   
@@ -116,7 +116,7 @@ namespace icl{
       }
       
       // uses ipp if available and if buf is not null
-      void yuyv(const icl8u* yuyv, const Size &size, ImgBase **dst, std::vector<icl8u> *buf=0){
+      void yuyv(const icl8u* yuyv, const Size &size, ImgBase **dst, std::vector<icl8u> *buf, const Size&){
         ensureCompatible(dst,depth8u,size,formatRGB);
         Img8u &image = *(*dst)->as8u();
         /*
@@ -150,7 +150,7 @@ namespace icl{
       }
 
       // uses ipp if available and if buf is not null
-      void yuy2(const icl8u* yuy2, const Size &size, ImgBase **dst, std::vector<icl8u> *buf=0){
+      void yuy2(const icl8u* yuy2, const Size &size, ImgBase **dst, std::vector<icl8u> *buf, const Size&){
         ensureCompatible(dst,depth8u,size,formatRGB);
         Img8u &image = *(*dst)->as8u();
         // interleaved order yuyv
@@ -175,13 +175,14 @@ namespace icl{
      
   
   #ifdef ICL_HAVE_LIBJPEG    
-      void mjpg(const icl8u* data, const Size &size, ImgBase **dst, std::vector<icl8u> *buf = 0){
+      // decodes at a reduced resolution if a desired size is given
+      void mjpg(const icl8u* data, const Size &size, ImgBase **dst, std::vector<icl8u>*, const Size &desiredSize){
         try{
           // naive check for a correct jpeg file:
           const unsigned char *p = data;
           ICLASSERT_THROW(*p++ == 0xFF,1); // SOI Marker
           ICLASSERT_THROW(*p++ == 0xD8,2);
-          JPEGDecoder::decode(data,4*size.getDim(),dst);
+          JPEGDecoder::decode(data,4*size.getDim(),dst,desiredSize);
         }catch(std::exception &ex){
           WARNING_LOG("error decoding motion JPEG : " + str(ex.what()) );
         }catch(...){
@@ -189,12 +190,12 @@ namespace icl{
         }
       }
   #endif
-      void yu12(const icl8u* data, const Size &size, ImgBase **dst, std::vector<icl8u>*){
+      void yu12(const icl8u* data, const Size &size, ImgBase **dst, std::vector<icl8u>*, const Size&){
         ensureCompatible(dst,depth8u,size,formatRGB);
         convertYUV420ToRGB8(data,size,(*dst)->as8u());
       }
 
-       void rgb3(const icl8u* data, const Size &size, ImgBase **dst, std::vector<icl8u>*){
+       void rgb3(const icl8u* data, const Size &size, ImgBase **dst, std::vector<icl8u>*, const Size&){
         ensureCompatible(dst,depth8u,size,formatRGB);
         interleavedToPlanar(data, (*dst)->as8u());
       }
@@ -228,8 +229,7 @@ namespace icl{
     void ColorFormatDecoder::decode(FourCC fourcc, const icl8u *data, const Size &size, ImgBase **dst){
       std::map<icl32u,decoder_func>::iterator it = m_functions.find(fourcc.asInt());
       if(it == m_functions.end()) throw ICLException("ColorFormatDecoder::unable to convert given format " + fourcc.asString());
-  
-      it->second(data,size,dst,&m_buffer);
+      it->second(data,size,dst,&m_buffer,m_desiredSize);
     }
   } // namespace io
 }
@@ -62,7 +62,8 @@ namespace icl{
           (note that bayer filters are often used with Firewire cameras, but in the DCGrabber
           backend, the core::BayerConverter is used automatically)
         * <b>MJPG</b> Motion jpeg. Here, each image frame actually contains binary encoded
-          jpeg data
+          jpeg data. If a desired size is set (see setDesiredSize), the frames are decoded
+          at a reduced resolution (1/2, 1/4 or 1/8) using libjpeg's DCT scaling
         
         \section EX ICL Specific Extensions
         For supporting the Myrmex Tactile Device, we added an extra
@@ -72,13 +73,14 @@ namespace icl{
     */
     class ICLIO_API ColorFormatDecoder{
       public:
-      // conversion function type
-      typedef void (*decoder_func)(const icl8u*,const utils::Size&,core::ImgBase**,std::vector<icl8u>*);
+      // conversion function type (the last parameter is the size hint, see setDesiredSize)
+      typedef void (*decoder_func)(const icl8u*,const utils::Size&,core::ImgBase**,std::vector<icl8u>*,const utils::Size&);
       
       private:
       std::vector<icl8u> m_buffer; //!< internal buffer  
       std::map<icl32u,decoder_func> m_functions; //!< internal lookup for conversion functions
       core::ImgBase *m_dstBuf;  //!< optionally used output buffer
+      utils::Size m_desiredSize; //!< size hint for motion jpeg decoding
       
       public:
       /// create a new instance
@@ -92,6 +94,13 @@ namespace icl{
         return m_functions.find(fourcc.asInt()) != m_functions.end();
       }
       
+      /// sets a size hint for the decoding of motion jpeg frames
+      /** The frames are decoded at the smallest supported reduced resolution, that is not
+          smaller than the given size (see JPEGDecoder). Other formats are not affected */
+      inline void setDesiredSize(const utils::Size &size){
+        m_desiredSize = size;
+      }
+      
       /// decodes a given data range to RGB
       void decode(FourCC fourcc, const icl8u *data, const utils::Size &size, core::ImgBase **dst);
   
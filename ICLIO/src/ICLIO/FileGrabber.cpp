@@ -36,6 +36,7 @@
 #include <ICLUtils/Exception.h>
 #include <ICLUtils/StringUtils.h>
 #include <ICLUtils/Thread.h>
+#include <ICLUtils/Semaphore.h>
 #include <ICLUtils/Function.h>
 #include <ICLUtils/File.h>
 // plugins
@@ -69,6 +70,8 @@ using namespace icl::core;
 namespace icl{
   namespace io{
 
+    class FileGrabberReadAhead;
+
     struct FileGrabber::Data{
         /// internal file list
         FileList oFileList;
@@ -102,47 +105,84 @@ namespace icl{
 
         /// also for time stamp based image acquisition
         Time referenceTimeReal;
-      
+
+        /// read-ahead decoding pipeline (created on demand)
+        FileGrabberReadAhead *readAhead;
+
+        /// number of frames that are decoded in advance (0: read-ahead is disabled)
+        int readAheadFrames;
+
+        /// number of decoder threads
+        int readAheadThreads;
+
+        /// memory limit for the decoded frames in MB (0: no limit)
+        int readAheadMemoryLimit;
+
+        /// set if the read-ahead pipeline must be recreated
+        bool readAheadChanged;
+
+        /// set if the last file was grabbed and loop is false
+        bool endReached;
+
+        /// waits until the given image's time stamp is reached (if useTimeStamps is set)
+        void waitForTimeStamp(const ImgBase *image);
     };
     
-    static FileGrabberPlugin *find_plugin(const std::string &type){
-      static std::map<std::string,SmartPtr<FileGrabberPlugin> > plugins;
+    /// factory function type for plugin instances
+    typedef FileGrabberPlugin *(*PluginFactory)();
+
+    /// creates a new plugin instance
+    template<class Plugin>
+    static FileGrabberPlugin *create_plugin(){
+      return new Plugin;
+    }
+
+    static std::string to_lower(const std::string &s){
+      std::string l = s;
+      for(unsigned int i=0;i<l.length();++i){
+        l[i] = tolower(l[i]);
+      }
+      return l;
+    }
+
+    static PluginFactory find_plugin_factory(const std::string &type){
+      static std::map<std::string,PluginFactory> plugins;
       if(!plugins.size()){
-        plugins[".ppm"] = new FileGrabberPluginPNM;
-        plugins[".pgm"] = new FileGrabberPluginPNM;
-        plugins[".pnm"] = new FileGrabberPluginPNM;
-        plugins[".icl"] = new FileGrabberPluginPNM;
-        plugins[".csv"] = new FileGrabberPluginCSV;
-        plugins[".bicl"] = new FileGrabberPluginBICL;
-        plugins[".rle1"] = new FileGrabberPluginBICL;
-        plugins[".rle4"] = new FileGrabberPluginBICL;
-        plugins[".rle6"] = new FileGrabberPluginBICL;
-        plugins[".rle8"] = new FileGrabberPluginBICL;
+        plugins[".ppm"] = create_plugin<FileGrabberPluginPNM>;
+        plugins[".pgm"] = create_plugin<FileGrabberPluginPNM>;
+        plugins[".pnm"] = create_plugin<FileGrabberPluginPNM>;
+        plugins[".icl"] = create_plugin<FileGrabberPluginPNM>;
+        plugins[".csv"] = create_plugin<FileGrabberPluginCSV>;
+        plugins[".bicl"] = create_plugin<FileGrabberPluginBICL>;
+        plugins[".rle1"] = create_plugin<FileGrabberPluginBICL>;
+        plugins[".rle4"] = create_plugin<FileGrabberPluginBICL>;
+        plugins[".rle6"] = create_plugin<FileGrabberPluginBICL>;
+        plugins[".rle8"] = create_plugin<FileGrabberPluginBICL>;
 
 #ifdef ICL_HAVE_LIBJPEG
-        plugins[".jpg"] = new FileGrabberPluginJPEG;
-        plugins[".jpeg"] = new FileGrabberPluginJPEG;
-        plugins[".jicl"] = new FileGrabberPluginBICL;
+        plugins[".jpg"] = create_plugin<FileGrabberPluginJPEG>;
+        plugins[".jpeg"] = create_plugin<FileGrabberPluginJPEG>;
+        plugins[".jicl"] = create_plugin<FileGrabberPluginBICL>;
 #elif ICL_HAVE_IMAGEMAGICK
-        plugins[".jpg"] = new FileGrabberPluginImageMagick;
-        plugins[".jpeg"] = new FileGrabberPluginImageMagick;
+        plugins[".jpg"] = create_plugin<FileGrabberPluginImageMagick>;
+        plugins[".jpeg"] = create_plugin<FileGrabberPluginImageMagick>;
 #endif
 
 #ifdef ICL_HAVE_LIBZ
-        plugins[".ppm.gz"] = new FileGrabberPluginPNM;
-        plugins[".pgm.gz"] = new FileGrabberPluginPNM;
-        plugins[".pnm.gz"] = new FileGrabberPluginPNM;
-        plugins[".icl.gz"] = new FileGrabberPluginPNM;
-        plugins[".csv.gz"] = new FileGrabberPluginCSV;
-        plugins[".bicl.gz"] = new FileGrabberPluginBICL;
-        plugins[".rle1.gz"] = new FileGrabberPluginBICL;
-        plugins[".rle4.gz"] = new FileGrabberPluginBICL;
-        plugins[".rle6.gz"] = new FileGrabberPluginBICL;
-        plugins[".rle8.gz"] = new FileGrabberPluginBICL;
+        plugins[".ppm.gz"] = create_plugin<FileGrabberPluginPNM>;
+        plugins[".pgm.gz"] = create_plugin<FileGrabberPluginPNM>;
+        plugins[".pnm.gz"] = create_plugin<FileGrabberPluginPNM>;
+        plugins[".icl.gz"] = create_plugin<FileGrabberPluginPNM>;
+        plugins[".csv.gz"] = create_plugin<FileGrabberPluginCSV>;
+        plugins[".bicl.gz"] = create_plugin<FileGrabberPluginBICL>;
+        plugins[".rle1.gz"] = create_plugin<FileGrabberPluginBICL>;
+        plugins[".rle4.gz"] = create_plugin<FileGrabberPluginBICL>;
+        plugins[".rle6.gz"] = create_plugin<FileGrabberPluginBICL>;
+        plugins[".rle8.gz"] = create_plugin<FileGrabberPluginBICL>;
 #endif
 
 #ifdef ICL_HAVE_LIBPNG
-        plugins[".png"] = new FileGrabberPluginPNG;
+        plugins[".png"] = create_plugin<FileGrabberPluginPNG>;
 #endif
 
 #ifdef ICL_HAVE_IMAGEMAGICK
@@ -162,20 +202,314 @@ namespace icl{
         };
         
         for(const char **pc=imageMagickFormats;*pc;++pc){
-          plugins[std::string(".")+*pc] = new FileGrabberPluginImageMagick;
+          plugins[std::string(".")+*pc] = create_plugin<FileGrabberPluginImageMagick>;
         }
 #endif
         // add additional plugins to the map
       }
-      std::string lowerType = type;
-      for(unsigned int i=0;i<lowerType.length();++i){
-        lowerType[i] = tolower(lowerType[i]);
-      }
-      std::map<std::string,SmartPtr<FileGrabberPlugin> >::iterator it = plugins.find(lowerType);
+      std::map<std::string,PluginFactory>::iterator it = plugins.find(to_lower(type));
       if(it == plugins.end()) return 0;
-      else return it->second.get();
+      else return it->second;
+    }
+
+    /// returns a plugin instance for the given file suffix from the given instance map
+    static FileGrabberPlugin *find_plugin(const std::string &type,
+                                          std::map<std::string,SmartPtr<FileGrabberPlugin> > &plugins){
+      PluginFactory create = find_plugin_factory(type);
+      if(!create) return 0;
+      SmartPtr<FileGrabberPlugin> &p = plugins[to_lower(type)];
+      if(!p) p = create();
+      return p.get();
+    }
+
+    /// returns the shared plugin instance for the given file suffix
+    static FileGrabberPlugin *find_plugin(const std::string &type){
+      static std::map<std::string,SmartPtr<FileGrabberPlugin> > plugins;
+      return find_plugin(type,plugins);
     }
     
+    /// frame of the read-ahead pool
+    struct ReadAheadFrame{
+      enum State { Empty, Decoding, Ready, Failed };
+      int fileIdx;        //!< index of the decoded file (-1 if unused)
+      State state;        //!< decoding state
+      ImgBase *image;     //!< decoded image (recycled for other files)
+      std::string error;  //!< error message (state Failed)
+      Size desiredSize;   //!< size hint, the file was decoded with
+      ReadAheadFrame():fileIdx(-1),state(Empty),image(0){}
+    };
+
+    /// background decoder threads, that decode the files following the current one
+    /** All files within the window [current, current+windowSize) are decoded in order
+        into a pool of numFrames+1 recycled images (the additional frame is the one
+        that was returned last). Frames that leave the window (e.g. because of a jump)
+        are not decoded anymore, frames that are still in the window after a jump are
+        reused. Frames that were decoded with another size hint are discarded. */
+    class FileGrabberReadAhead{
+      struct Worker : public Thread{
+        FileGrabberReadAhead *ra;
+        std::map<std::string,SmartPtr<FileGrabberPlugin> > plugins; // own plugin instances
+        Worker(FileGrabberReadAhead *ra):ra(ra){}
+        virtual void run(){ ra->work(*this); }
+      };
+
+      FileList files;
+      std::string forcedPluginType;
+      int numFrames;
+      size_t memoryLimit;
+      std::vector<ReadAheadFrame> frames;
+      std::vector<Worker*> workers;
+      Mutex mutex;
+      Semaphore workAvailable;
+      Semaphore frameDone;
+      bool quit;
+      int current;          // first file index of the window
+      bool loop;
+      int held;             // frame that was returned last (-1 if none)
+      size_t bytesPerFrame; // size of the last decoded image
+      Size desiredSize;     // size hint for the plugins
+
+      public:
+      FileGrabberReadAhead(const FileList &files, const std::string &forcedPluginType,
+                           int numFrames, int numThreads, int memoryLimitMB,
+                           int current, bool loop, const Size &desiredSize):
+        files(files),forcedPluginType(forcedPluginType),numFrames(numFrames),
+        memoryLimit(size_t(memoryLimitMB)<<20),frames(numFrames+1),
+        workAvailable(1),frameDone(1),quit(false),current(current),loop(loop),held(-1),bytesPerFrame(0),
+        desiredSize(desiredSize){
+        // utils::Semaphore can not be created without resources
+        workAvailable.acquire();
+        frameDone.acquire();
+        for(int i=0;i<numThreads;++i){
+          workers.push_back(new Worker(this));
+          workers.back()->start();
+        }
+      }
+
+      ~FileGrabberReadAhead(){
+        mutex.lock();
+        quit = true;
+        mutex.unlock();
+        workAvailable.release(workers.size());
+        for(unsigned int i=0;i<workers.size();++i){
+          workers[i]->wait();
+          delete workers[i];
+        }
+        for(unsigned int i=0;i<frames.size();++i){
+          ICL_DELETE(frames[i].image);
+        }
+      }
+
+      /// moves the window (e.g. after a jump)
+      void setPosition(int idx, bool loop){
+        Mutex::Locker lock(mutex);
+        current = idx;
+        this->loop = loop;
+        wakeWorkers();
+      }
+
+      /// returns the frame of file idx and moves the window to nextIdx
+      const ImgBase *grab(int idx, int nextIdx, bool loop, const Size &desiredSize){
+        mutex.lock();
+        current = idx;
+        this->loop = loop;
+        held = -1; // the last returned image is released
+        if(desiredSize != this->desiredSize){
+          // frames decoded with the old hint are decoded again (their images are recycled)
+          this->desiredSize = desiredSize;
+          for(unsigned int i=0;i<frames.size();++i){
+            if(frames[i].state == ReadAheadFrame::Ready || frames[i].state == ReadAheadFrame::Failed){
+              frames[i].fileIdx = -1;
+              frames[i].state = ReadAheadFrame::Empty;
+            }
+          }
+        }
+        wakeWorkers();
+        ReadAheadFrame *f = 0;
+        while(true){
+          for(unsigned int i=0;i<frames.size() && !f;++i){
+            if(frames[i].fileIdx == idx && frames[i].desiredSize == desiredSize &&
+               (frames[i].state == ReadAheadFrame::Ready || frames[i].state == ReadAheadFrame::Failed)){
+              f = &frames[i];
+            }
+          }
+          if(f) break;
+          mutex.unlock();
+          frameDone.acquire();
+          mutex.lock();
+        }
+        held = (int)(f - &frames[0]);
+        current = nextIdx;
+        wakeWorkers();
+        bool failed = f->state == ReadAheadFrame::Failed;
+        std::string error = f->error;
+        mutex.unlock();
+        if(failed) throw ICLException(error);
+        return f->image;
+      }
+
+      private:
+
+      /// number of frames that are decoded in advance (regarding the memory limit)
+      int getWindowSize() const{
+        int w = iclMin(numFrames, files.size());
+        if(memoryLimit && bytesPerFrame){
+          w = iclMax(1, iclMin(w, (int)(memoryLimit / bytesPerFrame) - 1));
+        }
+        return w;
+      }
+
+      bool inWindow(int idx, int windowSize) const{
+        int d = idx - current;
+        if(d < 0){
+          if(!loop) return false;
+          d += files.size();
+        }
+        return d < windowSize;
+      }
+
+      bool isReusable(const ReadAheadFrame &f, int windowSize) const{
+        return (&f - &frames[0]) != held && f.state != ReadAheadFrame::Decoding &&
+               (f.fileIdx < 0 || !inWindow(f.fileIdx, windowSize));
+      }
+
+      void wakeWorkers(){
+        if(workAvailable.getValue() < (int)workers.size()) workAvailable.release();
+      }
+
+      /// finds the next file to decode and reserves a frame for it (mutex must be locked)
+      ReadAheadFrame *findJob(){
+        const int n = files.size();
+        const int w = getWindowSize();
+
+        // release image memory of unused frames to obey the memory limit
+        int numImages = 0;
+        for(unsigned int i=0;i<frames.size();++i) numImages += !!frames[i].image;
+        for(unsigned int i=0;i<frames.size() && numImages > w+1;++i){
+          if(frames[i].image && isReusable(frames[i],w)){
+            ICL_DELETE(frames[i].image);
+            frames[i].fileIdx = -1;
+            frames[i].state = ReadAheadFrame::Empty;
+            --numImages;
+          }
+        }
+
+        for(int k=0;k<w;++k){
+          int idx = current + k;
+          if(idx >= n){
+            if(!loop) return 0;
+            idx -= n;
+          }
+          bool present = false;
+          for(unsigned int i=0;i<frames.size() && !present;++i){
+            present = frames[i].fileIdx == idx && frames[i].state != ReadAheadFrame::Empty;
+          }
+          if(present) continue;
+
+          // prefer frames that already have an image, that can be recycled
+          ReadAheadFrame *f = 0;
+          for(unsigned int i=0;i<frames.size();++i){
+            if(isReusable(frames[i],w) && (!f || (!f->image && frames[i].image))){
+              f = &frames[i];
+            }
+          }
+          if(!f) return 0;
+          f->fileIdx = idx;
+          f->state = ReadAheadFrame::Decoding;
+          f->desiredSize = desiredSize;
+          return f;
+        }
+        return 0;
+      }
+
+      void work(Worker &w){
+        while(true){
+          mutex.lock();
+          if(quit){
+            mutex.unlock();
+            return;
+          }
+          ReadAheadFrame *f = findJob();
+          if(!f){
+            mutex.unlock();
+            workAvailable.acquire();
+            continue;
+          }
+          std::string filename = files[f->fileIdx];
+          Size desired = f->desiredSize;
+          mutex.unlock();
+
+          // the frame is not touched by other threads while it is in state Decoding
+          bool failed = false;
+          std::string error;
+          try{
+            File file(filename);
+            if(!file.exists()) throw FileNotFoundException(filename);
+            FileGrabberPlugin *p = find_plugin(forcedPluginType == "" ? file.getSuffix() : forcedPluginType, w.plugins);
+            if(!p) throw InvalidFileException(str("file type (filename was \"")+filename+"\")");
+            try{
+              p->setDesiredSize(desired);
+              p->grab(file,&f->image);
+            }catch(ICLException&){
+              if(file.isOpen()) file.close();
+              throw;
+            }
+          }catch(ICLException &e){
+            failed = true;
+            error = e.what();
+          }
+
+          mutex.lock();
+          if(f->desiredSize != desiredSize){
+            // the size hint was changed while decoding: the file is decoded again
+            f->fileIdx = -1;
+            f->state = ReadAheadFrame::Empty;
+            mutex.unlock();
+            continue;
+          }
+          f->state = failed ? ReadAheadFrame::Failed : ReadAheadFrame::Ready;
+          f->error = error;
+          if(!failed && f->image){
+            bytesPerFrame = (size_t)f->image->getDim() * f->image->getChannels() * getSizeOf(f->image->getDepth());
+          }
+          mutex.unlock();
+          if(frameDone.getValue() < 1) frameDone.release();
+        }
+      }
+    };
+
+    void FileGrabber::Data::waitForTimeStamp(const ImgBase *image){
+      if(useTimeStamps){
+        Time now = Time::now();
+        Time &ref = referenceTime;
+        Time &refReal = referenceTimeReal;
+        Time t = image->getTime();
+        if(t == Time(0)){
+          ERROR_LOG("property 'use-time-stamps' activated, but image with time-stamp '0' found (deactivating 'use-time-stamps')");
+          useTimeStamps = false;
+          return;
+        }
+        if(ref == Time(0) || iCurrIdx == 1){
+          ref = t;
+          refReal = now;
+        }else{
+          Time desiredDT = t - ref;
+          Time currentDT = now - refReal;
+          if(desiredDT > currentDT){
+            Time ddt = desiredDT - currentDT;
+            Thread::usleep(ddt.toMicroSeconds());
+          }else{
+            static bool first = true;
+            if(first && iCurrIdx != 2){ // hack!!
+              first = false;
+              WARNING_LOG("property 'use-time-stamps' is activated, but the processing framerate\n"
+                          "    is slower than the captured image framerate (this message is only shown once)");
+            }
+          }
+        }
+      }
+    }
+
     FileGrabber::FileGrabber()
       :  m_data(new Data), m_propertyMutex(utils::Mutex::mutexTypeRecursive), m_updatingProperties(false)
     {
@@ -185,6 +519,12 @@ namespace icl{
       m_data->loop = true;
       m_data->poBufferImage = 0;
       m_data->useTimeStamps = false;
+      m_data->readAhead = 0;
+      m_data->readAheadFrames = 0;
+      m_data->readAheadThreads = 2;
+      m_data->readAheadMemoryLimit = 0;
+      m_data->readAheadChanged = false;
+      m_data->endReached = false;
       addProperties();
     }
     
@@ -241,6 +581,12 @@ namespace icl{
       m_data->loop = true;
       m_data->poBufferImage = 0;
       m_data->useTimeStamps = false;
+      m_data->readAhead = 0;
+      m_data->readAheadFrames = 0;
+      m_data->readAheadThreads = 2;
+      m_data->readAheadMemoryLimit = 0;
+      m_data->readAheadChanged = false;
+      m_data->endReached = false;
       
       
       if(buffer){
@@ -254,6 +600,7 @@ namespace icl{
     FileGrabber::~FileGrabber(){
       // {{{ open
 
+      ICL_DELETE(m_data->readAhead);
       ICL_DELETE(m_data->poBufferImage);
       for(unsigned int i=0;i<m_data->vecImageBuffer.size();i++){
         ICL_DELETE(m_data->vecImageBuffer[i]);
@@ -306,6 +653,7 @@ namespace icl{
       ICLASSERT_RETURN(m_data->oFileList.size());
       m_data->iCurrIdx++;
       if(m_data->iCurrIdx >= m_data->oFileList.size()) m_data->iCurrIdx = 0;
+      positionChanged();
     }
 
     // }}}
@@ -315,6 +663,29 @@ namespace icl{
       ICLASSERT_RETURN(m_data->oFileList.size());
       m_data->iCurrIdx--;
       if(m_data->iCurrIdx <= 0) m_data->iCurrIdx = m_data->oFileList.size()-1;
+      positionChanged();
+    }
+
+    // }}}
+
+    void FileGrabber::positionChanged(){
+      // {{{ open
+
+      utils::Mutex::Locker l(m_propertyMutex);
+      m_data->endReached = false;
+      if(m_data->readAhead){
+        m_data->readAhead->setPosition(m_data->iCurrIdx, m_data->loop);
+      }
+    }
+
+    // }}}
+
+    void FileGrabber::setReadAhead(int numFrames, int numThreads, int memoryLimitMB){
+      // {{{ open
+
+      setPropertyValue("read-ahead", numFrames);
+      setPropertyValue("read-ahead-threads", numThreads);
+      setPropertyValue("read-ahead-memory-limit", memoryLimitMB);
     }
 
     // }}}
@@ -363,17 +734,46 @@ namespace icl{
       }
 
       ICLASSERT_RETURN_VAL(!m_data->oFileList.isNull(),NULL);
-      File f(m_data->oFileList[m_data->iCurrIdx]);
-      if(m_data->bAutoNext) ++m_data->iCurrIdx;
-      if(!f.exists()) throw FileNotFoundException(f.getName());
-      if(m_data->iCurrIdx >= m_data->oFileList.size()){
-        if(m_data->loop){
+
+      // if loop is false, the last file is still returned (in both modes); the
+      // exception is thrown when the next image is grabbed
+      if(m_data->endReached) throw ICLException("No more files available");
+      const int idx = m_data->iCurrIdx;
+      if(m_data->bAutoNext){
+        if(idx+1 < m_data->oFileList.size()){
+          ++m_data->iCurrIdx;
+        }else if(m_data->loop){
           m_data->iCurrIdx = 0;
         }else{
-          throw ICLException("No more files available");
+          m_data->endReached = true;
+        }
+      }
+
+      if(m_data->readAheadFrames > 0){
+        FileGrabberReadAhead *ra = 0;
+        {
+          utils::Mutex::Locker l(m_propertyMutex);
+          if(m_data->readAheadChanged || !m_data->readAhead){
+            ICL_DELETE(m_data->readAhead);
+            m_data->readAhead = new FileGrabberReadAhead(m_data->oFileList, m_data->forcedPluginType,
+                                                         m_data->readAheadFrames, m_data->readAheadThreads,
+                                                         m_data->readAheadMemoryLimit, idx, m_data->loop,
+                                                         getDesired<Size>());
+            m_data->readAheadChanged = false;
+          }
+          ra = m_data->readAhead;
         }
+        const ImgBase *image = ra->grab(idx, m_data->iCurrIdx, m_data->loop, getDesired<Size>());
+        m_data->waitForTimeStamp(image);
+        return image;
+      }else if(m_data->readAhead){
+        utils::Mutex::Locker l(m_propertyMutex);
+        ICL_DELETE(m_data->readAhead);
       }
 
+      File f(m_data->oFileList[idx]);
+      if(!f.exists()) throw FileNotFoundException(f.getName());
+
       FileGrabberPlugin *p = find_plugin(m_data->forcedPluginType == "" ? f.getSuffix() : m_data->forcedPluginType);
       if(!p){
         throw InvalidFileException(str("file type (filename was \"")+f.getName()+"\")");
@@ -381,49 +781,23 @@ namespace icl{
       }
 
       try{
+        p->setDesiredSize(getDesired<Size>());
         p->grab(f,&m_data->poBufferImage);
       }catch(ICLException&){
         if(f.isOpen()) f.close();
         throw;
       }
 
-      if(m_data->useTimeStamps){
-        Time now = Time::now();
-        Time &ref = m_data->referenceTime;
-        Time &refReal = m_data->referenceTimeReal;
-        Time t = m_data->poBufferImage->getTime();
-        if(t == Time(0)){
-          ERROR_LOG("property 'use-time-stamps' activated, but image with time-stamp '0' found (deactivating 'use-time-stamps')");
-          m_data->useTimeStamps = false;
-          return m_data->poBufferImage;
-        }
-        if(ref == Time(0) || m_data->iCurrIdx == 1){
-          ref = t;
-          refReal = now;
-        }else{
-          Time desiredDT = t - ref;
-          Time currentDT = now - refReal;
-          if(desiredDT > currentDT){
-            Time ddt = desiredDT - currentDT;
-            Thread::usleep(ddt.toMicroSeconds());
-          }else{
-            static bool first = true;
-            if(first && m_data->iCurrIdx != 2){ // hack!!
-              first = false;
-              WARNING_LOG("property 'use-time-stamps' is activated, but the processing framerate\n"
-                          "    is slower than the captured image framerate (this message is only shown once)");
-            }
-          }
-        }
-      }
-
+      m_data->waitForTimeStamp(m_data->poBufferImage);
       return m_data->poBufferImage;
     }
 
     // }}}
 
     void FileGrabber::forcePluginType(const std::string &suffix){
+      utils::Mutex::Locker l(m_propertyMutex);
       m_data->forcedPluginType = suffix;
+      m_data->readAheadChanged = true;
     }
 
     void FileGrabber::addProperties(){
@@ -442,6 +816,9 @@ namespace icl{
       addProperty("file-count","info","",str(m_data->oFileList.size()),0,"Total count of files the grabber will show");
       //addProperty("frame-index","range","[0," + str(m_data->oFileList.size()-1) + "]1",m_data->iCurrIdx,20,"Currently grabbed frame");
       addProperty("frame-index","range:spinbox","[0," + str(m_data->oFileList.size()-1) + "]",m_data->iCurrIdx,20,"Currently grabbed frame");
+      addProperty("read-ahead","range:spinbox","[0,64]",m_data->readAheadFrames,0,"Number of frames that are decoded in advance by background threads (0: off)");
+      addProperty("read-ahead-threads","range:spinbox","[1,16]",m_data->readAheadThreads,0,"Number of decoder threads used for read-ahead");
+      addProperty("read-ahead-memory-limit","range:spinbox","[0,65536]",m_data->readAheadMemoryLimit,0,"Memory limit (in MB) for the frames decoded in advance (0: no limit)");
       Configurable::registerCallback(utils::function(this,&FileGrabber::processPropertyChange));
     }
 
@@ -454,6 +831,7 @@ namespace icl{
         prev();
       }else if(prop.name == "loop"){
         m_data->loop = parse<bool>(prop.value);
+        positionChanged();
       }else if(prop.name == "use-time-stamps"){
         bool val = parse<bool>(prop.value);
         if(val != m_data->useTimeStamps){
@@ -463,6 +841,7 @@ namespace icl{
         }
       }else if(prop.name == "jump-to-start"){
         m_data->iCurrIdx = 0;
+        positionChanged();
       }else if(prop.name == "auto-next"){
         m_data->bAutoNext = parse<bool>(prop.value);
       }else if(prop.name ==  "frame-index"){
@@ -479,8 +858,18 @@ namespace icl{
             WARNING_LOG("given frame-index was not within the valid range (given value was clipped)");
           }
           m_data->iCurrIdx = parse<int>(prop.value) % (m_data->oFileList.size()-1);
+          positionChanged();
           Thread::sleep(0.2);
         }
+      }else if(prop.name == "read-ahead"){
+        m_data->readAheadFrames = iclMax(0,parse<int>(prop.value));
+        m_data->readAheadChanged = true;
+      }else if(prop.name == "read-ahead-threads"){
+        m_data->readAheadThreads = iclMax(1,parse<int>(prop.value));
+        m_data->readAheadChanged = true;
+      }else if(prop.name == "read-ahead-memory-limit"){
+        m_data->readAheadMemoryLimit = iclMax(0,parse<int>(prop.value));
+        m_data->readAheadChanged = true;
       }else{
         ERROR_LOG("property \"" << prop.name << "\" is not available of cannot be set");
       }
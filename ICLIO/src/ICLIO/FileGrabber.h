@@ -49,6 +49,33 @@ namespace icl{
           ...
         }
         \endcode
+
+        \section READAHEAD Read-Ahead Decoding
+        By default, each file is decoded synchronously in the grab call, while
+        bufferImages decodes the whole sequence into memory at once. For the
+        playback of large image sequences, a bounded read-ahead mode can be
+        enabled (see setReadAhead or the properties "read-ahead",
+        "read-ahead-threads" and "read-ahead-memory-limit"). In this mode,
+        background decoder threads decode the next N files in order into a pool
+        of recycled images, so that the grab call usually just returns an already
+        decoded frame. Using T decoder threads, sustained playback is up to
+        T times faster than synchronous decoding.
+        - looping and the "auto-next" flag are supported
+        - jumps (next, prev, "jump-to-start", "frame-index") move the read-ahead
+          window: files that are no longer in the window are not decoded, already
+          decoded files that are still in the window are reused
+        - if a memory limit is given, the window is shrunk so that all decoded
+          frames (including the last returned one) fit into the limit
+        - each decoder thread uses its own plugin instances
+        - the image returned by grab is valid until the next grab call
+
+        \section SCALED Downscaled Decoding
+        If a desired size is set (e.g. via the "desired size" property), it is passed
+        to the plugins as a size hint. Jpeg files (and jpeg compressed .jicl files) are
+        then decoded directly at 1/2, 1/4 or 1/8 of their resolution using libjpeg's
+        DCT scaling (see JPEGDecoder), so that only a small residual resize is left to
+        the Grabber's desired size adaption. E.g. replaying 4K jpeg files at VGA size
+        decodes only 960x540 instead of 3840x2160 pixels.
     **/
     class ICLIO_API FileGrabber : public Grabber {
       public:
@@ -157,6 +184,12 @@ namespace icl{
       */
         void forcePluginType(const std::string &suffix);
 
+        /// enables decoding of the next numFrames files in background threads (see \ref READAHEAD)
+        /** @param numFrames number of frames that are decoded in advance (0 disables read-ahead)
+            @param numThreads number of decoder threads
+            @param memoryLimitMB memory limit for all decoded frames in MB (0: no limit) */
+        void setReadAhead(int numFrames, int numThreads=2, int memoryLimitMB=0);
+
       private:
         /// grab implementation called bz acquireImage().
         const core::ImgBase *grabImage();
@@ -166,6 +199,8 @@ namespace icl{
         void processPropertyChange(const utils::Configurable::Property &p);
         /// updates properties values.
         void updateProperties(const core::ImgBase* img);
+        /// notifies the read-ahead pipeline about a changed file index
+        void positionChanged();
 
         struct Data;
         Data *m_data;
@@ -42,12 +42,24 @@ namespace icl{
   #ifdef ICL_HAVE_LIBJPEG
       friend class JPEGDecoder;
   #endif
+
+      /// Default constructor (no size hint)
+      FileGrabberPlugin():m_desiredSize(utils::Size::null){}
   
       virtual ~FileGrabberPlugin() {}
       /// pure virtual grab function
       virtual void grab(utils::File &file, core::ImgBase **dest)=0;
+
+      /// sets a size hint for the decoded images (utils::Size::null: no hint)
+      /** Plugins that can decode images at a reduced resolution (jpeg and jpeg compressed
+          .jicl files) decode them at the smallest supported size, that is not smaller than
+          the given size. The FileGrabber passes its desired size and scales the result */
+      void setDesiredSize(const utils::Size &size) { m_desiredSize = size; }
   
       protected:
+      /// size hint for the decoded images
+      utils::Size m_desiredSize;
+
       /// Internally used collection of image parameters
       struct HeaderInfo{
         core::format imageFormat; ///!< format
@@ -44,6 +44,7 @@ namespace icl{
       const std::vector<icl8u> &data = file.readAll();
       
       ImageCompressor cmp;
+      cmp.setDesiredSize(m_desiredSize);
       cmp.uncompress(data.data(), data.size(), dest);
     }
   
@@ -42,7 +42,7 @@ namespace icl{
   #ifdef ICL_HAVE_LIBJPEG
     void FileGrabberPluginJPEG::grab(File &file, ImgBase **dest){
       // {{{ open 
-      JPEGDecoder::decode(file,dest);
+      JPEGDecoder::decode(file,dest,m_desiredSize);
     }
     // }}}
   #else
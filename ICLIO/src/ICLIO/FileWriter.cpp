@@ -30,6 +30,12 @@
 
 #include <ICLIO/FileWriter.h>
 #include <ICLUtils/StringUtils.h>
+#include <ICLUtils/Thread.h>
+#include <ICLUtils/Mutex.h>
+#include <ICLUtils/Semaphore.h>
+#include <ICLUtils/Time.h>
+#include <deque>
+#include <cstring>
 
 // plugins
 #include <ICLIO/FileWriterPluginPNM.h> 
@@ -54,50 +60,70 @@ namespace icl{
   namespace io{
   
     map<string,FileWriterPlugin*> FileWriter::s_mapPlugins;
-    
-    class FileWriterPluginMapInitializer{
-    public:
+
+    /// factory function type for plugin instances
+    typedef FileWriterPlugin *(*PluginFactory)();
+
+    /// creates a new plugin instance
+    template<class Plugin>
+    static FileWriterPlugin *create_plugin(){
+      return new Plugin;
+    }
+
+    /// creates a new run-length encoding bicl plugin instance
+    template<int BITS>
+    static FileWriterPlugin *create_rle_plugin(){
+      return new FileWriterPluginBICL("rlen",str(BITS));
+    }
+
+#ifdef ICL_HAVE_LIBJPEG
+    /// creates a new jpeg compressing bicl plugin instance
+    static FileWriterPlugin *create_jicl_plugin(){
+      return new FileWriterPluginBICL("jpeg","85");
+    }
+#endif
+
+    /// returns the map of all supported (lower case) suffixes and their plugin factories
+    static const std::map<std::string,PluginFactory> &get_plugin_factories(){
       // {{{ open
-  
-      FileWriterPluginMapInitializer(){
-        FileWriter::s_mapPlugins[".ppm"] = new FileWriterPluginPNM;
-        FileWriter::s_mapPlugins[".pgm"] = new FileWriterPluginPNM;
-        FileWriter::s_mapPlugins[".pnm"] = new FileWriterPluginPNM;
-        FileWriter::s_mapPlugins[".icl"] = new FileWriterPluginPNM;
-        FileWriter::s_mapPlugins[".csv"] = new FileWriterPluginCSV;
-        FileWriter::s_mapPlugins[".bicl"] = new FileWriterPluginBICL;
-        FileWriter::s_mapPlugins[".rle1"] = new FileWriterPluginBICL("rlen","1");
-        FileWriter::s_mapPlugins[".rle4"] = new FileWriterPluginBICL("rlen","4");
-        FileWriter::s_mapPlugins[".rle6"] = new FileWriterPluginBICL("rlen","6");
-        FileWriter::s_mapPlugins[".rle8"] = new FileWriterPluginBICL("rlen","8");
-  
-        
+
+      static std::map<std::string,PluginFactory> plugins;
+      if(!plugins.size()){
+        plugins[".ppm"] = create_plugin<FileWriterPluginPNM>;
+        plugins[".pgm"] = create_plugin<FileWriterPluginPNM>;
+        plugins[".pnm"] = create_plugin<FileWriterPluginPNM>;
+        plugins[".icl"] = create_plugin<FileWriterPluginPNM>;
+        plugins[".csv"] = create_plugin<FileWriterPluginCSV>;
+        plugins[".bicl"] = create_plugin<FileWriterPluginBICL>;
+        plugins[".rle1"] = create_rle_plugin<1>;
+        plugins[".rle4"] = create_rle_plugin<4>;
+        plugins[".rle6"] = create_rle_plugin<6>;
+        plugins[".rle8"] = create_rle_plugin<8>;
   
   #ifdef ICL_HAVE_LIBJPEG
-        FileWriter::s_mapPlugins[".jpeg"] = new FileWriterPluginJPEG;
-        FileWriter::s_mapPlugins[".jpg"] = new FileWriterPluginJPEG;
-        FileWriter::s_mapPlugins[".jicl"] = new FileWriterPluginBICL("jpeg","85");
+        plugins[".jpeg"] = create_plugin<FileWriterPluginJPEG>;
+        plugins[".jpg"] = create_plugin<FileWriterPluginJPEG>;
+        plugins[".jicl"] = create_jicl_plugin;
   #elif ICL_HAVE_IMAGEMAGICK
-        FileWriter::s_mapPlugins[".jpeg"] = new FileWriterPluginImageMagick;
-        FileWriter::s_mapPlugins[".jpg"] = new FileWriterPluginImageMagick;
+        plugins[".jpeg"] = create_plugin<FileWriterPluginImageMagick>;
+        plugins[".jpg"] = create_plugin<FileWriterPluginImageMagick>;
   #endif
   
   #ifdef ICL_HAVE_LIBZ
-        FileWriter::s_mapPlugins[".ppm.gz"] = new FileWriterPluginPNM;
-        FileWriter::s_mapPlugins[".pgm.gz"] = new FileWriterPluginPNM;
-        FileWriter::s_mapPlugins[".pnm.gz"] = new FileWriterPluginPNM;
-        FileWriter::s_mapPlugins[".icl.gz"] = new FileWriterPluginPNM;
-        FileWriter::s_mapPlugins[".csv.gz"] = new FileWriterPluginCSV;
-        FileWriter::s_mapPlugins[".bicl.gz"] = new FileWriterPluginBICL;
-        FileWriter::s_mapPlugins[".rle1.gz"] = new FileWriterPluginBICL("rlen","1");
-        FileWriter::s_mapPlugins[".rle4.gz"] = new FileWriterPluginBICL("rlen","4");
-        FileWriter::s_mapPlugins[".rle6.gz"] = new FileWriterPluginBICL("rlen","6");
-        FileWriter::s_mapPlugins[".rle8.gz"] = new FileWriterPluginBICL("rlen","8");
-  
+        plugins[".ppm.gz"] = create_plugin<FileWriterPluginPNM>;
+        plugins[".pgm.gz"] = create_plugin<FileWriterPluginPNM>;
+        plugins[".pnm.gz"] = create_plugin<FileWriterPluginPNM>;
+        plugins[".icl.gz"] = create_plugin<FileWriterPluginPNM>;
+        plugins[".csv.gz"] = create_plugin<FileWriterPluginCSV>;
+        plugins[".bicl.gz"] = create_plugin<FileWriterPluginBICL>;
+        plugins[".rle1.gz"] = create_rle_plugin<1>;
+        plugins[".rle4.gz"] = create_rle_plugin<4>;
+        plugins[".rle6.gz"] = create_rle_plugin<6>;
+        plugins[".rle8.gz"] = create_rle_plugin<8>;
   #endif
   
   #ifdef ICL_HAVE_LIBPNG
-        FileWriter::s_mapPlugins[".png"] = new FileWriterPluginPNG;
+        plugins[".png"] = create_plugin<FileWriterPluginPNG>;
   #endif
         
   #ifdef ICL_HAVE_IMAGEMAGICK
@@ -117,13 +143,27 @@ namespace icl{
           "wmf","wpg","xbm","xcf","xpm","xwd","ydbcr","ycbcra","yuv",0
         };
         for(const char **pc=imageMagickFormats;*pc;++pc){
-          FileWriter::s_mapPlugins[std::string(".")+*pc] = new FileWriterPluginImageMagick;
+          plugins[std::string(".")+*pc] = create_plugin<FileWriterPluginImageMagick>;
         }
-  
-  
   #endif
         // add plugins
       }
+      return plugins;
+    }
+
+    // }}}
+    
+    class FileWriterPluginMapInitializer{
+    public:
+      // {{{ open
+  
+      FileWriterPluginMapInitializer(){
+        const std::map<std::string,PluginFactory> &factories = get_plugin_factories();
+        for(std::map<std::string,PluginFactory>::const_iterator it = factories.begin();
+            it != factories.end(); ++it){
+          FileWriter::s_mapPlugins[it->first] = it->second();
+        }
+      }
       ~FileWriterPluginMapInitializer(){
         for(std::map<string,FileWriterPlugin*>::iterator it = FileWriter::s_mapPlugins.begin();
             it != FileWriter::s_mapPlugins.end(); ++it){
@@ -135,9 +175,227 @@ namespace icl{
     // }}}
     
     static FileWriterPluginMapInitializer __static_filewriter_plugin_initializer__;
+
+
+    /// asynchronous writing pipeline (see \ref ASYNC)
+    /** Images are copied into a bounded queue by FileWriter::write. The encoder threads
+        take the images from the queue in order, and each of them gets the next file name
+        from the FilenameGenerator while the mutex is locked. Therefore, the file names
+        are assigned in the order of the written images, even though the files are
+        encoded in parallel. Each encoder thread has its own plugin instances, as the
+        plugins serialize concurrent write calls internally. */
+    struct FileWriter::Data{
+      struct Worker : public Thread{
+        Data *data;
+        std::map<std::string,SmartPtr<FileWriterPlugin> > plugins; // own plugin instances
+        Worker(Data *data):data(data){}
+        virtual void run(){ data->work(*this); }
+      };
+
+      /// queued image
+      struct Job{
+        ImgBase *image; //!< copy of the written image
+        bool shallow;   //!< shallow copy of a copy-on-write image (not recycled)
+      };
+
+      FilenameGenerator &gen;
+      int queueSize;
+      QueuePolicy policy;
+      std::vector<Worker*> workers;
+      std::deque<Job> queue;
+      std::vector<ImgBase*> recycled; // deep copy buffers for reuse
+      int encoding;                   // number of images that are currently encoded
+      bool quit;
+      bool flushing;                  // flush waits for frameDone
+      Mutex mutex;
+      Semaphore jobsAvailable;        // one resource per queued image
+      Semaphore freeSlots;            // one resource per free queue entry
+      Semaphore frameDone;
+      AsyncStatistics stats;
+      double encodeTimeSum;
+
+      Data(FilenameGenerator &gen, int numThreads, int queueSize, QueuePolicy policy):
+        gen(gen),queueSize(queueSize),policy(policy),encoding(0),quit(false),flushing(false),
+        jobsAvailable(1),freeSlots(queueSize),frameDone(1),encodeTimeSum(0){
+        // utils::Semaphore can not be created without resources
+        jobsAvailable.acquire();
+        frameDone.acquire();
+        memset(&stats,0,sizeof(stats));
+        for(int i=0;i<numThreads;++i){
+          workers.push_back(new Worker(this));
+          workers.back()->start();
+        }
+      }
+
+      /// all queued images are written before the encoder threads are stopped
+      ~Data(){
+        mutex.lock();
+        quit = true;
+        mutex.unlock();
+        jobsAvailable.release(workers.size());
+        for(unsigned int i=0;i<workers.size();++i){
+          workers[i]->wait();
+          delete workers[i];
+        }
+        for(unsigned int i=0;i<recycled.size();++i){
+          delete recycled[i];
+        }
+      }
+
+      /// creates the copy of the given image (if dst is given, it is reused)
+      Job copy(const ImgBase *image, ImgBase *dst){
+        Job j;
+        j.shallow = image->isCopyOnWrite();
+        if(j.shallow){
+          // channels are shared: the caller detaches them when writing into the image
+          delete dst;
+          j.image = const_cast<ImgBase*>(image)->shallowCopy();
+        }else{
+          j.image = image->deepCopy(&dst);
+        }
+        return j;
+      }
+
+      /// returns an image buffer (mutex must be locked)
+      ImgBase *getBuffer(){
+        if(!recycled.size()) return 0;
+        ImgBase *b = recycled.back();
+        recycled.pop_back();
+        return b;
+      }
+
+      /// releases the image of the given job (mutex must be locked)
+      void release(Job &j){
+        if(j.shallow) delete j.image;
+        else recycled.push_back(j.image);
+        j.image = 0;
+      }
+
+      /// adds a copy of the given image to the queue
+      void push(const ImgBase *image){
+        if(policy == Block){
+          freeSlots.acquire();
+        }else if(!freeSlots.tryAcquire()){
+          mutex.lock();
+          if(policy == DropNewest || !queue.size()){
+            // (DropOldest: the queue might have been emptied in the meantime, so
+            //  we drop the new image, as well as we would do for DropNewest)
+            ++stats.framesDropped;
+            mutex.unlock();
+            return;
+          }
+          // the oldest image is replaced, its queue entry (and image buffer) is reused
+          Job oldest = queue.front();
+          queue.pop_front();
+          ++stats.framesDropped;
+          mutex.unlock();
+
+          if(oldest.shallow){
+            delete oldest.image;
+            oldest.image = 0;
+          }
+          enqueue(copy(image,oldest.image));
+          return;
+        }
+
+        mutex.lock();
+        ImgBase *buffer = getBuffer();
+        mutex.unlock();
+        enqueue(copy(image,buffer));
+      }
+
+      void enqueue(const Job &j){
+        mutex.lock();
+        queue.push_back(j);
+        stats.queueDepth = queue.size();
+        stats.maxQueueDepth = iclMax(stats.maxQueueDepth, stats.queueDepth);
+        mutex.unlock();
+        jobsAvailable.release();
+      }
+
+      /// waits until all queued images are written
+      void flush(){
+        mutex.lock();
+        while(queue.size() || encoding){
+          flushing = true;
+          mutex.unlock();
+          frameDone.acquire();
+          mutex.lock();
+        }
+        mutex.unlock();
+      }
+
+      void work(Worker &w){
+        while(true){
+          jobsAvailable.acquire();
+          mutex.lock();
+          if(!queue.size()){
+            // either quit or the job was dropped (DropOldest policy)
+            bool done = quit;
+            mutex.unlock();
+            if(done) return;
+            continue;
+          }
+          Job j = queue.front();
+          queue.pop_front();
+          stats.queueDepth = queue.size();
+          ++encoding;
+          std::string filename;
+          if(gen.filesLeft()){
+            filename = gen.next();
+          }
+          mutex.unlock();
+          freeSlots.release();
+
+          bool ok = false;
+          Time t = Time::now();
+          if(!filename.length()){
+            ERROR_LOG("No file names left to write the queued image");
+          }else{
+            File file(filename);
+            std::string suffix = toLower(file.getSuffix());
+            SmartPtr<FileWriterPlugin> &p = w.plugins[suffix];
+            if(!p){
+              const std::map<std::string,PluginFactory> &factories = get_plugin_factories();
+              std::map<std::string,PluginFactory>::const_iterator it = factories.find(suffix);
+              if(it != factories.end()) p = it->second();
+            }
+            if(!p){
+              ERROR_LOG("No Plugin to write files with suffix " << file.getSuffix() << " available");
+            }else{
+              try{
+                p->write(file,j.image);
+                ok = true;
+              }catch(const ICLException &ex){
+                ERROR_LOG("unable to write file " << filename << ": " << ex.what());
+              }
+            }
+          }
+          double dt = (Time::now()-t).toMilliSecondsDouble();
+
+          mutex.lock();
+          if(ok){
+            ++stats.framesWritten;
+            stats.lastEncodeTime = dt;
+            stats.maxEncodeTime = iclMax(stats.maxEncodeTime, dt);
+            encodeTimeSum += dt;
+            stats.meanEncodeTime = encodeTimeSum / stats.framesWritten;
+          }else{
+            ++stats.framesFailed;
+          }
+          release(j);
+          --encoding;
+          if(flushing){
+            flushing = false;
+            frameDone.release();
+          }
+          mutex.unlock();
+        }
+      }
+    };
   
     
-    FileWriter::FileWriter(){
+    FileWriter::FileWriter():m_data(0){
       // {{{ open
   
     }
@@ -147,20 +405,21 @@ namespace icl{
     FileWriter::FileWriter(const std::string &filepattern):
       // {{{ open
   
-      m_oGen(filepattern){}
+      m_oGen(filepattern),m_data(0){}
   
     // }}}
   
     FileWriter::FileWriter(const FilenameGenerator &gen):
       // {{{ open
   
-      m_oGen(gen){}
+      m_oGen(gen),m_data(0){}
   
     // }}}
   
     FileWriter::~FileWriter(){
       // {{{ open
   
+      ICL_DELETE(m_data);
     }
   
     // }}}
@@ -179,6 +438,12 @@ namespace icl{
       ICLASSERT_RETURN(image->getDim());
       ICLASSERT_RETURN(image->getChannels());
       ICLASSERT_RETURN(!m_oGen.isNull());
+
+      if(m_data){
+        m_data->push(image);
+        return;
+      }
+
       ICLASSERT_RETURN(m_oGen.filesLeft());
       
       File file(m_oGen.next());
@@ -201,6 +466,42 @@ namespace icl{
       return *this;
     }
   
+    // }}}
+
+    void FileWriter::setAsync(int numThreads, int queueSize, QueuePolicy policy){
+      // {{{ open
+
+      ICLASSERT_THROW(numThreads >= 0, ICLException("FileWriter::setAsync: numThreads must be >= 0"));
+      ICLASSERT_THROW(!numThreads || queueSize > 0,
+                      ICLException("FileWriter::setAsync: queueSize must be > 0"));
+      ICL_DELETE(m_data);
+      if(numThreads){
+        m_data = new Data(m_oGen,numThreads,queueSize,policy);
+      }
+    }
+
+    // }}}
+
+    bool FileWriter::isAsync() const{
+      return m_data;
+    }
+
+    void FileWriter::flush(){
+      if(m_data) m_data->flush();
+    }
+
+    FileWriter::AsyncStatistics FileWriter::getAsyncStatistics() const{
+      // {{{ open
+
+      if(!m_data){
+        AsyncStatistics s;
+        memset(&s,0,sizeof(s));
+        return s;
+      }
+      Mutex::Locker lock(m_data->mutex);
+      return m_data->stats;
+    }
+
     // }}}
   
     void FileWriter::setOption(const std::string &option, const std::string &value){
@@ -31,7 +31,6 @@
 #pragma once
 
 #include <ICLUtils/CompatMacros.h>
-#include <ICLUtils/Uncopyable.h>
 #include <ICLCore/Types.h>
 #include <ICLIO/ImageOutput.h>
 #include <ICLIO/FilenameGenerator.h>
@@ -104,6 +103,29 @@ namespace icl{
         <tr> <td><b>jpg 90%</b></td>  <td>5ms (not supported)</td> <td>5ms (not supported)</td> <td>101K (not supported)</td> </tr>
         <tr> <td><b>jpg 100%</b></td>  <td>7ms (not supported)</td> <td>3ms (not supported)</td> <td>269K (not supported)</td> </tr>
         </table>
+
+        \section ASYNC Asynchronous Writing
+          By default, FileWriter::write encodes and writes the image in the calling thread,
+          which usually is the capture thread of an application. If the encoding takes longer
+          than the frame interval (e.g. for png or gzipped pnm files), frames are lost. In
+          asynchronous mode (see FileWriter::setAsync), write only copies the image into a
+          bounded queue and a pool of encoder threads encodes and writes the queued images
+          in parallel.
+          - The queue holds copies of the written images. Deep copies are made into
+            recycled image buffers; images in copy-on-write mode (see
+            core::ImgBase::setCopyOnWrite) are only shallowly copied.
+          - The file names are still taken from the FilenameGenerator in the order of the
+            written images (the file name is assigned, when an encoder thread takes the
+            image from the queue, so dropped images do not produce gaps)
+          - If the queue is full, write either blocks (FileWriter::Block), replaces the oldest
+            queued image (FileWriter::DropOldest) or drops the new image (FileWriter::DropNewest)
+          - FileWriter::flush waits until all queued images were written; the destructor
+            and FileWriter::setAsync also write all queued images before they return
+          - FileWriter::getAsyncStatistics returns the current queue depth, the number of
+            written and dropped frames and the encoding times
+          
+          Please note, that the FilenameGenerator is used by the encoder threads in
+          asynchronous mode, so getFilenameGenerator() should only be used after flush().
         
         \section EX Example
         The following example illustrates using the file writer:
@@ -128,6 +150,25 @@ namespace icl{
       public:
       /// initializer class
       friend class FileWriterPluginMapInitializer;
+
+      /// behaviour of write in asynchronous mode, if the queue is full (see \ref ASYNC)
+      enum QueuePolicy{
+        Block,      //!< write waits until an encoder thread takes an image from the queue
+        DropOldest, //!< the oldest queued image is replaced by the new one
+        DropNewest  //!< the new image is dropped
+      };
+
+      /// statistics of the asynchronous mode
+      struct AsyncStatistics{
+        int queueDepth;        //!< number of queued images (that are not yet encoded)
+        int maxQueueDepth;     //!< maximum number of queued images
+        int framesWritten;     //!< number of written images
+        int framesDropped;     //!< number of images that were dropped because the queue was full
+        int framesFailed;      //!< number of images that could not be written
+        double lastEncodeTime; //!< time for encoding and writing the last image (in ms)
+        double meanEncodeTime; //!< mean time for encoding and writing an image (in ms)
+        double maxEncodeTime;  //!< maximum time for encoding and writing an image (in ms)
+      };
   
       /// creates an empty file writer
       FileWriter();
@@ -162,10 +203,31 @@ namespace icl{
           - "csv:extend-file-name" value of type bool ("true" or "false")
       **/
       void setOption(const std::string &option, const std::string &value);
+
+      /// enables or disables the asynchronous mode (see \ref ASYNC)
+      /** @param numThreads number of encoder threads (0 disables the asynchronous mode)
+          @param queueSize maximum number of queued images
+          @param policy behaviour of write if the queue is full
+          If the writer was already in asynchronous mode, all queued images are
+          written before the mode is changed. */
+      void setAsync(int numThreads, int queueSize=8, QueuePolicy policy=Block);
+
+      /// returns whether the asynchronous mode is enabled
+      bool isAsync() const;
+
+      /// waits until all queued images were written (only needed in asynchronous mode)
+      void flush();
+
+      /// returns the current statistics of the asynchronous mode
+      AsyncStatistics getAsyncStatistics() const;
       
       private:
       /// internal generator for new filenames
       FilenameGenerator m_oGen;
+
+      /// internal data for the asynchronous mode (0 in synchronous mode)
+      struct Data;
+      Data *m_data;
       
       /// static map of writer plugins
       static std::map<std::string,FileWriterPlugin*> s_mapPlugins;
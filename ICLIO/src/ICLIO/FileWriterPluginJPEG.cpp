@@ -48,10 +48,6 @@ namespace icl{
       s_iQuality = value;
     }
     int FileWriterPluginJPEG::s_iQuality = 90;
-    
-    Img8u FileWriterPluginJPEG::s_oBufferImage;
-    
-    Mutex FileWriterPluginJPEG::s_oBufferImageMutex;
    
     
   #ifdef ICL_HAVE_LIBJPEG
@@ -63,12 +59,12 @@ namespace icl{
         throw ICLException (str(fmt)+" not supported by jpeg");
       }
       
-      Mutex::Locker _locker(s_oBufferImageMutex);
-      
+      // a local conversion buffer is used, so that images can be encoded concurrently
+      Img8u oBufferImage;
       const Img8u *poSrc = 0;
       if(image->getDepth()!= depth8u){
-        image->convert<icl8u>(&s_oBufferImage);
-        poSrc = &s_oBufferImage;
+        image->convert<icl8u>(&oBufferImage);
+        poSrc = &oBufferImage;
       }else{
         poSrc = image->asImg<icl8u>();
       }
@@ -31,7 +31,6 @@
 #pragma once
 
 #include <ICLUtils/CompatMacros.h>
-#include <ICLUtils/Mutex.h>
 #include <ICLIO/FileWriterPlugin.h>
 
 namespace icl{
@@ -50,12 +49,6 @@ namespace icl{
       
       /// current quality (90%) by default
       static int s_iQuality;
-      
-      /// (static!) internal buffer for Any-to-icl8u conversion
-      static core::Img8u s_oBufferImage;
-      
-      /// mutex to protect the static buffer
-      static utils::Mutex s_oBufferImageMutex;
     };
   } // namespace io
 }
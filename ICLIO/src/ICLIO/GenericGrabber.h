@@ -94,6 +94,7 @@ namespace icl {
                                     - <b>dc</b> dc grabber
                                     - <b>dc800</b> dc grabber but with 800MBit iso-speed
                                     - <b>file</b> file grabber
+                                    - <b>rec</b> grabber for single-file image recordings (.iclrec)
                                     - <b>demo</b> demo grabber (moving red spot)
                                     - <b>create</b> create grabber (create an image using ICL's create function)
                                     - <b>sr</b> SwissRanger camera (mesa-imaging)
@@ -101,6 +102,7 @@ namespace icl {
                                     - <b>cvcam</b> OpenCV based camera grabber (supporting video 4 linux devices)
                                     - <b>cvvideo</b> OpenCV based video grabber
                                     - <b>sm</b> Qt-based Shared-Memory grabber (using QSharedMemoryInstance)
+                                    - <b>smr</b> lock-free Shared-Memory ring grabber (Linux only)
                                     - <b>myr</b> Uses Myrmex tactile input device as image source
                                     - <b>kinectd</b> Uses libfreenect to grab Microsoft-Kinect's core::depth images
                                     - <b>kinectc</b> Uses libfreenect to grab Microsoft-Kinect's rgb color images
@@ -139,6 +141,7 @@ namespace icl {
                                       (the unique ID can be found with 'icl-cam-cfg d -list-devices-only')
                                     - dc800=device-index (int)
                                     - file=pattern (string)
+                                    - rec=recording file name (string)
                                     - demo=anything (not regarded)
                                     - create=image name (see also icl::TestImages::create)
                                     - mv=device-name (string)
@@ -159,6 +162,7 @@ namespace icl {
                                       (e.g. device ID 301 selects the 2nd firewire device)
                                     - cvvideo=video-filename (string)
                                     - sm=Shared-memory-segment-id (string)
+                                    - smr=Shared-memory-ring-name (string)
                                     - myr=deviceIndex (int) (the device index is used to create the /dev/videoX device)
                                     - kinectd=device-index (int)
                                     - kinectc=device-index (int)
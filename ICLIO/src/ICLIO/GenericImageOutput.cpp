@@ -36,6 +36,14 @@
 #include <ICLIO/SharedMemoryPublisher.h>
 #endif
 
+#ifdef ICL_SYSTEM_LINUX
+#include <ICLIO/SharedMemoryRingPublisher.h>
+#endif
+
+#if defined(ICL_SYSTEM_LINUX) || defined(ICL_SYSTEM_APPLE)
+#include <ICLIO/ImageRecordingWriter.h>
+#endif
+
 #ifdef ICL_HAVE_ZMQ
 #include <ICLIO/ZmqImageOutput.h>
 #endif
@@ -160,6 +168,14 @@ namespace icl{
         o = new SharedMemoryPublisher(d);
       }
   #endif
+
+  #ifdef ICL_SYSTEM_LINUX
+      plugins.push_back("smr~Shared Memory Ring name~lock-free shared memory ring writer");
+
+      if(type == "smr"){
+        o = new SharedMemoryRingPublisher(d);
+      }
+  #endif
       
   #if defined(ICL_HAVE_RSB) && defined(ICL_HAVE_PROTOBUF)
       plugins.push_back("rsb~[transport:]/scope~Network output stream");
@@ -180,6 +196,14 @@ namespace icl{
         }
       }
   #endif
+  #if defined(ICL_SYSTEM_LINUX) || defined(ICL_SYSTEM_APPLE)
+      plugins.push_back("rec~File Name~indexed single-file recording (.iclrec)");
+
+      if(type == "rec"){
+        o = new ImageRecordingWriter(d);
+      }
+  #endif
+
       plugins.push_back("file~File Pattern~File Writer");
       
       if(type == "file"){
@@ -47,8 +47,10 @@ namespace icl{
         
         Supported Backends are:
           - "file" (description=filepattern)
+          - "rec" (single-file ImageRecording, description=filename)
           - "video" (description=output-video-filename,CODEC-FOURCCC=DIV3,VideoSize=VGA,FPS=24)
           - "sm" (SharedMemory output, description=memory-segment-ID)
+          - "smr" (lock-free SharedMemoryRing output (Linux only), description=ring-name)
           - "xcfp" (XCF Publisher output, description=stream-name)
           - "rsb" (Robotics Service Bus Output), description=[comma-sep. transport-list=spread]:scope)
           - "udp" QUdpSocket-based udp transfer, description=host:port
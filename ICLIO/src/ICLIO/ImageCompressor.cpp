@@ -38,6 +38,7 @@
 #endif
 //#include <ICLCV/RegionDetectorTools.h>
 #include <ICLUtils/File.h>
+#include <ICLUtils/MultiThreader.h>
 #include <ICLUtils/StringUtils.h>
 
 using namespace icl::utils;
@@ -53,14 +54,18 @@ namespace icl{
       ImgBase *decoded_buffer;
       ImageCompressor::CompressionSpec compression;
       
+      int numThreads;
+      Size desiredSize;
   #ifdef ICL_HAVE_LIBJPEG
       SmartPtr<JPEGEncoder> jpegEncoder;
+      MultiThreader jpegDecodingThreads;
   #endif
   
     };
   
     ImageCompressor::ImageCompressor(const ImageCompressor::CompressionSpec &spec):m_data(new Data){
       m_data->decoded_buffer = 0;
+      m_data->numThreads = 1;
       setCompression(spec);
     }
   
@@ -345,6 +350,7 @@ namespace icl{
   
         if(!m_data->jpegEncoder) m_data->jpegEncoder = new JPEGEncoder;
         m_data->jpegEncoder->setQuality(parse<int>(m_data->compression.quality));
+        m_data->jpegEncoder->setNumThreads(m_data->numThreads);
         const JPEGEncoder::EncodedData &jpeg = m_data->jpegEncoder->encode(image->as8u());
         
         int minLen = sizeof(Header::Params) + header.params.metaLen + jpeg.len;
@@ -469,7 +475,15 @@ namespace icl{
   
       if(header.getCompressionMode() == "jpeg"){
   #ifdef ICL_HAVE_LIBJPEG
-        JPEGDecoder::decode(header.imageBegin(), header.imageLen(), &useDst);
+        if(m_data->numThreads > 1){
+          if(m_data->jpegDecodingThreads.isNull() || m_data->jpegDecodingThreads.getNumThreads() != m_data->numThreads){
+            m_data->jpegDecodingThreads = MultiThreader(m_data->numThreads);
+          }
+          JPEGDecoder::decode(header.imageBegin(), header.imageLen(), &useDst, m_data->jpegDecodingThreads,
+                              m_data->desiredSize);
+        }else{
+          JPEGDecoder::decode(header.imageBegin(), header.imageLen(), &useDst, m_data->desiredSize);
+        }
         useDst->getMetaData().assign(header.metaBegin(), header.metaBegin()+header.params.metaLen);
   #else
         throw ICLException("ImageCompressor::uncompress: jpeg decoding is not supported without LIBJPEG");
@@ -538,6 +552,23 @@ namespace icl{
     ImageCompressor::CompressionSpec ImageCompressor::getCompression() const{
       return m_data->compression;
     }
+
+    void ImageCompressor::setNumThreads(int numThreads){
+      ICLASSERT_THROW(numThreads > 0, ICLException("ImageCompressor::setNumThreads: number of threads must be > 0"));
+      m_data->numThreads = numThreads;
+    }
+  
+    int ImageCompressor::getNumThreads() const{
+      return m_data->numThreads;
+    }
+  
+    void ImageCompressor::setDesiredSize(const Size &size){
+      m_data->desiredSize = size;
+    }
+  
+    const Size &ImageCompressor::getDesiredSize() const{
+      return m_data->desiredSize;
+    }
   
   } // namespace io
 }
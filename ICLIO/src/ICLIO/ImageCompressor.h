@@ -128,6 +128,22 @@ namespace icl{
         are available: I.e. 1 byte per image pixel 
         + header size of 37 + N bytes (N is meta data size)\n
         for JPEG data, 2x the raw image data is allocated
+
+        \section THREADS Multi-Threaded JPEG Compression
+        The "jpeg" mode can use several threads for both encoding and decoding
+        (see setNumThreads). The image is then encoded in horizontal slices, which
+        are separated by jpeg restart markers, so that the result is still a single
+        valid baseline jpeg stream (see JPEGEncoder). When decoding, such streams
+        are split at the restart markers and the slices are decoded in parallel
+        directly into the destination image channels (see JPEGDecoder). All other
+        compression modes are not affected.
+
+        \section DOWNSCALED Downscaled JPEG Decoding
+        If a desired size is set (see setDesiredSize), jpeg data is decoded directly
+        at a reduced resolution (1/2, 1/4 or 1/8) using libjpeg's DCT scaling. The
+        smallest of these sizes, that is not smaller than the desired size is used,
+        i.e. the uncompressed image is usually not exactly of the desired size. Grabbers,
+        that use an ImageCompressor, pass their desired size automatically.
     */
     class ICLIO_API ImageCompressor : public utils::Uncopyable{
       struct Data;  //!< pimpl type
@@ -234,6 +250,20 @@ namespace icl{
       
       /// can be implemented for returning the current compression mode
       virtual CompressionSpec getCompression() const;
+      
+      /// sets the number of threads that are used for jpeg en- and decoding (default: 1)
+      /** see \ref THREADS */
+      void setNumThreads(int numThreads);
+      
+      /// returns the number of threads used for jpeg en- and decoding
+      int getNumThreads() const;
+      
+      /// sets a size hint for jpeg decoding (utils::Size::null: always decode at full size)
+      /** see \ref DOWNSCALED */
+      void setDesiredSize(const utils::Size &size);
+      
+      /// returns the current size hint for jpeg decoding
+      const utils::Size &getDesiredSize() const;
         
     
   
@@ -0,0 +1,236 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLIO/src/ICLIO/ImageRecording.cpp                     **
+** Module : ICLIO                                                  **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#include <ICLIO/ImageRecording.h>
+#include <ICLIO/ImageCompressor.h>
+#include <ICLUtils/Macros.h>
+#include <ICLUtils/StringUtils.h>
+
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace icl::utils;
+using namespace icl::core;
+
+namespace icl{
+  namespace io{
+
+    struct ImageRecording::Data{
+      std::string filename;
+      const icl8u *base;                   // mapped file
+      size_t size;                         // file size
+      const IndexEntry *index;             // index (mapped or recovered)
+      int numFrames;
+      std::vector<IndexEntry> recovered;   // recovered index
+      size_t validEnd;                     // end of the last valid chunk
+      bool isRecovered;                    // whether the index was recovered
+      ImageCompressor compressor;
+    };
+
+    /// returns whether the mapped file ends with a valid trailer and index
+    static bool has_valid_index(const icl8u *base, size_t size){
+      typedef ImageRecording::Trailer Trailer;
+      if(size < sizeof(ImageRecording::FileHeader) + sizeof(Trailer)) return false;
+      const Trailer &t = *(const Trailer*)(base + size - sizeof(Trailer));
+      if(t.magic != ImageRecording::TRAILER_MAGIC) return false;
+      const icl64u indexEnd = size - sizeof(Trailer);
+      if(t.indexOffset < sizeof(ImageRecording::FileHeader) || t.indexOffset > indexEnd ||
+         t.numFrames != (indexEnd - t.indexOffset) / sizeof(ImageRecording::IndexEntry) ||
+         (indexEnd - t.indexOffset) % sizeof(ImageRecording::IndexEntry)){
+        return false;
+      }
+      return ImageRecording::checksum(base + t.indexOffset, indexEnd - t.indexOffset) == t.checksum;
+    }
+
+    ImageRecording::ImageRecording(const std::string &filename) throw (ICLException):
+      m_data(new Data){
+      m_data->filename = filename;
+      m_data->base = 0;
+      m_data->size = 0;
+      m_data->index = 0;
+      m_data->numFrames = 0;
+      m_data->validEnd = 0;
+      m_data->isRecovered = false;
+
+      int fd = ::open(filename.c_str(), O_RDONLY);
+      struct stat st;
+      if(fd < 0 || fstat(fd,&st)){
+        if(fd >= 0) ::close(fd);
+        delete m_data;
+        throw FileNotFoundException(filename);
+      }
+      m_data->size = st.st_size;
+      void *p = m_data->size ? mmap(0, m_data->size, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+      ::close(fd);
+
+      const FileHeader *h = (const FileHeader*)p;
+      if(p == MAP_FAILED || m_data->size < sizeof(FileHeader) ||
+         strncmp(h->magic,"ICLREC",8) || h->version != VERSION || h->headerSize != sizeof(FileHeader)){
+        if(p != MAP_FAILED) munmap(p, m_data->size);
+        delete m_data;
+        throw InvalidFileFormatException(filename);
+      }
+      m_data->base = (const icl8u*)p;
+      madvise(p, m_data->size, MADV_RANDOM);
+
+      if(has_valid_index(m_data->base, m_data->size)){
+        const Trailer &t = *(const Trailer*)(m_data->base + m_data->size - sizeof(Trailer));
+        m_data->index = (const IndexEntry*)(m_data->base + t.indexOffset);
+        m_data->numFrames = (int)t.numFrames;
+        m_data->validEnd = t.indexOffset;
+        return;
+      }
+
+      // scan all chunks, until the first invalid or incomplete one is found
+      size_t pos = sizeof(FileHeader);
+      while(pos + sizeof(ChunkHeader) <= m_data->size){
+        const ChunkHeader &c = *(const ChunkHeader*)(m_data->base + pos);
+        if(c.magic != CHUNK_MAGIC || c.len > m_data->size - pos - sizeof(ChunkHeader) ||
+           checksum(m_data->base + pos + sizeof(ChunkHeader), c.len) != c.checksum){
+          break;
+        }
+        IndexEntry e = { pos, c.time };
+        m_data->recovered.push_back(e);
+        pos += getChunkSize(c.len);
+      }
+      m_data->validEnd = pos;
+      m_data->isRecovered = true;
+      m_data->index = m_data->recovered.data();
+      m_data->numFrames = (int)m_data->recovered.size();
+      WARNING_LOG("recording " << filename << " has no valid index (recovered " 
+                  << m_data->numFrames << " frames)");
+    }
+
+    ImageRecording::~ImageRecording(){
+      munmap(const_cast<icl8u*>(m_data->base), m_data->size);
+      delete m_data;
+    }
+
+    const std::string &ImageRecording::getFileName() const{
+      return m_data->filename;
+    }
+
+    int ImageRecording::getNumFrames() const{
+      return m_data->numFrames;
+    }
+
+    bool ImageRecording::isRecovered() const{
+      return m_data->isRecovered;
+    }
+
+    ImageRecording::Frame ImageRecording::getFrame(int index) const{
+      ICLASSERT_THROW(index >= 0 && index < m_data->numFrames,
+                      ICLException("ImageRecording::getFrame: invalid frame index " + str(index)));
+      const IndexEntry &e = m_data->index[index];
+      ICLASSERT_THROW(e.offset + sizeof(ChunkHeader) <= m_data->size,
+                      InvalidFileFormatException(m_data->filename));
+      const ChunkHeader &c = *(const ChunkHeader*)(m_data->base + e.offset);
+      ICLASSERT_THROW(c.magic == CHUNK_MAGIC && c.len <= m_data->size - e.offset - sizeof(ChunkHeader),
+                      InvalidFileFormatException(m_data->filename));
+      Frame f = { m_data->base + e.offset + sizeof(ChunkHeader), (int)c.len, Time(c.time) };
+      return f;
+    }
+
+    Time ImageRecording::getTime(int index) const{
+      ICLASSERT_THROW(index >= 0 && index < m_data->numFrames,
+                      ICLException("ImageRecording::getTime: invalid frame index " + str(index)));
+      return Time(m_data->index[index].time);
+    }
+
+    static bool is_earlier(const icl64s &t, const ImageRecording::IndexEntry &e){
+      return t < e.time;
+    }
+
+    int ImageRecording::findFrame(const Time &t) const{
+      const IndexEntry *end = m_data->index + m_data->numFrames;
+      const IndexEntry *it = std::upper_bound(m_data->index, end, t.toMicroSeconds(), is_earlier);
+      return it == m_data->index ? 0 : (int)(it - m_data->index) - 1;
+    }
+
+    const ImgBase *ImageRecording::decode(int index, ImgBase **dst, const Size &desiredSize) const{
+      Frame f = getFrame(index);
+      m_data->compressor.setDesiredSize(desiredSize);
+      return m_data->compressor.uncompress(f.data, f.len, dst);
+    }
+
+    int ImageRecording::repair(const std::string &filename) throw (ICLException){
+      std::vector<IndexEntry> index;
+      size_t end = 0;
+      {
+        ImageRecording r(filename);
+        if(!r.isRecovered()) return r.getNumFrames();
+        index = r.m_data->recovered;
+        end = r.m_data->validEnd;
+      }
+      Trailer t;
+      memset(&t,0,sizeof(t));
+      t.magic = TRAILER_MAGIC;
+      t.version = VERSION;
+      t.indexOffset = end;
+      t.numFrames = index.size();
+      t.checksum = checksum((const icl8u*)index.data(), index.size()*sizeof(IndexEntry));
+
+      int fd = ::open(filename.c_str(), O_WRONLY);
+      ICLASSERT_THROW(fd >= 0, ICLException("ImageRecording::repair: unable to open " + filename));
+      const size_t indexLen = index.size()*sizeof(IndexEntry);
+      bool ok = !ftruncate(fd, end) &&
+                pwrite(fd, index.data(), indexLen, end) == (ssize_t)indexLen &&
+                pwrite(fd, &t, sizeof(t), end + indexLen) == (ssize_t)sizeof(t) &&
+                !fsync(fd);
+      ::close(fd);
+      ICLASSERT_THROW(ok, ICLException("ImageRecording::repair: unable to write the index to "
+                                       + filename + " (" + strerror(errno) + ")"));
+      return (int)index.size();
+    }
+
+    icl32u ImageRecording::checksum(const icl8u *data, size_t len){
+      // Adler-32: the modulo is only needed every 5552 bytes
+      icl32u a = 1, b = 0;
+      while(len){
+        size_t n = std::min(len, size_t(5552));
+        len -= n;
+        for(const icl8u *end = data+n; data < end; ++data){
+          a += *data;
+          b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+      }
+      return (b << 16) | a;
+    }
+
+  } // namespace io
+}
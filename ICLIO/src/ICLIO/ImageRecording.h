@@ -0,0 +1,179 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLIO/src/ICLIO/ImageRecording.h                       **
+** Module : ICLIO                                                  **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#pragma once
+
+#include <ICLUtils/CompatMacros.h>
+#include <ICLUtils/Uncopyable.h>
+#include <ICLUtils/Exception.h>
+#include <ICLUtils/Time.h>
+#include <ICLCore/ImgBase.h>
+#include <string>
+
+namespace icl{
+  namespace io{
+
+    /// Indexed single-file container for image sequences (".iclrec" files) \ingroup FILEIO_G
+    /** Image sequences that are recorded as directories of single image files need one
+        file open/stat call per frame and a directory scan on startup, which dominates the
+        seek and startup times of long recordings. An image recording stores all frames
+        as ImageCompressor payloads (i.e. the .bicl file content) in a single file, followed
+        by an index of the frame offsets and time stamps.
+
+        The ImageRecording class provides read access to such a file. The file is mapped
+        into memory (mmap), so that the raw payloads can be accessed without copying them
+        (see ImageRecording::getFrame), and frames can be found by index in O(1) and by
+        time stamp in O(log n). Recordings are written using the ImageRecordingWriter and
+        grabbed using the ImageRecordingGrabber (GenericGrabber backend "rec").
+        The application icl-recording-convert converts directories of image files into
+        recordings.
+
+        \section FORMAT File Format
+        All numbers are stored in the native (little endian) byte order.
+        - file header (64 bytes): magic code "ICLREC", version and header size
+        - for each frame: a chunk header (32 bytes) containing the magic code "ICLF", the
+          payload length, the time stamp (in micro seconds), the frame index and an Adler-32
+          checksum of the payload, followed by the payload itself, which is padded to a
+          multiple of 8 bytes
+        - the index: one entry per frame (16 bytes) containing the chunk offset and the
+          time stamp of the frame
+        - the trailer (32 bytes): magic code "ICLI", the index offset, the number of frames
+          and an Adler-32 checksum of the index
+
+        \section RECOVER Index Recovery
+        The index is written when the writer is closed. If the recording application
+        crashed, the file ends with the last completely written chunk (or with a partially
+        written one). In this case, the index is recovered by scanning all chunks from the
+        beginning of the file: the scan stops at the first chunk with an invalid header, a
+        truncated payload or a wrong checksum. ImageRecording::repair does the same and
+        writes the recovered index to the file, which truncates the incomplete chunk.
+    */
+    class ICLIO_API ImageRecording : public utils::Uncopyable{
+      struct Data;  //!< internal data
+      Data *m_data; //!< internal data
+
+      public:
+
+      /// file header (64 bytes)
+      struct FileHeader{
+        char magic[8];       //!< "ICLREC" (zero padded)
+        icl32u version;      //!< format version (1)
+        icl32u headerSize;   //!< size of the file header (64)
+        char reserved[48];   //!< unused (0)
+      };
+
+      /// chunk header (32 bytes), followed by the payload
+      struct ChunkHeader{
+        icl32u magic;        //!< "ICLF"
+        icl32u len;          //!< payload length (without padding)
+        icl64s time;         //!< time stamp in micro seconds
+        icl32u frameIndex;   //!< index of the frame
+        icl32u checksum;     //!< Adler-32 checksum of the payload
+        icl64u reserved;     //!< unused (0)
+      };
+
+      /// index entry (16 bytes)
+      struct IndexEntry{
+        icl64u offset;       //!< file offset of the chunk header
+        icl64s time;         //!< time stamp in micro seconds
+      };
+
+      /// trailer (32 bytes) at the end of the file
+      struct Trailer{
+        icl32u magic;        //!< "ICLI"
+        icl32u version;      //!< format version (1)
+        icl64u indexOffset;  //!< file offset of the index
+        icl64u numFrames;    //!< number of index entries
+        icl32u checksum;     //!< Adler-32 checksum of the index
+        icl32u reserved;     //!< unused (0)
+      };
+
+      /// magic codes and format version
+      enum{
+        VERSION = 1,
+        CHUNK_MAGIC = 0x464c4349,   //!< "ICLF"
+        TRAILER_MAGIC = 0x494c4349  //!< "ICLI"
+      };
+
+      /// returns the padded size of a chunk with given payload length
+      static size_t getChunkSize(size_t payloadLen){
+        return sizeof(ChunkHeader) + ((payloadLen + 7) & ~size_t(7));
+      }
+
+      /// raw frame payload (references the mapped file)
+      struct Frame{
+        const icl8u *data;   //!< ImageCompressor payload
+        int len;             //!< payload length in bytes
+        utils::Time time;    //!< time stamp of the frame
+      };
+
+      /// opens the given recording
+      /** If the file has no valid index, it is recovered (see \ref RECOVER) */
+      ImageRecording(const std::string &filename) throw (utils::ICLException);
+
+      /// Destructor (unmaps the file)
+      ~ImageRecording();
+
+      /// returns the file name
+      const std::string &getFileName() const;
+
+      /// returns the number of frames
+      int getNumFrames() const;
+
+      /// returns whether the index had to be recovered by scanning the file
+      bool isRecovered() const;
+
+      /// returns the raw payload of the frame with given index (zero-copy)
+      Frame getFrame(int index) const;
+
+      /// returns the time stamp of the frame with given index
+      utils::Time getTime(int index) const;
+
+      /// returns the index of the last frame whose time stamp is not later than t (O(log n))
+      /** If t is earlier than the first frame, 0 is returned. The time stamps are
+          expected to be ascending (which is the case for recorded image streams) */
+      int findFrame(const utils::Time &t) const;
+
+      /// decodes the frame with given index into the given image
+      /** If a desired size is given, jpeg compressed frames are decoded at the smallest
+          reduced resolution, that is not smaller than this size (see ImageCompressor) */
+      const core::ImgBase *decode(int index, core::ImgBase **dst,
+                                  const utils::Size &desiredSize=utils::Size::null) const;
+
+      /// checks the given file and writes the recovered index if the file has no valid one
+      /** returns the number of frames of the repaired recording */
+      static int repair(const std::string &filename) throw (utils::ICLException);
+
+      /// computes the Adler-32 checksum that is used for the chunk payloads and the index
+      static icl32u checksum(const icl8u *data, size_t len);
+    };
+
+  } // namespace io
+}
@@ -0,0 +1,221 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLIO/src/ICLIO/ImageRecordingGrabber.cpp              **
+** Module : ICLIO                                                  **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#include <ICLIO/ImageRecordingGrabber.h>
+#include <ICLUtils/StringUtils.h>
+#include <ICLUtils/Thread.h>
+#include <ICLUtils/Mutex.h>
+
+using namespace icl::utils;
+using namespace icl::core;
+
+namespace icl{
+  namespace io{
+
+    struct ImageRecordingGrabber::Data{
+      ImageRecording *recording;
+      ImgBase *image;
+      int next;               // index of the frame that is grabbed next
+      bool autoNext;
+      bool loop;
+      bool useTimeStamps;
+      Time referenceTime;     // time stamp of the first frame played with use-time-stamps
+      Time referenceTimeReal; // real time, when this frame was played
+      bool updatingProperties;
+      Mutex mutex;
+
+      /// waits until the given frame is due (regarding the first played frame)
+      void waitForTimeStamp(const Time &t){
+        Time now = Time::now();
+        if(referenceTime == Time(0)){
+          referenceTime = t;
+          referenceTimeReal = now;
+          return;
+        }
+        Time dt = (t - referenceTime) - (now - referenceTimeReal);
+        if(dt > Time(0)) Thread::usleep(dt.toMicroSeconds());
+      }
+    };
+
+    ImageRecordingGrabber::ImageRecordingGrabber(const std::string &filename) throw(ICLException):
+      m_data(new Data){
+      try{
+        m_data->recording = new ImageRecording(filename);
+      }catch(...){
+        delete m_data;
+        throw;
+      }
+      m_data->image = 0;
+      m_data->next = 0;
+      m_data->autoNext = true;
+      m_data->loop = true;
+      m_data->useTimeStamps = false;
+      m_data->updatingProperties = false;
+
+      const int n = m_data->recording->getNumFrames();
+      const int duration = n ? (int)(m_data->recording->getTime(n-1) - 
+                                     m_data->recording->getTime(0)).toMilliSeconds() : 0;
+
+      addProperty("format", "info", "", "unknown", 0, "");
+      addProperty("size", "info", "", "unknown", 0, "");
+      addProperty("next", "command", "", Any(), 0, "Increments the frame counter");
+      addProperty("prev", "command", "", Any(), 0, "Decrements the frame counter");
+      addProperty("jump-to-start", "command", "", Any(), 0, "Resets the frame counter to 0");
+      addProperty("frame-count", "info", "", str(n), 0, "Number of recorded frames");
+      addProperty("frame-index", "range:spinbox", "[0," + str(iclMax(n-1,0)) + "]", 0, 20,
+                  "Index of the frame that is grabbed next");
+      addProperty("seek-time", "range:spinbox", "[0," + str(duration) + "]", 0, 20,
+                  "Time (in ms relative to the first frame) of the frame that is grabbed next");
+      addProperty("auto-next", "flag", "", m_data->autoNext, 0,
+                  "Whether to move to the next frame automatically");
+      addProperty("loop", "flag", "", m_data->loop, 0,
+                  "Whether to start from the beginning when the end is reached");
+      addProperty("use-time-stamps", "flag", "", m_data->useTimeStamps, 0,
+                  "Whether to play the frames with the recorded frame rate");
+
+      Configurable::registerCallback(utils::function(this,&ImageRecordingGrabber::processPropertyChange));
+    }
+
+    ImageRecordingGrabber::~ImageRecordingGrabber(){
+      ICL_DELETE(m_data->image);
+      delete m_data->recording;
+      delete m_data;
+    }
+
+    const ImageRecording &ImageRecordingGrabber::getRecording() const{
+      return *m_data->recording;
+    }
+
+    int ImageRecordingGrabber::getNumFrames() const{
+      return m_data->recording->getNumFrames();
+    }
+
+    void ImageRecordingGrabber::seek(int index){
+      setPropertyValue("frame-index", index);
+    }
+
+    void ImageRecordingGrabber::seek(const Time &t){
+      Mutex::Locker lock(m_data->mutex);
+      m_data->next = m_data->recording->findFrame(t);
+      m_data->referenceTime = Time(0);
+    }
+
+    const ImgBase* ImageRecordingGrabber::acquireImage(){
+      Mutex::Locker lock(m_data->mutex);
+      const ImageRecording &rec = *m_data->recording;
+      const int n = rec.getNumFrames();
+      if(!n) return 0;
+
+      const int idx = clip(m_data->next, 0, n-1);
+      const ImgBase *image = 0;
+      try{
+        image = rec.decode(idx, &m_data->image, getDesired<Size>());
+      }catch(const ICLException &e){
+        ERROR_LOG("unable to decode frame " << idx << " of " << rec.getFileName() << ": " << e.what());
+        return 0;
+      }
+      if(m_data->useTimeStamps) m_data->waitForTimeStamp(image->getTime());
+
+      if(m_data->autoNext){
+        m_data->next = idx+1;
+        if(m_data->next == n){
+          if(m_data->loop){
+            m_data->next = 0;
+            m_data->referenceTime = Time(0);
+          }else{
+            m_data->next = n-1;
+          }
+        }
+      }
+
+      m_data->updatingProperties = true;
+      if(getPropertyValue("size") != str(image->getSize())){
+        setPropertyValue("size", image->getSize());
+      }
+      if(getPropertyValue("format") != str(image->getFormat())){
+        setPropertyValue("format", image->getFormat());
+      }
+      setPropertyValue("frame-index", m_data->next);
+      setPropertyValue("seek-time", (rec.getTime(m_data->next) - rec.getTime(0)).toMilliSeconds());
+      m_data->updatingProperties = false;
+      return image;
+    }
+
+    void ImageRecordingGrabber::processPropertyChange(const utils::Configurable::Property &prop){
+      if(m_data->updatingProperties) return;
+      const int n = m_data->recording->getNumFrames();
+      if(prop.name == "next"){
+        Mutex::Locker lock(m_data->mutex);
+        m_data->next = m_data->loop ? (m_data->next+1) % iclMax(n,1) : iclMin(m_data->next+1, n-1);
+        m_data->referenceTime = Time(0);
+      }else if(prop.name == "prev"){
+        Mutex::Locker lock(m_data->mutex);
+        m_data->next = (m_data->next > 0) ? m_data->next-1 : (m_data->loop ? n-1 : 0);
+        m_data->referenceTime = Time(0);
+      }else if(prop.name == "jump-to-start"){
+        Mutex::Locker lock(m_data->mutex);
+        m_data->next = 0;
+        m_data->referenceTime = Time(0);
+      }else if(prop.name == "frame-index"){
+        Mutex::Locker lock(m_data->mutex);
+        m_data->next = clip(parse<int>(prop.value), 0, iclMax(n-1,0));
+        m_data->referenceTime = Time(0);
+      }else if(prop.name == "seek-time"){
+        if(n) seek(m_data->recording->getTime(0) + Time(parse<icl64s>(prop.value)*1000));
+      }else if(prop.name == "auto-next"){
+        m_data->autoNext = parse<bool>(prop.value);
+      }else if(prop.name == "loop"){
+        m_data->loop = parse<bool>(prop.value);
+      }else if(prop.name == "use-time-stamps"){
+        Mutex::Locker lock(m_data->mutex);
+        m_data->useTimeStamps = parse<bool>(prop.value);
+        m_data->referenceTime = Time(0);
+      }
+    }
+
+    Grabber* createRecGrabber(const std::string &param){
+      return new ImageRecordingGrabber(param);
+    }
+
+    const std::vector<GrabberDeviceDescription>& getRecDeviceList(std::string hint, bool rescan){
+      static std::vector<GrabberDeviceDescription> deviceList;
+      if(!rescan) return deviceList;
+
+      deviceList.clear();
+      if(hint.size()) deviceList.push_back(
+        GrabberDeviceDescription("rec", hint, "A grabber for ImageRecording files (.iclrec).")
+        );
+      return deviceList;
+    }
+
+    REGISTER_GRABBER(rec,utils::function(createRecGrabber), utils::function(getRecDeviceList), "rec:recording file name:indexed single-file image recording (.iclrec)");
+
+  } // namespace io
+}
@@ -0,0 +1,96 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLIO/src/ICLIO/ImageRecordingGrabber.h                **
+** Module : ICLIO                                                  **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#pragma once
+
+#include <ICLUtils/CompatMacros.h>
+#include <ICLIO/Grabber.h>
+#include <ICLIO/ImageRecording.h>
+
+namespace icl{
+  namespace io{
+
+    /// Grabber class that plays back ImageRecording files (".iclrec")
+    /** The recording file is mapped into memory, so opening even very long recordings
+        does not need any directory scans, and jumping to a frame does not need any file
+        system calls. Please don't use this Grabber class directly, but instantiate
+        GenericGrabber with device type 'rec'.
+
+        \section PROPS Properties
+        - <b>next</b>, <b>prev</b>, <b>jump-to-start</b>: commands to move the frame counter
+        - <b>frame-index</b>: index of the frame that is grabbed next
+        - <b>seek-time</b>: jumps to the last frame whose time stamp is not later than the
+          given time (in ms relative to the first frame, found in O(log n))
+        - <b>auto-next</b> (default true): whether to move to the next frame automatically
+        - <b>loop</b> (default true): whether to start from the beginning when the end
+          of the recording is reached (otherwise, the last frame is grabbed again)
+        - <b>use-time-stamps</b> (default false): whether the frames are played back with
+          the recorded frame rate
+
+        The raw payloads of the recorded frames can directly be accessed (without copying
+        them) using getRecording().getFrame(index).
+    */
+    class ICLIO_API ImageRecordingGrabber : public Grabber {
+      /// Internal Data storage class
+      struct Data;
+
+      /// Hidden Data container
+      Data *m_data;
+
+      public:
+
+      /// Creates a new grabber instance for the given recording file
+      ImageRecordingGrabber(const std::string &filename) throw(utils::ICLException);
+
+      /// Destructor
+      ~ImageRecordingGrabber();
+
+      /// grabbing function
+      /** \copydoc icl::io::Grabber::grab(core::ImgBase**)  **/
+      virtual const core::ImgBase* acquireImage();
+
+      /// returns the underlying recording
+      const ImageRecording &getRecording() const;
+
+      /// returns the number of frames
+      int getNumFrames() const;
+
+      /// sets the index of the frame that is grabbed next
+      void seek(int index);
+
+      /// sets the next frame to the last one whose time stamp is not later than t
+      void seek(const utils::Time &t);
+
+      /// callback for changed configurable properties
+      void processPropertyChange(const utils::Configurable::Property &prop);
+    };
+
+  } // namespace io
+}
@@ -0,0 +1,185 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLIO/src/ICLIO/ImageRecordingWriter.cpp               **
+** Module : ICLIO                                                  **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#include <ICLIO/ImageRecordingWriter.h>
+#include <ICLIO/ImageRecording.h>
+#include <ICLUtils/Macros.h>
+
+#include <vector>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/uio.h>
+
+using namespace icl::utils;
+using namespace icl::core;
+
+namespace icl{
+  namespace io{
+
+    typedef ImageRecording::ChunkHeader ChunkHeader;
+    typedef ImageRecording::IndexEntry IndexEntry;
+    typedef ImageRecording::Trailer Trailer;
+
+    struct ImageRecordingWriter::Data{
+      std::string filename;
+      int fd;
+      size_t pos;                    // current end of the file
+      std::vector<IndexEntry> index;
+    };
+
+    /// writes all given buffers (using as few system calls as possible)
+    static bool write_all(int fd, struct iovec *iov, int n){
+      while(n){
+        ssize_t w = writev(fd, iov, n);
+        if(w < 0){
+          if(errno == EINTR) continue;
+          return false;
+        }
+        while(n && (size_t)w >= iov->iov_len){
+          w -= iov->iov_len;
+          ++iov;
+          --n;
+        }
+        if(n){
+          iov->iov_base = (char*)iov->iov_base + w;
+          iov->iov_len -= w;
+        }
+      }
+      return true;
+    }
+
+    ImageRecordingWriter::ImageRecordingWriter(const std::string &filename,
+                                               const CompressionSpec &compression)
+      throw (ICLException):m_data(new Data){
+      m_data->fd = -1;
+      m_data->pos = 0;
+      setCompression(compression);
+      if(filename.length()){
+        try{
+          open(filename);
+        }catch(...){
+          delete m_data;
+          throw;
+        }
+      }
+    }
+
+    ImageRecordingWriter::~ImageRecordingWriter(){
+      close();
+      delete m_data;
+    }
+
+    void ImageRecordingWriter::open(const std::string &filename) throw (ICLException){
+      close();
+      int fd = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+      if(fd < 0){
+        throw ICLException("ImageRecordingWriter: unable to create file " + filename
+                           + " (" + strerror(errno) + ")");
+      }
+      ImageRecording::FileHeader h;
+      memset(&h,0,sizeof(h));
+      strncpy(h.magic,"ICLREC",8);
+      h.version = ImageRecording::VERSION;
+      h.headerSize = sizeof(h);
+      if(::write(fd, &h, sizeof(h)) != (ssize_t)sizeof(h)){
+        ::close(fd);
+        throw ICLException("ImageRecordingWriter: unable to write file " + filename);
+      }
+      m_data->filename = filename;
+      m_data->fd = fd;
+      m_data->pos = sizeof(h);
+      m_data->index.clear();
+    }
+
+    void ImageRecordingWriter::close(){
+      if(m_data->fd < 0) return;
+      Trailer t;
+      memset(&t,0,sizeof(t));
+      t.magic = ImageRecording::TRAILER_MAGIC;
+      t.version = ImageRecording::VERSION;
+      t.indexOffset = m_data->pos;
+      t.numFrames = m_data->index.size();
+      t.checksum = ImageRecording::checksum((const icl8u*)m_data->index.data(),
+                                            m_data->index.size()*sizeof(IndexEntry));
+      struct iovec iov[2] = {
+        { m_data->index.data(), m_data->index.size()*sizeof(IndexEntry) },
+        { &t, sizeof(t) }
+      };
+      if(!write_all(m_data->fd, iov, 2)){
+        ERROR_LOG("unable to write the index of " << m_data->filename << " (" << strerror(errno) << ")");
+      }
+      ::close(m_data->fd);
+      m_data->fd = -1;
+    }
+
+    void ImageRecordingWriter::write(const ImgBase *image){
+      ICLASSERT_RETURN(image);
+      ICLASSERT_RETURN(m_data->fd >= 0);
+
+      const CompressedData data = compress(image);
+
+      ChunkHeader c;
+      memset(&c,0,sizeof(c));
+      c.magic = ImageRecording::CHUNK_MAGIC;
+      c.len = data.len;
+      c.time = image->getTime().toMicroSeconds();
+      c.frameIndex = m_data->index.size();
+      c.checksum = ImageRecording::checksum(data.bytes, data.len);
+
+      static const icl8u padding[8] = {0};
+      const size_t chunkSize = ImageRecording::getChunkSize(data.len);
+      struct iovec iov[3] = {
+        { &c, sizeof(c) },
+        { data.bytes, (size_t)data.len },
+        { const_cast<icl8u*>(padding), chunkSize - sizeof(c) - data.len }
+      };
+      if(!write_all(m_data->fd, iov, 3)){
+        ERROR_LOG("unable to write to " << m_data->filename << " (" << strerror(errno) << ")");
+        // remove the incomplete chunk, so that subsequent frames can still be recovered
+        if(!ftruncate(m_data->fd, m_data->pos)) lseek(m_data->fd, m_data->pos, SEEK_SET);
+        return;
+      }
+      IndexEntry e = { m_data->pos, c.time };
+      m_data->index.push_back(e);
+      m_data->pos += chunkSize;
+    }
+
+    std::string ImageRecordingWriter::getFileName() const{
+      return m_data->filename;
+    }
+
+    int ImageRecordingWriter::getNumFrames() const{
+      return m_data->index.size();
+    }
+
+  } // namespace io
+}
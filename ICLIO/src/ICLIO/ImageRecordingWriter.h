@@ -0,0 +1,86 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLIO/src/ICLIO/ImageRecordingWriter.h                 **
+** Module : ICLIO                                                  **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#pragma once
+
+#include <ICLUtils/CompatMacros.h>
+#include <ICLUtils/Exception.h>
+#include <ICLCore/ImgBase.h>
+#include <ICLIO/ImageOutput.h>
+
+namespace icl{
+  namespace io{
+
+    /// ImageOutput, that records images into a single ImageRecording file (".iclrec")
+    /** Each image is compressed using the inherited ImageCompressor (by default, with
+        compression mode "none") and appended to the file as one chunk. The index of all
+        frames is written, when the writer is closed. Each chunk is passed to the operating
+        system with a single write call, so if the recording application crashes, all frames
+        but the last one can be recovered (see ImageRecording, \ref RECOVER).
+        
+        The writer is also available as GenericImageOutput backend "rec". The recorded
+        file can be played back using the ImageRecordingGrabber (GenericGrabber backend "rec").
+    */
+    class ICLIO_API ImageRecordingWriter : public ImageOutput{
+      struct Data;  //!< internal data
+      Data *m_data; //!< internal data
+
+      public:
+
+      /// creates a new writer
+      /** If filename is "", no file is created. An existing file is overwritten. */
+      ImageRecordingWriter(const std::string &filename="",
+                           const CompressionSpec &compression=CompressionSpec("none"))
+        throw (utils::ICLException);
+
+      /// Destructor (closes the file)
+      ~ImageRecordingWriter();
+
+      /// closes the current file and creates a new one
+      void open(const std::string &filename) throw (utils::ICLException);
+
+      /// writes the index and closes the file
+      void close();
+
+      /// appends the given image to the file
+      void write(const core::ImgBase *image);
+
+      /// wraps write to implement ImageOutput interface
+      virtual void send(const core::ImgBase *image) { write(image); }
+
+      /// returns the current file name
+      std::string getFileName() const;
+
+      /// returns the number of frames written to the current file
+      int getNumFrames() const;
+    };
+
+  } // namespace io
+}
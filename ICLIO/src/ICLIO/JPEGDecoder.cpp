@@ -33,6 +33,7 @@
 #include <ICLUtils/Macros.h>
 #include <ICLIO/FileGrabberPlugin.h>
 #include <ICLUtils/StrTok.h>
+#include <cstring>
 
 using namespace icl::utils;
 using namespace icl::core;
@@ -92,16 +93,217 @@ namespace icl{
     };
   
   
-    void JPEGDecoder::decode(const unsigned char *data, unsigned int maxDataLen, ImgBase **dest){
-      decode_internal(0,data,maxDataLen,dest);
+    void JPEGDecoder::decode(const unsigned char *data, unsigned int maxDataLen, ImgBase **dest,
+                             const Size &targetSize){
+      decode_internal(0,data,maxDataLen,dest,targetSize);
+    }
+
+    int JPEGDecoder::getScaleDenominator(const Size &imageSize, const Size &targetSize){
+      if(targetSize == Size::null) return 1;
+      for(int d=8;d>1;d/=2){
+        if((imageSize.width + d - 1)/d >= targetSize.width &&
+           (imageSize.height + d - 1)/d >= targetSize.height){
+          return d;
+        }
+      }
+      return 1;
+    }
+
+    namespace{
+      /// decodes a part of a jpeg stream, that was split at restart markers
+      struct SliceDecodeWork : public MultiThreader::Work{
+        std::vector<icl8u> stream; //!< synthetic jpeg stream of the slice
+        int scaleDenom;            //!< DCT scaling denominator
+        int skipRows;              //!< number of leading rows, that belong to the previous slice
+        int y0;                    //!< first destination row
+        int height;                //!< number of destination rows
+        Img8u *dst;
+        bool failed;
+        
+        virtual void perform(){
+          failed = true;
+          JPEGDataHandle h;
+          std::vector<icl8u> buf;
+          if(setjmp(h.em.setjmp_buffer)){
+            jpeg_destroy_decompress(&h.info);
+            return;
+          }
+          jpeg_create_decompress(&h.info);
+          DataSourceManager src(&h.info,stream.data(),stream.size());
+          h.info.src = &src;
+          jpeg_read_header(&h.info, TRUE);
+          h.info.scale_num = 1;
+          h.info.scale_denom = scaleDenom;
+          jpeg_start_decompress(&h.info);
+          const int w = dst->getWidth(), c = dst->getChannels();
+          if((int)h.info.output_width != w || h.info.output_components != c ||
+             (int)h.info.output_height < skipRows + height){
+            jpeg_destroy_decompress(&h.info);
+            return;
+          }
+          buf.resize(w*c);
+          for(int y=-skipRows;y<height;++y){
+            icl8u *line = buf.data();
+            if(c == 1 && y >= 0){
+              line = dst->getData(0) + (y0+y)*w;
+            }
+            (void) jpeg_read_scanlines(&h.info, &line, 1);
+            if(c == 3 && y >= 0){
+              icl8u *pcR = dst->getData(0) + (y0+y)*w;
+              icl8u *pcG = dst->getData(1) + (y0+y)*w;
+              icl8u *pcB = dst->getData(2) + (y0+y)*w;
+              for(int x=0;x<w;++x,line+=3){
+                pcR[x] = line[0];
+                pcG[x] = line[1];
+                pcB[x] = line[2];
+              }
+            }
+          }
+          // the remaining (overlap) rows are not needed
+          jpeg_abort_decompress(&h.info);
+          jpeg_destroy_decompress(&h.info);
+          failed = false;
+        }
+      };
+      
+      /// tries to decode the stream in parallel (returns false if this is not possible)
+      bool decode_parallel(const unsigned char *data, unsigned int maxDataLen, ImgBase **dest,
+                           MultiThreader &threads, const Size &targetSize, 
+                           std::vector<SliceDecodeWork> &works){
+        const int nThreads = threads.isNull() ? 0 : threads.getNumThreads();
+        if(nThreads < 2) return false;
+        
+        JPEGStreamInfo stream;
+        if(!icl_jpeg_parse_stream(data, maxDataLen, stream) || !stream.restartInterval) return false;
+        
+        // read the header information using libjpeg
+        JPEGDataHandle h;
+        if(setjmp(h.em.setjmp_buffer)){
+          jpeg_destroy_decompress(&h.info);
+          return false;
+        }
+        jpeg_create_decompress(&h.info);
+        DataSourceManager src(&h.info,const_cast<JOCTET*>(data),maxDataLen);
+        h.info.src = &src;
+        jpeg_read_header(&h.info, TRUE);
+        const bool progressive = h.info.progressive_mode;
+        const int numComponents = h.info.num_components;
+        const int width = h.info.image_width, height = h.info.image_height;
+        int maxH = 1, maxV = 1;
+        for(int i=0;i<numComponents;++i){
+          maxH = iclMax(maxH,h.info.comp_info[i].h_samp_factor);
+          maxV = iclMax(maxV,h.info.comp_info[i].v_samp_factor);
+        }
+        format fmt = formatMatrix;
+        switch(h.info.out_color_space){
+          case JCS_GRAYSCALE: fmt = formatGray; break;
+          case JCS_RGB: fmt = formatRGB; break;
+          case JCS_YCbCr: fmt = formatYUV; break;
+          default: break;
+        }
+        jpeg_destroy_decompress(&h.info);
+        
+        if(progressive || (numComponents != 1 && numComponents != 3) || fmt == formatMatrix
+           || getChannelsOfFormat(fmt) != numComponents){
+          return false;
+        }
+        const int mcuW = numComponents == 1 ? DCTSIZE : maxH * DCTSIZE;
+        const int mcuH = numComponents == 1 ? DCTSIZE : maxV * DCTSIZE;
+        const int mcusPerRow = (width + mcuW - 1) / mcuW;
+        const int mcuRows = (height + mcuH - 1) / mcuH;
+        if(stream.restartInterval % mcusPerRow) return false;
+        const int rowsPerInterval = stream.restartInterval / mcusPerRow;
+        const int numIntervals = (mcuRows + rowsPerInterval - 1) / rowsPerInterval;
+        if(numIntervals < 2) return false;
+        
+        // find the restart markers (the intervals' boundaries) and the end of image
+        std::vector<unsigned int> begins(1,stream.scanBegin), ends;
+        begins.reserve(numIntervals);
+        ends.reserve(numIntervals);
+        const unsigned char *p = data + stream.scanBegin, *end = data + maxDataLen - 1;
+        while(true){
+          p = (const unsigned char*)memchr(p, 0xFF, end - p);
+          if(!p) return false;
+          const unsigned char m = p[1];
+          if(m == 0x00 || m == 0xFF){
+            p += (m == 0x00) ? 2 : 1;
+            continue;
+          }
+          if(m >= 0xD0 && m <= 0xD7){
+            ends.push_back(p - data);
+            begins.push_back(p - data + 2);
+            p += 2;
+          }else if(m == JPEG_EOI){
+            ends.push_back(p - data);
+            break;
+          }else{
+            return false; // e.g. DNL or a second scan
+          }
+          if((int)begins.size() > numIntervals) return false;
+        }
+        if((int)ends.size() != numIntervals) return false;
+        
+        // the chroma upsampling needs the neighbouring rows
+        const int overlap = (numComponents > 1 && maxV > 1) ? 1 : 0;
+        const int nSlices = iclMin(nThreads, numIntervals);
+        const int intervalHeight = rowsPerInterval * mcuH;
+        
+        // the interval height is a multiple of 8, so that scaled slices start at integer rows
+        const int d = JPEGDecoder::getScaleDenominator(Size(width,height), targetSize);
+        const Size scaledSize((width + d - 1)/d, (height + d - 1)/d);
+        ensureCompatible(dest, depth8u, scaledSize, numComponents, fmt);
+        Img8u *dst = (*dest)->as8u();
+        
+        works.resize(nSlices);
+        MultiThreader::WorkSet ws(nThreads,(MultiThreader::Work*)0);
+        for(int i=0;i<nSlices;++i){
+          const int i0 = numIntervals * i / nSlices, i1 = numIntervals * (i+1) / nSlices;
+          const int d0 = iclMax(0, i0 - overlap), d1 = iclMin(numIntervals, i1 + overlap);
+          
+          SliceDecodeWork &w = works[i];
+          w.dst = dst;
+          w.scaleDenom = d;
+          w.y0 = i0 * intervalHeight / d;
+          w.height = iclMin(i1 * intervalHeight / d, scaledSize.height) - w.y0;
+          w.skipRows = (i0 - d0) * intervalHeight / d;
+          const int sliceHeight = iclMin(d1 * intervalHeight, height) - d0 * intervalHeight;
+          
+          const unsigned int scanLen = ends[d1-1] - begins[d0];
+          w.stream.resize(stream.scanBegin + scanLen + 2);
+          memcpy(w.stream.data(), data, stream.scanBegin);
+          w.stream[stream.sofPos] = (icl8u)(sliceHeight >> 8);
+          w.stream[stream.sofPos+1] = (icl8u)(sliceHeight & 0xFF);
+          icl_jpeg_copy_scan(data + begins[d0], scanLen, 0, w.stream.data() + stream.scanBegin);
+          w.stream[stream.scanBegin + scanLen] = 0xFF;
+          w.stream[stream.scanBegin + scanLen + 1] = JPEG_EOI;
+          ws[i] = &w;
+        }
+        threads(ws);
+        
+        for(int i=0;i<nSlices;++i){
+          if(works[i].failed) throw InvalidFileFormatException();
+        }
+        dst->setTime(Time());
+        return true;
+      }
+    }
+    
+    void JPEGDecoder::decode(const unsigned char *data, unsigned int maxDataLen, ImgBase **dest,
+                             MultiThreader &threads, const Size &targetSize){
+      ICLASSERT_RETURN(data && dest);
+      std::vector<SliceDecodeWork> works;
+      if(!decode_parallel(data, maxDataLen, dest, threads, targetSize, works)){
+        decode_internal(0,data,maxDataLen,dest,targetSize);
+      }
     }
   
-    void JPEGDecoder::decode(File &file, ImgBase **dest) throw (InvalidFileFormatException){
-      decode_internal(&file,0,0,dest);
+    void JPEGDecoder::decode(File &file, ImgBase **dest, const Size &targetSize) throw (InvalidFileFormatException){
+      decode_internal(&file,0,0,dest,targetSize);
       return;
     }
   
-    void JPEGDecoder::decode_internal(File *file, const unsigned char *data, unsigned int maxDataLen, ImgBase **dest) throw (InvalidFileFormatException){
+    void JPEGDecoder::decode_internal(File *file, const unsigned char *data, unsigned int maxDataLen, ImgBase **dest,
+                                      const Size &targetSize) throw (InvalidFileFormatException){
       ICLASSERT_RETURN(!(file&&data));
       ICLASSERT_RETURN(!(!file&&!data));
       ICLASSERT_RETURN(dest);
@@ -169,6 +371,9 @@ namespace icl{
       }
   
       /* Step 4: set parameters for decompression */
+      jpegHandle.info.scale_num = 1;
+      jpegHandle.info.scale_denom = getScaleDenominator(Size(jpegHandle.info.image_width,
+                                                             jpegHandle.info.image_height), targetSize);
 
       /* Step 5: Start decompressor */
       jpeg_start_decompress(&jpegHandle.info);
@@ -33,18 +33,41 @@
 #include <ICLUtils/CompatMacros.h>
 #include <ICLUtils/File.h>
 #include <ICLUtils/Exception.h>
+#include <ICLUtils/MultiThreader.h>
+#include <ICLUtils/Size.h>
 #include <ICLCore/Types.h>
 
 namespace icl{
   namespace io{
     /// Utility class for decoding JPEG-Data streams (with ICL_HAVE_LIBJPEG only)
+    /** \section PARALLEL Parallel Decoding
+        Baseline jpeg streams with restart markers at MCU row boundaries (e.g. the streams
+        written by the JPEGEncoder using more than one thread) can be decoded in parallel:
+        The entropy coded data is split at the restart markers into horizontal slices,
+        each slice is decoded by a separate thread directly into the rows of the planar
+        destination image. For chroma subsampled streams, each slice is decoded with one
+        additional restart interval above and below, so that the chroma upsampling yields
+        exactly the same result as sequential decoding. Streams that cannot be split (e.g.
+        progressive streams or streams without restart markers) are decoded sequentially.
+
+        \section SCALED Downscaled Decoding
+        All decode methods accept an optional target size. If it is given, libjpeg's DCT
+        scaling is used to decode the image directly at 1/2, 1/4 or 1/8 of its resolution:
+        The smallest of these sizes, that is not smaller than the target size, is used (see
+        getScaleDenominator). This is much faster than decoding at full resolution and scaling
+        the result down afterwards, since most of the decoding work (inverse DCT, upsampling and
+        color conversion) is only done for the reduced number of pixels. Please note that the
+        decoded image size is in general not exactly the target size, i.e. a residual resize
+        is still necessary (e.g. the Grabber does this automatically for its desired size). */
     class ICLIO_API JPEGDecoder{
       public:
       /// Decode JPEG-File (E.g. used for FileGrabberPluginJPEG)
       /** @param file must be opened in mode readBinary or not opend 
           @param dst image, which is adapted to the found image parameters
+          @param targetSize optional size hint for downscaled decoding (see \ref SCALED)
       */
-      static void decode(utils::File &file, core::ImgBase **dst) throw (utils::InvalidFileFormatException);
+      static void decode(utils::File &file, core::ImgBase **dst, 
+                         const utils::Size &targetSize=utils::Size::null) throw (utils::InvalidFileFormatException);
       
       /// Decode a data stream (E.g. used for Decoding Motion-JPEG streams in unicap's DefaultConvertEngine)
       /** @param data jpeg data stream (must be valid, otherwise unpredictable behaviour occurs
@@ -53,13 +76,27 @@ namespace icl{
                             corrupted jpeg data (e.g. end-of-image-marker is missing). The given data
                             pointer can be much longer then the actual jpeg data. If that is the case,
                             libjpeg obviously reads only necessary bytes.
-          @param dst destination image, which is adapted to the found images parameters */
-      static void decode(const unsigned char *data,unsigned int maxDataLen,core::ImgBase **dst);
+          @param dst destination image, which is adapted to the found images parameters
+          @param targetSize optional size hint for downscaled decoding (see \ref SCALED) */
+      static void decode(const unsigned char *data,unsigned int maxDataLen,core::ImgBase **dst,
+                         const utils::Size &targetSize=utils::Size::null);
+
+      /// Decodes a data stream using the given threads (see \ref PARALLEL)
+      /** The parameters are the same as for the sequential version. If the stream has no suitable
+          restart markers, it is decoded sequentially */
+      static void decode(const unsigned char *data,unsigned int maxDataLen,core::ImgBase **dst,
+                         utils::MultiThreader &threads, const utils::Size &targetSize=utils::Size::null);
+
+      /// returns the DCT scaling denominator (1, 2, 4 or 8) that is used for the given sizes
+      /** This is the largest denominator for which the scaled image size is not smaller than
+          the target size. If the target size is null, 1 is returned */
+      static int getScaleDenominator(const utils::Size &imageSize, const utils::Size &targetSize);
       
       private:
       /// internal utility function, which does all the work
       static void decode_internal(utils::File *file,const unsigned char *data, 
-                                  unsigned int maxDataLen, core::ImgBase **dst) throw (utils::InvalidFileFormatException);
+                                  unsigned int maxDataLen, core::ImgBase **dst,
+                                  const utils::Size &targetSize) throw (utils::InvalidFileFormatException);
     };
   } // namespace io
 }
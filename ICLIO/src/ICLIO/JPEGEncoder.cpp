@@ -33,6 +33,8 @@
 #include <ICLCore/Img.h>
 #include <ICLUtils/StringUtils.h>
 #include <ICLUtils/File.h>
+#include <ICLUtils/MultiThreader.h>
+#include <cstring>
 
 using namespace icl::utils;
 using namespace icl::core;
@@ -85,87 +87,17 @@ namespace icl{
     }
     using namespace jpeg_encoder;
   
-    struct JPEGEncoder::Data{
-      int quality;
-      JPEGEncoder::EncodedData encoded;
-      Img8u buffer8u;
-      std::vector<icl8u> dataBuffer;
-    };
-  
-    
-    JPEGEncoder::JPEGEncoder(int quality):m_data(new Data){
-      m_data->quality = quality;
-      m_data->encoded.bytes = 0;
-      m_data->encoded.len = 0;
-    }
-    
-    JPEGEncoder::~JPEGEncoder(){
-      delete m_data;
-    }
-  
-    void JPEGEncoder::setQuality(int quality){
-      m_data->quality = quality;
-    }
-      
-      
-    const JPEGEncoder::EncodedData &JPEGEncoder::encode(const ImgBase *image){
-      if(!image){
-        m_data->encoded.bytes = 0;
-        m_data->encoded.len = 0;
-        ERROR_LOG("JPEGEncoder::encode: given image is NULL");
-        return m_data->encoded;
-      }
-  
-      format fmt = image->getFormat();
-      int channels = image->getChannels();
-      
-      if(channels != 1 && channels != 3){
-        throw ICLException("JEPGEncoder:encode: jpeg does only support 1 or 3 channels");
-      }
-      const Img8u *psrc = 0;
-      if(image->getDepth()!= depth8u){
-        static bool first = true;
-        if(first){
-          first = false;
-          WARNING_LOG("JPEGEncoder:encode: given image depth was not 8u so it had to be converted internally\n"
-                      "this might lead to loss of precision (this message is only shown once)");
-        }
-        image->convert(&m_data->buffer8u);
-        psrc = &m_data->buffer8u;
-      }else{
-        psrc = image->as8u();
-      }
-      const Img8u &src = *psrc;
-      
-      //////////////////////////////////////////////////////////////////////
-      /// WRITE HEADER DATA ////////////////////////////////////////////////
-      //////////////////////////////////////////////////////////////////////
-      J_COLOR_SPACE jCS;
-      switch (fmt) {
-        case formatGray: jCS = JCS_GRAYSCALE; break;
-        case formatYUV:  jCS = JCS_YCbCr; break;
-        case formatRGB:  jCS = JCS_RGB; break;
-        case formatMatrix:{
-          if(channels == 1){
-            jCS = JCS_GRAYSCALE; 
-          }else if(channels == 3){
-            jCS = JCS_RGB;
-          }else{
-            throw ICLException(str(__FUNCTION__)+": matrix format with " + str(channels) + " channels is not supported");
-          }
-        }
-  
-        default: 
-          throw ICLException(str(__FUNCTION__)+":"+str(fmt) + " not supported by jpeg");
-      }
-      
-      ICLException err(str(__FUNCTION__)+": Error in JPEG compression");
+    /// encodes the image rows [y0,y0+height) as a separate jpeg stream
+    static int encode_rows(const Img8u &src, J_COLOR_SPACE jCS, int quality, int y0, int height,
+                           int restartInRows, std::vector<icl8u> &dst){
+      ICLException err("JPEGEncoder::encode: Error in JPEG compression");
   
       struct jpeg_compress_struct jpgCinfo;
       struct icl_jpeg_error_mgr   jpgErr;
       
       // Step 1: Set up the error handler first, in case initialization fails
       jpgCinfo.err = jpeg_std_error(&jpgErr);
+      jpgErr.error_exit = icl_jpeg_error_exit;
       if (setjmp(jpgErr.setjmp_buffer)) {
         /* If we get here, the JPEG code has signaled an error.
             * We need to clean up the JPEG object and signal the error to the caller */
@@ -178,12 +110,12 @@ namespace icl{
       
       // Step 2: specify data destination
       int bytesWritten = 0;
-      m_data->dataBuffer.resize(4000 + src.getWidth() * src.getHeight() * src.getChannels() * 2);
-      install_MemDst(&jpgCinfo,(JOCTET*)m_data->dataBuffer.data(),m_data->dataBuffer.size(),&bytesWritten);
+      dst.resize(4000 + src.getWidth() * height * src.getChannels() * 2);
+      install_MemDst(&jpgCinfo,(JOCTET*)dst.data(),dst.size(),&bytesWritten);
       
       /* Step 3: set parameters for compression */
       jpgCinfo.image_width  = src.getSize().width;
-      jpgCinfo.image_height = src.getSize().height;
+      jpgCinfo.image_height = height;
       jpgCinfo.input_components = src.getChannels(); // # of color components 
       jpgCinfo.in_color_space = jCS; 	/* colorspace of input image */
       
@@ -194,7 +126,10 @@ namespace icl{
       
       /* Now you can set any non-default parameters you wish to.
           * Here we just illustrate the use of quality (quantization table) scaling: */
-      jpeg_set_quality(&jpgCinfo, m_data->quality, TRUE /* limit to baseline-JPEG values */);
+      jpeg_set_quality(&jpgCinfo, quality, TRUE /* limit to baseline-JPEG values */);
+      
+      /* slices get a restart marker at the beginning of each MCU row, so that they can be concatenated */
+      jpgCinfo.restart_in_rows = restartInRows;
       
       /* Step 4: Start compressor */
       /* TRUE ensures that we will write a complete interchange-JPEG file.
@@ -229,17 +164,17 @@ namespace icl{
         int iLineStep = src.getSize().width;
         // grayscale image, can handover image channels directly
         while (jpgCinfo.next_scanline < jpgCinfo.image_height) {
-          icl8u *pcBuf = const_cast<icl8u*>(src.getData (0)) + jpgCinfo.next_scanline*iLineStep;
+          icl8u *pcBuf = const_cast<icl8u*>(src.getData (0)) + (y0+jpgCinfo.next_scanline)*iLineStep;
           (void) jpeg_write_scanlines(&jpgCinfo, &pcBuf, 1);
         }
       } else {
         // file format is interleaved, i.e. RGB or something similar
         const Size& size = src.getSize();
         std::vector<icl8u> buf(3*size.width);
-        const icl8u *pcR = src.begin(0);
-        const icl8u *pcG = src.begin(1);
-        const icl8u *pcB = src.begin(2);
-        for (int l=0; l<size.height; l++) {
+        const icl8u *pcR = src.begin(0) + y0*size.width;
+        const icl8u *pcG = src.begin(1) + y0*size.width;
+        const icl8u *pcB = src.begin(2) + y0*size.width;
+        for (int l=0; l<height; l++) {
           icl8u *pc=buf.data();
           for (int c=0; c<size.width; ++c){
             *pc++ = pcR[c];
@@ -261,10 +196,208 @@ namespace icl{
       /* Step 8: release JPEG compression object */
       jpeg_destroy_compress(&jpgCinfo);
   
-      m_data->encoded.bytes = m_data->dataBuffer.data();
-      m_data->encoded.len = bytesWritten;
-      return m_data->encoded;
+      return bytesWritten;
+    }
+  
+
+    /// returns the MCU height that libjpeg uses for the given color space
+    static int get_mcu_height(J_COLOR_SPACE jCS, int channels){
+      if(channels == 1) return DCTSIZE;
+      struct jpeg_compress_struct jpgCinfo;
+      struct icl_jpeg_error_mgr   jpgErr;
+      jpgCinfo.err = jpeg_std_error(&jpgErr);
+      jpeg_create_compress(&jpgCinfo);
+      jpgCinfo.input_components = channels;
+      jpgCinfo.in_color_space = jCS;
+      jpeg_set_defaults(&jpgCinfo);
+      int maxV = 1;
+      for(int i=0;i<jpgCinfo.num_components;++i){
+        maxV = iclMax(maxV,jpgCinfo.comp_info[i].v_samp_factor);
+      }
+      jpeg_destroy_compress(&jpgCinfo);
+      return maxV * DCTSIZE;
+    }
+
+    /// encodes a horizontal slice of the image (used for parallel encoding)
+    struct SliceWork : public MultiThreader::Work{
+      const Img8u *src;
+      J_COLOR_SPACE jCS;
+      int quality;
+      int firstRow; //!< first MCU row
+      int y0;
+      int height;
+      int len;
+      std::vector<icl8u> buffer;
+      std::string error;
+
+      virtual void perform(){
+        try{
+          len = encode_rows(*src, jCS, quality, y0, height, 1, buffer);
+        }catch(const ICLException &e){
+          error = e.what();
+        }
+      }
+    };
   
+    struct JPEGEncoder::Data{
+      int quality;
+      int numThreads;
+      JPEGEncoder::EncodedData encoded;
+      Img8u buffer8u;
+      std::vector<icl8u> dataBuffer;
+      std::vector<SliceWork> works;
+      MultiThreader threads;
+    };
+  
+    
+    JPEGEncoder::JPEGEncoder(int quality):m_data(new Data){
+      m_data->quality = quality;
+      m_data->numThreads = 1;
+      m_data->encoded.bytes = 0;
+      m_data->encoded.len = 0;
+    }
+    
+    JPEGEncoder::~JPEGEncoder(){
+      delete m_data;
+    }
+  
+    void JPEGEncoder::setQuality(int quality){
+      m_data->quality = quality;
+    }
+  
+    void JPEGEncoder::setNumThreads(int numThreads){
+      ICLASSERT_THROW(numThreads > 0, ICLException("JPEGEncoder::setNumThreads: number of threads must be > 0"));
+      m_data->numThreads = numThreads;
+    }
+  
+    int JPEGEncoder::getNumThreads() const{
+      return m_data->numThreads;
+    }
+      
+      
+    const JPEGEncoder::EncodedData &JPEGEncoder::encode(const ImgBase *image){
+      if(!image){
+        m_data->encoded.bytes = 0;
+        m_data->encoded.len = 0;
+        ERROR_LOG("JPEGEncoder::encode: given image is NULL");
+        return m_data->encoded;
+      }
+  
+      format fmt = image->getFormat();
+      int channels = image->getChannels();
+      
+      if(channels != 1 && channels != 3){
+        throw ICLException("JEPGEncoder:encode: jpeg does only support 1 or 3 channels");
+      }
+      const Img8u *psrc = 0;
+      if(image->getDepth()!= depth8u){
+        static bool first = true;
+        if(first){
+          first = false;
+          WARNING_LOG("JPEGEncoder:encode: given image depth was not 8u so it had to be converted internally\n"
+                      "this might lead to loss of precision (this message is only shown once)");
+        }
+        image->convert(&m_data->buffer8u);
+        psrc = &m_data->buffer8u;
+      }else{
+        psrc = image->as8u();
+      }
+      const Img8u &src = *psrc;
+      
+      //////////////////////////////////////////////////////////////////////
+      /// WRITE HEADER DATA ////////////////////////////////////////////////
+      //////////////////////////////////////////////////////////////////////
+      J_COLOR_SPACE jCS;
+      switch (fmt) {
+        case formatGray: jCS = JCS_GRAYSCALE; break;
+        case formatYUV:  jCS = JCS_YCbCr; break;
+        case formatRGB:  jCS = JCS_RGB; break;
+        case formatMatrix:{
+          if(channels == 1){
+            jCS = JCS_GRAYSCALE; 
+          }else if(channels == 3){
+            jCS = JCS_RGB;
+          }else{
+            throw ICLException(str(__FUNCTION__)+": matrix format with " + str(channels) + " channels is not supported");
+          }
+        }
+  
+        default: 
+          throw ICLException(str(__FUNCTION__)+":"+str(fmt) + " not supported by jpeg");
+      }
+      
+      const int nThreads = iclMax(1,m_data->numThreads);
+      if(nThreads == 1){
+        m_data->encoded.len = encode_rows(src, jCS, m_data->quality, 0, src.getHeight(), 0, m_data->dataBuffer);
+        m_data->encoded.bytes = m_data->dataBuffer.data();
+        return m_data->encoded;
+      }
+      
+      //////////////////////////////////////////////////////////////////////
+      /// PARALLEL ENCODING (see \ref PARALLEL) ///////////////////////////
+      //////////////////////////////////////////////////////////////////////
+      const int mcuHeight = get_mcu_height(jCS, channels);
+      const int mcuRows = (src.getHeight() + mcuHeight - 1) / mcuHeight;
+      const int nSlices = iclMin(nThreads, mcuRows);
+      
+      std::vector<SliceWork> &works = m_data->works;
+      works.resize(nSlices);
+      MultiThreader::WorkSet ws(nSlices);
+      for(int i=0;i<nSlices;++i){
+        SliceWork &w = works[i];
+        w.src = &src;
+        w.jCS = jCS;
+        w.quality = m_data->quality;
+        w.firstRow = (mcuRows * i / nSlices);
+        w.y0 = w.firstRow * mcuHeight;
+        w.height = iclMin((mcuRows * (i+1) / nSlices) * mcuHeight, src.getHeight()) - w.y0;
+        w.len = 0;
+        w.error.clear();
+        ws[i] = &w;
+      }
+      if(m_data->threads.isNull() || m_data->threads.getNumThreads() != nSlices){
+        m_data->threads = MultiThreader(nSlices);
+      }
+      m_data->threads(ws);
+      
+      int maxLen = 2;
+      for(int i=0;i<nSlices;++i){
+        if(works[i].error.length()) throw ICLException(works[i].error);
+        maxLen += works[i].len;
+      }
+      
+      // concatenate the slices: the first slice provides all headers (its height is patched
+      // to the full image height), the entropy coded data of all other slices is appended,
+      // each preceded by a restart marker and with renumbered internal restart markers
+      std::vector<icl8u> &out = m_data->dataBuffer;
+      out.resize(maxLen);
+      int pos = 0;
+      for(int i=0;i<nSlices;++i){
+        const SliceWork &w = works[i];
+        const icl8u *data = w.buffer.data();
+        JPEGStreamInfo info;
+        if(!icl_jpeg_parse_stream(data, w.len, info) || w.len < (int)info.scanBegin + 2){
+          throw ICLException("JPEGEncoder::encode: unable to concatenate the encoded slices");
+        }
+        const int scanLen = w.len - info.scanBegin - 2; // without EOI
+        if(!i){
+          memcpy(out.data(), data, info.scanBegin);
+          out[info.sofPos] = (icl8u)(src.getHeight() >> 8);
+          out[info.sofPos+1] = (icl8u)(src.getHeight() & 0xFF);
+          pos = info.scanBegin;
+        }else{
+          out[pos++] = 0xFF;
+          out[pos++] = 0xD0 + ((w.firstRow-1) & 7);
+        }
+        icl_jpeg_copy_scan(data + info.scanBegin, scanLen, w.firstRow, out.data() + pos);
+        pos += scanLen;
+      }
+      out[pos++] = 0xFF;
+      out[pos++] = JPEG_EOI;
+      
+      m_data->encoded.bytes = out.data();
+      m_data->encoded.len = pos;
+      return m_data->encoded;
     }
   
     void JPEGEncoder::writeToFile(const ImgBase *image, const std::string &filename){
@@ -45,6 +45,19 @@
 namespace icl{
   namespace io{
     /// encoding class for data-to-data jpeg compression
+    /** \section PARALLEL Parallel Encoding
+        If more than one thread is set (see setNumThreads), the image is split into horizontal
+        slices, whose heights are multiples of the jpeg MCU height (8 rows for gray images and
+        16 rows for color images). Each slice is encoded by a separate thread with a restart
+        marker at the beginning of each MCU row. Since restart markers reset the DC prediction
+        of the entropy coder, the slices' entropy coded data can simply be concatenated (with
+        renumbered restart markers) behind the headers of the first slice. The result is a
+        valid baseline jpeg stream, which can be decoded by any jpeg decoder. The JPEGDecoder
+        can decode such streams in parallel as well.
+
+        The restart markers increase the stream size a little (2 bytes per MCU row plus
+        byte alignment of the entropy coded data). If only one thread is used (default), no
+        restart markers are written. */
     class ICLIO_API JPEGEncoder : public utils::Uncopyable{
       struct Data;  //!< pimpl type
       Data *m_data; //!< pimpl pointer
@@ -60,6 +73,12 @@ namespace icl{
       /// sets the compression quality level
       void setQuality(int quality);
       
+      /// sets the number of threads that are used for encoding (see \ref PARALLEL)
+      void setNumThreads(int numThreads);
+      
+      /// returns the number of threads that are used for encoding
+      int getNumThreads() const;
+      
       /// encoded data type
       struct EncodedData{
         icl8u *bytes; //!< byte pointer
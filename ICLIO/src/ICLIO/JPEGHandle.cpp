@@ -29,6 +29,7 @@
 ********************************************************************/
 
 #include <ICLIO/JPEGHandle.h>
+#include <cstring>
 
 namespace icl{
   namespace io{
@@ -44,6 +45,51 @@ namespace icl{
       /* Return control to the setjmp point */
       longjmp(err->setjmp_buffer, 1);
     }
+
+    bool icl_jpeg_parse_stream(const unsigned char *data, unsigned int len, JPEGStreamInfo &info){
+      info.sofPos = 0;
+      info.restartInterval = 0;
+      if(len < 4 || data[0] != 0xFF || data[1] != 0xD8) return false;
+      unsigned int pos = 2;
+      while(pos + 4 <= len){
+        if(data[pos] != 0xFF) return false;
+        const unsigned char m = data[pos+1];
+        if(m == 0xFF){ // fill byte
+          ++pos;
+          continue;
+        }
+        const unsigned int segLen = (data[pos+2] << 8) | data[pos+3];
+        if(pos + 2 + segLen > len) return false;
+        if(m == 0xC0 || m == 0xC1){ // baseline or extended sequential huffman coding
+          info.sofPos = pos + 5;
+        }else if((m >= 0xC2 && m <= 0xCF) && m != 0xC4 && m != 0xC8 && m != 0xCC){
+          return false; // progressive, lossless or arithmetic coding
+        }else if(m == 0xDD){ // DRI
+          info.restartInterval = (data[pos+4] << 8) | data[pos+5];
+        }else if(m == 0xDA){ // SOS
+          info.scanBegin = pos + 2 + segLen;
+          return info.sofPos != 0;
+        }
+        pos += 2 + segLen;
+      }
+      return false;
+    }
+
+    void icl_jpeg_copy_scan(const unsigned char *src, unsigned int len, int firstRestart, 
+                            unsigned char *dst){
+      memcpy(dst, src, len);
+      // 0xFF bytes of the entropy coded data are always followed by a stuffed 0x00, so
+      // every 0xFF followed by 0xD0-0xD7 is a restart marker
+      unsigned char *end = dst + len - 1;
+      for(unsigned char *p = dst; p < end; ){
+        p = (unsigned char*)memchr(p, 0xFF, end - p);
+        if(!p) break;
+        if(p[1] >= 0xD0 && p[1] <= 0xD7){
+          p[1] = 0xD0 + (firstRestart++ & 7);
+        }
+        p += 2;
+      }
+    }
   #endif // ICL_HAVE_LIBJPEG
   } // namespace io
 }
@@ -50,6 +50,20 @@ namespace icl{
     
     // passes controll back to the caller
     ICLIO_API void icl_jpeg_error_exit(j_common_ptr cinfo);
+
+    // positions of a baseline jpeg stream's markers (used for restart marker based slicing)
+    struct JPEGStreamInfo{
+      unsigned int sofPos;          // offset of the frame header's height field
+      unsigned int scanBegin;       // offset of the entropy coded data (after the SOS segment)
+      unsigned int restartInterval; // restart interval in MCUs (0 if no DRI marker was found)
+    };
+
+    // parses the stream's markers until the start of scan (returns false for non-baseline streams)
+    ICLIO_API bool icl_jpeg_parse_stream(const unsigned char *data, unsigned int len, JPEGStreamInfo &info);
+
+    // copies entropy coded data and renumbers all contained restart markers starting with firstRestart
+    ICLIO_API void icl_jpeg_copy_scan(const unsigned char *src, unsigned int len, int firstRestart,
+                                      unsigned char *dst);
     
     // }}}
   
@@ -199,6 +199,7 @@ namespace icl{
         return NULL;
       }
 
+      m_data->compressor.setDesiredSize(getDesired<Size>());
       m_data->compressor.uncompress((const icl8u*)m_data->mem.constData(), m_data->mem.getSize(), &m_data->image);
       m_data->mem.unlock();
       if(Size(getPropertyValue("size")) != m_data->image->getSize()){
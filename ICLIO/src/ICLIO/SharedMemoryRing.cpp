@@ -0,0 +1,411 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLIO/src/ICLIO/SharedMemoryRing.cpp                   **
+** Module : ICLIO                                                  **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#include <ICLIO/SharedMemoryRing.h>
+#include <ICLUtils/Macros.h>
+#include <ICLUtils/StringUtils.h>
+#include <ICLUtils/Time.h>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <errno.h>
+#include <climits>
+#include <cstring>
+
+using namespace icl::utils;
+
+namespace icl{
+  namespace io{
+
+    namespace{
+      const icl32u RING_MAGIC = 0x52434949;   // "IICR"
+      const icl32u RING_VERSION = 1;
+      const std::string RING_PREFIX = "icl.ring.";
+
+      /// segment header (the first 64 Bytes of the segment)
+      /** The atomically accessed fields are accessed using the GCC __atomic builtins */
+      struct RingHeader{
+        icl32u magic;       //!< written last by the writer, when the ring is initialized
+        icl32u version;     //!< layout version
+        icl32u numSlots;    //!< number of slots
+        icl32u obsolete;    //!< set to 1 if the writer has replaced or closed the ring
+        icl64u slotSize;    //!< capacity of each slot
+        icl64u dataOffset;  //!< page aligned offset of the first slot
+        icl64u latestFrame; //!< number of the latest complete frame
+        int futexWord;      //!< changed with every frame (the lower 32 Bit of latestFrame)
+        int waiters;        //!< number of readers that wait in waitForFrame
+        char pad[16];
+      };
+
+      /// per slot header (following the segment header)
+      struct SlotHeader{
+        icl64u seq;         //!< seqlock counter (odd while the slot is written, 2*frame afterwards)
+        icl64u size;        //!< used Bytes
+        char pad[48];
+      };
+
+      inline size_t page_size(){
+        return (size_t)sysconf(_SC_PAGESIZE);
+      }
+
+      inline size_t round_up(size_t n, size_t m){
+        return ((n + m - 1) / m) * m;
+      }
+
+      inline size_t header_region_size(int numSlots){
+        return round_up(sizeof(RingHeader) + numSlots*sizeof(SlotHeader), page_size());
+      }
+
+      inline std::string shm_name(const std::string &name){
+        ICLASSERT_THROW(name.length() && name.find('/') == std::string::npos,
+                        ICLException("SharedMemoryRing: invalid ring name \"" + name + "\""));
+        return "/" + RING_PREFIX + name;
+      }
+
+      inline std::string errno_str(){
+        return strerror(errno);
+      }
+
+      inline void futex_wake_all(int *addr){
+        syscall(SYS_futex, addr, FUTEX_WAKE, INT_MAX, (void*)0, (void*)0, 0);
+      }
+
+      inline void futex_wait(int *addr, int expected, int timeoutMs){
+        if(timeoutMs < 0){
+          syscall(SYS_futex, addr, FUTEX_WAIT, expected, (void*)0, (void*)0, 0);
+        }else{
+          struct timespec ts;
+          ts.tv_sec = timeoutMs / 1000;
+          ts.tv_nsec = (timeoutMs % 1000) * 1000000L;
+          syscall(SYS_futex, addr, FUTEX_WAIT, expected, &ts, (void*)0, 0);
+        }
+      }
+
+      /// marks an existing ring as obsolete and wakes up all its readers
+      void make_obsolete(RingHeader *h){
+        __atomic_store_n(&h->obsolete, 1, __ATOMIC_SEQ_CST);
+        __atomic_add_fetch(&h->futexWord, 1, __ATOMIC_SEQ_CST);
+        futex_wake_all(&h->futexWord);
+      }
+    }
+
+    struct SharedMemoryRing::Data{
+      std::string name;
+      bool writer;
+      RingHeader *header;
+      SlotHeader *slots;
+      icl8u *data;         // first slot
+      size_t headerMapSize;
+      size_t dataMapSize;  // only used by readers, the writer uses one mapping for everything
+      icl64u writeFrame;   // frame that is currently written (0 if none)
+
+      Data(const std::string &name, bool writer):
+        name(name),writer(writer),header(0),slots(0),data(0),
+        headerMapSize(0),dataMapSize(0),writeFrame(0){}
+
+      void unmap(){
+        if(!header) return;
+        if(writer){
+          munmap(header, headerMapSize);
+        }else{
+          munmap(header, headerMapSize);
+          munmap((void*)data, dataMapSize);
+        }
+        header = 0;
+        slots = 0;
+        data = 0;
+      }
+
+      /// maps the segment with the given name as reader (returns false if it does not exist or is not ready yet)
+      bool connect(){
+        int fd = shm_open(shm_name(name).c_str(), O_RDWR, 0);
+        if(fd < 0) return false;
+
+        struct stat st;
+        if(fstat(fd,&st) || (size_t)st.st_size < page_size()){
+          close(fd);
+          return false;
+        }
+        RingHeader *h = (RingHeader*)mmap(0, page_size(), PROT_READ, MAP_SHARED, fd, 0);
+        if(h == MAP_FAILED){
+          close(fd);
+          return false;
+        }
+        bool ready = (__atomic_load_n(&h->magic, __ATOMIC_ACQUIRE) == RING_MAGIC && h->version == RING_VERSION);
+        int numSlots = h->numSlots;
+        size_t slotSize = h->slotSize, dataOffset = h->dataOffset;
+        munmap(h, page_size());
+
+        if(!ready || (size_t)st.st_size < dataOffset + numSlots*slotSize){
+          close(fd);
+          return false;
+        }
+
+        // the header region is writable (waiter counter), the slots are read-only
+        void *hm = mmap(0, dataOffset, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        void *dm = mmap(0, numSlots*slotSize, PROT_READ, MAP_SHARED, fd, dataOffset);
+        close(fd);
+        if(hm == MAP_FAILED || dm == MAP_FAILED){
+          if(hm != MAP_FAILED) munmap(hm, dataOffset);
+          if(dm != MAP_FAILED) munmap(dm, numSlots*slotSize);
+          return false;
+        }
+        unmap();
+        header = (RingHeader*)hm;
+        slots = (SlotHeader*)(header+1);
+        data = (icl8u*)dm;
+        headerMapSize = dataOffset;
+        dataMapSize = numSlots*slotSize;
+        return true;
+      }
+
+      /// creates (or replaces) the segment as writer
+      void create(int numSlots, size_t slotSize){
+        std::string sn = shm_name(name);
+
+        // replace an existing ring: attached readers are notified
+        int fd = shm_open(sn.c_str(), O_RDWR, 0);
+        if(fd >= 0){
+          struct stat st;
+          if(!fstat(fd,&st) && (size_t)st.st_size >= page_size()){
+            RingHeader *h = (RingHeader*)mmap(0, page_size(), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if(h != MAP_FAILED){
+              make_obsolete(h);
+              munmap(h, page_size());
+            }
+          }
+          close(fd);
+          shm_unlink(sn.c_str());
+        }
+
+        fd = shm_open(sn.c_str(), O_RDWR | O_CREAT | O_EXCL, 0666);
+        if(fd < 0){
+          throw ICLException("SharedMemoryRing: unable to create shared memory segment " + sn + " (" + errno_str() + ")");
+        }
+        size_t dataOffset = header_region_size(numSlots);
+        size_t total = dataOffset + numSlots*slotSize;
+        if(ftruncate(fd, total)){
+          std::string err = errno_str();
+          close(fd);
+          shm_unlink(sn.c_str());
+          throw ICLException("SharedMemoryRing: unable to resize shared memory segment " + sn + " (" + err + ")");
+        }
+        void *m = mmap(0, total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if(m == MAP_FAILED){
+          std::string err = errno_str();
+          shm_unlink(sn.c_str());
+          throw ICLException("SharedMemoryRing: unable to map shared memory segment " + sn + " (" + err + ")");
+        }
+        unmap();
+        header = (RingHeader*)m;
+        slots = (SlotHeader*)(header+1);
+        data = (icl8u*)m + dataOffset;
+        headerMapSize = total;
+
+        // ftruncate provides zeroed memory
+        header->version = RING_VERSION;
+        header->numSlots = numSlots;
+        header->slotSize = slotSize;
+        header->dataOffset = dataOffset;
+        __atomic_store_n(&header->magic, RING_MAGIC, __ATOMIC_RELEASE);
+      }
+    };
+
+    SharedMemoryRing::SharedMemoryRing(const std::string &name, int numSlots, size_t slotSize) throw (ICLException):
+      m_data(new Data(name,true)){
+      if(numSlots < 2 || !slotSize){
+        delete m_data;
+        throw ICLException(str(__FUNCTION__)+": at least 2 slots with non-zero size are needed");
+      }
+      try{
+        m_data->create(numSlots, round_up(slotSize, page_size()));
+      }catch(...){
+        delete m_data;
+        throw;
+      }
+    }
+
+    SharedMemoryRing::SharedMemoryRing(const std::string &name) throw (ICLException):
+      m_data(new Data(name,false)){
+      bool ok = false;
+      try{
+        ok = m_data->connect();
+      }catch(...){
+        delete m_data;
+        throw;
+      }
+      if(!ok){
+        delete m_data;
+        throw ICLException(str(__FUNCTION__)+": unable to connect to shared memory ring \"" + name + "\"");
+      }
+    }
+
+    SharedMemoryRing::~SharedMemoryRing(){
+      if(m_data->writer && m_data->header){
+        make_obsolete(m_data->header);
+        shm_unlink(shm_name(m_data->name).c_str());
+      }
+      m_data->unmap();
+      delete m_data;
+    }
+
+    const std::string &SharedMemoryRing::getName() const{
+      return m_data->name;
+    }
+
+    bool SharedMemoryRing::isWriter() const{
+      return m_data->writer;
+    }
+
+    int SharedMemoryRing::getNumSlots() const{
+      return m_data->header->numSlots;
+    }
+
+    size_t SharedMemoryRing::getSlotSize() const{
+      return m_data->header->slotSize;
+    }
+
+    icl64u SharedMemoryRing::getLatestFrame() const{
+      return __atomic_load_n(&m_data->header->latestFrame, __ATOMIC_ACQUIRE);
+    }
+
+    bool SharedMemoryRing::isObsolete() const{
+      return __atomic_load_n(&m_data->header->obsolete, __ATOMIC_ACQUIRE);
+    }
+
+    icl8u *SharedMemoryRing::beginWrite(size_t size) throw (ICLException){
+      ICLASSERT_THROW(m_data->writer, ICLException(str(__FUNCTION__)+": this instance is not the writer"));
+      ICLASSERT_THROW(size <= getSlotSize(), ICLException(str(__FUNCTION__)+": frame size " + str(size) +
+                                                          " exceeds the slot size " + str(getSlotSize())));
+      RingHeader &h = *m_data->header;
+      if(!m_data->writeFrame){
+        m_data->writeFrame = h.latestFrame + 1;
+      }
+      int slot = m_data->writeFrame % h.numSlots;
+      SlotHeader &s = m_data->slots[slot];
+      // mark the slot as being written before any of its data is touched
+      __atomic_store_n(&s.seq, 2*m_data->writeFrame-1, __ATOMIC_RELAXED);
+      __atomic_thread_fence(__ATOMIC_RELEASE);
+      return m_data->data + slot*h.slotSize;
+    }
+
+    icl64u SharedMemoryRing::commitWrite(size_t size) throw (ICLException){
+      ICLASSERT_THROW(m_data->writeFrame, ICLException(str(__FUNCTION__)+": commitWrite without beginWrite"));
+      ICLASSERT_THROW(size <= getSlotSize(), ICLException(str(__FUNCTION__)+": invalid frame size"));
+      RingHeader &h = *m_data->header;
+      icl64u frame = m_data->writeFrame;
+      SlotHeader &s = m_data->slots[frame % h.numSlots];
+      __atomic_store_n(&s.size, (icl64u)size, __ATOMIC_RELAXED);
+      __atomic_store_n(&s.seq, 2*frame, __ATOMIC_RELEASE);
+      __atomic_store_n(&h.latestFrame, frame, __ATOMIC_RELEASE);
+      __atomic_store_n(&h.futexWord, (int)frame, __ATOMIC_SEQ_CST);
+      // the futex system call is only needed if a reader is waiting
+      if(__atomic_load_n(&h.waiters, __ATOMIC_SEQ_CST) > 0){
+        futex_wake_all(&h.futexWord);
+      }
+      m_data->writeFrame = 0;
+      return frame;
+    }
+
+    bool SharedMemoryRing::waitForFrame(icl64u lastFrame, int timeoutMs){
+      RingHeader &h = *m_data->header;
+      Time deadline = timeoutMs < 0 ? Time::null : Time::now() + Time(icl64s(timeoutMs)*1000);
+      while(true){
+        if(getLatestFrame() > lastFrame) return true;
+        if(isObsolete()) return false;
+
+        int remaining = -1;
+        if(timeoutMs >= 0){
+          remaining = (int)((deadline - Time::now()).toMilliSeconds());
+          if(remaining <= 0) return false;
+        }
+        // the waiter must be registered before the futex word is read, otherwise
+        // the writer might skip the wake-up call for a frame we did not see yet
+        __atomic_add_fetch(&h.waiters, 1, __ATOMIC_SEQ_CST);
+        int w = __atomic_load_n(&h.futexWord, __ATOMIC_SEQ_CST);
+        if(getLatestFrame() <= lastFrame && !isObsolete()){
+          futex_wait(&h.futexWord, w, remaining);
+        }
+        __atomic_sub_fetch(&h.waiters, 1, __ATOMIC_SEQ_CST);
+      }
+    }
+
+    SharedMemoryRing::View SharedMemoryRing::getLatest() const{
+      const RingHeader &h = *m_data->header;
+      View v;
+      while(true){
+        icl64u frame = getLatestFrame();
+        if(!frame) return v;
+        int slot = frame % h.numSlots;
+        const SlotHeader &s = m_data->slots[slot];
+        icl64u seq = __atomic_load_n(&s.seq, __ATOMIC_ACQUIRE);
+        if(seq != 2*frame) continue; // already being overwritten: use a newer frame
+        v.data = m_data->data + slot*h.slotSize;
+        v.size = __atomic_load_n(&s.size, __ATOMIC_RELAXED);
+        v.frame = frame;
+        v.slot = slot;
+        v.seq = seq;
+        return v;
+      }
+    }
+
+    bool SharedMemoryRing::validate(const View &view) const{
+      if(view.isNull()) return false;
+      __atomic_thread_fence(__ATOMIC_ACQUIRE);
+      return __atomic_load_n(&m_data->slots[view.slot].seq, __ATOMIC_RELAXED) == view.seq;
+    }
+
+    bool SharedMemoryRing::reconnect(){
+      ICLASSERT_THROW(!m_data->writer, ICLException(str(__FUNCTION__)+": the writer can not reconnect"));
+      return m_data->connect();
+    }
+
+    std::vector<std::string> SharedMemoryRing::getRingNames(){
+      std::vector<std::string> names;
+      DIR *dir = opendir("/dev/shm");
+      if(!dir) return names;
+      while(struct dirent *e = readdir(dir)){
+        std::string n = e->d_name;
+        if(n.length() > RING_PREFIX.length() && !n.compare(0,RING_PREFIX.length(),RING_PREFIX)){
+          names.push_back(n.substr(RING_PREFIX.length()));
+        }
+      }
+      closedir(dir);
+      return names;
+    }
+
+  } // namespace io
+}
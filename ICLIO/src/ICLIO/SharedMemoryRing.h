@@ -0,0 +1,178 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLIO/src/ICLIO/SharedMemoryRing.h                     **
+** Module : ICLIO                                                  **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#pragma once
+
+#include <ICLUtils/CompatMacros.h>
+#include <ICLUtils/BasicTypes.h>
+#include <ICLUtils/Uncopyable.h>
+#include <ICLUtils/Exception.h>
+#include <string>
+#include <vector>
+
+namespace icl{
+  namespace io{
+
+    /// Lock-free multi-slot ring buffer in POSIX shared memory (Linux only)
+    /** The SharedMemoryRing is the transport layer of the "smr" image output
+        and grabber backends (see SharedMemoryRingPublisher and
+        SharedMemoryRingGrabber). In contrast to the Qt-based SharedMemorySegment,
+        it does not use a system semaphore that is locked by the writer and all
+        readers for the whole copy operation. Instead:
+
+        - the segment contains a ring of numSlots slots, each slot starts at a
+          page aligned offset (and is therefore also 64-Byte aligned)
+        - there is exactly one writer, that writes frame n into slot n % numSlots.
+          The writer never waits for readers.
+        - each slot is protected by its own sequence counter (seqlock): the
+          counter is odd while the writer writes the slot and it becomes 2n once
+          frame n is complete. A reader reads the counter, uses the slot data and
+          checks the counter again afterwards (see validate). If the counter has
+          changed, the writer has overwritten the slot in the meantime and the
+          read has to be repeated. As the writer always writes the oldest slot,
+          a reader has numSlots-1 frame periods to use a slot.
+        - readers that wait for a new frame are blocked in the kernel using a futex
+          on a frame counter in the segment header. The writer only issues a wake-up
+          system call if at least one reader is waiting.
+        - readers map the slot data read-only, so a View can directly be wrapped
+          (e.g. using core::ImageSerializer::wrapAligned) without copying and
+          without the risk of corrupting the ring
+
+        Any number of readers can be attached to a ring. If the writer needs larger
+        slots, it marks the current segment as obsolete and replaces it by a new one
+        with the same name. Readers notice this on their next access and reconnect
+        automatically.
+
+        \section EX Example
+        <pre>
+        // writer process
+        SharedMemoryRing w("my-ring",4,1<<20);
+        icl8u *slot = w.beginWrite(n);
+        std::copy(src,src+n,slot);
+        w.commitWrite(n);
+
+        // reader process
+        SharedMemoryRing r("my-ring");
+        icl64u last = 0;
+        while(r.waitForFrame(last,1000)){
+          SharedMemoryRing::View v = r.getLatest();
+          process(v.data,v.size);
+          if(r.validate(v)) last = v.frame; // otherwise, v was overwritten while processing
+        }
+        </pre>
+    */
+    class ICLIO_API SharedMemoryRing : public utils::Uncopyable{
+      struct Data;  //!< internal data
+      Data *m_data; //!< internal data
+
+      public:
+
+      /// zero-copy read-only reference to a published frame
+      struct View{
+        const icl8u *data; //!< slot data (64-Byte aligned), null if the view is invalid
+        size_t size;       //!< number of valid Bytes in the slot
+        icl64u frame;      //!< frame number (the first frame is 1)
+        int slot;          //!< slot index
+        icl64u seq;        //!< slot sequence counter at acquisition time
+
+        /// creates an invalid view
+        View():data(0),size(0),frame(0),slot(-1),seq(0){}
+
+        /// returns whether the view references a frame
+        bool isNull() const { return !data; }
+      };
+
+      /// creates a writer that creates (or replaces) the ring with the given name
+      /** slotSize is rounded up to a multiple of the page size */
+      SharedMemoryRing(const std::string &name, int numSlots, size_t slotSize) throw (utils::ICLException);
+
+      /// creates a reader that connects to the existing ring with the given name
+      /** An exception is thrown if no ring with that name exists */
+      SharedMemoryRing(const std::string &name) throw (utils::ICLException);
+
+      /// Destructor
+      /** If this instance is the writer, the ring is marked obsolete, all waiting
+          readers are woken up and the segment name is removed. Readers that are
+          still attached keep their mapping until they are destroyed */
+      ~SharedMemoryRing();
+
+      /// returns the ring name
+      const std::string &getName() const;
+
+      /// returns whether this instance is the writer
+      bool isWriter() const;
+
+      /// returns the number of slots
+      int getNumSlots() const;
+
+      /// returns the capacity of each slot in Bytes
+      size_t getSlotSize() const;
+
+      /// returns the number of the latest published frame (0 if there is none yet)
+      icl64u getLatestFrame() const;
+
+      /// returns whether the writer has replaced or closed the ring
+      /** Readers of an obsolete ring have to reconnect (see reconnect) */
+      bool isObsolete() const;
+
+      /// writer only: starts writing a frame of given size (in Bytes) and returns the slot data
+      /** The returned pointer is 64-Byte aligned. An exception is thrown if
+          size is larger than the slot size */
+      icl8u *beginWrite(size_t size) throw (utils::ICLException);
+
+      /// writer only: publishes the frame that was started with beginWrite
+      /** size can be smaller than the size that was passed to beginWrite.
+          The frame number of the published frame is returned */
+      icl64u commitWrite(size_t size) throw (utils::ICLException);
+
+      /// reader only: waits until a frame newer than lastFrame is published
+      /** Returns true if a newer frame is available and false if the ring became
+          obsolete or if no new frame was published within timeoutMs
+          milliseconds (a negative timeout waits forever) */
+      bool waitForFrame(icl64u lastFrame, int timeoutMs=-1);
+
+      /// returns a view to the latest published frame (the view is null if there is none)
+      View getLatest() const;
+
+      /// checks whether the given view was not overwritten by the writer in the meantime
+      /** Must be called after the view's data was processed. If false is returned,
+          all results computed from the view data have to be discarded */
+      bool validate(const View &view) const;
+
+      /// reader only: connects to the current segment with the same name
+      /** Returns false if no such segment exists (the old segment is kept then) */
+      bool reconnect();
+
+      /// returns the names of all existing rings
+      static std::vector<std::string> getRingNames();
+    };
+
+  } // namespace io
+}
@@ -0,0 +1,200 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLIO/src/ICLIO/SharedMemoryRingGrabber.cpp            **
+** Module : ICLIO                                                  **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#include <ICLIO/SharedMemoryRingGrabber.h>
+#include <ICLIO/SharedMemoryRing.h>
+#include <ICLCore/ImageSerializer.h>
+#include <ICLUtils/StringUtils.h>
+#include <ICLUtils/SmartPtr.h>
+#include <ICLUtils/Thread.h>
+#include <ICLUtils/Mutex.h>
+
+using namespace icl::utils;
+using namespace icl::core;
+
+namespace icl{
+  namespace io{
+
+    static void addDevicesToList(std::vector<GrabberDeviceDescription> &deviceList){
+      std::vector<std::string> names = SharedMemoryRing::getRingNames();
+      for(unsigned int i=0;i<names.size();++i){
+        deviceList.push_back(GrabberDeviceDescription("smr",names[i],names[i]));
+      }
+    }
+
+    struct SharedMemoryRingGrabber::Data{
+      SmartPtr<SharedMemoryRing> ring;
+      ImgBase *copied;   // image with own channel data
+      ImgBase *wrapped;  // image that references the ring's slot memory
+      bool zeroCopy;
+      bool omitDoubledFrames;
+      int timeout;
+      icl64u lastFrame;
+      SharedMemoryRing::View lastView;
+      bool lastViewWrapped;
+      Mutex mutex;
+    };
+
+    SharedMemoryRingGrabber::SharedMemoryRingGrabber(const std::string &name) throw(ICLException):
+      m_data(new Data){
+      m_data->copied = 0;
+      m_data->wrapped = 0;
+      m_data->zeroCopy = false;
+      m_data->omitDoubledFrames = true;
+      m_data->timeout = 1000;
+      m_data->lastFrame = 0;
+      m_data->lastViewWrapped = false;
+
+      if(name.length()){
+        try{
+          m_data->ring = new SharedMemoryRing(name);
+        }catch(ICLException &e){
+          delete m_data;
+          throw ICLException(str(__FUNCTION__)+": unable to connect to shared memory ring \"" + name + "\"");
+        }
+      }
+
+      addProperty("format", "info", "", "", 0, "");
+      addProperty("size", "info", "", "", 0, "");
+      addProperty("omit-doubled-frames", "flag", "", m_data->omitDoubledFrames, 0,
+                  "If set, the grabber waits for a new image");
+      addProperty("zero-copy", "flag", "", m_data->zeroCopy, 0,
+                  "If set, grabbed images reference the shared memory directly");
+      addProperty("timeout", "range", "[0,10000]:1", m_data->timeout, 0,
+                  "Maximum time (in ms) to wait for a new image");
+
+      Configurable::registerCallback(utils::function(this,&SharedMemoryRingGrabber::processPropertyChange));
+    }
+
+    SharedMemoryRingGrabber::~SharedMemoryRingGrabber(){
+      ICL_DELETE(m_data->copied);
+      ICL_DELETE(m_data->wrapped);
+      delete m_data;
+    }
+
+    const std::vector<GrabberDeviceDescription> &SharedMemoryRingGrabber::getDeviceList(bool rescan){
+      static std::vector<GrabberDeviceDescription> deviceList;
+      if(rescan){
+        deviceList.clear();
+        addDevicesToList(deviceList);
+      }
+      return deviceList;
+    }
+
+    const ImgBase* SharedMemoryRingGrabber::acquireImage(){
+      Mutex::Locker lock(m_data->mutex);
+      ICLASSERT_RETURN_VAL(m_data->ring, 0);
+      SharedMemoryRing &ring = *m_data->ring;
+      const Time deadline = Time::now() + Time(icl64s(m_data->timeout)*1000);
+
+      while(true){
+        if(ring.isObsolete()){
+          // the publisher has replaced (or closed) the ring: frame numbers start again
+          if(ring.reconnect()) m_data->lastFrame = 0;
+        }
+        int remaining = (int)(deadline - Time::now()).toMilliSeconds();
+        if(remaining < 0) return 0;
+        if(!ring.waitForFrame(m_data->omitDoubledFrames ? m_data->lastFrame : 0, remaining)){
+          if(ring.isObsolete()) Thread::msleep(1); // the new ring might not exist yet
+          continue;
+        }
+
+        SharedMemoryRing::View v = ring.getLatest();
+        if(v.isNull()) continue;
+
+        // the writer may overwrite the slot at any time: the length-checked parsing
+        // functions check all sizes of the header against the slot size, so that an
+        // inconsistent header can never lead to reading beyond the slot
+        const size_t len = iclMin(v.size, ring.getSlotSize());
+        if(len < ImageSerializer::getAlignedHeaderSize()) continue;
+        if(!ring.validate(v)) continue;
+
+        ImgBase **image = m_data->zeroCopy ? &m_data->wrapped : &m_data->copied;
+        try{
+          if(m_data->zeroCopy){
+            ImageSerializer::wrapAligned(const_cast<icl8u*>(v.data), len, image);
+          }else{
+            ImageSerializer::deserialize(v.data, len, image);
+          }
+        }catch(const std::exception &){
+          // the header was overwritten while it was parsed
+          if(ring.validate(v)) throw;
+          continue;
+        }
+        if(!ring.validate(v)) continue;
+
+        m_data->lastFrame = v.frame;
+        m_data->lastView = v;
+        m_data->lastViewWrapped = m_data->zeroCopy;
+
+        if(Size(getPropertyValue("size")) != (*image)->getSize()){
+          setPropertyValue("size", (*image)->getSize());
+        }
+        return (*image)->getDim() ? *image : 0;
+      }
+    }
+
+    bool SharedMemoryRingGrabber::isLastImageValid() const{
+      if(!m_data->lastViewWrapped) return true;
+      return m_data->ring->validate(m_data->lastView);
+    }
+
+    void SharedMemoryRingGrabber::processPropertyChange(const utils::Configurable::Property &prop){
+      if(prop.name == "omit-doubled-frames"){
+        m_data->omitDoubledFrames = parse<bool>(prop.value);
+      }else if(prop.name == "zero-copy"){
+        m_data->zeroCopy = parse<bool>(prop.value);
+      }else if(prop.name == "timeout"){
+        m_data->timeout = parse<int>(prop.value);
+      }
+    }
+
+    REGISTER_CONFIGURABLE(SharedMemoryRingGrabber, return new SharedMemoryRingGrabber(""));
+
+    Grabber* createSMRGrabber(const std::string &param){
+      return new SharedMemoryRingGrabber(param);
+    }
+
+    const std::vector<GrabberDeviceDescription>& getSMRDeviceList(std::string hint, bool rescan){
+      static std::vector<GrabberDeviceDescription> deviceList;
+      if(!rescan) return deviceList;
+
+      deviceList.clear();
+      addDevicesToList(deviceList);
+      if(hint.size()) deviceList.push_back(
+        GrabberDeviceDescription("smr", hint, "A grabber for images published via a shared memory ring.")
+        );
+      return deviceList;
+    }
+
+    REGISTER_GRABBER(smr,utils::function(createSMRGrabber), utils::function(getSMRDeviceList), "smr:shared memory ring name:lock-free shared memory ring source (Linux only)");
+
+  } // namespace io
+}
@@ -0,0 +1,90 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLIO/src/ICLIO/SharedMemoryRingGrabber.h              **
+** Module : ICLIO                                                  **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#pragma once
+
+#include <ICLUtils/CompatMacros.h>
+#include <ICLIO/Grabber.h>
+
+namespace icl{
+  namespace io{
+
+    /// Grabber class that grabs images from a SharedMemoryRing (Linux only)
+    /** Images that are published using the SharedMemoryRingPublisher can
+        be grabbed with this grabber type. Please don't use this Grabber class
+        directly, but instantiate GenericGrabber with device type 'smr'.
+
+        \section PROPS Properties
+        - <b>omit-doubled-frames</b> (default true): acquireImage blocks until a new
+          frame is published (the grabber thread sleeps on a futex and is woken up
+          by the publisher)
+        - <b>timeout</b>: maximum time (in ms) to wait for a new frame. If no
+          frame is published within this time, acquireImage returns null
+        - <b>zero-copy</b> (default false): if enabled, the returned image's
+          channels directly reference the read-only slot memory of the ring.
+          Such an image must not be modified and it is only valid until the
+          next call to acquireImage. Moreover, the publisher might overwrite the
+          slot while the image is still in use (which happens if numSlots-1
+          more images are published in the meantime). Use isLastImageValid
+          after processing the image to detect this case.
+    */
+    class ICLIO_API SharedMemoryRingGrabber : public Grabber {
+      /// Internal Data storage class
+      struct Data;
+
+      /// Hidden Data container
+      Data *m_data;
+
+      public:
+
+      /// Creates a new SharedMemoryRingGrabber instance (please use the GenericGrabber instead)
+      SharedMemoryRingGrabber(const std::string &name="") throw(utils::ICLException);
+
+      /// Destructor
+      ~SharedMemoryRingGrabber();
+
+      /// returns a list of all available shared-memory rings
+      static const std::vector<GrabberDeviceDescription> &getDeviceList(bool rescan);
+
+      /// grabbing function
+      /** \copydoc icl::io::Grabber::grab(core::ImgBase**)  **/
+      virtual const core::ImgBase* acquireImage();
+
+      /// returns whether the last acquired image was not overwritten by the publisher
+      /** This is only relevant if the "zero-copy" property is enabled, copied images
+          are always valid */
+      bool isLastImageValid() const;
+
+      /// callback for changed configurable properties
+      void processPropertyChange(const utils::Configurable::Property &prop);
+    };
+
+  } // namespace io
+}
@@ -0,0 +1,91 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLIO/src/ICLIO/SharedMemoryRingPublisher.cpp          **
+** Module : ICLIO                                                  **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#include <ICLIO/SharedMemoryRingPublisher.h>
+#include <ICLIO/SharedMemoryRing.h>
+#include <ICLCore/ImageSerializer.h>
+#include <ICLUtils/StringUtils.h>
+#include <ICLUtils/SmartPtr.h>
+
+using namespace icl::utils;
+using namespace icl::core;
+
+namespace icl{
+  namespace io{
+
+    struct SharedMemoryRingPublisher::Data{
+      std::string name;
+      int numSlots;
+      SmartPtr<SharedMemoryRing> ring;
+      icl64u numPublished;
+    };
+
+    SharedMemoryRingPublisher::SharedMemoryRingPublisher(const std::string &name, int numSlots) throw (ICLException):
+      m_data(new Data){
+      m_data->numPublished = 0;
+      createPublisher(name,numSlots);
+    }
+
+    SharedMemoryRingPublisher::~SharedMemoryRingPublisher(){
+      delete m_data;
+    }
+
+    void SharedMemoryRingPublisher::createPublisher(const std::string &name, int numSlots) throw (ICLException){
+      ICLASSERT_THROW(numSlots >= 2, ICLException(str(__FUNCTION__)+": at least 2 slots are needed"));
+      m_data->ring = SmartPtr<SharedMemoryRing>();
+      m_data->name = name;
+      m_data->numSlots = numSlots;
+    }
+
+    void SharedMemoryRingPublisher::publish(const ImgBase *image){
+      ICLASSERT_RETURN(image);
+      ICLASSERT_RETURN(m_data->name.length());
+      size_t size = ImageSerializer::estimateAlignedSerializedSize(image);
+      if(!m_data->ring || m_data->ring->getSlotSize() < size){
+        // the old ring must be removed before its name is reused
+        m_data->ring = SmartPtr<SharedMemoryRing>();
+        m_data->ring = new SharedMemoryRing(m_data->name, m_data->numSlots, size + size/4);
+      }
+      SharedMemoryRing &r = *m_data->ring;
+      ImageSerializer::serializeAligned(image, r.beginWrite(size));
+      r.commitWrite(size);
+      ++m_data->numPublished;
+    }
+
+    std::string SharedMemoryRingPublisher::getRingName() const{
+      return m_data->name;
+    }
+
+    icl64u SharedMemoryRingPublisher::getNumPublishedFrames() const{
+      return m_data->numPublished;
+    }
+
+  } // namespace io
+}
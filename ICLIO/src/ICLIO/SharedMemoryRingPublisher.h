@@ -0,0 +1,81 @@
+/********************************************************************
+**                Image Component Library (ICL)                    **
+**                                                                 **
+** Copyright (C) 2006-2013 CITEC, University of Bielefeld          **
+**                         Neuroinformatics Group                  **
+** Website: www.iclcv.org and                                      **
+**          http://opensource.cit-ec.de/projects/icl               **
+**                                                                 **
+** File   : ICLIO/src/ICLIO/SharedMemoryRingPublisher.h            **
+** Module : ICLIO                                                  **
+** Authors: Christof Elbrechter                                    **
+**                                                                 **
+**                                                                 **
+** GNU LESSER GENERAL PUBLIC LICENSE                               **
+** This file may be used under the terms of the GNU Lesser General **
+** Public License version 3.0 as published by the                  **
+**                                                                 **
+** Free Software Foundation and appearing in the file LICENSE.LGPL **
+** included in the packaging of this file.  Please review the      **
+** following information to ensure the license requirements will   **
+** be met: http://www.gnu.org/licenses/lgpl-3.0.txt                **
+**                                                                 **
+** The development of this software was supported by the           **
+** Excellence Cluster EXC 277 Cognitive Interaction Technology.    **
+** The Excellence Cluster EXC 277 is a grant of the Deutsche       **
+** Forschungsgemeinschaft (DFG) in the context of the German       **
+** Excellence Initiative.                                          **
+**                                                                 **
+********************************************************************/
+
+#pragma once
+
+#include <ICLUtils/CompatMacros.h>
+#include <ICLCore/ImgBase.h>
+#include <ICLIO/ImageOutput.h>
+
+namespace icl{
+  namespace io{
+
+    /// Publisher, that publishes images via a SharedMemoryRing (Linux only)
+    /** Images are serialized in the aligned wire format of core::ImageSerializer
+        directly into the next slot of the ring, so sending an image needs exactly
+        one copy of the image data. Readers are woken up by a futex instead of
+        polling (see SharedMemoryRing for details). Images can be grabbed using the
+        SharedMemoryRingGrabber (GenericGrabber backend "smr").
+
+        The slot size is adapted automatically: if an image does not fit into
+        the current slots, the ring is replaced by a new one, whose slots are
+        25% larger than needed. Attached grabbers reconnect automatically.
+    */
+    class ICLIO_API SharedMemoryRingPublisher : public ImageOutput{
+      struct Data;  //!< internal data
+      Data *m_data; //!< internal data
+
+      public:
+
+      /// Creates a new publisher instance
+      /** If name is "", no ring is created */
+      SharedMemoryRingPublisher(const std::string &name="", int numSlots=4) throw (utils::ICLException);
+
+      /// Destructor (removes the ring)
+      ~SharedMemoryRingPublisher();
+
+      /// sets the publisher to use a new ring
+      /** The ring itself is created when the first image is published */
+      void createPublisher(const std::string &name, int numSlots=4) throw (utils::ICLException);
+
+      /// publishes given image
+      void publish(const core::ImgBase *image);
+
+      /// wraps publish to implement ImageOutput interface
+      virtual void send(const core::ImgBase *image) { publish(image); }
+
+      /// returns current ring name
+      std::string getRingName() const;
+
+      /// returns the number of published frames
+      icl64u getNumPublishedFrames() const;
+    };
+  } // namespace io
+}
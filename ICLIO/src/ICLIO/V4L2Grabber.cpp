@@ -708,6 +708,9 @@ namespace icl{
 
     const ImgBase *V4L2Grabber::acquireImage(){
       Mutex::Locker lock(implMutex);
+      impl->mutex.lock();
+      impl->decoder.setDesiredSize(getDesired<Size>()); // motion jpeg is decoded at reduced size
+      impl->mutex.unlock();
       const ImgBase *image = 0;
       do{ image = impl->acquireImage(); } while(!image || !image->getDim() );
       return image;
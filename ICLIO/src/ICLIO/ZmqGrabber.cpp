@@ -105,6 +105,7 @@ namespace icl{
         Thread::msleep(10);
         m_data->mutex.lock();
       }
+      m_data->cmp.setDesiredSize(getDesired<Size>());
       const ImgBase *image = m_data->cmp.uncompress(m_data->rbuf.data(), m_data->rbuf.size());
       m_data->mutex.unlock();
       return image;